@@ -364,6 +364,25 @@ struct cfs_percpt_lock {
 	unsigned int		  pcl_locked;
 	/* private lock table */
 	spinlock_t		**pcl_locks;
+	/* when the current exclusive hold started */
+	ktime_t			  pcl_ex_start;
+	/* exclusive lock statistics, updated with all locks held */
+	__u64			  pcl_ex_count;
+	__u64			  pcl_ex_hold_ns;
+	__u64			  pcl_ex_max_ns;
+	/* # private lockers that had to wait for an exclusive holder */
+	atomic64_t		  pcl_ex_stalls;
+};
+
+/* snapshot of the statistics of a cpu-partition lock */
+struct cfs_percpt_lock_stats {
+	/* # exclusive acquisitions */
+	__u64	pls_ex_count;
+	/* total and longest time the lock was held exclusively */
+	__u64	pls_ex_hold_ns;
+	__u64	pls_ex_max_ns;
+	/* # private acquisitions stalled behind an exclusive holder */
+	__u64	pls_ex_stalls;
 };
 
 /* return number of private locks */
@@ -384,6 +403,11 @@ void cfs_percpt_lock(struct cfs_percpt_lock *pcl, int index);
 /* unlock private lock \a index of \a pcl */
 void cfs_percpt_unlock(struct cfs_percpt_lock *pcl, int index);
 
+/* get/reset exclusive locking statistics of \a pcl */
+void cfs_percpt_lock_stats_get(struct cfs_percpt_lock *pcl,
+			       struct cfs_percpt_lock_stats *stats);
+void cfs_percpt_lock_stats_reset(struct cfs_percpt_lock *pcl);
+
 #define CFS_PERCPT_LOCK_KEYS	256
 
 /* NB: don't allocate keys dynamically, lockdep needs them to be in ".data" */
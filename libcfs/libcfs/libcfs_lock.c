@@ -107,7 +107,9 @@ __acquires(pcl->pcl_locks)
 
 	if (ncpt == 1) {
 		index = 0;
-	} else { /* serialize with exclusive lock */
+	} else if (unlikely(pcl->pcl_locked)) {
+		/* serialize with exclusive lock */
+		atomic64_inc(&pcl->pcl_ex_stalls);
 		while (pcl->pcl_locked)
 			cpu_relax();
 	}
@@ -127,6 +129,7 @@ __acquires(pcl->pcl_locks)
 			pcl->pcl_locked = 1;
 		}
 	}
+	pcl->pcl_ex_start = ktime_get();
 }
 EXPORT_SYMBOL(cfs_percpt_lock);
 
@@ -136,6 +139,7 @@ cfs_percpt_unlock(struct cfs_percpt_lock *pcl, int index)
 __releases(pcl->pcl_locks)
 {
 	int	ncpt = cfs_cpt_number(pcl->pcl_cptab);
+	s64	held;
 	int	i;
 
 	index = ncpt == 1 ? 0 : index;
@@ -145,6 +149,12 @@ __releases(pcl->pcl_locks)
 		return;
 	}
 
+	held = ktime_to_ns(ktime_sub(ktime_get(), pcl->pcl_ex_start));
+	pcl->pcl_ex_count++;
+	pcl->pcl_ex_hold_ns += held;
+	if (held > pcl->pcl_ex_max_ns)
+		pcl->pcl_ex_max_ns = held;
+
 	for (i = ncpt - 1; i >= 0; i--) {
 		if (i == 0) {
 			LASSERT(pcl->pcl_locked);
@@ -154,3 +164,33 @@ __releases(pcl->pcl_locks)
 	}
 }
 EXPORT_SYMBOL(cfs_percpt_unlock);
+
+/**
+ * get exclusive locking statistics of a cpu-partition lock
+ *
+ * The counters are read without locking, so the snapshot may be slightly
+ * inconsistent, which is fine for monitoring purposes.
+ */
+void
+cfs_percpt_lock_stats_get(struct cfs_percpt_lock *pcl,
+			  struct cfs_percpt_lock_stats *stats)
+{
+	stats->pls_ex_count = READ_ONCE(pcl->pcl_ex_count);
+	stats->pls_ex_hold_ns = READ_ONCE(pcl->pcl_ex_hold_ns);
+	stats->pls_ex_max_ns = READ_ONCE(pcl->pcl_ex_max_ns);
+	stats->pls_ex_stalls = atomic64_read(&pcl->pcl_ex_stalls);
+}
+EXPORT_SYMBOL(cfs_percpt_lock_stats_get);
+
+/** reset exclusive locking statistics of a cpu-partition lock */
+void
+cfs_percpt_lock_stats_reset(struct cfs_percpt_lock *pcl)
+{
+	cfs_percpt_lock(pcl, CFS_PERCPT_LOCK_EX);
+	pcl->pcl_ex_count = 0;
+	pcl->pcl_ex_hold_ns = 0;
+	pcl->pcl_ex_max_ns = 0;
+	atomic64_set(&pcl->pcl_ex_stalls, 0);
+	cfs_percpt_unlock(pcl, CFS_PERCPT_LOCK_EX);
+}
+EXPORT_SYMBOL(cfs_percpt_lock_stats_reset);
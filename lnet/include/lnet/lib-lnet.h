@@ -544,7 +544,9 @@ extern unsigned int lnet_health_sensitivity;
 extern unsigned int lnet_recovery_interval;
 extern unsigned int lnet_recovery_limit;
 extern unsigned int lnet_peer_discovery_disabled;
+extern unsigned int lnet_max_discovery_pings;
 extern unsigned int lnet_drop_asym_route;
+extern unsigned int lnet_path_selection;
 extern unsigned int router_sensitivity_percentage;
 extern int alive_router_check_interval;
 extern int live_router_check_interval;
@@ -724,6 +726,8 @@ void lnet_msg_containers_destroy(void);
 int lnet_msg_containers_create(void);
 
 char *lnet_health_error2str(enum lnet_msg_hstatus hstatus);
+void lnet_path_stats_update(struct lnet_path_stats *ps, s64 rtt_ns,
+			    unsigned int nob);
 char *lnet_msgtyp2str(int type);
 int lnet_fail_nid(lnet_nid_t nid, unsigned int threshold);
 
@@ -938,6 +942,7 @@ int lnet_peer_ni_set_non_mr_pref_nid(struct lnet_peer_ni *lpni, lnet_nid_t nid);
 int lnet_add_peer_ni(lnet_nid_t key_nid, lnet_nid_t nid, bool mr, bool temp);
 int lnet_del_peer_ni(lnet_nid_t key_nid, lnet_nid_t nid);
 int lnet_get_peer_info(struct lnet_ioctl_peer_cfg *cfg, void __user *bulk);
+int lnet_get_peer_ni_pstats(struct lnet_ioctl_peer_ni_pstats *stats);
 int lnet_get_peer_ni_info(__u32 peer_index, __u64 *nid,
 			  char alivness[LNET_MAX_STR_LEN],
 			  __u32 *cpt_iter, __u32 *refcount,
@@ -121,6 +121,9 @@ struct lnet_msg {
 	 */
 	ktime_t			msg_deadline;
 
+	/* When the message was last handed to the LND for sending */
+	ktime_t			msg_send_time;
+
 	/* The message health status. */
 	enum lnet_msg_hstatus	msg_health_status;
 	/* This is a recovery message */
@@ -387,6 +390,35 @@ struct lnet_health_remote_stats {
 	atomic_t hlt_network_timeout;
 };
 
+/* how multi-rail selection breaks ties between equally healthy paths */
+enum lnet_path_sel_policy {
+	/* most available credits, then round-robin */
+	LNET_PATH_SEL_CREDITS = 0,
+	/* lowest expected completion time from measured RTT/bandwidth */
+	LNET_PATH_SEL_MEASURED = 1,
+	LNET_PATH_SEL_MAX = LNET_PATH_SEL_MEASURED,
+};
+
+/* path measurements older than this (seconds) are no longer trusted */
+#define LNET_PATH_STATS_MAX_AGE	30
+
+/*
+ * Measured performance of a path, fed back from message completion.
+ * Both values are exponentially weighted moving averages and are 0
+ * until the first sample arrives. Protected by ni_lock for a local NI
+ * and lpni_lock for a peer NI.
+ */
+struct lnet_path_stats {
+	/* send completion time in microseconds */
+	__u32	lps_rtt_usec;
+	/* achieved bandwidth in bytes per second */
+	__u64	lps_bytes_per_sec;
+	/* number of samples folded into the averages */
+	__u64	lps_samples;
+	/* when the last sample was folded in, in seconds */
+	time64_t lps_last_sample;
+};
+
 struct lnet_net {
 	/* chain on the ln_nets */
 	struct list_head	net_list;
@@ -467,6 +499,9 @@ struct lnet_ni {
 	/* per ni credits */
 	atomic_t		ni_tx_credits;
 
+	/* bytes of messages holding NI tx credits */
+	atomic_long_t		ni_txqnob;
+
 	/* percpt TX queues */
 	struct lnet_tx_queue	**ni_tx_queues;
 
@@ -501,6 +536,7 @@ struct lnet_ni {
 	/* NI statistics */
 	struct lnet_element_stats ni_stats;
 	struct lnet_health_local_stats ni_hstats;
+	struct lnet_path_stats	ni_path_stats;
 
 	/* physical device CPT */
 	int			ni_dev_cpt;
@@ -578,6 +614,7 @@ struct lnet_peer_ni {
 	/* statistics kept on each peer NI */
 	struct lnet_element_stats lpni_stats;
 	struct lnet_health_remote_stats lpni_hstats;
+	struct lnet_path_stats	lpni_path_stats;
 	/* spin lock protecting credits and lpni_txq */
 	spinlock_t		lpni_lock;
 	/* # tx credits available */
@@ -703,6 +740,15 @@ struct lnet_peer {
 	/* buffer for data pushed by peer */
 	struct lnet_ping_buffer	*lp_data;
 
+	/* last data merged into the peer, to recognise repeated pushes */
+	struct lnet_ping_buffer	*lp_merged_data;
+
+	/* lp_ni_gen when lp_merged_data was merged */
+	unsigned int		lp_merged_gen;
+
+	/* bumped whenever a peer_ni is attached to or detached from peer */
+	unsigned int		lp_ni_gen;
+
 	/* MD handle for ping in progress */
 	struct lnet_handle_md	lp_ping_mdh;
 
@@ -1198,6 +1244,10 @@ struct lnet {
 	struct list_head		ln_dc_working;
 	/* discovery expired list */
 	struct list_head		ln_dc_expired;
+	/* peers waiting for a discovery ping slot */
+	struct list_head		ln_dc_deferred;
+	/* # discovery pings in flight */
+	atomic_t			ln_dc_pings;
 	/* discovery thread wait queue */
 	wait_queue_head_t		ln_dc_waitq;
 	/* discovery startup/shutdown state */
@@ -1246,6 +1296,13 @@ struct lnet {
 	struct list_head		ln_mt_localNIRecovq;
 	/* local NIs to recover */
 	struct list_head		ln_mt_peerNIRecovq;
+	/*
+	 * Protects the recovery queues, the ni_recovery/lpni_recovery
+	 * links and the recovery ping counts. Health updates happen on the
+	 * message completion path, so these must not need the net lock of
+	 * one particular CPT, let alone the exclusive one.
+	 */
+	spinlock_t			ln_mt_recovery_lock;
 	/*
 	 * An array of queues for GET/PUT waiting for REPLY/ACK respectively.
 	 * There are CPT number of queues. Since response trackers will be
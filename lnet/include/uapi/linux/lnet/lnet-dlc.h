@@ -213,6 +213,16 @@ struct lnet_ioctl_peer_ni_hstats {
 	__u64 hlpni_next_ping;
 };
 
+/* measured path performance of a peer NI, see lnet_path_selection */
+struct lnet_ioctl_peer_ni_pstats {
+	struct libcfs_ioctl_hdr pst_hdr;
+	lnet_nid_t pst_nid;
+	__u32 pst_rtt_usec;
+	__u32 pst_padding;
+	__u64 pst_bytes_per_sec;
+	__u64 pst_samples;
+};
+
 struct lnet_ioctl_element_msg_stats {
 	struct libcfs_ioctl_hdr im_hdr;
 	__u32 im_idx;
@@ -616,7 +616,7 @@ kiblnd_debug_conn(struct kib_conn *conn)
 		kiblnd_debug_tx(list_entry(tmp, struct kib_tx, tx_list));
 
 	CDEBUG(D_CONSOLE, "   rxs:\n");
-	for (i = 0; i < IBLND_RX_MSGS(conn); i++)
+	for (i = 0; conn->ibc_rxs != NULL && i < IBLND_RX_MSGS(conn); i++)
 		kiblnd_debug_rx(&conn->ibc_rxs[i]);
 
 	spin_unlock(&conn->ibc_lock);
@@ -822,6 +822,8 @@ kiblnd_create_conn(struct kib_peer_ni *peer_ni, struct rdma_cm_id *cmid,
 
         kiblnd_hdev_addref_locked(dev->ibd_hdev);
         conn->ibc_hdev = dev->ibd_hdev;
+	if (conn->ibc_hdev->ibh_srqs != NULL)
+		conn->ibc_srq = conn->ibc_hdev->ibh_srqs[cpt];
 
         kiblnd_setup_mtu_locked(cmid);
 
@@ -867,6 +869,8 @@ kiblnd_create_conn(struct kib_peer_ni *peer_ni, struct rdma_cm_id *cmid,
 	init_qp_attr.qp_type = IB_QPT_RC;
 	init_qp_attr.send_cq = cq;
 	init_qp_attr.recv_cq = cq;
+	if (conn->ibc_srq != NULL)
+		init_qp_attr.srq = conn->ibc_srq->isrq_srq;
 
 	if (peer_ni->ibp_queue_depth_mod &&
 	    peer_ni->ibp_queue_depth_mod < peer_ni->ibp_queue_depth) {
@@ -881,7 +885,8 @@ kiblnd_create_conn(struct kib_peer_ni *peer_ni, struct rdma_cm_id *cmid,
 		 * the maximum work requests for the device is maxed out
 		 */
 		init_qp_attr.cap.max_send_wr = kiblnd_send_wrs(conn);
-		init_qp_attr.cap.max_recv_wr = IBLND_RECV_WRS(conn);
+		init_qp_attr.cap.max_recv_wr = conn->ibc_srq != NULL ?
+					       0 : IBLND_RECV_WRS(conn);
 		rc = rdma_create_qp(cmid, conn->ibc_hdev->ibh_pd,
 				    &init_qp_attr);
 		if (rc != -ENOMEM || conn->ibc_queue_depth < 2)
@@ -911,6 +916,18 @@ kiblnd_create_conn(struct kib_peer_ni *peer_ni, struct rdma_cm_id *cmid,
 		peer_ni->ibp_queue_depth_mod = conn->ibc_queue_depth;
 	}
 
+	if (conn->ibc_srq != NULL) {
+		/* Receives complete on my CQ from buffers in the shared pool.
+		 * The SRQ attachment counts as one rx (and holds a ref) until
+		 * my CQ has been drained after the QP is disconnected, see
+		 * kiblnd_scheduler().
+		 */
+		atomic_set(&conn->ibc_refcount, 2);
+		conn->ibc_nrx = 1;
+		conn->ibc_srq_attached = 1;
+		goto posted;
+	}
+
 	LIBCFS_CPT_ALLOC(conn->ibc_rxs, lnet_cpt_table(), cpt,
 			 IBLND_RX_MSGS(conn) * sizeof(struct kib_rx));
 	if (conn->ibc_rxs == NULL) {
@@ -958,6 +975,7 @@ kiblnd_create_conn(struct kib_peer_ni *peer_ni, struct rdma_cm_id *cmid,
                 }
         }
 
+posted:
         /* Init successful! */
         LASSERT (state == IBLND_CONN_ACTIVE_CONNECT ||
                  state == IBLND_CONN_PASSIVE_WAIT);
@@ -1228,52 +1246,43 @@ kiblnd_alloc_pages(struct kib_pages **pp, int cpt, int npages)
         return 0;
 }
 
-void
-kiblnd_unmap_rx_descs(struct kib_conn *conn)
+static void
+kiblnd_unmap_rx_pages(struct kib_hca_dev *hdev, struct kib_rx *rxs, int nrx)
 {
 	struct kib_rx *rx;
-        int       i;
-
-        LASSERT (conn->ibc_rxs != NULL);
-        LASSERT (conn->ibc_hdev != NULL);
-
-	for (i = 0; i < IBLND_RX_MSGS(conn); i++) {
-		rx = &conn->ibc_rxs[i];
+	int i;
 
-		LASSERT(rx->rx_nob >= 0); /* not posted */
+	for (i = 0; i < nrx; i++) {
+		rx = &rxs[i];
 
-		kiblnd_dma_unmap_single(conn->ibc_hdev->ibh_ibdev,
+		kiblnd_dma_unmap_single(hdev->ibh_ibdev,
 					KIBLND_UNMAP_ADDR(rx, rx_msgunmap,
 							  rx->rx_msgaddr),
 					IBLND_MSG_SIZE, DMA_FROM_DEVICE);
 	}
-
-        kiblnd_free_pages(conn->ibc_rx_pages);
-
-        conn->ibc_rx_pages = NULL;
 }
 
-void
-kiblnd_map_rx_descs(struct kib_conn *conn)
+static void
+kiblnd_map_rx_pages(struct kib_hca_dev *hdev, struct kib_rx *rxs, int nrx,
+		    struct kib_pages *pages)
 {
 	struct kib_rx *rx;
-        struct page    *pg;
-        int             pg_off;
-        int             ipg;
-        int             i;
+	struct page *pg;
+	int pg_off;
+	int ipg;
+	int i;
 
-	for (pg_off = ipg = i = 0; i < IBLND_RX_MSGS(conn); i++) {
-		pg = conn->ibc_rx_pages->ibp_pages[ipg];
-		rx = &conn->ibc_rxs[i];
+	for (pg_off = ipg = i = 0; i < nrx; i++) {
+		pg = pages->ibp_pages[ipg];
+		rx = &rxs[i];
 
-		rx->rx_conn = conn;
 		rx->rx_msg = (struct kib_msg *)(((char *)page_address(pg)) + pg_off);
 
 		rx->rx_msgaddr =
-			kiblnd_dma_map_single(conn->ibc_hdev->ibh_ibdev,
+			kiblnd_dma_map_single(hdev->ibh_ibdev,
 					      rx->rx_msg, IBLND_MSG_SIZE,
 					      DMA_FROM_DEVICE);
-		LASSERT(!kiblnd_dma_mapping_error(conn->ibc_hdev->ibh_ibdev,
+		LASSERT(!kiblnd_dma_mapping_error(hdev->ibh_ibdev,
 						  rx->rx_msgaddr));
 		KIBLND_UNMAP_ADDR_SET(rx, rx_msgunmap, rx->rx_msgaddr);
 
@@ -1287,11 +1296,293 @@ kiblnd_map_rx_descs(struct kib_conn *conn)
 		if (pg_off == PAGE_SIZE) {
 			pg_off = 0;
 			ipg++;
-			LASSERT(ipg <= IBLND_RX_MSG_PAGES(conn));
+			LASSERT(ipg <= pages->ibp_npages);
 		}
 	}
 }
 
+void
+kiblnd_unmap_rx_descs(struct kib_conn *conn)
+{
+	int i;
+
+	LASSERT(conn->ibc_rxs != NULL);
+	LASSERT(conn->ibc_hdev != NULL);
+
+	for (i = 0; i < IBLND_RX_MSGS(conn); i++)
+		LASSERT(conn->ibc_rxs[i].rx_nob >= 0); /* not posted */
+
+	kiblnd_unmap_rx_pages(conn->ibc_hdev, conn->ibc_rxs,
+			      IBLND_RX_MSGS(conn));
+	kiblnd_free_pages(conn->ibc_rx_pages);
+
+	conn->ibc_rx_pages = NULL;
+}
+
+void
+kiblnd_map_rx_descs(struct kib_conn *conn)
+{
+	int i;
+
+	for (i = 0; i < IBLND_RX_MSGS(conn); i++)
+		conn->ibc_rxs[i].rx_conn = conn;
+
+	kiblnd_map_rx_pages(conn->ibc_hdev, conn->ibc_rxs,
+			    IBLND_RX_MSGS(conn), conn->ibc_rx_pages);
+}
+
+static void
+kiblnd_srq_free_chunk(struct kib_srq *srq, struct kib_srq_chunk *chunk)
+{
+	if (chunk->isc_pages != NULL) {
+		kiblnd_unmap_rx_pages(srq->isrq_hdev, chunk->isc_rxs,
+				      chunk->isc_nrx);
+		kiblnd_free_pages(chunk->isc_pages);
+	}
+
+	if (chunk->isc_rxs != NULL)
+		CFS_FREE_PTR_ARRAY(chunk->isc_rxs, chunk->isc_nrx);
+
+	LIBCFS_FREE(chunk, sizeof(*chunk));
+}
+
+/*
+ * Add \a nrx receive buffers to \a srq and post them. The caller
+ * serialises growing \a srq, either by creating it or by owning
+ * KIB_SRQ_GROWING.
+ */
+static int
+kiblnd_srq_grow(struct kib_srq *srq, int nrx)
+{
+	struct kib_srq_chunk *chunk;
+	int i;
+	int rc;
+
+	LASSERT(nrx > 0);
+
+	LIBCFS_CPT_ALLOC(chunk, lnet_cpt_table(), srq->isrq_cpt,
+			 sizeof(*chunk));
+	if (chunk == NULL)
+		return -ENOMEM;
+
+	chunk->isc_nrx = nrx;
+	LIBCFS_CPT_ALLOC(chunk->isc_rxs, lnet_cpt_table(), srq->isrq_cpt,
+			 nrx * sizeof(struct kib_rx));
+	if (chunk->isc_rxs == NULL) {
+		rc = -ENOMEM;
+		goto failed;
+	}
+
+	rc = kiblnd_alloc_pages(&chunk->isc_pages, srq->isrq_cpt,
+				DIV_ROUND_UP(nrx * IBLND_MSG_SIZE, PAGE_SIZE));
+	if (rc != 0)
+		goto failed;
+
+	kiblnd_map_rx_pages(srq->isrq_hdev, chunk->isc_rxs, nrx,
+			    chunk->isc_pages);
+
+	list_add_tail(&chunk->isc_list, &srq->isrq_chunks);
+	srq->isrq_nrx += nrx;
+
+	for (i = 0; i < nrx; i++) {
+		chunk->isc_rxs[i].rx_srq = srq;
+		/* buffers that fail to post stay idle until SRQ cleanup */
+		rc = kiblnd_post_srq_rx(&chunk->isc_rxs[i]);
+		if (rc != 0)
+			break;
+	}
+
+	CDEBUG(D_NET, "SRQ on CPT %d: %d rx buffers, %d posted\n",
+	       srq->isrq_cpt, srq->isrq_nrx, atomic_read(&srq->isrq_posted));
+	return rc;
+
+failed:
+	kiblnd_srq_free_chunk(srq, chunk);
+	return rc;
+}
+
+/*
+ * Ask the HCA to raise IB_EVENT_SRQ_LIMIT_REACHED once fewer than
+ * 1/IBLND_SRQ_LOW_FRAC of the pool is posted. The limit disarms when it
+ * fires, so it is re-armed after each growth.
+ */
+static void
+kiblnd_srq_arm_limit(struct kib_srq *srq)
+{
+	struct ib_srq_attr attr;
+	int rc;
+
+	if (srq->isrq_nrx >= srq->isrq_max_nrx)
+		return;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.srq_limit = max(srq->isrq_nrx / IBLND_SRQ_LOW_FRAC, 1);
+	rc = ib_modify_srq(srq->isrq_srq, &attr, IB_SRQ_LIMIT);
+	if (rc != 0)
+		CDEBUG(D_NET, "Can't arm SRQ limit on CPT %d: %d\n",
+		       srq->isrq_cpt, rc);
+}
+
+/* double the pool of \a srq, up to the SRQ size */
+void
+kiblnd_srq_try_grow(struct kib_srq *srq)
+{
+	int nrx;
+
+	if (srq->isrq_nrx >= srq->isrq_max_nrx)
+		return;
+
+	if (test_and_set_bit(KIB_SRQ_GROWING, &srq->isrq_flags))
+		return;
+
+	/* the SRQ may be destroyed under me */
+	if (test_bit(KIB_SRQ_DYING, &srq->isrq_flags)) {
+		clear_bit(KIB_SRQ_GROWING, &srq->isrq_flags);
+		return;
+	}
+
+	nrx = min(srq->isrq_nrx, srq->isrq_max_nrx - srq->isrq_nrx);
+	if (nrx > 0 && kiblnd_srq_grow(srq, nrx) != 0)
+		CWARN("Can't grow SRQ on CPT %d from %d rx buffers\n",
+		      srq->isrq_cpt, srq->isrq_nrx);
+
+	kiblnd_srq_arm_limit(srq);
+	clear_bit(KIB_SRQ_GROWING, &srq->isrq_flags);
+}
+
+static void
+kiblnd_srq_grow_work(struct work_struct *work)
+{
+	kiblnd_srq_try_grow(container_of(work, struct kib_srq,
+					 isrq_grow_work));
+}
+
+static void
+kiblnd_srq_event(struct ib_event *event, void *arg)
+{
+	struct kib_srq *srq = arg;
+
+	if (event->event != IB_EVENT_SRQ_LIMIT_REACHED) {
+		CDEBUG(D_NET, "SRQ event %d on CPT %d\n",
+		       event->event, srq->isrq_cpt);
+		return;
+	}
+
+	/* called in interrupt context, allocate buffers in a worker */
+	if (!test_bit(KIB_SRQ_DYING, &srq->isrq_flags))
+		schedule_work(&srq->isrq_grow_work);
+}
+
+static void
+kiblnd_hdev_cleanup_srqs(struct kib_hca_dev *hdev)
+{
+	struct kib_srq_chunk *chunk;
+	struct kib_srq *srq;
+	int i;
+
+	if (hdev->ibh_srqs == NULL)
+		return;
+
+	/* no connections are left, so every buffer is idle or posted */
+	cfs_percpt_for_each(srq, i, hdev->ibh_srqs) {
+		if (srq->isrq_srq != NULL && !IS_ERR(srq->isrq_srq)) {
+			/* A limit event can still come until the SRQ is
+			 * destroyed. A grow work queued by it after the
+			 * first cancel sees KIB_SRQ_DYING and leaves the
+			 * SRQ alone, the second cancel waits for it.
+			 */
+			set_bit(KIB_SRQ_DYING, &srq->isrq_flags);
+			cancel_work_sync(&srq->isrq_grow_work);
+			ib_destroy_srq(srq->isrq_srq);
+			cancel_work_sync(&srq->isrq_grow_work);
+		}
+
+		while ((chunk = list_first_entry_or_null(&srq->isrq_chunks,
+							 struct kib_srq_chunk,
+							 isc_list)) != NULL) {
+			list_del(&chunk->isc_list);
+			kiblnd_srq_free_chunk(srq, chunk);
+		}
+	}
+
+	cfs_percpt_free(hdev->ibh_srqs);
+	hdev->ibh_srqs = NULL;
+}
+
+static int
+kiblnd_hdev_setup_srqs(struct kib_hca_dev *hdev)
+{
+	struct ib_srq_init_attr attr;
+	struct kib_srq *srq;
+	int max_wr;
+	int rc;
+	int i;
+
+	if (!*kiblnd_tunables.kib_use_srq)
+		return 0;
+
+	if (hdev->ibh_max_srq_wr <= 0) {
+		CWARN("%s: device has no SRQ support, using per connection receive buffers\n",
+		      hdev->ibh_ibdev->name);
+		return 0;
+	}
+
+	max_wr = min(*kiblnd_tunables.kib_srq_rx_max, hdev->ibh_max_srq_wr);
+	if (max_wr <= 0) {
+		CERROR("Invalid srq_rx_max %d\n",
+		       *kiblnd_tunables.kib_srq_rx_max);
+		return -EINVAL;
+	}
+
+	hdev->ibh_srqs = cfs_percpt_alloc(lnet_cpt_table(),
+					  sizeof(struct kib_srq));
+	if (hdev->ibh_srqs == NULL) {
+		CERROR("Can't allocate SRQ array\n");
+		return -ENOMEM;
+	}
+
+	cfs_percpt_for_each(srq, i, hdev->ibh_srqs) {
+		srq->isrq_hdev = hdev;
+		srq->isrq_cpt = i;
+		srq->isrq_max_nrx = max_wr;
+		INIT_LIST_HEAD(&srq->isrq_chunks);
+		INIT_WORK(&srq->isrq_grow_work, kiblnd_srq_grow_work);
+		atomic_set(&srq->isrq_posted, 0);
+	}
+
+	cfs_percpt_for_each(srq, i, hdev->ibh_srqs) {
+		memset(&attr, 0, sizeof(attr));
+		attr.event_handler = kiblnd_srq_event;
+		attr.srq_context = srq;
+		attr.attr.max_wr = max_wr;
+		attr.attr.max_sge = 1;
+
+		srq->isrq_srq = ib_create_srq(hdev->ibh_pd, &attr);
+		if (IS_ERR(srq->isrq_srq)) {
+			rc = PTR_ERR(srq->isrq_srq);
+			CERROR("Can't create SRQ with %d WRs: %d\n",
+			       max_wr, rc);
+			goto failed;
+		}
+
+		rc = kiblnd_srq_grow(srq, clamp(*kiblnd_tunables.kib_srq_rx_init,
+						1, max_wr));
+		if (rc != 0) {
+			CERROR("Can't post SRQ rx buffers: %d\n", rc);
+			goto failed;
+		}
+		kiblnd_srq_arm_limit(srq);
+	}
+
+	CDEBUG(D_NET, "%s: using SRQs, up to %d rx buffers per CPT\n",
+	       hdev->ibh_ibdev->name, max_wr);
+	return 0;
+
+failed:
+	kiblnd_hdev_cleanup_srqs(hdev);
+	return rc;
+}
+
 static void
 kiblnd_unmap_tx_pool(struct kib_tx_pool *tpo)
 {
@@ -2597,6 +2888,8 @@ kiblnd_hdev_get_attr(struct kib_hca_dev *hdev)
 
 	hdev->ibh_mr_size = dev_attr->max_mr_size;
 	hdev->ibh_max_qp_wr = dev_attr->max_qp_wr;
+	hdev->ibh_max_srq_wr = dev_attr->max_srq > 0 ?
+			       dev_attr->max_srq_wr : 0;
 
 	/* Setup device Memory Registration capabilities */
 #ifdef HAVE_FMR_POOL_API
@@ -2667,6 +2960,8 @@ kiblnd_hdev_destroy(struct kib_hca_dev *hdev)
 	if (hdev->ibh_event_handler.device != NULL)
 		ib_unregister_event_handler(&hdev->ibh_event_handler);
 
+	kiblnd_hdev_cleanup_srqs(hdev);
+
 #ifdef HAVE_IB_GET_DMA_MR
         kiblnd_hdev_cleanup_mrs(hdev);
 #endif
@@ -2886,6 +3181,12 @@ kiblnd_dev_failover(struct kib_dev *dev, struct net *ns)
 	}
 #endif
 
+	rc = kiblnd_hdev_setup_srqs(hdev);
+	if (rc != 0) {
+		CERROR("Can't setup SRQs: %d\n", rc);
+		goto out;
+	}
+
 	INIT_IB_EVENT_HANDLER(&hdev->ibh_event_handler,
 				hdev->ibh_ibdev, kiblnd_event_handler);
 	ib_register_event_handler(&hdev->ibh_event_handler);
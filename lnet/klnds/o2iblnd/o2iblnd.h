@@ -117,6 +117,11 @@ struct kib_tunables {
 	int		 *kib_nscheds;
 	int		 *kib_wrq_sge;		/* # sg elements per wrq */
 	int		 *kib_use_fastreg_gaps; /* enable discontiguous fastreg fragment support */
+	int		 *kib_wc_batch;		/* # completions per CQ poll */
+	int		 *kib_cq_busy_poll_usecs; /* busy-poll empty CQ (usecs) */
+	int		 *kib_use_srq;		/* share rx buffers per CPT */
+	int		 *kib_srq_rx_init;	/* initial # SRQ rx per CPT */
+	int		 *kib_srq_rx_max;	/* max # SRQ rx per CPT */
 };
 
 extern struct kib_tunables  kiblnd_tunables;
@@ -150,6 +155,18 @@ extern struct kib_tunables  kiblnd_tunables;
 #define IBLND_OOB_MSGS(v)           (IBLND_OOB_CAPABLE(v) ? 2 : 0)
 
 #define IBLND_MSG_SIZE              (4<<10)                 /* max size of queued messages (inc hdr) */
+
+/* completions reaped by a scheduler thread per ib_poll_cq() call */
+#define IBLND_WC_BATCH_DEFAULT		16
+#define IBLND_WC_BATCH_MAX		64
+
+/* receive buffers per CPT in SRQ mode; the pool grows on demand */
+#define IBLND_SRQ_RX_INIT		256
+#define IBLND_SRQ_RX_MAX		8192
+/* grow the pool when fewer than 1/IBLND_SRQ_LOW_FRAC buffers are posted */
+#define IBLND_SRQ_LOW_FRAC		4
+/* peers retry forever when the shared pool is momentarily empty */
+#define IBLND_RNR_RETRY_INFINITE	7
 #define IBLND_MAX_RDMA_FRAGS         LNET_MAX_IOV           /* max # of fragments supported */
 
 /************************/
@@ -218,6 +235,8 @@ struct kib_hca_dev {
 	__u64                ibh_page_mask;     /* page mask of current HCA */
 	__u64                ibh_mr_size;       /* size of MR */
 	int		     ibh_max_qp_wr;     /* maximum work requests size */
+	int		     ibh_max_srq_wr;    /* maximum SRQ work requests */
+	struct kib_srq     **ibh_srqs;          /* per-CPT SRQs, or NULL */
 #ifdef HAVE_IB_GET_DMA_MR
 	struct ib_mr        *ibh_mrs;           /* global MR */
 #endif
@@ -243,6 +262,42 @@ struct kib_pages {
         struct page            *ibp_pages[0];           /* page array */
 };
 
+/* receive buffers shared by all connections of a HCA on one CPT */
+struct kib_srq {
+	/* the verbs SRQ */
+	struct ib_srq		*isrq_srq;
+	/* owner */
+	struct kib_hca_dev	*isrq_hdev;
+	/* CPT of the buffers */
+	int			 isrq_cpt;
+	/* KIB_SRQ_GROWING, KIB_SRQ_DYING */
+	unsigned long		 isrq_flags;
+	/* kib_srq_chunks, changed only while growing */
+	struct list_head	 isrq_chunks;
+	/* # rx buffers */
+	int			 isrq_nrx;
+	/* max # rx buffers (SRQ size) */
+	int			 isrq_max_nrx;
+	/* # rx buffers currently posted */
+	atomic_t		 isrq_posted;
+	/* grows the pool on IB_EVENT_SRQ_LIMIT_REACHED */
+	struct work_struct	 isrq_grow_work;
+};
+
+#define KIB_SRQ_GROWING		0
+#define KIB_SRQ_DYING		1
+
+struct kib_srq_chunk {
+	/* chain on isrq_chunks */
+	struct list_head	 isc_list;
+	/* premapped rx msg pages */
+	struct kib_pages	*isc_pages;
+	/* # rx descs */
+	int			 isc_nrx;
+	/* the rx descs */
+	struct kib_rx		*isc_rxs;
+};
+
 struct kib_pool;
 struct kib_poolset;
 
@@ -476,8 +531,10 @@ struct kib_data {
 struct kib_rx {					/* receive message */
 	/* queue for attention */
 	struct list_head	rx_list;
-	/* owning conn */
+	/* owning conn (while not posted on an SRQ) */
 	struct kib_conn	       *rx_conn;
+	/* SRQ this rx belongs to, NULL if private to rx_conn */
+	struct kib_srq	       *rx_srq;
 	/* # bytes received (-1 while posted) */
 	int			rx_nob;
 	/* message buffer (host vaddr) */
@@ -602,6 +659,10 @@ struct kib_conn {
 	unsigned int		ibc_scheduled:1;
 	/* CQ callback fired */
 	unsigned int		ibc_ready:1;
+	/* SRQ receives may still complete on my CQ */
+	unsigned int		ibc_srq_attached:1;
+	/* IB_EVENT_QP_LAST_WQE_REACHED raised, under ibs_lock */
+	unsigned int		ibc_srq_last_wqe:1;
 	/* time of last send */
 	ktime_t			ibc_last_send;
 	/** link chain for kiblnd_check_conns only */
@@ -626,6 +687,8 @@ struct kib_conn {
 	struct kib_rx		*ibc_rxs;
 	/* premapped rx msg pages */
 	struct kib_pages	*ibc_rx_pages;
+	/* shared receive queue, NULL if I own my rxs */
+	struct kib_srq		*ibc_srq;
 
 	/* CM id */
 	struct rdma_cm_id	*ibc_cmid;
@@ -709,6 +772,18 @@ static inline int kiblnd_timeout(void)
 		lnet_get_lnd_timeout();
 }
 
+/*
+ * RNR retries requested from the peer. Credits advertised by a
+ * connection on an SRQ are not backed by buffers of its own, so a burst
+ * from many peers can find the shared pool empty until it grows: let
+ * them retry instead of failing the connection.
+ */
+static inline int kiblnd_rnr_retry_count(struct kib_conn *conn)
+{
+	return conn->ibc_srq != NULL ? IBLND_RNR_RETRY_INFINITE :
+		*kiblnd_tunables.kib_rnr_retry_count;
+}
+
 static inline int
 kiblnd_concurrent_sends(int version, struct lnet_ni *ni)
 {
@@ -1120,6 +1195,7 @@ int  kiblnd_scheduler(void *arg);
 int  kiblnd_failover_thread (void *arg);
 
 int kiblnd_alloc_pages(struct kib_pages **pp, int cpt, int npages);
+void kiblnd_srq_try_grow(struct kib_srq *srq);
 
 int  kiblnd_cm_callback(struct rdma_cm_id *cmid,
                         struct rdma_cm_event *event);
@@ -1156,6 +1232,7 @@ void kiblnd_pack_msg(struct lnet_ni *ni, struct kib_msg *msg, int version,
 		     int credits, lnet_nid_t dstnid, __u64 dststamp);
 int kiblnd_unpack_msg(struct kib_msg *msg, int nob);
 int kiblnd_post_rx(struct kib_rx *rx, int credit);
+int kiblnd_post_srq_rx(struct kib_rx *rx);
 
 int kiblnd_send(struct lnet_ni *ni, void *private, struct lnet_msg *lntmsg);
 int kiblnd_recv(struct lnet_ni *ni, void *private, struct lnet_msg *lntmsg,
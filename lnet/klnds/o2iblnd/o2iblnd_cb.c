@@ -154,9 +154,85 @@ kiblnd_drop_rx(struct kib_rx *rx)
 	conn->ibc_nrx--;
 	spin_unlock_irqrestore(&sched->ibs_lock, flags);
 
+	/* back to the shared pool while conn still pins the HCA */
+	if (rx->rx_srq != NULL)
+		kiblnd_post_srq_rx(rx);
+
 	kiblnd_conn_decref(conn);
 }
 
+int
+kiblnd_post_srq_rx(struct kib_rx *rx)
+{
+	struct kib_srq *srq = rx->rx_srq;
+	struct ib_recv_wr *bad_wrq = NULL;
+#ifdef HAVE_IB_GET_DMA_MR
+	struct ib_mr *mr = srq->isrq_hdev->ibh_mrs;
+#endif
+	int rc;
+
+	LASSERT(rx->rx_nob >= 0);		/* not posted */
+#ifdef HAVE_IB_GET_DMA_MR
+	LASSERT(mr != NULL);
+
+	rx->rx_sge.lkey   = mr->lkey;
+#else
+	rx->rx_sge.lkey   = srq->isrq_hdev->ibh_pd->local_dma_lkey;
+#endif
+	rx->rx_sge.addr   = rx->rx_msgaddr;
+	rx->rx_sge.length = IBLND_MSG_SIZE;
+
+	rx->rx_wrq.next = NULL;
+	rx->rx_wrq.sg_list = &rx->rx_sge;
+	rx->rx_wrq.num_sge = 1;
+	rx->rx_wrq.wr_id = kiblnd_ptr2wreqid(rx, IBLND_WID_RX);
+
+	rx->rx_conn = NULL;
+	rx->rx_nob = -1;			/* flag posted */
+	atomic_inc(&srq->isrq_posted);
+
+#ifdef HAVE_IB_POST_SEND_RECV_CONST
+	rc = ib_post_srq_recv(srq->isrq_srq, &rx->rx_wrq,
+			      (const struct ib_recv_wr **)&bad_wrq);
+#else
+	rc = ib_post_srq_recv(srq->isrq_srq, &rx->rx_wrq, &bad_wrq);
+#endif
+	if (unlikely(rc != 0)) {
+		CERROR("Can't post rx on SRQ for CPT %d: %d, bad_wrq: %p\n",
+		       srq->isrq_cpt, rc, bad_wrq);
+		atomic_dec(&srq->isrq_posted);
+		rx->rx_nob = 0;
+	}
+
+	return rc;
+}
+
+/*
+ * An rx from the shared pool completed on \a conn's CQ: \a conn owns it
+ * until it's reposted. Grow the pool if it's running low.
+ */
+static void
+kiblnd_srq_rx_taken(struct kib_conn *conn, struct kib_rx *rx)
+{
+	struct kib_sched_info *sched = conn->ibc_sched;
+	struct kib_srq *srq = rx->rx_srq;
+	unsigned long flags;
+	int posted;
+
+	kiblnd_conn_addref(conn);
+	spin_lock_irqsave(&sched->ibs_lock, flags);
+	conn->ibc_nrx++;
+	spin_unlock_irqrestore(&sched->ibs_lock, flags);
+	rx->rx_conn = conn;
+
+	posted = atomic_dec_return(&srq->isrq_posted);
+	if (likely(posted * IBLND_SRQ_LOW_FRAC >= srq->isrq_nrx ||
+		   srq->isrq_nrx >= srq->isrq_max_nrx))
+		return;
+
+	kiblnd_srq_try_grow(srq);
+}
+
 int
 kiblnd_post_rx(struct kib_rx *rx, int credit)
 {
@@ -173,6 +249,20 @@ kiblnd_post_rx(struct kib_rx *rx, int credit)
 	LASSERT (credit == IBLND_POSTRX_NO_CREDIT ||
 		 credit == IBLND_POSTRX_PEER_CREDIT ||
 		 credit == IBLND_POSTRX_RSRVD_CREDIT);
+
+	if (rx->rx_srq != NULL) {
+		/* the buffer goes straight back to the shared pool, only the
+		 * credit belongs to this connection
+		 */
+		LASSERT(rx->rx_nob >= 0);
+		kiblnd_conn_addref(conn);
+		kiblnd_drop_rx(rx);
+		rc = 0;
+		if (conn->ibc_state != IBLND_CONN_ESTABLISHED)
+			goto out;
+		goto post_credit;
+	}
+
 #ifdef HAVE_IB_GET_DMA_MR
 	LASSERT(mr != NULL);
 
@@ -223,6 +313,7 @@ kiblnd_post_rx(struct kib_rx *rx, int credit)
 		goto out;
 	}
 
+post_credit:
 	if (credit == IBLND_POSTRX_NO_CREDIT)
 		goto out;
 
@@ -2191,6 +2282,13 @@ kiblnd_finalise_conn(struct kib_conn *conn)
 
 	kiblnd_set_conn_state(conn, IBLND_CONN_DISCONNECTED);
 
+	/* SRQ receives aren't flushed by the QP: the SRQ attachment is only
+	 * dropped after IB_EVENT_QP_LAST_WQE_REACHED, see kiblnd_qp_event().
+	 * Poll my CQ once more in case it has already been raised.
+	 */
+	if (conn->ibc_srq_attached)
+		kiblnd_cq_completion(conn->ibc_cq, conn);
+
 	/* Complete all tx descs not waiting for sends to complete.
 	 * NB we should be safe from RDMA now that the QP has changed state */
 
@@ -2681,7 +2779,7 @@ kiblnd_passive_connect(struct rdma_cm_id *cmid, void *priv, int priv_nob)
 	cp.initiator_depth     = 0;
 	cp.flow_control        = 1;
 	cp.retry_count         = *kiblnd_tunables.kib_retry_count;
-	cp.rnr_retry_count     = *kiblnd_tunables.kib_rnr_retry_count;
+	cp.rnr_retry_count     = kiblnd_rnr_retry_count(conn);
 
 	CDEBUG(D_NET, "Accept %s\n", libcfs_nid2str(nid));
 
@@ -3111,7 +3209,7 @@ kiblnd_active_connect(struct rdma_cm_id *cmid)
         cp.initiator_depth     = 0;
         cp.flow_control        = 1;
         cp.retry_count         = *kiblnd_tunables.kib_retry_count;
-        cp.rnr_retry_count     = *kiblnd_tunables.kib_rnr_retry_count;
+	cp.rnr_retry_count     = kiblnd_rnr_retry_count(conn);
 
         LASSERT(cmid->context == (void *)conn);
         LASSERT(conn->ibc_cmid == cmid);
@@ -3656,6 +3754,19 @@ kiblnd_qp_event(struct ib_event *event, void *arg)
 		rdma_notify(conn->ibc_cmid, IB_EVENT_COMM_EST);
 		return;
 
+	case IB_EVENT_QP_LAST_WQE_REACHED: {
+		struct kib_sched_info *sched = conn->ibc_sched;
+		unsigned long flags;
+
+		/* no more SRQ receives will complete on this QP, let the
+		 * scheduler drop the SRQ attachment once my CQ is drained */
+		spin_lock_irqsave(&sched->ibs_lock, flags);
+		conn->ibc_srq_last_wqe = 1;
+		spin_unlock_irqrestore(&sched->ibs_lock, flags);
+		kiblnd_cq_completion(conn->ibc_cq, conn);
+		return;
+	}
+
 	case IB_EVENT_PORT_ERR:
 	case IB_EVENT_DEVICE_FATAL:
 		CERROR("Fatal device error for NI %s\n",
@@ -3677,8 +3788,10 @@ kiblnd_qp_event(struct ib_event *event, void *arg)
 }
 
 static void
-kiblnd_complete (struct ib_wc *wc)
+kiblnd_complete(struct kib_conn *conn, struct ib_wc *wc)
 {
+	struct kib_rx *rx;
+
 	switch (kiblnd_wreqid2type(wc->wr_id)) {
 	default:
 		LBUG();
@@ -3704,10 +3817,12 @@ kiblnd_complete (struct ib_wc *wc)
                 kiblnd_tx_complete(kiblnd_wreqid2ptr(wc->wr_id), wc->status);
                 return;
 
-        case IBLND_WID_RX:
-                kiblnd_rx_complete(kiblnd_wreqid2ptr(wc->wr_id), wc->status,
-                                   wc->byte_len);
-                return;
+	case IBLND_WID_RX:
+		rx = kiblnd_wreqid2ptr(wc->wr_id);
+		if (rx->rx_srq != NULL)
+			kiblnd_srq_rx_taken(conn, rx);
+		kiblnd_rx_complete(rx, wc->status, wc->byte_len);
+		return;
         }
 }
 
@@ -3752,6 +3867,48 @@ kiblnd_cq_event(struct ib_event *event, void *arg)
                libcfs_nid2str(conn->ibc_peer->ibp_nid), event->event);
 }
 
+/*
+ * Reap up to \a nwc completions from the CQ of \a conn. If the CQ is empty,
+ * optionally busy-poll it for cq_busy_poll_usecs, then re-arm it and poll
+ * once more to catch completions that arrived before it was re-armed.
+ * Returns the number of completions reaped or a negative error.
+ */
+static int
+kiblnd_poll_cq(struct kib_conn *conn, struct ib_wc *wcs, int nwc)
+{
+	int busy_usecs = *kiblnd_tunables.kib_cq_busy_poll_usecs;
+	ktime_t deadline;
+	int i;
+	int rc;
+
+	for (i = 0; i < nwc; i++)
+		wcs[i].wr_id = IBLND_WID_INVAL;
+
+	rc = ib_poll_cq(conn->ibc_cq, nwc, wcs);
+	if (rc != 0)
+		return rc;
+
+	if (busy_usecs > 0) {
+		deadline = ktime_add_us(ktime_get(), busy_usecs);
+		do {
+			cpu_relax();
+			rc = ib_poll_cq(conn->ibc_cq, nwc, wcs);
+			if (rc != 0)
+				return rc;
+		} while (ktime_before(ktime_get(), deadline) &&
+			 !need_resched());
+	}
+
+	rc = ib_req_notify_cq(conn->ibc_cq, IB_CQ_NEXT_COMP);
+	if (rc < 0) {
+		CWARN("%s: ib_req_notify_cq failed: %d\n",
+		      libcfs_nid2str(conn->ibc_peer->ibp_nid), rc);
+		return rc;
+	}
+
+	return ib_poll_cq(conn->ibc_cq, nwc, wcs);
+}
+
 int
 kiblnd_scheduler(void *arg)
 {
@@ -3761,8 +3918,13 @@ kiblnd_scheduler(void *arg)
 	wait_queue_entry_t wait;
 	unsigned long flags;
 	struct ib_wc wc;
+	struct ib_wc *wcs;
+	struct ib_wc *cq_wcs;
 	bool did_something;
+	bool last_wqe;
+	int nwc;
 	int rc;
+	int i;
 
 	init_wait(&wait);
 
@@ -3773,6 +3935,11 @@ kiblnd_scheduler(void *arg)
 		CWARN("Unable to bind on CPU partition %d, please verify whether all CPUs are healthy and reload modules if necessary, otherwise your system might under risk of low performance\n", sched->ibs_cpt);
 	}
 
+	/* completions are reaped in batches; fall back to one at a time */
+	LIBCFS_CPT_ALLOC(wcs, lnet_cpt_table(), sched->ibs_cpt,
+			 sizeof(*wcs) * IBLND_WC_BATCH_MAX);
+	cq_wcs = wcs ? wcs : &wc;
+
 	spin_lock_irqsave(&sched->ibs_lock, flags);
 
 	while (!kiblnd_data.kib_shutdown) {
@@ -3794,39 +3961,35 @@ kiblnd_scheduler(void *arg)
 			LASSERT(conn->ibc_scheduled);
 			list_del(&conn->ibc_sched_list);
 			conn->ibc_ready = 0;
+			/* sampled before polling: SRQ completions that came
+			 * before IB_EVENT_QP_LAST_WQE_REACHED are in my CQ */
+			last_wqe = conn->ibc_srq_last_wqe;
 
 			spin_unlock_irqrestore(&sched->ibs_lock, flags);
 
-			wc.wr_id = IBLND_WID_INVAL;
+			nwc = wcs ? clamp(*kiblnd_tunables.kib_wc_batch, 1,
+					  IBLND_WC_BATCH_MAX) : 1;
+			rc = kiblnd_poll_cq(conn, cq_wcs, nwc);
 
-			rc = ib_poll_cq(conn->ibc_cq, 1, &wc);
-			if (rc == 0) {
-				rc = ib_req_notify_cq(conn->ibc_cq,
-						      IB_CQ_NEXT_COMP);
-				if (rc < 0) {
-					CWARN("%s: ib_req_notify_cq failed: %d, closing connection\n",
-					      libcfs_nid2str(conn->ibc_peer->ibp_nid), rc);
-					kiblnd_close_conn(conn, -EIO);
-					kiblnd_conn_decref(conn);
-					spin_lock_irqsave(&sched->ibs_lock,
-							  flags);
+			for (i = 0; i < rc; i++) {
+				if (likely(cq_wcs[i].wr_id != IBLND_WID_INVAL))
 					continue;
-				}
-
-				rc = ib_poll_cq(conn->ibc_cq, 1, &wc);
-			}
 
-			if (unlikely(rc > 0 && wc.wr_id == IBLND_WID_INVAL)) {
 				LCONSOLE_ERROR(
 					"ib_poll_cq (rc: %d) returned invalid "
 					"wr_id, opcode %d, status: %d, "
 					"vendor_err: %d, conn: %s status: %d\n"
 					"please upgrade firmware and OFED or "
 					"contact vendor.\n", rc,
-					wc.opcode, wc.status, wc.vendor_err,
+					cq_wcs[i].opcode, cq_wcs[i].status,
+					cq_wcs[i].vendor_err,
 					libcfs_nid2str(conn->ibc_peer->ibp_nid),
 					conn->ibc_state);
+				/* don't lose the good ones reaped before it */
+				for (nwc = 0; nwc < i; nwc++)
+					kiblnd_complete(conn, &cq_wcs[nwc]);
 				rc = -EINVAL;
+				break;
 			}
 
 			if (rc < 0) {
@@ -3841,6 +4004,17 @@ kiblnd_scheduler(void *arg)
 
 			spin_lock_irqsave(&sched->ibs_lock, flags);
 
+			/* The QP has consumed its last SRQ WQE and my CQ is
+			 * empty, so nothing more can complete here from the
+			 * SRQ.
+			 */
+			if (rc == 0 && conn->ibc_srq_attached && last_wqe) {
+				conn->ibc_srq_attached = 0;
+				LASSERT(conn->ibc_nrx > 0);
+				conn->ibc_nrx--;
+				kiblnd_conn_decref(conn);
+			}
+
 			if (rc != 0 || conn->ibc_ready) {
 				/* There may be another completion waiting; get
 				 * another scheduler to check while I handle
@@ -3857,7 +4031,11 @@ kiblnd_scheduler(void *arg)
 
 			if (rc != 0) {
 				spin_unlock_irqrestore(&sched->ibs_lock, flags);
-				kiblnd_complete(&wc);
+				/* handle the whole batch without the sched
+				 * lock, in CQ order
+				 */
+				for (i = 0; i < rc; i++)
+					kiblnd_complete(conn, &cq_wcs[i]);
 
 				spin_lock_irqsave(&sched->ibs_lock, flags);
 			}
@@ -3882,6 +4060,9 @@ kiblnd_scheduler(void *arg)
 
 	spin_unlock_irqrestore(&sched->ibs_lock, flags);
 
+	if (wcs)
+		LIBCFS_FREE(wcs, sizeof(*wcs) * IBLND_WC_BATCH_MAX);
+
 	kiblnd_thread_fini();
 	return 0;
 }
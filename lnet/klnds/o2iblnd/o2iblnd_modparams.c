@@ -185,6 +185,28 @@ static unsigned int wrq_sge = 2;
 module_param(wrq_sge, uint, 0444);
 MODULE_PARM_DESC(wrq_sge, "# scatter/gather element per work request");
 
+static int wc_batch = IBLND_WC_BATCH_DEFAULT;
+module_param(wc_batch, int, 0644);
+MODULE_PARM_DESC(wc_batch, "max # of completions reaped per CQ poll (1-"
+		 __stringify(IBLND_WC_BATCH_MAX) ")");
+
+static int cq_busy_poll_usecs;
+module_param(cq_busy_poll_usecs, int, 0644);
+MODULE_PARM_DESC(cq_busy_poll_usecs, "microseconds to busy-poll an empty CQ before re-arming it (0 to disable)");
+
+/* NB: SRQs are created with the HCA, so this can't change at runtime */
+static int use_srq;
+module_param(use_srq, int, 0444);
+MODULE_PARM_DESC(use_srq, "share receive buffers between connections on each CPT (0 to disable)");
+
+static int srq_rx_init = IBLND_SRQ_RX_INIT;
+module_param(srq_rx_init, int, 0444);
+MODULE_PARM_DESC(srq_rx_init, "initial # of receive buffers per CPT in SRQ mode");
+
+static int srq_rx_max = IBLND_SRQ_RX_MAX;
+module_param(srq_rx_max, int, 0444);
+MODULE_PARM_DESC(srq_rx_max, "max # of receive buffers per CPT in SRQ mode");
+
 struct kib_tunables kiblnd_tunables = {
         .kib_dev_failover           = &dev_failover,
         .kib_service                = &service,
@@ -200,6 +222,11 @@ struct kib_tunables kiblnd_tunables = {
 	.kib_nscheds		    = &nscheds,
 	.kib_wrq_sge		    = &wrq_sge,
 	.kib_use_fastreg_gaps       = &use_fastreg_gaps,
+	.kib_wc_batch		    = &wc_batch,
+	.kib_cq_busy_poll_usecs	    = &cq_busy_poll_usecs,
+	.kib_use_srq		    = &use_srq,
+	.kib_srq_rx_init	    = &srq_rx_init,
+	.kib_srq_rx_max		    = &srq_rx_max,
 };
 
 static struct lnet_ioctl_config_o2iblnd_tunables default_tunables;
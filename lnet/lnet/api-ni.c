@@ -80,6 +80,16 @@ module_param(lnet_numa_range, uint, 0444);
 MODULE_PARM_DESC(lnet_numa_range,
 		"NUMA range to consider during Multi-Rail selection");
 
+/*
+ * lnet_path_selection chooses how Multi-Rail picks between equally healthy
+ * local and peer NIs: by available credits (0), or by the expected
+ * completion time derived from measured RTT and bandwidth (1).
+ */
+unsigned int lnet_path_selection = LNET_PATH_SEL_CREDITS;
+module_param(lnet_path_selection, uint, 0644);
+MODULE_PARM_DESC(lnet_path_selection,
+		 "Multi-Rail path selection policy: 0 = credits, 1 = measured latency/bandwidth");
+
 /*
  * lnet_health_sensitivity determines by how much we decrement the health
  * value on sending error. The value defaults to 100, which means health
@@ -167,6 +177,16 @@ module_param_call(lnet_peer_discovery_disabled, discovery_set, param_get_int,
 MODULE_PARM_DESC(lnet_peer_discovery_disabled,
 		"Set to 1 to disable peer discovery on this node.");
 
+/*
+ * lnet_max_discovery_pings limits the number of discovery pings in flight,
+ * so a node that discovers many peers at once (e.g. at mount time) paces
+ * itself instead of pinging every NID it knows about together.
+ */
+unsigned int lnet_max_discovery_pings = 64;
+module_param(lnet_max_discovery_pings, uint, 0644);
+MODULE_PARM_DESC(lnet_max_discovery_pings,
+		 "Max # of discovery pings in flight (0 for no limit)");
+
 unsigned int lnet_drop_asym_route;
 static int drop_asym_route_set(const char *val, cfs_kernel_param_arg_t *kp);
 
@@ -1279,8 +1299,11 @@ lnet_prepare(lnet_pid_t requested_pid)
 	INIT_LIST_HEAD(&the_lnet.ln_dc_request);
 	INIT_LIST_HEAD(&the_lnet.ln_dc_working);
 	INIT_LIST_HEAD(&the_lnet.ln_dc_expired);
+	INIT_LIST_HEAD(&the_lnet.ln_dc_deferred);
+	atomic_set(&the_lnet.ln_dc_pings, 0);
 	INIT_LIST_HEAD(&the_lnet.ln_mt_localNIRecovq);
 	INIT_LIST_HEAD(&the_lnet.ln_mt_peerNIRecovq);
+	spin_lock_init(&the_lnet.ln_mt_recovery_lock);
 	INIT_LIST_HEAD(&the_lnet.ln_udsp_list);
 	init_waitqueue_head(&the_lnet.ln_dc_waitq);
 	the_lnet.ln_mt_handler = NULL;
@@ -3810,6 +3833,7 @@ lnet_ni_set_healthv(lnet_nid_t nid, int value, bool all)
 			if (all || (nid_is_nid4(&ni->ni_nid) &&
 				    lnet_nid_to_nid4(&ni->ni_nid) == nid)) {
 				atomic_set(&ni->ni_healthv, value);
+				spin_lock(&the_lnet.ln_mt_recovery_lock);
 				if (list_empty(&ni->ni_recovery) &&
 				    value < LNET_MAX_HEALTH_VALUE) {
 					CERROR("manually adding local NI %s to recovery\n",
@@ -3818,6 +3842,7 @@ lnet_ni_set_healthv(lnet_nid_t nid, int value, bool all)
 						      &the_lnet.ln_mt_localNIRecovq);
 					lnet_ni_addref_locked(ni, 0);
 				}
+				spin_unlock(&the_lnet.ln_mt_recovery_lock);
 				if (!all) {
 					lnet_net_unlock(LNET_LOCK_EX);
 					return;
@@ -3890,7 +3915,7 @@ lnet_get_local_ni_recovery_list(struct lnet_ioctl_recovery_list *list)
 	struct lnet_ni *ni;
 	int i = 0;
 
-	lnet_net_lock(LNET_LOCK_EX);
+	spin_lock(&the_lnet.ln_mt_recovery_lock);
 	list_for_each_entry(ni, &the_lnet.ln_mt_localNIRecovq, ni_recovery) {
 		if (!nid_is_nid4(&ni->ni_nid))
 			continue;
@@ -3899,7 +3924,7 @@ lnet_get_local_ni_recovery_list(struct lnet_ioctl_recovery_list *list)
 		if (i >= LNET_MAX_SHOW_NUM_NID)
 			break;
 	}
-	lnet_net_unlock(LNET_LOCK_EX);
+	spin_unlock(&the_lnet.ln_mt_recovery_lock);
 	list->rlst_num_nids = i;
 
 	return 0;
@@ -3911,14 +3936,14 @@ lnet_get_peer_ni_recovery_list(struct lnet_ioctl_recovery_list *list)
 	struct lnet_peer_ni *lpni;
 	int i = 0;
 
-	lnet_net_lock(LNET_LOCK_EX);
+	spin_lock(&the_lnet.ln_mt_recovery_lock);
 	list_for_each_entry(lpni, &the_lnet.ln_mt_peerNIRecovq, lpni_recovery) {
 		list->rlst_nid_array[i] = lnet_nid_to_nid4(&lpni->lpni_nid);
 		i++;
 		if (i >= LNET_MAX_SHOW_NUM_NID)
 			break;
 	}
-	lnet_net_unlock(LNET_LOCK_EX);
+	spin_unlock(&the_lnet.ln_mt_recovery_lock);
 	list->rlst_num_nids = i;
 
 	return 0;
@@ -4161,6 +4186,19 @@ LNetCtl(unsigned int cmd, void *arg)
 		return rc;
 	}
 
+	case IOC_LIBCFS_GET_PEER_NI_PSTATS: {
+		struct lnet_ioctl_peer_ni_pstats *stats = arg;
+
+		if (stats->pst_hdr.ioc_len < sizeof(*stats))
+			return -EINVAL;
+
+		mutex_lock(&the_lnet.ln_api_mutex);
+		rc = lnet_get_peer_ni_pstats(stats);
+		mutex_unlock(&the_lnet.ln_api_mutex);
+
+		return rc;
+	}
+
 	case IOC_LIBCFS_GET_RECOVERY_QUEUE: {
 		struct lnet_ioctl_recovery_list *list = arg;
 		if (list->rlst_hdr.ioc_len < sizeof(*list))
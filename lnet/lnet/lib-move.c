@@ -736,6 +736,7 @@ lnet_ni_send(struct lnet_ni *ni, struct lnet_msg *msg)
 	LASSERT(nid_is_lo0(&ni->ni_nid) ||
 		(msg->msg_txcredit && msg->msg_peertxcredit));
 
+	msg->msg_send_time = ktime_get();
 	rc = (ni->ni_net->net_lnd->lnd_send)(ni, priv, msg);
 	if (rc < 0) {
 		msg->msg_no_resend = true;
@@ -917,6 +918,8 @@ lnet_post_send_locked(struct lnet_msg *msg, int do_send)
 		msg->msg_txcredit = 1;
 		tq->tq_credits--;
 		atomic_dec(&ni->ni_tx_credits);
+		atomic_long_add(msg->msg_len + sizeof(struct lnet_hdr),
+				&ni->ni_txqnob);
 
 		if (tq->tq_credits < tq->tq_credits_min)
 			tq->tq_credits_min = tq->tq_credits;
@@ -1071,6 +1074,8 @@ lnet_return_tx_credits_locked(struct lnet_msg *msg)
 
 		tq->tq_credits++;
 		atomic_inc(&ni->ni_tx_credits);
+		atomic_long_sub(msg->msg_len + sizeof(struct lnet_hdr),
+				&ni->ni_txqnob);
 		if (tq->tq_credits <= 0) {
 			msg2 = list_entry(tq->tq_delayed.next,
 					  struct lnet_msg, msg_list);
@@ -1291,6 +1296,53 @@ routing_off:
 	}
 }
 
+/* cost of a path without recent measurements, compares equal to any */
+#define LNET_PATH_COST_UNKNOWN	U64_MAX
+
+/*
+ * Expected time in microseconds for a new message on a path to complete:
+ * the measured RTT plus the time needed to drain the bytes already in
+ * flight at the measured bandwidth. Paths without samples, or whose
+ * samples have aged out, have an unknown cost and are neither preferred
+ * nor avoided: selection falls back to credits for them, which gets them
+ * used and measured.
+ */
+static u64
+lnet_path_cost(struct lnet_path_stats *ps, long inflight)
+{
+	u64 cost;
+
+	if (!ps->lps_samples ||
+	    ktime_get_seconds() - ps->lps_last_sample >
+	    LNET_PATH_STATS_MAX_AGE)
+		return LNET_PATH_COST_UNKNOWN;
+
+	cost = ps->lps_rtt_usec;
+	if (ps->lps_bytes_per_sec && inflight > 0)
+		cost += div64_u64((u64)inflight * USEC_PER_SEC,
+				  ps->lps_bytes_per_sec);
+
+	return cost;
+}
+
+/*
+ * Compare path costs with 1/8 hysteresis so that measurement noise does
+ * not make selection flap between comparable paths.
+ * Returns < 0 if @cost is clearly cheaper than @best, > 0 if it is
+ * clearly more expensive, and 0 if they should be treated as equal.
+ */
+static int
+lnet_compare_path_cost(u64 cost, u64 best)
+{
+	if (cost == LNET_PATH_COST_UNKNOWN || best == LNET_PATH_COST_UNKNOWN)
+		return 0;
+	if (cost + (cost >> 3) < best)
+		return -1;
+	if (best + (best >> 3) < cost)
+		return 1;
+	return 0;
+}
+
 static struct lnet_peer_ni *
 lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 		    struct lnet_peer *peer,
@@ -1310,9 +1362,14 @@ lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 		INT_MIN;
 	int best_lpni_healthv = (best_lpni) ?
 		atomic_read(&best_lpni->lpni_healthv) : 0;
+	u64 best_lpni_cost = (best_lpni) ?
+		lnet_path_cost(&best_lpni->lpni_path_stats,
+			       best_lpni->lpni_txqnob) :
+		LNET_PATH_COST_UNKNOWN;
 	bool best_lpni_is_preferred = false;
 	bool lpni_is_preferred;
 	int lpni_healthv;
+	u64 lpni_cost;
 	__u32 lpni_sel_prio;
 	__u32 best_sel_prio = LNET_MAX_SELECTION_PRIORITY;
 
@@ -1334,13 +1391,16 @@ lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 
 		lpni_healthv = atomic_read(&lpni->lpni_healthv);
 		lpni_sel_prio = lpni->lpni_sel_priority;
+		lpni_cost = lnet_path_cost(&lpni->lpni_path_stats,
+					   lpni->lpni_txqnob);
 
 		if (best_lpni)
-			CDEBUG(D_NET, "n:[%s, %s] h:[%d, %d] p:[%d, %d] c:[%d, %d] s:[%d, %d]\n",
+			CDEBUG(D_NET, "n:[%s, %s] h:[%d, %d] p:[%d, %d] t:[%llu, %llu] c:[%d, %d] s:[%d, %d]\n",
 				libcfs_nidstr(&lpni->lpni_nid),
 				libcfs_nidstr(&best_lpni->lpni_nid),
 				lpni_healthv, best_lpni_healthv,
 				lpni_sel_prio, best_sel_prio,
+				lpni_cost, best_lpni_cost,
 				lpni->lpni_txcredits, best_lpni_credits,
 				lpni->lpni_seq, best_lpni->lpni_seq);
 		else
@@ -1374,6 +1434,17 @@ lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 			continue;
 		}
 
+		/* prefer the path expected to complete the message first */
+		if (lnet_path_selection == LNET_PATH_SEL_MEASURED) {
+			int cmp = lnet_compare_path_cost(lpni_cost,
+							 best_lpni_cost);
+
+			if (cmp > 0)
+				continue;
+			else if (cmp < 0)
+				goto select_lpni;
+		}
+
 		if (lpni->lpni_txcredits < best_lpni_credits)
 			/* We already have a peer that has more credits
 			 * available than this one. No need to consider
@@ -1395,6 +1466,7 @@ select_lpni:
 		best_sel_prio = lpni_sel_prio;
 		best_lpni = lpni;
 		best_lpni_credits = lpni->lpni_txcredits;
+		best_lpni_cost = lpni_cost;
 	}
 
 	/* if we still can't find a peer ni then we can't reach it */
@@ -1631,6 +1703,7 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 	struct lnet_ni *ni = NULL;
 	int best_credits;
 	int best_healthv;
+	u64 best_cost;
 	__u32 best_sel_prio;
 	unsigned int best_dev_prio;
 	unsigned int dev_idx = UINT_MAX;
@@ -1653,6 +1726,7 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		best_dev_prio = UINT_MAX;
 		best_credits = INT_MIN;
 		best_healthv = 0;
+		best_cost = LNET_PATH_COST_UNKNOWN;
 	} else {
 		best_dev_prio = lnet_dev_prio_of_md(best_ni, dev_idx);
 		shortest_distance = cfs_cpt_distance(lnet_cpt_table(), md_cpt,
@@ -1660,6 +1734,8 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		best_credits = atomic_read(&best_ni->ni_tx_credits);
 		best_healthv = atomic_read(&best_ni->ni_healthv);
 		best_sel_prio = best_ni->ni_sel_priority;
+		best_cost = lnet_path_cost(&best_ni->ni_path_stats,
+					   atomic_long_read(&best_ni->ni_txqnob));
 	}
 
 	while ((ni = lnet_get_next_ni_locked(local_net, ni))) {
@@ -1667,6 +1743,7 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		int ni_credits;
 		int ni_healthv;
 		int ni_fatal;
+		u64 ni_cost;
 		__u32 ni_sel_prio;
 		unsigned int ni_dev_prio;
 
@@ -1674,6 +1751,8 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		ni_healthv = atomic_read(&ni->ni_healthv);
 		ni_fatal = atomic_read(&ni->ni_fatal_error_on);
 		ni_sel_prio = ni->ni_sel_priority;
+		ni_cost = lnet_path_cost(&ni->ni_path_stats,
+					 atomic_long_read(&ni->ni_txqnob));
 
 		/*
 		 * calculate the distance from the CPT on which
@@ -1695,19 +1774,20 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 
 		/*
 		 * Select on health, selection policy, direct dma prio,
-		 * shorter distance, available credits, then round-robin.
+		 * shorter distance, measured path cost (if enabled),
+		 * available credits, then round-robin.
 		 */
 		if (ni_fatal)
 			continue;
 
 		if (best_ni)
-			CDEBUG(D_NET, "compare ni %s [c:%d, d:%d, s:%d, p:%u, g:%u] with best_ni %s [c:%d, d:%d, s:%d, p:%u, g:%u]\n",
+			CDEBUG(D_NET, "compare ni %s [c:%d, d:%d, s:%d, p:%u, g:%u, t:%llu] with best_ni %s [c:%d, d:%d, s:%d, p:%u, g:%u, t:%llu]\n",
 			       libcfs_nidstr(&ni->ni_nid), ni_credits, distance,
-			       ni->ni_seq, ni_sel_prio, ni_dev_prio,
+			       ni->ni_seq, ni_sel_prio, ni_dev_prio, ni_cost,
 			       (best_ni) ? libcfs_nidstr(&best_ni->ni_nid)
 			       : "not selected", best_credits, shortest_distance,
 			       (best_ni) ? best_ni->ni_seq : 0,
-			       best_sel_prio, best_dev_prio);
+			       best_sel_prio, best_dev_prio, best_cost);
 		else
 			goto select_ni;
 
@@ -1731,6 +1811,15 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		else if (distance < shortest_distance)
 			goto select_ni;
 
+		if (lnet_path_selection == LNET_PATH_SEL_MEASURED) {
+			int cmp = lnet_compare_path_cost(ni_cost, best_cost);
+
+			if (cmp > 0)
+				continue;
+			else if (cmp < 0)
+				goto select_ni;
+		}
+
 		if (ni_credits < best_credits)
 			continue;
 		else if (ni_credits > best_credits)
@@ -1746,6 +1835,7 @@ select_ni:
 		best_healthv = ni_healthv;
 		best_ni = ni;
 		best_credits = ni_credits;
+		best_cost = ni_cost;
 	}
 
 	CDEBUG(D_NET, "selected best_ni %s\n",
@@ -3409,10 +3499,10 @@ lnet_recover_local_nis(void)
 	 * the head of the ln_mt_localNIRecovq. Any newly added local NIs
 	 * will be traversed in the next iteration.
 	 */
-	lnet_net_lock(0);
+	spin_lock(&the_lnet.ln_mt_recovery_lock);
 	list_splice_init(&the_lnet.ln_mt_localNIRecovq,
 			 &local_queue);
-	lnet_net_unlock(0);
+	spin_unlock(&the_lnet.ln_mt_recovery_lock);
 
 	now = ktime_get_seconds();
 
@@ -3431,7 +3521,9 @@ lnet_recover_local_nis(void)
 		lnet_ni_lock(ni);
 		if (ni->ni_state != LNET_NI_STATE_ACTIVE ||
 		    healthv == LNET_MAX_HEALTH_VALUE) {
+			spin_lock(&the_lnet.ln_mt_recovery_lock);
 			list_del_init(&ni->ni_recovery);
+			spin_unlock(&the_lnet.ln_mt_recovery_lock);
 			lnet_unlink_ni_recovery_mdh_locked(ni, 0, false);
 			lnet_ni_unlock(ni);
 			lnet_ni_decref_locked(ni, 0);
@@ -3505,7 +3597,9 @@ lnet_recover_local_nis(void)
 			 * continue examining the rest of the queue.
 			 */
 			lnet_net_lock(0);
+			spin_lock(&the_lnet.ln_mt_recovery_lock);
 			list_del_init(&ni->ni_recovery);
+			spin_unlock(&the_lnet.ln_mt_recovery_lock);
 			lnet_ni_decref_locked(ni, 0);
 			lnet_net_unlock(0);
 
@@ -3526,7 +3620,9 @@ lnet_recover_local_nis(void)
 				LNetMDUnlink(mdh);
 				continue;
 			}
+			spin_lock(&the_lnet.ln_mt_recovery_lock);
 			ni->ni_ping_count++;
+			spin_unlock(&the_lnet.ln_mt_recovery_lock);
 
 			ni->ni_ping_mdh = mdh;
 			lnet_ni_add_to_recoveryq_locked(ni, &processed_list,
@@ -3546,10 +3642,10 @@ lnet_recover_local_nis(void)
 	 * put back the remaining NIs on the ln_mt_localNIRecovq to be
 	 * reexamined in the next iteration.
 	 */
+	spin_lock(&the_lnet.ln_mt_recovery_lock);
 	list_splice_init(&processed_list, &local_queue);
-	lnet_net_lock(0);
 	list_splice(&local_queue, &the_lnet.ln_mt_localNIRecovq);
-	lnet_net_unlock(0);
+	spin_unlock(&the_lnet.ln_mt_recovery_lock);
 }
 
 static int
@@ -3576,15 +3672,19 @@ lnet_clean_local_ni_recoveryq(void)
 	/* This is only called when the monitor thread has stopped */
 	lnet_net_lock(0);
 
+	spin_lock(&the_lnet.ln_mt_recovery_lock);
 	while (!list_empty(&the_lnet.ln_mt_localNIRecovq)) {
 		ni = list_entry(the_lnet.ln_mt_localNIRecovq.next,
 				struct lnet_ni, ni_recovery);
 		list_del_init(&ni->ni_recovery);
+		spin_unlock(&the_lnet.ln_mt_recovery_lock);
 		lnet_ni_lock(ni);
 		lnet_unlink_ni_recovery_mdh_locked(ni, 0, true);
 		lnet_ni_unlock(ni);
 		lnet_ni_decref_locked(ni, 0);
+		spin_lock(&the_lnet.ln_mt_recovery_lock);
 	}
+	spin_unlock(&the_lnet.ln_mt_recovery_lock);
 
 	lnet_net_unlock(0);
 }
@@ -3613,19 +3713,26 @@ static void
 lnet_clean_peer_ni_recoveryq(void)
 {
 	struct lnet_peer_ni *lpni, *tmp;
+	LIST_HEAD(local_queue);
 
-	lnet_net_lock(LNET_LOCK_EX);
+	/* This is only called when the monitor thread has stopped */
+	spin_lock(&the_lnet.ln_mt_recovery_lock);
+	list_splice_init(&the_lnet.ln_mt_peerNIRecovq, &local_queue);
+	spin_unlock(&the_lnet.ln_mt_recovery_lock);
 
-	list_for_each_entry_safe(lpni, tmp, &the_lnet.ln_mt_peerNIRecovq,
-				 lpni_recovery) {
+	lnet_net_lock(0);
+
+	list_for_each_entry_safe(lpni, tmp, &local_queue, lpni_recovery) {
+		spin_lock(&the_lnet.ln_mt_recovery_lock);
 		list_del_init(&lpni->lpni_recovery);
+		spin_unlock(&the_lnet.ln_mt_recovery_lock);
 		spin_lock(&lpni->lpni_lock);
-		lnet_unlink_lpni_recovery_mdh_locked(lpni, LNET_LOCK_EX, true);
+		lnet_unlink_lpni_recovery_mdh_locked(lpni, 0, true);
 		spin_unlock(&lpni->lpni_lock);
 		lnet_peer_ni_decref_locked(lpni);
 	}
 
-	lnet_net_unlock(LNET_LOCK_EX);
+	lnet_net_unlock(0);
 }
 
 static void
@@ -3664,13 +3771,13 @@ lnet_recover_peer_nis(void)
 	time64_t now;
 
 	/*
-	 * Always use cpt 0 for locking across all interactions with
-	 * ln_mt_peerNIRecovq
+	 * ln_mt_recovery_lock protects ln_mt_peerNIRecovq; cpt 0 is used for
+	 * the peer NI references taken and dropped below.
 	 */
-	lnet_net_lock(0);
+	spin_lock(&the_lnet.ln_mt_recovery_lock);
 	list_splice_init(&the_lnet.ln_mt_peerNIRecovq,
 			 &local_queue);
-	lnet_net_unlock(0);
+	spin_unlock(&the_lnet.ln_mt_recovery_lock);
 
 	now = ktime_get_seconds();
 
@@ -3685,7 +3792,9 @@ lnet_recover_peer_nis(void)
 		spin_lock(&lpni->lpni_lock);
 		if (lpni->lpni_state & LNET_PEER_NI_DELETING ||
 		    healthv == LNET_MAX_HEALTH_VALUE) {
+			spin_lock(&the_lnet.ln_mt_recovery_lock);
 			list_del_init(&lpni->lpni_recovery);
+			spin_unlock(&the_lnet.ln_mt_recovery_lock);
 			lnet_unlink_lpni_recovery_mdh_locked(lpni, 0, false);
 			spin_unlock(&lpni->lpni_lock);
 			lnet_peer_ni_decref_locked(lpni);
@@ -3739,7 +3848,9 @@ lnet_recover_peer_nis(void)
 			/* FIXME handle large-addr nid */
 			nid = lnet_nid_to_nid4(&lpni->lpni_nid);
 			lnet_net_lock(0);
+			spin_lock(&the_lnet.ln_mt_recovery_lock);
 			list_del_init(&lpni->lpni_recovery);
+			spin_unlock(&the_lnet.ln_mt_recovery_lock);
 			lnet_peer_ni_decref_locked(lpni);
 			lnet_net_unlock(0);
 
@@ -3760,7 +3871,9 @@ lnet_recover_peer_nis(void)
 				continue;
 			}
 
+			spin_lock(&the_lnet.ln_mt_recovery_lock);
 			lpni->lpni_ping_count++;
+			spin_unlock(&the_lnet.ln_mt_recovery_lock);
 
 			lpni->lpni_recovery_ping_mdh = mdh;
 
@@ -3780,10 +3893,10 @@ lnet_recover_peer_nis(void)
 			spin_unlock(&lpni->lpni_lock);
 	}
 
+	spin_lock(&the_lnet.ln_mt_recovery_lock);
 	list_splice_init(&processed_list, &local_queue);
-	lnet_net_lock(0);
 	list_splice(&local_queue, &the_lnet.ln_mt_peerNIRecovq);
-	lnet_net_unlock(0);
+	spin_unlock(&the_lnet.ln_mt_recovery_lock);
 }
 
 static int
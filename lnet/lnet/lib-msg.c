@@ -440,12 +440,15 @@ static void
 lnet_dec_healthv_locked(atomic_t *healthv, int sensitivity)
 {
 	int h = atomic_read(healthv);
+	int old;
 
-	if (h < sensitivity) {
-		atomic_set(healthv, 0);
-	} else {
-		h -= sensitivity;
-		atomic_set(healthv, h);
+	/* callers may hold different CPT locks, so don't lose updates */
+	for (;;) {
+		old = atomic_cmpxchg(healthv, h,
+				     h < sensitivity ? 0 : h - sensitivity);
+		if (old == h)
+			break;
+		h = old;
 	}
 }
 
@@ -460,6 +463,12 @@ lnet_ni_add_to_recoveryq_locked(struct lnet_ni *ni,
 	if (atomic_read(&ni->ni_healthv) == LNET_MAX_HEALTH_VALUE)
 		return;
 
+	spin_lock(&the_lnet.ln_mt_recovery_lock);
+	if (!list_empty(&ni->ni_recovery)) {
+		spin_unlock(&the_lnet.ln_mt_recovery_lock);
+		return;
+	}
+
 	/* This NI is going on the recovery queue, so take a ref on it */
 	lnet_ni_addref_locked(ni, 0);
 
@@ -472,6 +481,7 @@ lnet_ni_add_to_recoveryq_locked(struct lnet_ni *ni,
 	       atomic_read(&ni->ni_healthv));
 
 	list_add_tail(&ni->ni_recovery, recovery_queue);
+	spin_unlock(&the_lnet.ln_mt_recovery_lock);
 }
 
 static void
@@ -494,7 +504,7 @@ lnet_handle_local_failure(struct lnet_ni *local_ni)
 	lnet_net_unlock(0);
 }
 
-/* must hold net_lock/0 */
+/* must hold lnet_net_lock on any CPT */
 void
 lnet_handle_remote_failure_locked(struct lnet_peer_ni *lpni)
 {
@@ -529,27 +539,35 @@ lnet_handle_remote_failure_locked(struct lnet_peer_ni *lpni)
 static void
 lnet_handle_remote_failure(struct lnet_peer_ni *lpni)
 {
+	int cpt;
+
 	/* lpni could be NULL if we're in the LOLND case */
 	if (!lpni)
 		return;
 
-	lnet_net_lock(0);
+	/*
+	 * Any CPT lock keeps the peer lists stable, so use the peer NI's own
+	 * rather than funnelling all failures through CPT 0.
+	 */
+	cpt = lpni->lpni_cpt;
+	lnet_net_lock(cpt);
 	/* the mt could've shutdown and cleaned up the queues */
 	if (the_lnet.ln_mt_state != LNET_MT_STATE_RUNNING) {
-		lnet_net_unlock(0);
+		lnet_net_unlock(cpt);
 		return;
 	}
 	lnet_handle_remote_failure_locked(lpni);
-	lnet_net_unlock(0);
+	lnet_net_unlock(cpt);
 }
 
+/* must hold lnet_net_lock(cpt) */
 static void
 lnet_incr_hstats(struct lnet_ni *ni, struct lnet_peer_ni *lpni,
-		 enum lnet_msg_hstatus hstatus)
+		 enum lnet_msg_hstatus hstatus, int cpt)
 {
 	struct lnet_counters_health *health;
 
-	health = &the_lnet.ln_counters[0]->lct_health;
+	health = &the_lnet.ln_counters[cpt]->lct_health;
 
 	switch (hstatus) {
 	case LNET_MSG_STATUS_LOCAL_INTERRUPT:
@@ -771,6 +789,78 @@ lnet_attempt_msg_resend(struct lnet_msg *msg)
 	return 0;
 }
 
+/* weight of a new sample in the path EWMAs is 1 / 2^LNET_PATH_EWMA_SHIFT */
+#define LNET_PATH_EWMA_SHIFT	3
+/* smaller messages are dominated by latency and say nothing of bandwidth */
+#define LNET_PATH_BW_MIN_BYTES	4096
+
+/*
+ * Fold @sample into @avg once per @steps. Each step removes 1/8 of the
+ * remaining weight of the old average, so history decays with time.
+ */
+static inline u64
+lnet_path_ewma(u64 avg, u64 sample, unsigned int steps)
+{
+	while (steps-- > 0) {
+		if (sample >= avg)
+			avg += (sample - avg) >> LNET_PATH_EWMA_SHIFT;
+		else
+			avg -= (avg - sample) >> LNET_PATH_EWMA_SHIFT;
+	}
+
+	return avg;
+}
+
+/*
+ * Fold the completion time of a @nob byte message into the path stats.
+ * A sample counts once, plus once per second since the previous sample,
+ * so that measurements of a path that has been idle age out instead of
+ * steering selection forever. Stats older than LNET_PATH_STATS_MAX_AGE
+ * are dropped and restarted from the new sample.
+ * Caller holds the lock of the NI or peer NI owning @ps.
+ */
+void
+lnet_path_stats_update(struct lnet_path_stats *ps, s64 rtt_ns,
+		       unsigned int nob)
+{
+	time64_t now = ktime_get_seconds();
+	unsigned int steps;
+	u64 rtt_us;
+
+	if (rtt_ns <= 0)
+		return;
+
+	if (ps->lps_samples &&
+	    now - ps->lps_last_sample > LNET_PATH_STATS_MAX_AGE) {
+		ps->lps_samples = 0;
+		ps->lps_bytes_per_sec = 0;
+	}
+	steps = 1 + clamp_t(time64_t, now - ps->lps_last_sample, 0,
+			    LNET_PATH_STATS_MAX_AGE);
+	ps->lps_last_sample = now;
+
+	rtt_us = max_t(u64, div_u64(rtt_ns, NSEC_PER_USEC), 1);
+	rtt_us = min_t(u64, rtt_us, U32_MAX);
+	if (!ps->lps_samples)
+		ps->lps_rtt_usec = rtt_us;
+	else
+		ps->lps_rtt_usec = lnet_path_ewma(ps->lps_rtt_usec, rtt_us,
+						  steps);
+
+	if (nob >= LNET_PATH_BW_MIN_BYTES) {
+		u64 bw = div64_u64((u64)nob * NSEC_PER_SEC, rtt_ns);
+
+		if (!ps->lps_bytes_per_sec)
+			ps->lps_bytes_per_sec = bw;
+		else
+			ps->lps_bytes_per_sec =
+				lnet_path_ewma(ps->lps_bytes_per_sec, bw,
+					       steps);
+	}
+
+	ps->lps_samples++;
+}
+
 /*
  * Do a health check on the message:
  * return -1 if we're not going to handle the error or
@@ -789,6 +879,7 @@ lnet_health_check(struct lnet_msg *msg)
 	bool attempt_remote_resend;
 	bool handle_local_health;
 	bool handle_remote_health;
+	int cpt;
 
 	/* if we're shutting down no point in handling health. */
 	if (the_lnet.ln_mt_state != LNET_MT_STATE_RUNNING)
@@ -818,10 +909,12 @@ lnet_health_check(struct lnet_msg *msg)
 	if (msg->msg_tx_committed) {
 		ni = msg->msg_txni;
 		lpni = msg->msg_txpeer;
+		cpt = msg->msg_tx_cpt;
 		attempt_local_resend = attempt_remote_resend = true;
 	} else {
 		ni = msg->msg_rxni;
 		lpni = msg->msg_rxpeer;
+		cpt = msg->msg_rx_cpt;
 		attempt_local_resend = attempt_remote_resend = false;
 	}
 
@@ -861,8 +954,12 @@ lnet_health_check(struct lnet_msg *msg)
 			attempt_local_resend = false;
 		}
 
-		lnet_net_lock(0);
-		lnet_incr_hstats(ni, lpni, hstatus);
+		/*
+		 * The message's own CPT lock is enough to keep the peer
+		 * stable and to update the per-CPT health counters.
+		 */
+		lnet_net_lock(cpt);
+		lnet_incr_hstats(ni, lpni, hstatus, cpt);
 		/* For remote failures, health/recovery/resends are not needed
 		 * if the peer only has a single interface. Special case for
 		 * routers where we rely on health feature to manage route
@@ -877,7 +974,7 @@ lnet_health_check(struct lnet_msg *msg)
 			if (!lnet_isrouter(lpni))
 				handle_remote_health = false;
 		}
-		lnet_net_unlock(0);
+		lnet_net_unlock(cpt);
 	}
 
 	switch (hstatus) {
@@ -890,8 +987,29 @@ lnet_health_check(struct lnet_msg *msg)
 		 * faster recovery.
 		 */
 		lnet_inc_healthv(&ni->ni_healthv, lnet_health_sensitivity);
-		lnet_net_lock(0);
-		ni->ni_ping_count = 0;
+		if (unlikely(ni->ni_ping_count)) {
+			spin_lock(&the_lnet.ln_mt_recovery_lock);
+			ni->ni_ping_count = 0;
+			spin_unlock(&the_lnet.ln_mt_recovery_lock);
+		}
+		/*
+		 * Feed the send completion time back into the path
+		 * measurements used by Multi-Rail selection.
+		 */
+		if (lpni && msg->msg_tx_committed &&
+		    ktime_to_ns(msg->msg_send_time)) {
+			s64 rtt_ns = ktime_to_ns(ktime_sub(ktime_get(),
+							   msg->msg_send_time));
+
+			lnet_ni_lock(ni);
+			lnet_path_stats_update(&ni->ni_path_stats, rtt_ns,
+					       msg->msg_len);
+			lnet_ni_unlock(ni);
+			spin_lock(&lpni->lpni_lock);
+			lnet_path_stats_update(&lpni->lpni_path_stats, rtt_ns,
+					       msg->msg_len);
+			spin_unlock(&lpni->lpni_lock);
+		}
 		/*
 		 * It's possible msg_txpeer is NULL in the LOLND
 		 * case. Only increment the peer's health if we're
@@ -901,7 +1019,12 @@ lnet_health_check(struct lnet_msg *msg)
 		 * as indication that the router is fully healthy.
 		 */
 		if (lpni && msg->msg_rx_committed) {
-			lpni->lpni_ping_count = 0;
+			lnet_net_lock(cpt);
+			if (unlikely(lpni->lpni_ping_count)) {
+				spin_lock(&the_lnet.ln_mt_recovery_lock);
+				lpni->lpni_ping_count = 0;
+				spin_unlock(&the_lnet.ln_mt_recovery_lock);
+			}
 			/*
 			 * If we're receiving a message from the router or
 			 * I'm a router, then set that lpni's health to
@@ -927,8 +1050,8 @@ lnet_health_check(struct lnet_msg *msg)
 						&the_lnet.ln_mt_peerNIRecovq,
 						ktime_get_seconds());
 			}
+			lnet_net_unlock(cpt);
 		}
-		lnet_net_unlock(0);
 
 		/* we can finalize this message */
 		return -1;
@@ -306,6 +306,9 @@ lnet_destroy_peer_locked(struct lnet_peer *lp)
 	if (lp->lp_data)
 		lnet_ping_buffer_decref(lp->lp_data);
 
+	if (lp->lp_merged_data)
+		lnet_ping_buffer_decref(lp->lp_merged_data);
+
 	/*
 	 * if there are messages still on the pending queue, then make
 	 * sure to queue them on the ln_msg_resend list so they can be
@@ -358,6 +361,7 @@ lnet_peer_detach_peer_ni_locked(struct lnet_peer_ni *lpni)
 	/* Update peer NID count. */
 	lp = lpn->lpn_peer;
 	lp->lp_nnis--;
+	lp->lp_ni_gen++;
 
 	/*
 	 * If there are no more peer nets, make the peer unfindable
@@ -1591,6 +1595,7 @@ lnet_peer_attach_peer_ni(struct lnet_peer *lp,
 	spin_unlock(&lp->lp_lock);
 
 	lp->lp_nnis++;
+	lp->lp_ni_gen++;
 
 	/* apply UDSPs */
 	if (new_lpn) {
@@ -2335,6 +2340,84 @@ static void lnet_peer_discovery_complete(struct lnet_peer *lp)
 	lnet_peer_decref_locked(lp);
 }
 
+/*
+ * Compare two ping infos, ignoring the sequence number carried by the
+ * loopback NI in pi_ni[0].
+ */
+static bool lnet_ping_info_same(struct lnet_ping_info *pi1,
+				struct lnet_ping_info *pi2)
+{
+	if (pi1->pi_features != pi2->pi_features ||
+	    pi1->pi_pid != pi2->pi_pid ||
+	    pi1->pi_nnis != pi2->pi_nnis || pi1->pi_nnis < 1)
+		return false;
+
+	return !memcmp(&pi1->pi_ni[1], &pi2->pi_ni[1],
+		       (pi1->pi_nnis - 1) * sizeof(pi1->pi_ni[0]));
+}
+
+/*
+ * Peers push their ping buffer every time they (re)discover us, which at
+ * mount time means every client pushes to every server even though
+ * nothing changed. Such a push carries exactly the data we merged last,
+ * and needs no work from the discovery thread as long as nothing changed
+ * the peer's NIs since.
+ */
+static bool lnet_peer_push_unchanged(struct lnet_peer *lp,
+				     struct lnet_ping_buffer *pbuf)
+__must_hold(&lp->lp_lock)
+{
+	if (!lp->lp_merged_data || lp->lp_merged_gen != lp->lp_ni_gen)
+		return false;
+
+	if ((lp->lp_state & (LNET_PEER_NIDS_UPTODATE |
+			     LNET_PEER_DATA_PRESENT |
+			     LNET_PEER_FORCE_PING)) != LNET_PEER_NIDS_UPTODATE)
+		return false;
+
+	return lnet_ping_info_same(&lp->lp_merged_data->pb_info,
+				   &pbuf->pb_info);
+}
+
+/* Remember the data last merged into lp, or forget it if pbuf is NULL. */
+static void lnet_peer_set_merged_data(struct lnet_peer *lp,
+				      struct lnet_ping_buffer *pbuf)
+{
+	struct lnet_ping_buffer *old;
+
+	if (pbuf)
+		lnet_ping_buffer_addref(pbuf);
+
+	spin_lock(&lp->lp_lock);
+	old = lp->lp_merged_data;
+	lp->lp_merged_data = pbuf;
+	lp->lp_merged_gen = lp->lp_ni_gen;
+	spin_unlock(&lp->lp_lock);
+
+	if (old)
+		lnet_ping_buffer_decref(old);
+}
+
+static bool lnet_dc_ping_slot_available(void)
+{
+	unsigned int max = READ_ONCE(lnet_max_discovery_pings);
+
+	return !max || atomic_read(&the_lnet.ln_dc_pings) < max;
+}
+
+/* Clear PING_SENT and release the ping slot it holds. */
+static void lnet_peer_clear_ping_sent(struct lnet_peer *lp)
+__must_hold(&lp->lp_lock)
+{
+	if (!(lp->lp_state & LNET_PEER_PING_SENT))
+		return;
+
+	lp->lp_state &= ~LNET_PEER_PING_SENT;
+	atomic_dec(&the_lnet.ln_dc_pings);
+	if (!list_empty(&the_lnet.ln_dc_deferred))
+		wake_up(&the_lnet.ln_dc_waitq);
+}
+
 /*
  * Handle inbound push.
  * Like any event handler, called with lnet_res_lock/CPT held.
@@ -2470,7 +2553,15 @@ void lnet_peer_push_event(struct lnet_event *ev)
 		goto out;
 	}
 
-	/* always assume new data */
+	if (lnet_peer_push_unchanged(lp, pbuf)) {
+		lp->lp_peer_seqno = LNET_PING_BUFFER_SEQNO(pbuf);
+		CDEBUG(D_NET, "Unchanged Push %s %u\n",
+		       libcfs_nidstr(&lp->lp_primary_nid),
+		       LNET_PING_BUFFER_SEQNO(pbuf));
+		goto out;
+	}
+
+	/* otherwise assume new data */
 	lp->lp_peer_seqno = LNET_PING_BUFFER_SEQNO(pbuf);
 	lp->lp_state &= ~LNET_PEER_NIDS_UPTODATE;
 
@@ -2833,7 +2924,7 @@ lnet_discovery_event_reply(struct lnet_peer *lp, struct lnet_event *ev)
 	lnet_ping_buffer_addref(pbuf);
 	lp->lp_data = pbuf;
 out:
-	lp->lp_state &= ~LNET_PEER_PING_SENT;
+	lnet_peer_clear_ping_sent(lp);
 	spin_unlock(&lp->lp_lock);
 
 	lnet_net_lock(LNET_LOCK_EX);
@@ -2862,7 +2953,7 @@ lnet_discovery_event_send(struct lnet_peer *lp, struct lnet_event *ev)
 
 	spin_lock(&lp->lp_lock);
 	if (ev->msg_type == LNET_MSG_GET) {
-		lp->lp_state &= ~LNET_PEER_PING_SENT;
+		lnet_peer_clear_ping_sent(lp);
 		lp->lp_state |= LNET_PEER_PING_FAILED;
 		lp->lp_ping_error = ev->status;
 	} else { /* ev->msg_type == LNET_MSG_PUT */
@@ -2891,7 +2982,7 @@ lnet_discovery_event_unlink(struct lnet_peer *lp, struct lnet_event *ev)
 	spin_lock(&lp->lp_lock);
 	/* We've passed through LNetGet() */
 	if (lp->lp_state & LNET_PEER_PING_SENT) {
-		lp->lp_state &= ~LNET_PEER_PING_SENT;
+		lnet_peer_clear_ping_sent(lp);
 		lp->lp_state |= LNET_PEER_PING_FAILED;
 		lp->lp_ping_error = -ETIMEDOUT;
 		CDEBUG(D_NET, "Ping Unlink for message to peer %s\n",
@@ -3143,6 +3234,7 @@ out:
 	CFS_FREE_PTR_ARRAY(curnis, nnis);
 	CFS_FREE_PTR_ARRAY(addnis, nnis);
 	CFS_FREE_PTR_ARRAY(delnis, nnis);
+	lnet_peer_set_merged_data(lp, rc ? NULL : pbuf);
 	lnet_ping_buffer_decref(pbuf);
 	CDEBUG(D_NET, "peer %s (%p): %d\n",
 	       libcfs_nidstr(&lp->lp_primary_nid), lp, rc);
@@ -3472,6 +3564,7 @@ __must_hold(&lp->lp_lock)
 	int cpt;
 
 	lp->lp_state |= LNET_PEER_PING_SENT;
+	atomic_inc(&the_lnet.ln_dc_pings);
 	lp->lp_state &= ~LNET_PEER_FORCE_PING;
 	spin_unlock(&lp->lp_lock);
 
@@ -3516,7 +3609,8 @@ fail_error:
 	 * have set it if we called LNetMDUnlink() above.
 	 */
 	spin_lock(&lp->lp_lock);
-	lp->lp_state &= ~(LNET_PEER_PING_SENT | LNET_PEER_PING_FAILED);
+	lnet_peer_clear_ping_sent(lp);
+	lp->lp_state &= ~LNET_PEER_PING_FAILED;
 	return rc;
 }
 
@@ -3697,6 +3791,9 @@ static int lnet_peer_discovery_wait_for_work(void)
 			break;
 		if (!list_empty(&the_lnet.ln_dc_request))
 			break;
+		if (!list_empty(&the_lnet.ln_dc_deferred) &&
+		    lnet_dc_ping_slot_available())
+			break;
 		if (!list_empty(&the_lnet.ln_msg_resend))
 			break;
 		lnet_net_unlock(cpt);
@@ -3762,10 +3859,38 @@ static void lnet_resend_msgs(void)
 	}
 }
 
+/*
+ * Whether discovery of lp has to wait for a ping slot: true if the next
+ * step for lp is a ping (see lnet_peer_discovery()) and the maximum number
+ * of pings is in flight. Call with lnet_net_lock/EX held.
+ */
+static bool lnet_peer_ping_deferred(struct lnet_peer *lp)
+{
+	unsigned int state;
+
+	if (lnet_dc_ping_slot_available() || list_empty(&lp->lp_peer_list))
+		return false;
+
+	spin_lock(&lp->lp_lock);
+	state = lp->lp_state;
+	spin_unlock(&lp->lp_lock);
+
+	if (state & (LNET_PEER_MARK_DELETION | LNET_PEER_MARK_DELETED |
+		     LNET_PEER_DATA_PRESENT | LNET_PEER_PING_FAILED |
+		     LNET_PEER_PUSH_FAILED))
+		return false;
+
+	if (state & LNET_PEER_FORCE_PING)
+		return true;
+
+	return !(state & (LNET_PEER_FORCE_PUSH | LNET_PEER_NIDS_UPTODATE));
+}
+
 /* The discovery thread. */
 static int lnet_peer_discovery(void *arg)
 {
 	struct lnet_peer *lp;
+	bool merged;
 	int rc;
 
 	wait_for_completion(&the_lnet.ln_started);
@@ -3790,6 +3915,15 @@ static int lnet_peer_discovery(void *arg)
 			break;
 		}
 
+		/*
+		 * Peers that were waiting for a ping slot go first, in
+		 * the order they were deferred.
+		 */
+		if (!list_empty(&the_lnet.ln_dc_deferred) &&
+		    lnet_dc_ping_slot_available())
+			list_splice_init(&the_lnet.ln_dc_deferred,
+					 &the_lnet.ln_dc_request);
+
 		/*
 		 * Process all incoming discovery work requests.  When
 		 * discovery must wait on a peer to change state, it
@@ -3797,10 +3931,22 @@ static int lnet_peer_discovery(void *arg)
 		 * timestamp keeps track of when the peer was added,
 		 * so we can time out discovery requests that take too
 		 * long.
+		 *
+		 * A peer that needs a ping while lnet_max_discovery_pings
+		 * are in flight is parked on ln_dc_deferred. By the time
+		 * its turn comes, discovery of another peer may have
+		 * claimed all of its NIDs, in which case it's no longer
+		 * on the peer list and there is nothing left to ping.
 		 */
 		while (!list_empty(&the_lnet.ln_dc_request)) {
 			lp = list_first_entry(&the_lnet.ln_dc_request,
 					      struct lnet_peer, lp_dc_list);
+			if (lnet_peer_ping_deferred(lp)) {
+				list_move_tail(&lp->lp_dc_list,
+					       &the_lnet.ln_dc_deferred);
+				continue;
+			}
+			merged = list_empty(&lp->lp_peer_list);
 			list_move(&lp->lp_dc_list, &the_lnet.ln_dc_working);
 			/*
 			 * set the time the peer was put on the dc_working
@@ -3839,6 +3985,8 @@ static int lnet_peer_discovery(void *arg)
 				rc = lnet_peer_ping_failed(lp);
 			else if (lp->lp_state & LNET_PEER_PUSH_FAILED)
 				rc = lnet_peer_push_failed(lp);
+			else if (merged)
+				rc = lnet_peer_discovered(lp);
 			else if (lp->lp_state & LNET_PEER_FORCE_PING)
 				rc = lnet_peer_send_ping(lp);
 			else if (lp->lp_state & LNET_PEER_FORCE_PUSH)
@@ -3897,6 +4045,7 @@ static int lnet_peer_discovery(void *arg)
 
 	/* Queue cleanup 3: clear the request queue. */
 	lnet_net_lock(LNET_LOCK_EX);
+	list_splice_init(&the_lnet.ln_dc_deferred, &the_lnet.ln_dc_request);
 	while (!list_empty(&the_lnet.ln_dc_request)) {
 		lp = list_first_entry(&the_lnet.ln_dc_request,
 				      struct lnet_peer, lp_dc_list);
@@ -3964,6 +4113,7 @@ void lnet_peer_discovery_stop(void)
 
 	LASSERT(list_empty(&the_lnet.ln_dc_request));
 	LASSERT(list_empty(&the_lnet.ln_dc_working));
+	LASSERT(list_empty(&the_lnet.ln_dc_deferred));
 	LASSERT(list_empty(&the_lnet.ln_dc_expired));
 
 	CDEBUG(D_NET, "discovery stopped\n");
@@ -4196,7 +4346,36 @@ out:
 	return rc;
 }
 
-/* must hold net_lock/0 */
+int lnet_get_peer_ni_pstats(struct lnet_ioctl_peer_ni_pstats *stats)
+{
+	struct lnet_peer_ni *lpni;
+	int cpt;
+	int rc = 0;
+
+	cpt = lnet_net_lock_current();
+	lpni = lnet_find_peer_ni_locked(stats->pst_nid);
+	if (!lpni) {
+		rc = -ENOENT;
+		goto unlock;
+	}
+
+	spin_lock(&lpni->lpni_lock);
+	stats->pst_rtt_usec = lpni->lpni_path_stats.lps_rtt_usec;
+	stats->pst_bytes_per_sec = lpni->lpni_path_stats.lps_bytes_per_sec;
+	stats->pst_samples = lpni->lpni_path_stats.lps_samples;
+	spin_unlock(&lpni->lpni_lock);
+	lnet_peer_ni_decref_locked(lpni);
+
+unlock:
+	lnet_net_unlock(cpt);
+
+	return rc;
+}
+
+/*
+ * must hold lnet_net_lock on any CPT, ln_mt_recovery_lock is taken here to
+ * serialize with other threads adding to or draining the recovery queue
+ */
 void
 lnet_peer_ni_add_to_recoveryq_locked(struct lnet_peer_ni *lpni,
 				     struct list_head *recovery_queue,
@@ -4206,6 +4385,7 @@ lnet_peer_ni_add_to_recoveryq_locked(struct lnet_peer_ni *lpni,
 	if (the_lnet.ln_mt_state != LNET_MT_STATE_RUNNING)
 		return;
 
+	/* cheap unlocked checks first, this is called for every message */
 	if (!list_empty(&lpni->lpni_recovery))
 		return;
 
@@ -4220,6 +4400,10 @@ lnet_peer_ni_add_to_recoveryq_locked(struct lnet_peer_ni *lpni,
 		return;
 	}
 
+	spin_lock(&the_lnet.ln_mt_recovery_lock);
+	if (!list_empty(&lpni->lpni_recovery))
+		goto out_unlock;
+
 	if (lnet_recovery_limit &&
 	    now > lpni->lpni_last_alive + lnet_recovery_limit) {
 		CDEBUG(D_NET, "lpni %s aged out last alive %lld\n",
@@ -4229,7 +4413,7 @@ lnet_peer_ni_add_to_recoveryq_locked(struct lnet_peer_ni *lpni,
 		 * the recovery queue we will send the first ping right away.
 		 */
 		lpni->lpni_ping_count = 0;
-		return;
+		goto out_unlock;
 	}
 
 	/* This peer NI is going on the recovery queue, so take a ref on it */
@@ -4245,6 +4429,8 @@ lnet_peer_ni_add_to_recoveryq_locked(struct lnet_peer_ni *lpni,
 	       atomic_read(&lpni->lpni_healthv));
 
 	list_add_tail(&lpni->lpni_recovery, recovery_queue);
+out_unlock:
+	spin_unlock(&the_lnet.ln_mt_recovery_lock);
 }
 
 /* Call with the ln_api_mutex held */
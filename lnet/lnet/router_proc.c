@@ -126,6 +126,46 @@ out_no_ctrs:
 	return rc;
 }
 
+/*
+ * Exclusive use of the LNet global locks. Every exclusive hold stalls
+ * all CPTs, so on a healthy system in steady state ex_count should not
+ * grow with traffic. Writing anything resets the counters.
+ */
+static int proc_lnet_lock_stats(struct ctl_table *table, int write,
+				void __user *buffer, size_t *lenp,
+				loff_t *ppos)
+{
+	struct cfs_percpt_lock_stats net;
+	struct cfs_percpt_lock_stats res;
+	char tmpstr[256];
+	int len;
+
+	if (write) {
+		cfs_percpt_lock_stats_reset(the_lnet.ln_net_lock);
+		cfs_percpt_lock_stats_reset(the_lnet.ln_res_lock);
+		return 0;
+	}
+
+	cfs_percpt_lock_stats_get(the_lnet.ln_net_lock, &net);
+	cfs_percpt_lock_stats_get(the_lnet.ln_res_lock, &res);
+
+	len = scnprintf(tmpstr, sizeof(tmpstr),
+			"%-8s %12s %16s %12s %12s\n"
+			"%-8s %12llu %16llu %12llu %12llu\n"
+			"%-8s %12llu %16llu %12llu %12llu",
+			"lock", "ex_count", "ex_hold_ns", "ex_max_ns",
+			"ex_stalls",
+			"net", net.pls_ex_count, net.pls_ex_hold_ns,
+			net.pls_ex_max_ns, net.pls_ex_stalls,
+			"res", res.pls_ex_count, res.pls_ex_hold_ns,
+			res.pls_ex_max_ns, res.pls_ex_stalls);
+
+	if (*ppos >= len)
+		return 0;
+
+	return cfs_trace_copyout_string(buffer, *lenp, tmpstr + *ppos, "\n");
+}
+
 static int
 proc_lnet_routes(struct ctl_table *table, int write, void __user *buffer,
 		 size_t *lenp, loff_t *ppos)
@@ -851,6 +891,11 @@ static struct ctl_table lnet_table[] = {
 		.mode		= 0644,
 		.proc_handler	= &proc_lnet_stats,
 	},
+	{
+		.procname	= "lock_stats",
+		.mode		= 0644,
+		.proc_handler	= &proc_lnet_lock_stats,
+	},
 	{
 		.procname	= "routes",
 		.mode		= 0444,
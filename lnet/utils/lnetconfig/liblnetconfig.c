@@ -2915,6 +2915,7 @@ int lustre_lnet_show_peer(char *knid, int detail, int seq_no,
 	struct lnet_ioctl_element_stats *lpni_stats;
 	struct lnet_ioctl_element_msg_stats *msg_stats;
 	struct lnet_ioctl_peer_ni_hstats *hstats;
+	struct lnet_ioctl_peer_ni_pstats pstats;
 	struct lnet_ioctl_construct_udsp_info udsp_info;
 	lnet_nid_t *nidp;
 	int rc = LUSTRE_CFG_RC_OUT_OF_MEM;
@@ -2925,7 +2926,7 @@ int lustre_lnet_show_peer(char *knid, int detail, int seq_no,
 	struct cYAML *root = NULL, *peer = NULL, *peer_ni = NULL,
 		     *first_seq = NULL, *peer_root = NULL, *tmp = NULL,
 		     *msg_statistics = NULL, *statistics = NULL,
-		     *yhstats;
+		     *path_stats = NULL, *yhstats;
 	char err_str[LNET_MAX_STR_LEN] = "\"out of memory\"";
 	struct lnet_process_id *list = NULL;
 	void *data = NULL;
@@ -3159,6 +3160,33 @@ continue_without_udsp_info:
 			    == NULL)
 				goto out;
 
+			/* older kernels do not report path stats */
+			LIBCFS_IOC_INIT_V2(pstats, pst_hdr);
+			pstats.pst_nid = *nidp;
+			if (l_ioctl(LNET_DEV_ID, IOC_LIBCFS_GET_PEER_NI_PSTATS,
+				    &pstats) != 0)
+				goto continue_without_path_stats;
+
+			path_stats = cYAML_create_object(peer_ni, "path stats");
+			if (path_stats == NULL)
+				goto out;
+
+			if (cYAML_create_number(path_stats, "rtt_usec",
+						pstats.pst_rtt_usec)
+			    == NULL)
+				goto out;
+
+			if (cYAML_create_number(path_stats, "bytes_per_sec",
+						pstats.pst_bytes_per_sec)
+			    == NULL)
+				goto out;
+
+			if (cYAML_create_number(path_stats, "samples",
+						pstats.pst_samples)
+			    == NULL)
+				goto out;
+
+continue_without_path_stats:
 			if (detail < 2)
 				continue;
 
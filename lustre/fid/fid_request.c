@@ -50,23 +50,20 @@
 
 struct dentry *seq_debugfs_dir;
 
-static int seq_client_rpc(struct lu_client_seq *seq,
-			  struct lu_seq_range *output, __u32 opc,
-			  const char *opcname)
+static struct ptlrpc_request *seq_client_rpc_pack(struct lu_client_seq *seq,
+						  __u32 opc,
+						  unsigned int *debug_mask)
 {
 	struct obd_export     *exp = seq->lcs_exp;
 	struct ptlrpc_request *req;
-	struct lu_seq_range   *out, *in;
+	struct lu_seq_range   *in;
 	__u32                 *op;
-	unsigned int           debug_mask;
-	int                    rc;
-	ENTRY;
 
 	LASSERT(exp != NULL && !IS_ERR(exp));
 	req = ptlrpc_request_alloc_pack(class_exp2cliimp(exp), &RQF_SEQ_QUERY,
 					LUSTRE_MDS_VERSION, SEQ_QUERY);
 	if (!req)
-		RETURN(-ENOMEM);
+		return NULL;
 
 	/* Init operation code */
 	op = req_capsule_client_get(&req->rq_pill, &RMF_SEQ_OPC);
@@ -99,7 +96,7 @@ static int seq_client_rpc(struct lu_client_seq *seq,
 			req->rq_no_resend = 1;
 			req->rq_no_delay = 1;
 		}
-		debug_mask = D_CONSOLE;
+		*debug_mask = D_CONSOLE;
 	} else {
 		if (seq->lcs_type == LUSTRE_SEQ_METADATA) {
 			req->rq_reply_portal = MDC_REPLY_PORTAL;
@@ -109,7 +106,7 @@ static int seq_client_rpc(struct lu_client_seq *seq,
 			req->rq_request_portal = SEQ_DATA_PORTAL;
 		}
 
-		debug_mask = D_INFO;
+		*debug_mask = D_INFO;
 	}
 
 	/* Allow seq client RPC during recovery time. */
@@ -117,32 +114,155 @@ static int seq_client_rpc(struct lu_client_seq *seq,
 
 	ptlrpc_at_set_req_timeout(req);
 
-	rc = ptlrpc_queue_wait(req);
+	return req;
+}
 
-	if (rc)
-		GOTO(out_req, rc);
+static int seq_client_rpc_unpack(struct lu_client_seq *seq,
+				 struct ptlrpc_request *req,
+				 struct lu_seq_range *output,
+				 const char *opcname, unsigned int debug_mask)
+{
+	struct lu_seq_range *out;
 
 	out = req_capsule_server_get(&req->rq_pill, &RMF_SEQ_RANGE);
+	if (!out)
+		return -EPROTO;
+
 	*output = *out;
 
 	if (!lu_seq_range_is_sane(output)) {
 		CERROR("%s: Invalid range received from server: "
 		       DRANGE"\n", seq->lcs_name, PRANGE(output));
-		GOTO(out_req, rc = -EINVAL);
+		return -EINVAL;
 	}
 
 	if (lu_seq_range_is_exhausted(output)) {
 		CERROR("%s: Range received from server is exhausted: "
 		       DRANGE"]\n", seq->lcs_name, PRANGE(output));
-		GOTO(out_req, rc = -EINVAL);
+		return -EINVAL;
 	}
 
 	CDEBUG_LIMIT(debug_mask, "%s: Allocated %s-sequence "DRANGE"]\n",
 		     seq->lcs_name, opcname, PRANGE(output));
 
-	EXIT;
-out_req:
+	return 0;
+}
+
+static int seq_client_rpc(struct lu_client_seq *seq,
+			  struct lu_seq_range *output, __u32 opc,
+			  const char *opcname)
+{
+	struct ptlrpc_request *req;
+	unsigned int           debug_mask;
+	int                    rc;
+	ENTRY;
+
+	req = seq_client_rpc_pack(seq, opc, &debug_mask);
+	if (!req)
+		RETURN(-ENOMEM);
+
+	rc = ptlrpc_queue_wait(req);
+	if (rc == 0)
+		rc = seq_client_rpc_unpack(seq, req, output, opcname,
+					   debug_mask);
+
 	ptlrpc_req_finished(req);
+	RETURN(rc);
+}
+
+static int seq_client_prefetch_interpret(const struct lu_env *env,
+					 struct ptlrpc_request *req,
+					 void *args, int rc)
+{
+	union ptlrpc_async_args *aa = args;
+	struct lu_client_seq *seq;
+	struct lu_seq_range range;
+	__u32 gen;
+
+	aa = ptlrpc_req_async_args(aa, req);
+	seq = aa->pointer_arg[0];
+	gen = (__u32)(unsigned long)aa->pointer_arg[1];
+
+	if (rc == 0)
+		rc = seq_client_rpc_unpack(seq, req, &range, "meta", D_INFO);
+
+	spin_lock(&seq->lcs_lock);
+	/* The space may have been flushed since the RPC was sent. */
+	if (rc == 0 && gen == seq->lcs_prefetch_gen)
+		seq->lcs_space_next = range;
+	seq->lcs_prefetching = 0;
+	spin_unlock(&seq->lcs_lock);
+	wake_up_var(&seq->lcs_space_next);
+
+	if (rc != 0)
+		CDEBUG(D_INFO, "%s: cannot prefetch meta-sequence: rc = %d\n",
+		       seq->lcs_name, rc);
+
+	return 0;
+}
+
+/*
+ * Send the meta-sequence request asynchronously before current sequence
+ * runs out, so the FID allocation does not need to wait for the RPC when
+ * switching sequence. Called with lcs_mutex held.
+ */
+static void seq_client_prefetch(struct lu_client_seq *seq)
+{
+	union ptlrpc_async_args *aa;
+	struct ptlrpc_request *req;
+	unsigned int debug_mask;
+
+	if (seq->lcs_srv || !seq->lcs_exp ||
+	    !lu_seq_range_is_exhausted(&seq->lcs_space))
+		return;
+
+	spin_lock(&seq->lcs_lock);
+	if (seq->lcs_prefetching ||
+	    !lu_seq_range_is_exhausted(&seq->lcs_space_next)) {
+		spin_unlock(&seq->lcs_lock);
+		return;
+	}
+	seq->lcs_prefetching = 1;
+	spin_unlock(&seq->lcs_lock);
+
+	req = seq_client_rpc_pack(seq, SEQ_ALLOC_META, &debug_mask);
+	if (!req) {
+		spin_lock(&seq->lcs_lock);
+		seq->lcs_prefetching = 0;
+		spin_unlock(&seq->lcs_lock);
+		wake_up_var(&seq->lcs_space_next);
+		return;
+	}
+
+	aa = ptlrpc_req_async_args(aa, req);
+	aa->pointer_arg[0] = seq;
+	aa->pointer_arg[1] = (void *)(unsigned long)seq->lcs_prefetch_gen;
+	req->rq_interpret_reply = seq_client_prefetch_interpret;
+	ptlrpcd_add_req(req);
+}
+
+/*
+ * Take the prefetched meta-sequence range, wait for the prefetch RPC if it
+ * is in flight. Called with lcs_mutex held.
+ *
+ * \retval	0 if lcs_space is refilled with the prefetched range
+ * \retval	-ENOENT if nothing was prefetched
+ */
+static int seq_client_prefetch_get(struct lu_client_seq *seq)
+{
+	int rc = -ENOENT;
+
+	wait_var_event(&seq->lcs_space_next, !seq->lcs_prefetching);
+
+	spin_lock(&seq->lcs_lock);
+	if (!lu_seq_range_is_exhausted(&seq->lcs_space_next)) {
+		seq->lcs_space = seq->lcs_space_next;
+		lu_seq_range_init(&seq->lcs_space_next);
+		seq->lcs_prefetch_hits++;
+		rc = 0;
+	}
+	spin_unlock(&seq->lcs_lock);
+
 	return rc;
 }
 
@@ -226,7 +346,11 @@ static int seq_client_alloc_seq(const struct lu_env *env,
 	LASSERT(lu_seq_range_is_sane(&seq->lcs_space));
 
 	if (lu_seq_range_is_exhausted(&seq->lcs_space)) {
-		rc = seq_client_alloc_meta(env, seq);
+		rc = -ENOENT;
+		if (!seq->lcs_srv)
+			rc = seq_client_prefetch_get(seq);
+		if (rc)
+			rc = seq_client_alloc_meta(env, seq);
 		if (rc) {
 			if (rc != -EINPROGRESS)
 				CERROR("%s: Cannot allocate new meta-sequence: rc = %d\n",
@@ -325,6 +449,11 @@ int seq_client_alloc_fid(const struct lu_env *env,
 		/* Just bump last allocated fid and return to caller. */
 		seq->lcs_fid.f_oid++;
 		rc = 0;
+
+		if (seq->lcs_prefetch_lowat &&
+		    seq->lcs_width - fid_oid(&seq->lcs_fid) <=
+		    seq->lcs_prefetch_lowat)
+			seq_client_prefetch(seq);
 	} else {
 		u64 seqnr;
 
@@ -372,6 +501,13 @@ void seq_client_flush(struct lu_client_seq *seq)
 	seq->lcs_space.lsr_index = -1;
 
 	lu_seq_range_init(&seq->lcs_space);
+
+	/* The prefetched range or the one in flight may be from the MDT
+	 * before failover, drop it. */
+	spin_lock(&seq->lcs_lock);
+	lu_seq_range_init(&seq->lcs_space_next);
+	seq->lcs_prefetch_gen++;
+	spin_unlock(&seq->lcs_lock);
 	mutex_unlock(&seq->lcs_mutex);
 }
 EXPORT_SYMBOL(seq_client_flush);
@@ -396,6 +532,9 @@ void seq_client_fini(struct lu_client_seq *seq)
 
 	seq_client_debugfs_fini(seq);
 
+	/* The prefetch RPC refers to the sequence manager. */
+	wait_var_event(&seq->lcs_space_next, !seq->lcs_prefetching);
+
 	if (seq->lcs_exp) {
 		class_export_put(seq->lcs_exp);
 		seq->lcs_exp = NULL;
@@ -421,10 +560,19 @@ void seq_client_init(struct lu_client_seq *seq,
 	seq->lcs_type = type;
 
 	mutex_init(&seq->lcs_mutex);
-	if (type == LUSTRE_SEQ_METADATA)
+	spin_lock_init(&seq->lcs_lock);
+	seq->lcs_prefetching = 0;
+	seq->lcs_prefetch_hits = 0;
+	seq->lcs_prefetch_gen = 0;
+	if (type == LUSTRE_SEQ_METADATA) {
 		seq->lcs_width = LUSTRE_METADATA_SEQ_MAX_WIDTH;
-	else
+		/* Only the clients ask the MDTs for meta-sequence. */
+		if (!srv)
+			seq->lcs_prefetch_lowat =
+				LUSTRE_METADATA_SEQ_PREFETCH_LOWAT;
+	} else {
 		seq->lcs_width = LUSTRE_DATA_SEQ_MAX_WIDTH;
+	}
 
 	/* Make sure that things are clear before work is started. */
 	seq_client_flush(seq);
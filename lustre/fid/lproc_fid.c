@@ -564,6 +564,14 @@ static ssize_t ldebugfs_client_fid_width_seq_write(struct file *file,
 
 		CDEBUG(D_INFO, "%s: Sequence size: %llu\n", seq->lcs_name,
 		       seq->lcs_width);
+
+		/* prefetch_lowat is never above the width */
+		if (seq->lcs_prefetch_lowat > val) {
+			seq->lcs_prefetch_lowat = val;
+			CDEBUG(D_INFO,
+			       "%s: Sequence prefetch low-water: %llu\n",
+			       seq->lcs_name, seq->lcs_prefetch_lowat);
+		}
 	} else {
 		count = -ERANGE;
 	}
@@ -585,6 +593,61 @@ ldebugfs_client_fid_width_seq_show(struct seq_file *m, void *unused)
 	RETURN(0);
 }
 
+static ssize_t
+ldebugfs_client_fid_prefetch_lowat_seq_write(struct file *file,
+					     const char __user *buffer,
+					     size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct lu_client_seq *seq = m->private;
+	u64 val;
+	int rc;
+
+	ENTRY;
+	rc = kstrtoull_from_user(buffer, count, 0, &val);
+	if (rc)
+		return rc;
+
+	mutex_lock(&seq->lcs_mutex);
+	if (val <= seq->lcs_width) {
+		seq->lcs_prefetch_lowat = val;
+
+		CDEBUG(D_INFO, "%s: Sequence prefetch low-water: %llu\n",
+		       seq->lcs_name, seq->lcs_prefetch_lowat);
+	} else {
+		count = -ERANGE;
+	}
+
+	mutex_unlock(&seq->lcs_mutex);
+	RETURN(count);
+}
+
+static int
+ldebugfs_client_fid_prefetch_lowat_seq_show(struct seq_file *m, void *unused)
+{
+	struct lu_client_seq *seq = (struct lu_client_seq *)m->private;
+
+	ENTRY;
+	mutex_lock(&seq->lcs_mutex);
+	seq_printf(m, "%llu\n", seq->lcs_prefetch_lowat);
+	mutex_unlock(&seq->lcs_mutex);
+
+	RETURN(0);
+}
+
+static int
+ldebugfs_client_fid_prefetch_hits_seq_show(struct seq_file *m, void *unused)
+{
+	struct lu_client_seq *seq = (struct lu_client_seq *)m->private;
+
+	ENTRY;
+	spin_lock(&seq->lcs_lock);
+	seq_printf(m, "%llu\n", seq->lcs_prefetch_hits);
+	spin_unlock(&seq->lcs_lock);
+
+	RETURN(0);
+}
+
 static int
 ldebugfs_client_fid_fid_seq_show(struct seq_file *m, void *unused)
 {
@@ -619,6 +682,8 @@ ldebugfs_client_fid_server_seq_show(struct seq_file *m, void *unused)
 
 LDEBUGFS_SEQ_FOPS(ldebugfs_client_fid_space);
 LDEBUGFS_SEQ_FOPS(ldebugfs_client_fid_width);
+LDEBUGFS_SEQ_FOPS(ldebugfs_client_fid_prefetch_lowat);
+LDEBUGFS_SEQ_FOPS_RO(ldebugfs_client_fid_prefetch_hits);
 LDEBUGFS_SEQ_FOPS_RO(ldebugfs_client_fid_server);
 LDEBUGFS_SEQ_FOPS_RO(ldebugfs_client_fid_fid);
 
@@ -627,6 +692,10 @@ struct ldebugfs_vars seq_client_debugfs_list[] = {
 	  .fops	=	&ldebugfs_client_fid_space_fops	},
 	{ .name	=	"width",
 	  .fops	=	&ldebugfs_client_fid_width_fops	},
+	{ .name	=	"prefetch_lowat",
+	  .fops	=	&ldebugfs_client_fid_prefetch_lowat_fops },
+	{ .name	=	"prefetch_hits",
+	  .fops	=	&ldebugfs_client_fid_prefetch_hits_fops },
 	{ .name	=	"server",
 	  .fops	=	&ldebugfs_client_fid_server_fops},
 	{ .name	=	"fid",
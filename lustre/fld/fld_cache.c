@@ -67,6 +67,7 @@ struct fld_cache *fld_cache_init(const char *name, int cache_size,
 
 	cache->fci_cache_count = 0;
 	rwlock_init(&cache->fci_lock);
+	RCU_INIT_POINTER(cache->fci_array, NULL);
 
 	strlcpy(cache->fci_name, name, sizeof(cache->fci_name));
 
@@ -97,6 +98,91 @@ void fld_cache_fini(struct fld_cache *cache)
 	OBD_FREE_PTR(cache);
 }
 
+static void fld_cache_array_free(struct rcu_head *head)
+{
+	struct fld_cache_array *fca;
+
+	fca = container_of(head, struct fld_cache_array, fca_rcu);
+	OBD_FREE_LARGE(fca, sizeof(*fca) +
+		       fca->fca_count * sizeof(fca->fca_slots[0]));
+}
+
+/**
+ * drop the lockless lookup snapshot before changing the cache entries,
+ * the lookups fall back to the entries list until it is published again.
+ */
+static void fld_cache_invalidate_nolock(struct fld_cache *cache)
+{
+	struct fld_cache_array *fca;
+
+	cache->fci_gen++;
+	fca = rcu_dereference_protected(cache->fci_array, 1);
+	if (fca == NULL)
+		return;
+
+	RCU_INIT_POINTER(cache->fci_array, NULL);
+	call_rcu(&fca->fca_rcu, fld_cache_array_free);
+}
+
+/**
+ * Build the sorted array snapshot of the cache entries and publish it for
+ * the lockless lookup.
+ *
+ * Called without \a fci_lock held after the cache entries change, since the
+ * array allocation may sleep. If the cache is changed by race, then leave
+ * it to the one that changed the cache to publish.
+ */
+void fld_cache_publish(struct fld_cache *cache)
+{
+	struct fld_cache_array *fca;
+	struct fld_cache_entry *flde;
+	unsigned int gen;
+	u64 max_end = 0;
+	int count;
+	int i = 0;
+
+	ENTRY;
+
+	read_lock(&cache->fci_lock);
+	gen = cache->fci_gen;
+	count = cache->fci_cache_count;
+	read_unlock(&cache->fci_lock);
+
+	if (count == 0)
+		RETURN_EXIT;
+
+	OBD_ALLOC_LARGE(fca, sizeof(*fca) + count * sizeof(fca->fca_slots[0]));
+	if (fca == NULL)
+		RETURN_EXIT;
+
+	write_lock(&cache->fci_lock);
+	if (cache->fci_gen != gen || cache->fci_cache_count != count ||
+	    rcu_access_pointer(cache->fci_array) != NULL) {
+		write_unlock(&cache->fci_lock);
+		OBD_FREE_LARGE(fca, sizeof(*fca) +
+			       count * sizeof(fca->fca_slots[0]));
+		RETURN_EXIT;
+	}
+
+	list_for_each_entry(flde, &cache->fci_entries_head, fce_list) {
+		if (i == count)
+			break;
+
+		max_end = max(max_end, flde->fce_range.lsr_end);
+		fca->fca_slots[i].fcs_range = flde->fce_range;
+		fca->fca_slots[i].fcs_max_end = max_end;
+		i++;
+	}
+	LASSERTF(i == count, "%s: %d entries, count %d\n",
+		 cache->fci_name, i, count);
+
+	fca->fca_count = count;
+	rcu_assign_pointer(cache->fci_array, fca);
+	write_unlock(&cache->fci_lock);
+
+	EXIT;
+}
+
 /**
  * delete given node from list.
  */
@@ -232,6 +318,7 @@ void fld_cache_flush(struct fld_cache *cache)
 	ENTRY;
 
 	write_lock(&cache->fci_lock);
+	fld_cache_invalidate_nolock(cache);
 	cache->fci_cache_size = 0;
 	fld_cache_shrink(cache);
 	write_unlock(&cache->fci_lock);
@@ -367,6 +454,10 @@ struct fld_cache_entry
  *
  * This function handles all cases of merging and breaking up of
  * ranges.
+ *
+ * Called with \a fci_lock held for write. It drops the lockless lookup
+ * snapshot, the caller must call fld_cache_publish() after the lock is
+ * released.
  */
 int fld_cache_insert_nolock(struct fld_cache *cache,
 			    struct fld_cache_entry *f_new)
@@ -387,6 +478,7 @@ int fld_cache_insert_nolock(struct fld_cache *cache,
 	 * insertion loop.
 	 */
 
+	fld_cache_invalidate_nolock(cache);
 	fld_cache_shrink(cache);
 
 	head = &cache->fci_entries_head;
@@ -430,12 +522,21 @@ int fld_cache_insert(struct fld_cache *cache,
 	write_lock(&cache->fci_lock);
 	rc = fld_cache_insert_nolock(cache, flde);
 	write_unlock(&cache->fci_lock);
+	/* the snapshot was dropped even if the insert failed */
+	fld_cache_publish(cache);
 	if (rc)
 		OBD_FREE_PTR(flde);
 
 	RETURN(rc);
 }
 
+/**
+ * Delete FLD entry starting or ending as \a range from FLD cache.
+ *
+ * Called with \a fci_lock held for write, the caller must call
+ * fld_cache_publish() after the lock is released as for
+ * fld_cache_insert_nolock().
+ */
 void fld_cache_delete_nolock(struct fld_cache *cache,
 		      const struct lu_seq_range *range)
 {
@@ -443,6 +544,7 @@ void fld_cache_delete_nolock(struct fld_cache *cache,
 	struct fld_cache_entry *tmp;
 	struct list_head *head;
 
+	fld_cache_invalidate_nolock(cache);
 	head = &cache->fci_entries_head;
 	list_for_each_entry_safe(flde, tmp, head, fce_list) {
 		/* add list if next is end of list */
@@ -455,18 +557,73 @@ void fld_cache_delete_nolock(struct fld_cache *cache,
 	}
 }
 
+/**
+ * lookup \a seq sequence in the fld cache snapshot by binary search, with
+ * the same result as the entries list walking in fld_cache_lookup().
+ */
+static int fld_cache_array_lookup(const struct fld_cache_array *fca,
+				  const u64 seq, struct lu_seq_range *range)
+{
+	int lo = 0;
+	int hi = fca->fca_count;
+	int found = -1;
+	int i;
+
+	/* find the first slot that starts after \a seq */
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+
+		if (fca->fca_slots[mid].fcs_range.lsr_start > seq)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	/* The ranges with different flags may overlap, the first one that
+	 * contains \a seq wins. Generally only the last one is checked. */
+	for (i = lo - 1; i >= 0 && fca->fca_slots[i].fcs_max_end > seq; i--) {
+		if (lu_seq_range_within(&fca->fca_slots[i].fcs_range, seq))
+			found = i;
+	}
+
+	if (found >= 0) {
+		*range = fca->fca_slots[found].fcs_range;
+		return 0;
+	}
+
+	if (lo > 0 && lo < fca->fca_count)
+		*range = fca->fca_slots[lo - 1].fcs_range;
+
+	return -ENOENT;
+}
+
 /**
  * lookup \a seq sequence for range in fld cache.
  */
 int fld_cache_lookup(struct fld_cache *cache,
 		     const u64 seq, struct lu_seq_range *range)
 {
+	struct fld_cache_array *fca;
 	struct fld_cache_entry *flde;
 	struct fld_cache_entry *prev = NULL;
 	struct list_head *head;
+	int rc;
 
 	ENTRY;
 
+	rcu_read_lock();
+	fca = rcu_dereference(cache->fci_array);
+	if (fca != NULL) {
+		rc = fld_cache_array_lookup(fca, seq, range);
+		rcu_read_unlock();
+
+		cache->fci_stat.fst_count++;
+		if (rc == 0)
+			cache->fci_stat.fst_cache++;
+		RETURN(rc);
+	}
+	rcu_read_unlock();
+
 	read_lock(&cache->fci_lock);
 	head = &cache->fci_entries_head;
 
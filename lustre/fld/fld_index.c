@@ -209,6 +209,7 @@ int fld_index_create(const struct lu_env *env, struct lu_server_fld *fld,
 		fld_cache_delete_nolock(fld->lsf_cache, new_range);
 	rc = fld_cache_insert_nolock(fld->lsf_cache, flde);
 	write_unlock(&fld->lsf_cache->fci_lock);
+	fld_cache_publish(fld->lsf_cache);
 	if (rc)
 		OBD_FREE_PTR(flde);
 out:
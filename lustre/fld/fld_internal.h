@@ -79,6 +79,25 @@ struct fld_cache_entry {
 	struct lu_seq_range	fce_range;
 };
 
+struct fld_cache_slot {
+	struct lu_seq_range	fcs_range;
+	/**
+	 * The max lsr_end of the ranges in this and former slots, to stop
+	 * the lookup as soon as no former range can contain the seq. */
+	u64			fcs_max_end;
+};
+
+/**
+ * Read-only snapshot of the fld cache entries for lockless lookup, sorted
+ * on range->lsr_start field as the entries list. It is replaced as whole
+ * under RCU after the cache is changed.
+ */
+struct fld_cache_array {
+	struct rcu_head		fca_rcu;
+	int			fca_count;
+	struct fld_cache_slot	fca_slots[0];
+};
+
 struct fld_cache {
 	/**
 	 * Cache guard, protects fci_hash mostly because others immutable after
@@ -86,6 +105,15 @@ struct fld_cache {
 	 */
 	rwlock_t		 fci_lock;
 
+	/**
+	 * Snapshot of fci_entries_head for lockless lookup, NULL if it is
+	 * not built for the latest entries yet. Updated under \a fci_lock */
+	struct fld_cache_array __rcu *fci_array;
+
+	/**
+	 * Changed every time the cache entries change. Protected by \a fci_lock */
+	unsigned int		 fci_gen;
+
         /**
          * Cache shrink threshold */
         int                      fci_threshold;
@@ -197,6 +225,7 @@ int fld_cache_insert_nolock(struct fld_cache *cache,
 			    struct fld_cache_entry *f_new);
 void fld_cache_delete_nolock(struct fld_cache *cache,
 			     const struct lu_seq_range *range);
+void fld_cache_publish(struct fld_cache *cache);
 int fld_cache_lookup(struct fld_cache *cache,
 		     const u64 seq, struct lu_seq_range *range);
 
@@ -529,6 +529,8 @@ static void __exit fld_exit(void)
 #endif /* HAVE_SERVER_SUPPORT */
 
 	debugfs_remove_recursive(fld_debugfs_dir);
+	/* wait for the fld cache snapshots being freed */
+	rcu_barrier();
 }
 
 MODULE_AUTHOR("OpenSFS, Inc. <http://www.lustre.org/>");
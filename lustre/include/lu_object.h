@@ -1591,6 +1591,7 @@ struct lu_tgt_qos {
 						       * every obj*/
 	__u64			 ltq_avail;	/* bytes/inode avail */
 	__u64			 ltq_weight;	/* net weighting */
+	__u32			 ltq_load_cut;	/* weight cut by load, 0-256 */
 	time64_t		 ltq_used;	/* last used time, seconds */
 	bool			 ltq_usable:1;	/* usable for striping */
 };
@@ -1602,6 +1603,10 @@ struct lu_tgt_qos {
 #define LOV_QOS_DEF_PRIO_FREE		90
 #define LMV_QOS_DEF_PRIO_FREE		90
 
+#define LOV_QOS_DEF_PRIO_LOAD		80
+/* os_load above which a target is skipped by the first round-robin pass */
+#define LOV_QOS_LOAD_BUSY		90
+
 struct lu_tgt_desc {
 	union {
 		struct dt_device	*ltd_tgt;
@@ -1639,6 +1644,7 @@ struct lu_qos {
 	struct rw_semaphore	 lq_rw_sem;
 	__u32			 lq_active_svr_count;
 	unsigned int		 lq_prio_free;   /* priority for free space */
+	unsigned int		 lq_prio_load;   /* priority for target load */
 	unsigned int		 lq_threshold_rr;/* priority for rr */
 #ifdef HAVE_SERVER_SUPPORT
 	struct lu_qos_rr	 lq_rr;          /* round robin qos data */
@@ -117,16 +117,35 @@ struct target_distribute_txn_data {
 	void			*tdtd_show_retrievers_cbdata;
 };
 
+/* per-CPT part of the grant accounting, see tgt_grant.c */
+struct tg_grants_shard {
+	/* changes of tgd_tot_* not folded into tg_grants_data yet */
+	s64			 tgs_dirty;
+	s64			 tgs_granted;
+	s64			 tgs_pending;
+	/* space written by committed I/Os, not taken out of tgd_osfs yet */
+	u64			 tgs_written;
+	/* free space reserved to grant from this CPT, can be slightly
+	 * negative since tgt_grant_alloc() rounds grant up to block size */
+	s64			 tgs_avail;
+};
+
 struct tg_grants_data {
 	/* grants: all values in bytes */
-	/* grant lock to protect all grant counters */
-	spinlock_t		 tgd_grant_lock;
+	/* grant lock, a private lock protects the shard of the CPT and the
+	 * grant counters of the exports hashed to it, the exclusive lock
+	 * (CFS_PERCPT_LOCK_EX) is needed to access the global counters */
+	struct cfs_percpt_lock	*tgd_grant_lock;
+	struct tg_grants_shard	**tgd_grant_shards;
 	/* total amount of dirty data reported by clients in incoming obdo */
 	u64			 tgd_tot_dirty;
 	/* sum of filesystem space granted to clients for async writes */
 	u64			 tgd_tot_granted;
 	/* grant used by I/Os in progress (between prepare and commit) */
 	u64			 tgd_tot_pending;
+	/* space accounted in the shards: tgs_granted + tgs_avail +
+	 * tgs_written of all the shards */
+	s64			 tgd_tot_reserved;
 	/* amount of available space in percentage that is never used for
 	 * grants, used on MDT to always keep space for metadata. */
 	u64			 tgd_reserved_pcnt;
@@ -202,6 +221,8 @@ struct lu_target {
 	struct dt_object	*lut_reply_data;
 	/** Bitmap of used slots in the reply data file */
 	unsigned long		**lut_reply_bitmap;
+	/** per-CPT caches of reply data slots */
+	struct tg_reply_slot_cache **lut_reply_cache;
 	/** target sync count, used for debug & test */
 	atomic_t		 lut_sync_count;
 
@@ -226,6 +247,20 @@ struct lu_target {
 /* number of slots in reply bitmap */
 #define LUT_REPLY_SLOTS_PER_CHUNK (1<<20)
 #define LUT_REPLY_SLOTS_MAX_CHUNKS 16
+/* number of slots cached per CPT */
+#define LUT_REPLY_SLOTS_CACHE	(2 * BITS_PER_LONG)
+
+/* Free reply data slots kept by a CPT, clear in the reply bitmap until used.
+ * Slots are claimed a bitmap word at a time, so that reply data written by
+ * the threads of a CPT are adjacent in the reply_data file */
+struct tg_reply_slot_cache {
+	spinlock_t		trsc_lock;
+	/** number of cached slots */
+	int			trsc_count;
+	/** bitmap word to look for free slots from */
+	int			trsc_cursor;
+	int			trsc_slots[LUT_REPLY_SLOTS_CACHE];
+};
 
 #define TRD_INDEX_MEMORY -1
 
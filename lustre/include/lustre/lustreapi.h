@@ -326,10 +326,13 @@ struct find_param {
 				 fp_newerxy:1,
 				 fp_exclude_btime:1,
 				 fp_exclude_perm:1,
-				 fp_unused_bit4:1, /* Once all unused fields  */
-				 fp_unused_bit5:1, /* are used we need to add */
-				 fp_unused_bit6:1, /* a separate flag field at*/
-				 fp_unused_bit7:1; /* the end of the struct.  */
+				 fp_sorted:1,	/* print results sorted */
+				 fp_mdt_scan:1,	/* filter entries on the MDT */
+				 fp_unused_bit6:1, /* Once all unused fields  */
+				 fp_unused_bit7:1; /* are used we need to add a
+						    * separate flag field at
+						    * the end of the struct.
+						    */
 
 	enum llapi_layout_verbose fp_verbose;
 	int			 fp_quiet;
@@ -400,12 +403,24 @@ struct find_param {
 	int			 fp_bsign;
 	unsigned int		 fp_hash_inflags;
 	unsigned int		 fp_hash_exflags;
+	/* number of threads for parallel directory traversal */
+	unsigned int		 fp_threads;
+	/* stat/layout ioctls in flight per MDT during parallel traversal,
+	 * 0 for the default, LLAPI_FIND_MDT_INFLIGHT_UNLIMITED for no limit
+	 */
+	unsigned int		 fp_mdt_inflight;
 };
 
+#define LLAPI_FIND_THREADS_MAX		256
+#define LLAPI_FIND_MDT_INFLIGHT_DEFAULT	8
+#define LLAPI_FIND_MDT_INFLIGHT_UNLIMITED	(~0U)
+
 int llapi_ostlist(char *path, struct find_param *param);
 int llapi_uuid_match(char *real_uuid, char *search_uuid);
 int llapi_getstripe(char *path, struct find_param *param);
 int llapi_find(char *path, struct find_param *param);
+int llapi_find_parallel(char *path, struct find_param *param,
+			unsigned int nthreads);
 
 int llapi_file_fget_mdtidx(int fd, int *mdtidx);
 int llapi_dir_set_default_lmv(const char *name,
@@ -546,6 +561,8 @@ int llapi_changelog_start(void **priv, enum changelog_send_flag flags,
 			  const char *mdtname, long long startrec);
 int llapi_changelog_fini(void **priv);
 int llapi_changelog_recv(void *priv, struct changelog_rec **rech);
+int llapi_changelog_recv_batch(void *priv, struct changelog_rec **recs,
+			       unsigned int count);
 int llapi_changelog_in_buf(void *priv);
 int llapi_changelog_free(struct changelog_rec **rech);
 int llapi_changelog_get_fd(void *priv);
@@ -554,6 +571,8 @@ int llapi_changelog_clear(const char *mdtname, const char *idstr,
 			  long long endrec);
 extern int llapi_changelog_set_xflags(void *priv,
 				    enum changelog_send_extra_flag extra_flags);
+int llapi_changelog_set_filter(void *priv,
+			       const struct changelog_filter *filter);
 
 /* HSM copytool interface.
  * priv is private state, managed internally by these functions
@@ -133,6 +133,12 @@ struct filter_export_data {
 	 * ofd_soft_sync_limit number of RPCs, and trigger a sync. */
 	atomic_t		fed_soft_sync_count;
 	__u32			fed_group;
+	/* highest precreate request served on this connection, so that
+	 * a precreate overtaken by a later one is not taken for a LAST_ID
+	 * corruption on the MDT, protected by os_create_lock */
+	__u64			fed_precreate_seq;
+	__u64			fed_precreate_oid;
+	__u32			fed_precreate_conn_cnt;
 };
 
 struct mgs_export_data {
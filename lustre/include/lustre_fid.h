@@ -188,6 +188,11 @@ enum {
 	 */
 	LUSTRE_SEQ_META_WIDTH = 0x0000000000000001ULL,
 
+	/*
+	 * Prefetch next sequence when a quarter of metadata FIDs are left.
+	 */
+	LUSTRE_METADATA_SEQ_PREFETCH_LOWAT = LUSTRE_METADATA_SEQ_MAX_WIDTH / 4,
+
 	/*
 	 * seq allocation pool size.
 	 */
@@ -445,6 +450,30 @@ struct lu_client_seq {
 
 	/* Seq-server for direct talking */
 	struct lu_server_seq	*lcs_srv;
+
+	/* Protects lcs_space_next, lcs_prefetch_hits and lcs_prefetching. */
+	spinlock_t		lcs_lock;
+
+	/*
+	 * Meta-sequence range prefetched asynchronously, to be used after
+	 * lcs_space is exhausted.
+	 */
+	struct lu_seq_range	lcs_space_next;
+
+	/*
+	 * Prefetch next meta-sequence when there are no more than this
+	 * count of FIDs left in current sequence, 0 to disable prefetch.
+	 */
+	__u64			lcs_prefetch_lowat;
+
+	/* Sequence switches served by a prefetched range. */
+	__u64			lcs_prefetch_hits;
+
+	/* Generation to drop the prefetched range across flush. */
+	__u32			lcs_prefetch_gen;
+
+	/* Prefetch RPC in flight. */
+	unsigned int		lcs_prefetching:1;
 };
 
 /* server sequence manager interface */
@@ -105,6 +105,8 @@ int lfsck_get_speed(char *buf, struct dt_device *key);
 int lfsck_set_speed(struct dt_device *key, __u32 val);
 int lfsck_get_windows(char *buf, struct dt_device *key);
 int lfsck_set_windows(struct dt_device *key, unsigned int val);
+int lfsck_get_threads(char *buf, struct dt_device *key);
+int lfsck_set_threads(struct dt_device *key, unsigned int val);
 
 int lfsck_dump(struct seq_file *m, struct dt_device *key, enum lfsck_type type);
 
@@ -164,6 +164,10 @@ int llog_cat_process_or_fork(const struct lu_env *env,
 			     int startidx, bool fork);
 int llog_cat_process(const struct lu_env *env, struct llog_handle *cat_llh,
 		     llog_cb_t cb, void *data, int startcat, int startidx);
+int llog_cat_process_parallel(const struct lu_env *env,
+			      struct llog_handle *cat_llh, llog_cb_t cb,
+			      void *data, int nthreads, int prefetch,
+			      bool ordered);
 __u64 llog_cat_size(const struct lu_env *env, struct llog_handle *cat_llh);
 __u32 llog_cat_free_space(struct llog_handle *cat_llh);
 int llog_cat_reverse_process(const struct lu_env *env,
@@ -113,6 +113,7 @@ void lustre_swab_lov_mds_md(struct lov_mds_md *lmm);
 void lustre_swab_idx_info(struct idx_info *ii);
 void lustre_swab_lip_header(struct lu_idxpage *lip);
 void lustre_swab_fid2path(struct getinfo_fid2path *gf);
+void lustre_swab_find_scan(struct lu_find_scan *lfs, __u32 len);
 void lustre_swab_layout_intent(struct layout_intent *li);
 void lustre_swab_hsm_user_state(struct hsm_user_state *hus);
 void lustre_swab_hsm_current_action(struct hsm_current_action *action);
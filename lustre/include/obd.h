@@ -779,6 +779,7 @@ void obd_nid_del(struct obd_device *obd, struct obd_export *exp);
 #define KEY_ASYNC               "async"
 #define KEY_CHANGELOG_CLEAR     "changelog_clear"
 #define KEY_FID2PATH            "fid2path"
+#define KEY_FIND_SCAN		"find_scan"
 #define KEY_CHECKSUM            "checksum"
 #define KEY_CLEAR_FS            "clear_fs"
 #define KEY_CONN_DATA           "conn_data"
@@ -850,6 +850,9 @@ struct ptlrpc_body_v2 {
 #define OBD_CONNECT2_BATCH_RPC        0x400000ULL /* Multi-RPC batch request */
 #define OBD_CONNECT2_PCCRO	      0x800000ULL /* Read-only PCC */
 #define OBD_CONNECT2_ATOMIC_OPEN_LOCK 0x4000000ULL/* request lock on 1st open */
+#define OBD_CONNECT2_PIPE_PRECREATE 0x8000000000ULL/* OST_CREATE overtaking */
+#define OBD_CONNECT2_DESTROY_BATCH 0x10000000000ULL/* multi-object OST_DESTROY */
+#define OBD_CONNECT2_QUOTA_BATCH   0x20000000000ULL/* multi-ID QUOTA_DQACQ */
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
  * flag value is not in use on some other branch.  Please clear any such
@@ -912,7 +915,8 @@ struct ptlrpc_body_v2 {
 				OBD_CONNECT2_GETATTR_PFID |\
 				OBD_CONNECT2_LSEEK | OBD_CONNECT2_DOM_LVB |\
 				OBD_CONNECT2_REP_MBITS | \
-				OBD_CONNECT2_ATOMIC_OPEN_LOCK)
+				OBD_CONNECT2_ATOMIC_OPEN_LOCK | \
+				OBD_CONNECT2_QUOTA_BATCH)
 
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
 				OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
@@ -935,7 +939,9 @@ struct ptlrpc_body_v2 {
 
 #define OST_CONNECT_SUPPORTED2 (OBD_CONNECT2_LOCKAHEAD | OBD_CONNECT2_INC_XID |\
 				OBD_CONNECT2_ENCRYPT | OBD_CONNECT2_LSEEK |\
-				OBD_CONNECT2_REP_MBITS)
+				OBD_CONNECT2_REP_MBITS | \
+				OBD_CONNECT2_DESTROY_BATCH | \
+				OBD_CONNECT2_PIPE_PRECREATE)
 
 #define ECHO_CONNECT_SUPPORTED (OBD_CONNECT_FID | OBD_CONNECT_FLAGS2)
 #define ECHO_CONNECT_SUPPORTED2 OBD_CONNECT2_REP_MBITS
@@ -1539,6 +1545,9 @@ struct quota_body {
 /* qb_usage is the current qunit (in kbytes/inodes) when quota_body is used in
  * quota reply */
 #define qb_qunit	qb_usage
+/* qb_padding is the result of the request for this ID when quota_body is used
+ * in the reply of a batched QUOTA_DQACQ, see OBD_CONNECT2_QUOTA_BATCH */
+#define qb_rc		qb_padding
 
 #define QUOTA_DQACQ_FL_ACQ	0x1  /* acquire quota */
 #define QUOTA_DQACQ_FL_PREACQ	0x2  /* pre-acquire */
@@ -3311,6 +3320,78 @@ struct getparent {
 	char		gp_name[0];     /**< zero-terminated link name */
 } __attribute__((packed));
 
+/** lfs find predicates evaluated on the MDT, see LL_IOC_FIND_SCAN */
+enum lu_find_scan_valid {
+	LFSV_ATIME		= 0x0001,
+	LFSV_MTIME		= 0x0002,
+	LFSV_CTIME		= 0x0004,
+	LFSV_SIZE		= 0x0008,
+	LFSV_UID		= 0x0010,
+	LFSV_GID		= 0x0020,
+	LFSV_PROJID		= 0x0040,
+	LFSV_POOL		= 0x0080,
+	LFSV_LAYOUT		= 0x0100,
+	LFSV_STRIPE_COUNT	= 0x0200,
+};
+
+/** one "[+-]N" comparison, with the same meaning as for lfs find */
+struct lu_find_scan_cmp {
+	__u64	lfsc_value;
+	__u64	lfsc_margin;
+	__s32	lfsc_sign;	/* < 0 for "+N", > 0 for "-N" */
+	__u32	lfsc_padding;
+};
+
+/** directory entry that was not rejected by the MDT */
+struct lu_find_scan_ent {
+	struct lu_fid	lfse_fid;
+	__u16		lfse_namelen;
+	__u16		lfse_type;	/* DT_* file type */
+	__u32		lfse_padding;
+	char		lfse_name[0];	/* NUL terminated, 8-byte padded */
+};
+
+/**
+ * Scan one directory on the MDT holding it, and return only the entries
+ * that may match the given predicates.  Subdirectories are always returned
+ * so that the caller can descend into them.  The scan resumes from
+ * \a lfs_cookie, which is MDS_DIR_END_OFF on return once the directory has
+ * been read completely.
+ */
+struct lu_find_scan {
+	struct lu_fid	lfs_fid;	/* directory to scan */
+	__u64		lfs_cookie;	/* in: hash to resume at, out: next */
+	__u32		lfs_valid;	/* LFSV_* predicates to check */
+	__u32		lfs_exclude;	/* LFSV_* predicates negated by "!" */
+	__u32		lfs_uid;
+	__u32		lfs_gid;
+	__u32		lfs_projid;
+	__u32		lfs_layout;	/* LOV_PATTERN_* */
+	struct lu_find_scan_cmp lfs_atime;
+	struct lu_find_scan_cmp lfs_mtime;
+	struct lu_find_scan_cmp lfs_ctime;
+	struct lu_find_scan_cmp lfs_size;
+	struct lu_find_scan_cmp lfs_stripe_count;
+	char		lfs_pool[LOV_MAXPOOLNAME + 1];
+	__u32		lfs_count;	/* out: entries in lfs_ents */
+	__u32		lfs_buflen;	/* in: size of lfs_ents, out: used */
+	struct lu_fid	lfs_root_fid;	/* fileset root, set by the client */
+	char		lfs_ents[0];
+};
+
+#define LU_FIND_SCAN_MAX_BUF	(64 * 1024)
+
+static inline size_t lu_find_scan_ent_size(unsigned int namelen)
+{
+	return (sizeof(struct lu_find_scan_ent) + namelen + 1 + 7) & ~7;
+}
+
+static inline struct lu_find_scan_ent *
+lu_find_scan_ent_next(struct lu_find_scan_ent *ent)
+{
+	return (void *)ent + lu_find_scan_ent_size(ent->lfse_namelen);
+}
+
 enum layout_intent_opc {
 	LAYOUT_INTENT_ACCESS	= 0,	/** generic access */
 	LAYOUT_INTENT_READ	= 1,	/** not used */
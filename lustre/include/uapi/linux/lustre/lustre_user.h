@@ -283,9 +283,11 @@ struct obd_statfs {
 					/* used in QoS code to find preferred
 					 * OSTs */
 	__u32           os_granted;	/* space granted for MDS */
-	__u32           os_spare3;	/* Unused padding fields.  Remember */
-	__u32           os_spare4;	/* to fix lustre_swab_obd_statfs() */
-	__u32           os_spare5;
+	__u32		os_load;	/* short-term target load, 0-100%,
+					 * used in QoS code to avoid busy
+					 * OSTs */
+	__u32           os_spare4;	/* Unused padding fields.  Remember */
+	__u32           os_spare5;	/* to fix lustre_swab_obd_statfs() */
 	__u32           os_spare6;
 	__u32           os_spare7;
 	__u32           os_spare8;
@@ -634,6 +636,7 @@ struct ll_ioc_lease_id {
 #define LL_IOC_PCC_DETACH_BY_FID	_IOW('f', 252, struct lu_pcc_detach_fid)
 #define LL_IOC_PCC_STATE		_IOR('f', 252, struct lu_pcc_state)
 #define LL_IOC_PROJECT			_IOW('f', 253, struct lu_project)
+#define LL_IOC_FIND_SCAN		_IOWR('f', 254, struct lu_find_scan)
 
 #ifndef	FS_IOC_FSGETXATTR
 /*
@@ -1732,6 +1735,19 @@ enum changelog_send_extra_flag {
 /* 31 usable bytes string + null terminator. */
 #define LUSTRE_JOBID_SIZE	32
 
+/*
+ * Per-reader changelog filter, see OBD_IOC_CHLG_SET_FILTER.  A record is
+ * delivered only if it matches all of the fields that are set.  This is
+ * applied by the client changelog reader, the MDT sends all records.
+ */
+struct changelog_filter {
+	__u32	cf_type_mask;	/* (1 << CL_*) record types, 0 for all */
+	__u32	cf_padding;
+	__u64	cf_seq_start;	/* target or parent FID sequence within */
+	__u64	cf_seq_end;	/* [start, end), end == 0 for all */
+	char	cf_jobid[LUSTRE_JOBID_SIZE]; /* exact jobid, "" for all */
+};
+
 /* This is the minimal changelog record. It can contain extensions
  * such as rename fields or process jobid. Its exact content is described
  * by the cr_flags and cr_extra_flags.
@@ -2495,6 +2511,7 @@ enum lu_ladvise_type {
 	LU_LADVISE_DONTNEED	= 2,
 	LU_LADVISE_LOCKNOEXPAND = 3,
 	LU_LADVISE_LOCKAHEAD	= 4,
+	LU_LADVISE_WILLWRITE	= 5,
 	LU_LADVISE_MAX
 };
 
@@ -2503,6 +2520,7 @@ enum lu_ladvise_type {
 	[LU_LADVISE_DONTNEED]		= "dontneed",			\
 	[LU_LADVISE_LOCKNOEXPAND]	= "locknoexpand",		\
 	[LU_LADVISE_LOCKAHEAD]		= "lockahead",			\
+	[LU_LADVISE_WILLWRITE]		= "willwrite",			\
 }
 
 /* This is the userspace argument for ladvise.  It is currently the same as
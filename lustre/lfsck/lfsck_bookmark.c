@@ -46,6 +46,7 @@ static void lfsck_bookmark_le_to_cpu(struct lfsck_bookmark *des,
 	des->lb_param = le16_to_cpu(src->lb_param);
 	des->lb_speed_limit = le32_to_cpu(src->lb_speed_limit);
 	des->lb_async_windows = le16_to_cpu(src->lb_async_windows);
+	des->lb_assistant_threads = le16_to_cpu(src->lb_assistant_threads);
 	fid_le_to_cpu(&des->lb_lpf_fid, &src->lb_lpf_fid);
 	fid_le_to_cpu(&des->lb_last_fid, &src->lb_last_fid);
 }
@@ -58,6 +59,7 @@ void lfsck_bookmark_cpu_to_le(struct lfsck_bookmark *des,
 	des->lb_param = cpu_to_le16(src->lb_param);
 	des->lb_speed_limit = cpu_to_le32(src->lb_speed_limit);
 	des->lb_async_windows = cpu_to_le16(src->lb_async_windows);
+	des->lb_assistant_threads = cpu_to_le16(src->lb_assistant_threads);
 	fid_cpu_to_le(&des->lb_lpf_fid, &src->lb_lpf_fid);
 	fid_cpu_to_le(&des->lb_last_fid, &src->lb_last_fid);
 }
@@ -251,6 +253,11 @@ int lfsck_set_param(const struct lu_env *env, struct lfsck_instance *lfsck,
 			bk->lb_async_windows = LFSCK_ASYNC_WIN_DEFAULT;
 			dirty = true;
 		}
+
+		if (bk->lb_assistant_threads != 0) {
+			bk->lb_assistant_threads = 0;
+			dirty = true;
+		}
 	} else {
 		if ((bk->lb_param & LPF_ALL_TGT) &&
 		    !(start->ls_flags & LPF_ALL_TGT)) {
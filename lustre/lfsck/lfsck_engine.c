@@ -1541,6 +1541,133 @@ again:
 	RETURN(rc != 0 ? rc : rc1);
 }
 
+static inline bool lfsck_assistant_shard_empty(struct lfsck_assistant_data *lad,
+					       struct lfsck_assistant_shard *las)
+{
+	bool empty = false;
+
+	spin_lock(&lad->lad_lock);
+	if (list_empty(&las->las_req_list))
+		empty = true;
+	spin_unlock(&lad->lad_lock);
+
+	return empty;
+}
+
+static inline bool lfsck_assistant_worker_exit(struct lfsck_assistant_data *lad,
+					       struct ptlrpc_thread *mthread)
+{
+	return test_bit(LAD_WORKERS_STOP, &lad->lad_flags) ||
+	       test_bit(LAD_EXIT, &lad->lad_flags) ||
+	       !thread_is_running(mthread);
+}
+
+/**
+ * The LFSCK assistant worker handles the phase1 requests queued on its
+ * shard. The requests for the same parent object are always dispatched
+ * to the same worker, so they are still handled in order, but the ones
+ * for different objects can be checked/repaired in parallel.
+ *
+ * The global lad_req_list still contains all the unfinished requests in
+ * the order they were generated by the LFSCK main engine, so the head of
+ * the list is still the position to resume from after checkpoint.
+ */
+int lfsck_assistant_worker(void *args)
+{
+	struct lfsck_thread_args	  *lta	   = args;
+	struct lu_env			  *env	   = &lta->lta_env;
+	struct lfsck_component		  *com     = lta->lta_com;
+	struct lfsck_instance		  *lfsck   = lta->lta_lfsck;
+	struct lfsck_bookmark		  *bk	   = &lfsck->li_bookmark_ram;
+	struct lfsck_assistant_data	  *lad     = com->lc_data;
+	struct lfsck_assistant_shard	  *las     = lta->lta_shard;
+	struct ptlrpc_thread		  *mthread = &lfsck->li_thread;
+	struct ptlrpc_thread		  *athread = &lad->lad_thread;
+	const struct lfsck_assistant_operations *lao     = lad->lad_ops;
+	struct lfsck_assistant_req	  *lar;
+	bool				   used    = false;
+	int				   rc      = 0;
+
+	spin_lock(&lad->lad_lock);
+	las->las_task = current;
+	spin_unlock(&lad->lad_lock);
+
+	while (1) {
+		while (!lfsck_assistant_shard_empty(lad, las)) {
+			bool wakeup = false;
+			bool empty;
+
+			if (unlikely(test_bit(LAD_EXIT, &lad->lad_flags) ||
+				     !thread_is_running(mthread)))
+				GOTO(out, rc = 0);
+
+			/* Only the worker itself can remove the "lar" from
+			 * the head of its shard list, so it is safe to handle
+			 * current "lar" without the spin_lock. */
+			lar = list_entry(las->las_req_list.next,
+					 struct lfsck_assistant_req,
+					 lar_shard_list);
+			rc = lao->la_handler_p1(env, com, lar);
+			spin_lock(&lad->lad_lock);
+			list_del_init(&lar->lar_list);
+			list_del_init(&lar->lar_shard_list);
+			lad->lad_prefetched--;
+			if (lad->lad_prefetched <= (bk->lb_async_windows / 2))
+				wakeup = true;
+			empty = list_empty(&lad->lad_req_list);
+			if (!used) {
+				lad->lad_workers_used++;
+				used = true;
+			}
+			spin_unlock(&lad->lad_lock);
+			if (wakeup)
+				wake_up(&mthread->t_ctl_waitq);
+			if (empty)
+				wake_up(&athread->t_ctl_waitq);
+
+			lao->la_req_fini(env, lar);
+			if (rc < 0 && bk->lb_param & LPF_FAILOUT)
+				GOTO(out, rc);
+		}
+
+		wait_event_idle(las->las_waitq,
+				!lfsck_assistant_shard_empty(lad, las) ||
+				lfsck_assistant_worker_exit(lad, mthread));
+
+		if (lfsck_assistant_worker_exit(lad, mthread) &&
+		    lfsck_assistant_shard_empty(lad, las))
+			GOTO(out, rc = 0);
+	}
+
+out:
+	spin_lock(&lad->lad_lock);
+	if (rc < 0 && lad->lad_worker_status == 0)
+		lad->lad_worker_status = rc;
+	las->las_task = NULL;
+	spin_unlock(&lad->lad_lock);
+
+	CDEBUG(D_LFSCK, "%s: %s LFSCK assistant worker exit: rc = %d\n",
+	       lfsck_lfsck2name(lfsck), lad->lad_name, rc);
+
+	atomic_dec(&lad->lad_workers);
+	wake_up(&athread->t_ctl_waitq);
+	lfsck_thread_args_fini(lta);
+
+	return rc;
+}
+
+static void lfsck_assistant_workers_stop(struct lfsck_assistant_data *lad)
+{
+	int i;
+
+	set_bit(LAD_WORKERS_STOP, &lad->lad_flags);
+	for (i = 0; i < lad->lad_shard_count; i++)
+		wake_up(&lad->lad_shards[i].las_waitq);
+
+	wait_event_idle(lad->lad_thread.t_ctl_waitq,
+			atomic_read(&lad->lad_workers) == 0);
+}
+
 /**
  * The LFSCK assistant thread is triggered by the LFSCK main engine.
  * They co-work together as an asynchronous pipeline: the LFSCK main
@@ -1558,6 +1685,10 @@ again:
  * LFSCK assistant thread. So under such 1:N multiple asynchronous
  * pipelines mode, the whole LFSCK performance will be much better
  * than check/repair everything by the LFSCK main engine itself.
+ *
+ * The phase1 requests are handled by the assistant workers started by
+ * the assistant thread, which drives the phase transitions and the
+ * phase2 scanning by itself.
  */
 int lfsck_assistant_engine(void *args)
 {
@@ -1565,7 +1696,6 @@ int lfsck_assistant_engine(void *args)
 	struct lu_env			  *env	   = &lta->lta_env;
 	struct lfsck_component		  *com     = lta->lta_com;
 	struct lfsck_instance		  *lfsck   = lta->lta_lfsck;
-	struct lfsck_bookmark		  *bk	   = &lfsck->li_bookmark_ram;
 	struct lfsck_position		  *pos     = &com->lc_pos_start;
 	struct lfsck_thread_info	  *info    = lfsck_env_info(env);
 	struct lfsck_request		  *lr      = &info->lti_lr;
@@ -1594,6 +1724,10 @@ int lfsck_assistant_engine(void *args)
 		GOTO(fini, rc);
 	}
 
+	rc = lfsck_assistant_workers_start(com);
+	if (rc != 0)
+		GOTO(fini, rc);
+
 	spin_lock(&lad->lad_lock);
 	lad->lad_task = current;
 	thread_set_flags(athread, SVC_RUNNING);
@@ -1601,49 +1735,22 @@ int lfsck_assistant_engine(void *args)
 	wake_up(&mthread->t_ctl_waitq);
 
 	while (1) {
-		while (!list_empty(&lad->lad_req_list)) {
-			bool wakeup = false;
-
-			if (unlikely(test_bit(LAD_EXIT, &lad->lad_flags) ||
-				     !thread_is_running(mthread)))
-				GOTO(cleanup, rc = lad->lad_post_result);
-
-			lar = list_entry(lad->lad_req_list.next,
-					 struct lfsck_assistant_req,
-					 lar_list);
-			/* Only the lfsck_assistant_engine thread itself can
-			 * remove the "lar" from the head of the list, LFSCK
-			 * engine thread only inserts other new "lar" at the
-			 * end of the list. So it is safe to handle current
-			 * "lar" without the spin_lock. */
-			rc = lao->la_handler_p1(env, com, lar);
-			spin_lock(&lad->lad_lock);
-			list_del_init(&lar->lar_list);
-			lad->lad_prefetched--;
-			/* Wake up the main engine thread only when the list
-			 * is empty or half of the prefetched items have been
-			 * handled to avoid too frequent thread schedule. */
-			if (lad->lad_prefetched <= (bk->lb_async_windows / 2))
-				wakeup = true;
-			spin_unlock(&lad->lad_lock);
-			if (wakeup)
-				wake_up(&mthread->t_ctl_waitq);
-
-			lao->la_req_fini(env, lar);
-			if (rc < 0 && bk->lb_param & LPF_FAILOUT)
-				GOTO(cleanup, rc);
-		}
-
+		/* The phase1 requests are handled by the assistant workers,
+		 * wait for all of them done before going to the next phase. */
 		wait_event_idle(athread->t_ctl_waitq,
-				!lfsck_assistant_req_empty(lad) ||
+				lad->lad_worker_status < 0 ||
 				test_bit(LAD_EXIT, &lad->lad_flags) ||
-				test_bit(LAD_TO_POST, &lad->lad_flags) ||
-				test_bit(LAD_TO_DOUBLE_SCAN, &lad->lad_flags));
+				(lfsck_assistant_req_empty(lad) &&
+				 (test_bit(LAD_TO_POST, &lad->lad_flags) ||
+				  test_bit(LAD_TO_DOUBLE_SCAN, &lad->lad_flags))));
+
+		if (unlikely(lad->lad_worker_status < 0))
+			GOTO(cleanup, rc = lad->lad_worker_status);
 
 		if (unlikely(test_bit(LAD_EXIT, &lad->lad_flags)))
 			GOTO(cleanup, rc = lad->lad_post_result);
 
-		if (!list_empty(&lad->lad_req_list))
+		if (!lfsck_assistant_req_empty(lad))
 			continue;
 
 		if (test_bit(LAD_TO_POST, &lad->lad_flags)) {
@@ -1672,6 +1779,8 @@ int lfsck_assistant_engine(void *args)
 
 		if (test_bit(LAD_TO_DOUBLE_SCAN, &lad->lad_flags)) {
 			clear_bit(LAD_TO_DOUBLE_SCAN, &lad->lad_flags);
+			/* No more phase1 requests. */
+			lfsck_assistant_workers_stop(lad);
 			atomic_inc(&lfsck->li_double_scan_count);
 			set_bit(LAD_IN_DOUBLE_SCAN, &lad->lad_flags);
 			wake_up(&mthread->t_ctl_waitq);
@@ -1741,6 +1850,8 @@ p2_next:
 	}
 
 cleanup:
+	lfsck_assistant_workers_stop(lad);
+
 	/* Cleanup the unfinished requests. */
 	spin_lock(&lad->lad_lock);
 	if (rc < 0)
@@ -1755,6 +1866,7 @@ cleanup:
 				 struct lfsck_assistant_req,
 				 lar_list);
 		list_del_init(&lar->lar_list);
+		list_del_init(&lar->lar_shard_list);
 		lad->lad_prefetched--;
 		spin_unlock(&lad->lad_lock);
 		lao->la_req_fini(env, lar);
@@ -46,6 +46,9 @@
 
 #define LFSCK_CHECKPOINT_INTERVAL	60
 
+/* The max count of the phase1 assistant workers per LFSCK component. */
+#define LFSCK_ASSISTANT_THREADS_MAX	16
+
 enum lfsck_flags {
 	/* Finish the first cycle scanning. */
 	LF_SCANNED_ONCE		= 0x00000001ULL,
@@ -91,8 +94,8 @@ struct lfsck_bookmark {
 	/* The windows size for async requests pipeline. */
 	__u16	lb_async_windows;
 
-	/* For 64-bits aligned. */
-	__u16	lb_padding;
+	/* How many phase1 assistant threads per component, 0 for auto. */
+	__u16	lb_assistant_threads;
 
 	/* The FID for .lustre/lost+found/MDTxxxx */
 	struct lu_fid	lb_lpf_fid;
@@ -772,13 +775,24 @@ struct lfsck_thread_args {
 	struct lfsck_instance		*lta_lfsck;
 	struct lfsck_component		*lta_com;
 	struct lfsck_start_param	*lta_lsp;
+	struct lfsck_assistant_shard	*lta_shard;
 };
 
 struct lfsck_assistant_req {
+	/* link into lfsck_assistant_data::lad_req_list */
 	struct list_head		 lar_list;
+	/* link into lfsck_assistant_shard::las_req_list */
+	struct list_head		 lar_shard_list;
 	struct lfsck_assistant_object	*lar_parent;
 };
 
+/* The phase1 requests queue handled by one assistant worker. */
+struct lfsck_assistant_shard {
+	struct list_head		 las_req_list;
+	wait_queue_head_t		 las_waitq;
+	struct task_struct		*las_task;
+};
+
 struct lfsck_namespace_req {
 	struct lfsck_assistant_req	 lnr_lar;
 	struct lfsck_lmv		*lnr_lmv;
@@ -821,6 +835,11 @@ struct lfsck_assistant_operations {
 	void (*la_sync_failures)(const struct lu_env *env,
 				 struct lfsck_component *com,
 				 struct lfsck_request *lr);
+
+	/* Return the key to dispatch the phase1 request to the assistant
+	 * workers. The requests with the same key are handled in order by
+	 * the same worker. NULL if all requests are handled by one worker. */
+	__u64 (*la_req_key)(struct lfsck_assistant_req *lar);
 };
 
 struct lfsck_assistant_data {
@@ -851,6 +870,18 @@ struct lfsck_assistant_data {
 
 	const struct lfsck_assistant_operations	*lad_ops;
 
+	/* phase1 requests queues, one per assistant worker. */
+	struct lfsck_assistant_shard		 lad_shards[LFSCK_ASSISTANT_THREADS_MAX];
+	int					 lad_shard_count;
+	/* how many assistant workers are running. */
+	atomic_t				 lad_workers;
+	/* the first failure of the assistant workers. */
+	int					 lad_worker_status;
+	/* how many assistant workers handled phase1 requests in this run. */
+	int					 lad_workers_used;
+	/* serialize the repairing and statistics among the workers. */
+	struct mutex				 lad_mutex;
+
 	struct cfs_bitmap				*lad_bitmap;
 
 	__u32					 lad_touch_gen;
@@ -866,6 +897,7 @@ enum {
 	LAD_IN_DOUBLE_SCAN = 2,
 	LAD_EXIT = 3,
 	LAD_INCOMPLETE = 4,
+	LAD_WORKERS_STOP = 5,
 };
 
 #define LFSCK_TMPBUF_LEN	64
@@ -962,6 +994,10 @@ void lfsck_thread_args_fini(struct lfsck_thread_args *lta);
 struct lfsck_assistant_data *
 lfsck_assistant_data_init(const struct lfsck_assistant_operations *lao,
 			  const char *name);
+struct lfsck_assistant_shard *
+lfsck_assistant_req_add(struct lfsck_assistant_data *lad,
+			struct lfsck_assistant_req *lar);
+int lfsck_assistant_workers_start(struct lfsck_component *com);
 struct lfsck_assistant_object *
 lfsck_assistant_object_init(const struct lu_env *env, const struct lu_fid *fid,
 			    const struct lu_attr *attr, __u64 cookie,
@@ -1008,6 +1044,7 @@ int lfsck_open_dir(const struct lu_env *env,
 		   struct lfsck_instance *lfsck, __u64 cookie);
 int lfsck_master_engine(void *args);
 int lfsck_assistant_engine(void *args);
+int lfsck_assistant_worker(void *args);
 
 /* lfsck_bookmark.c */
 void lfsck_bookmark_cpu_to_le(struct lfsck_bookmark *des,
@@ -196,6 +196,7 @@ lfsck_layout_assistant_req_init(struct lfsck_assistant_object *lso,
 		return ERR_PTR(-ENOMEM);
 
 	INIT_LIST_HEAD(&llr->llr_lar.lar_list);
+	INIT_LIST_HEAD(&llr->llr_lar.lar_shard_list);
 	llr->llr_lar.lar_parent = lfsck_assistant_object_get(lso);
 	llr->llr_child = child;
 	llr->llr_comp_id = comp_id;
@@ -5503,8 +5504,8 @@ static int lfsck_layout_scan_stripes(const struct lu_env *env,
 		struct lfsck_layout_req *llr;
 		struct lfsck_tgt_desc	*tgt	= NULL;
 		struct dt_object	*cobj	= NULL;
+		struct lfsck_assistant_shard *las;
 		__u32			 index;
-		bool			 wakeup = false;
 
 		if (unlikely(lovea_slot_is_dummy(objs)))
 			continue;
@@ -5621,14 +5622,10 @@ static int lfsck_layout_scan_stripes(const struct lu_env *env,
 			RETURN(lad->lad_assistant_status);
 		}
 
-		list_add_tail(&llr->llr_lar.lar_list, &lad->lad_req_list);
-		if (lad->lad_prefetched == 0)
-			wakeup = true;
-
-		lad->lad_prefetched++;
+		las = lfsck_assistant_req_add(lad, &llr->llr_lar);
 		spin_unlock(&lad->lad_lock);
-		if (wakeup)
-			wake_up(&athread->t_ctl_waitq);
+		if (las != NULL)
+			wake_up(&las->las_waitq);
 
 next:
 		down_write(&com->lc_sem);
@@ -6096,6 +6093,7 @@ static void lfsck_layout_dump(const struct lu_env *env,
 	struct lfsck_instance	*lfsck = com->lc_lfsck;
 	struct lfsck_bookmark	*bk    = &lfsck->li_bookmark_ram;
 	struct lfsck_layout	*lo    = com->lc_file_ram;
+	struct lfsck_assistant_data *lad = com->lc_data;
 	const char *prefix;
 
 	down_read(&com->lc_sem);
@@ -6138,7 +6136,8 @@ static void lfsck_layout_dump(const struct lu_env *env,
 		   "%s_others: %llu\n"
 		   "skipped: %llu\n"
 		   "failed_phase1: %llu\n"
-		   "failed_phase2: %llu\n",
+		   "failed_phase2: %llu\n"
+		   "assistant_workers: %d\n",
 		   lo->ll_success_count,
 		   prefix, lo->ll_objs_repaired[LLIT_DANGLING - 1],
 		   prefix, lo->ll_objs_repaired[LLIT_UNMATCHED_PAIR - 1],
@@ -6148,7 +6147,8 @@ static void lfsck_layout_dump(const struct lu_env *env,
 		   prefix, lo->ll_objs_repaired[LLIT_OTHERS - 1],
 		   lo->ll_objs_skipped,
 		   lo->ll_objs_failed_phase1,
-		   lo->ll_objs_failed_phase2);
+		   lo->ll_objs_failed_phase2,
+		   lad->lad_workers_used);
 
 	if (lo->ll_status == LS_SCANNING_PHASE1) {
 		time64_t duration = ktime_get_seconds() -
@@ -6911,6 +6911,13 @@ static void lfsck_layout_assistant_fill_pos(const struct lu_env *env,
 	pos->lp_oit_cookie = llr->llr_lar.lar_parent->lso_oit_cookie - 1;
 }
 
+/* Dispatch the requests by the parent, so the stripes of the same file
+ * are checked in order by the same assistant worker. */
+static __u64 lfsck_layout_assistant_req_key(struct lfsck_assistant_req *lar)
+{
+	return fid_flatten(&lar->lar_parent->lso_fid);
+}
+
 const struct lfsck_assistant_operations lfsck_layout_assistant_ops = {
 	.la_handler_p1		= lfsck_layout_assistant_handler_p1,
 	.la_handler_p2		= lfsck_layout_assistant_handler_p2,
@@ -6918,6 +6925,7 @@ const struct lfsck_assistant_operations lfsck_layout_assistant_ops = {
 	.la_double_scan_result	= lfsck_layout_double_scan_result,
 	.la_req_fini		= lfsck_layout_assistant_req_fini,
 	.la_sync_failures	= lfsck_layout_assistant_sync_failures,
+	.la_req_key		= lfsck_layout_assistant_req_key,
 };
 
 int lfsck_layout_setup(const struct lu_env *env, struct lfsck_instance *lfsck)
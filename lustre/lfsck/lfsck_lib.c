@@ -1960,6 +1960,7 @@ lfsck_assistant_data_init(const struct lfsck_assistant_operations *lao,
 			  const char *name)
 {
 	struct lfsck_assistant_data *lad;
+	int i;
 
 	OBD_ALLOC_PTR(lad);
 	if (lad != NULL) {
@@ -1978,6 +1979,12 @@ lfsck_assistant_data_init(const struct lfsck_assistant_operations *lao,
 		INIT_LIST_HEAD(&lad->lad_mdt_phase1_list);
 		INIT_LIST_HEAD(&lad->lad_mdt_phase2_list);
 		init_waitqueue_head(&lad->lad_thread.t_ctl_waitq);
+		for (i = 0; i < LFSCK_ASSISTANT_THREADS_MAX; i++) {
+			INIT_LIST_HEAD(&lad->lad_shards[i].las_req_list);
+			init_waitqueue_head(&lad->lad_shards[i].las_waitq);
+		}
+		atomic_set(&lad->lad_workers, 0);
+		mutex_init(&lad->lad_mutex);
 		lad->lad_ops = lao;
 		lad->lad_name = name;
 	}
@@ -1985,6 +1992,119 @@ lfsck_assistant_data_init(const struct lfsck_assistant_operations *lao,
 	return lad;
 }
 
+/**
+ * Queue the phase1 request for the LFSCK assistant workers.
+ *
+ * The caller must hold lad_lock.
+ *
+ * \retval	the shard to be woken up after lad_lock released
+ * \retval	NULL if the shard's worker is busy with former requests
+ */
+struct lfsck_assistant_shard *
+lfsck_assistant_req_add(struct lfsck_assistant_data *lad,
+			struct lfsck_assistant_req *lar)
+{
+	struct lfsck_assistant_shard *las = &lad->lad_shards[0];
+	bool wakeup;
+
+	if (lad->lad_shard_count > 1)
+		las += hash_64(lad->lad_ops->la_req_key(lar), 32) %
+		       lad->lad_shard_count;
+
+	wakeup = list_empty(&las->las_req_list);
+	list_add_tail(&lar->lar_list, &lad->lad_req_list);
+	list_add_tail(&lar->lar_shard_list, &las->las_req_list);
+	lad->lad_prefetched++;
+
+	return wakeup ? las : NULL;
+}
+
+/* Interrupt the LFSCK assistant thread and its workers for stopping. */
+static void lfsck_assistant_force_sig(struct lfsck_assistant_data *lad)
+{
+	int i;
+
+	spin_lock(&lad->lad_lock);
+	if (lad->lad_task != NULL)
+		cfs_force_sig(SIGINT, lad->lad_task);
+	for (i = 0; i < lad->lad_shard_count; i++) {
+		if (lad->lad_shards[i].las_task != NULL)
+			cfs_force_sig(SIGINT, lad->lad_shards[i].las_task);
+		wake_up(&lad->lad_shards[i].las_waitq);
+	}
+	spin_unlock(&lad->lad_lock);
+}
+
+static int lfsck_assistant_threads(struct lfsck_instance *lfsck,
+				   struct lfsck_assistant_data *lad)
+{
+	int threads = lfsck->li_bookmark_ram.lb_assistant_threads;
+
+	if (lad->lad_ops->la_req_key == NULL)
+		return 1;
+
+	/* Scale with the CPUs by default, the other half is left for the
+	 * LFSCK main engine and the OSD/RPC handling of the repairing. */
+	if (threads == 0)
+		threads = num_online_cpus() / 2;
+
+	return clamp(threads, 1, LFSCK_ASSISTANT_THREADS_MAX);
+}
+
+/**
+ * Start the phase1 assistant workers for the LFSCK component.
+ *
+ * Called by the LFSCK assistant thread before the main engine begins to
+ * generate the phase1 requests. If some workers cannot be started, then
+ * the requests are dispatched among the started ones.
+ */
+int lfsck_assistant_workers_start(struct lfsck_component *com)
+{
+	struct lfsck_instance		*lfsck = com->lc_lfsck;
+	struct lfsck_assistant_data	*lad   = com->lc_data;
+	struct lfsck_assistant_shard	*las;
+	struct lfsck_thread_args	*lta;
+	struct task_struct		*task;
+	int				 count;
+	int				 rc    = 0;
+	int				 i;
+
+	count = lfsck_assistant_threads(lfsck, lad);
+	lad->lad_worker_status = 0;
+	lad->lad_workers_used = 0;
+	for (i = 0; i < count; i++) {
+		las = &lad->lad_shards[i];
+		lta = lfsck_thread_args_init(lfsck, com, NULL);
+		if (IS_ERR(lta)) {
+			rc = PTR_ERR(lta);
+			break;
+		}
+
+		lta->lta_shard = las;
+		atomic_inc(&lad->lad_workers);
+		task = kthread_run(lfsck_assistant_worker, lta, "%s_%02d",
+				   lad->lad_name, i);
+		if (IS_ERR(task)) {
+			rc = PTR_ERR(task);
+			atomic_dec(&lad->lad_workers);
+			lfsck_thread_args_fini(lta);
+			break;
+		}
+	}
+
+	if (i == 0) {
+		CERROR("%s: cannot start LFSCK assistant worker for %s: "
+		       "rc = %d\n", lfsck_lfsck2name(lfsck), lad->lad_name, rc);
+		return rc;
+	}
+
+	lad->lad_shard_count = i;
+	CDEBUG(D_LFSCK, "%s: started %d LFSCK assistant workers for %s: "
+	       "rc = %d\n", lfsck_lfsck2name(lfsck), i, lad->lad_name, rc);
+
+	return 0;
+}
+
 struct lfsck_assistant_object *
 lfsck_assistant_object_init(const struct lu_env *env, const struct lu_fid *fid,
 			    const struct lu_attr *attr, __u64 cookie,
@@ -2868,6 +2988,69 @@ int lfsck_set_windows(struct dt_device *key, unsigned int val)
 }
 EXPORT_SYMBOL(lfsck_set_windows);
 
+int lfsck_get_threads(char *buf, struct dt_device *key)
+{
+	struct lu_env		env;
+	struct lfsck_instance  *lfsck;
+	int			rc;
+	ENTRY;
+
+	rc = lu_env_init(&env, LCT_MD_THREAD | LCT_DT_THREAD);
+	if (rc != 0)
+		RETURN(rc);
+
+	lfsck = lfsck_instance_find(key, true, false);
+	if (likely(lfsck != NULL)) {
+		rc = sprintf(buf, "%u\n",
+			     lfsck->li_bookmark_ram.lb_assistant_threads);
+		lfsck_instance_put(&env, lfsck);
+	} else {
+		rc = -ENXIO;
+	}
+
+	lu_env_fini(&env);
+
+	RETURN(rc);
+}
+EXPORT_SYMBOL(lfsck_get_threads);
+
+int lfsck_set_threads(struct dt_device *key, unsigned int val)
+{
+	struct lu_env		env;
+	struct lfsck_instance  *lfsck;
+	int			rc;
+	ENTRY;
+
+	rc = lu_env_init(&env, LCT_MD_THREAD | LCT_DT_THREAD);
+	if (rc != 0)
+		RETURN(rc);
+
+	lfsck = lfsck_instance_find(key, true, false);
+	if (likely(lfsck != NULL)) {
+		if (val > LFSCK_ASSISTANT_THREADS_MAX) {
+			CWARN("%s: invalid assistant threads count. The valid "
+			      "range is [0 - %u], 0 for auto.\n",
+			      lfsck_lfsck2name(lfsck),
+			      LFSCK_ASSISTANT_THREADS_MAX);
+			rc = -EINVAL;
+		} else if (lfsck->li_bookmark_ram.lb_assistant_threads != val) {
+			/* Take effect since next LFSCK run. */
+			mutex_lock(&lfsck->li_mutex);
+			lfsck->li_bookmark_ram.lb_assistant_threads = val;
+			rc = lfsck_bookmark_store(&env, lfsck);
+			mutex_unlock(&lfsck->li_mutex);
+		}
+		lfsck_instance_put(&env, lfsck);
+	} else {
+		rc = -ENXIO;
+	}
+
+	lu_env_fini(&env);
+
+	RETURN(rc);
+}
+EXPORT_SYMBOL(lfsck_set_threads);
+
 int lfsck_dump(struct seq_file *m, struct dt_device *key, enum lfsck_type type)
 {
 	struct lu_env		env;
@@ -3418,18 +3601,12 @@ int lfsck_stop(const struct lu_env *env, struct dt_device *key,
 
 		list_for_each_entry(com, &lfsck->li_list_scan, lc_link) {
 			lad = com->lc_data;
-			spin_lock(&lad->lad_lock);
-			if (lad->lad_task != NULL)
-				cfs_force_sig(SIGINT, lad->lad_task);
-			spin_unlock(&lad->lad_lock);
+			lfsck_assistant_force_sig(lad);
 		}
 
 		list_for_each_entry(com, &lfsck->li_list_double_scan, lc_link) {
 			lad = com->lc_data;
-			spin_lock(&lad->lad_lock);
-			if (lad->lad_task != NULL)
-				cfs_force_sig(SIGINT, lad->lad_task);
-			spin_unlock(&lad->lad_lock);
+			lfsck_assistant_force_sig(lad);
 		}
 	}
 
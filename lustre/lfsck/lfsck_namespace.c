@@ -70,6 +70,7 @@ lfsck_namespace_assistant_req_init(struct lfsck_instance *lfsck,
 		return ERR_PTR(-ENOMEM);
 
 	INIT_LIST_HEAD(&lnr->lnr_lar.lar_list);
+	INIT_LIST_HEAD(&lnr->lnr_lar.lar_shard_list);
 	lnr->lnr_lar.lar_parent = lfsck_assistant_object_get(lso);
 	lnr->lnr_lmv = lfsck_lmv_get(lfsck->li_lmv);
 	lnr->lnr_fid = ent->lde_fid;
@@ -4309,10 +4310,10 @@ static void lfsck_namespace_close_dir(const struct lu_env *env,
 	struct lfsck_instance		*lfsck	= com->lc_lfsck;
 	struct lfsck_lmv		*llmv	= lfsck->li_lmv;
 	struct lfsck_namespace_req	*lnr;
+	struct lfsck_assistant_shard	*las;
 	struct lu_attr *la = &lfsck_env_info(env)->lti_la2;
 	__u32 size = sizeof(*lnr) + LFSCK_TMPBUF_LEN;
 	int rc;
-	bool wakeup = false;
 	ENTRY;
 
 	if (llmv == NULL)
@@ -4341,6 +4342,7 @@ static void lfsck_namespace_close_dir(const struct lu_env *env,
 	/* Generate a dummy request to indicate that all shards' name entry
 	 * in this striped directory has been scanned for the first time. */
 	INIT_LIST_HEAD(&lnr->lnr_lar.lar_list);
+	INIT_LIST_HEAD(&lnr->lnr_lar.lar_shard_list);
 	lnr->lnr_lar.lar_parent = lso;
 	lnr->lnr_lmv = lfsck_lmv_get(llmv);
 	lnr->lnr_fid = *lfsck_dto2fid(lfsck->li_obj_dir);
@@ -4359,14 +4361,10 @@ static void lfsck_namespace_close_dir(const struct lu_env *env,
 		RETURN_EXIT;
 	}
 
-	list_add_tail(&lnr->lnr_lar.lar_list, &lad->lad_req_list);
-	if (lad->lad_prefetched == 0)
-		wakeup = true;
-
-	lad->lad_prefetched++;
+	las = lfsck_assistant_req_add(lad, &lnr->lnr_lar);
 	spin_unlock(&lad->lad_lock);
-	if (wakeup)
-		wake_up(&lad->lad_thread.t_ctl_waitq);
+	if (las != NULL)
+		wake_up(&las->las_waitq);
 
 	EXIT;
 }
@@ -4673,7 +4671,7 @@ static int lfsck_namespace_exec_dir(const struct lu_env *env,
 	struct lfsck_bookmark		*bk	 = &lfsck->li_bookmark_ram;
 	struct ptlrpc_thread		*mthread = &lfsck->li_thread;
 	struct ptlrpc_thread		*athread = &lad->lad_thread;
-	bool				 wakeup	 = false;
+	struct lfsck_assistant_shard	*las;
 
 	wait_event_idle(mthread->t_ctl_waitq,
 			lad->lad_prefetched < bk->lb_async_windows ||
@@ -4704,14 +4702,10 @@ static int lfsck_namespace_exec_dir(const struct lu_env *env,
 		return lad->lad_assistant_status;
 	}
 
-	list_add_tail(&lnr->lnr_lar.lar_list, &lad->lad_req_list);
-	if (lad->lad_prefetched == 0)
-		wakeup = true;
-
-	lad->lad_prefetched++;
+	las = lfsck_assistant_req_add(lad, &lnr->lnr_lar);
 	spin_unlock(&lad->lad_lock);
-	if (wakeup)
-		wake_up(&lad->lad_thread.t_ctl_waitq);
+	if (las != NULL)
+		wake_up(&las->las_waitq);
 
 	down_write(&com->lc_sem);
 	com->lc_new_checked++;
@@ -4783,6 +4777,7 @@ lfsck_namespace_dump(const struct lu_env *env, struct lfsck_component *com,
 	struct lfsck_instance	*lfsck = com->lc_lfsck;
 	struct lfsck_bookmark	*bk    = &lfsck->li_bookmark_ram;
 	struct lfsck_namespace	*ns    = com->lc_file_ram;
+	struct lfsck_assistant_data *lad = com->lc_data;
 
 	down_read(&com->lc_sem);
 	seq_printf(m, "name: lfsck_namespace\n"
@@ -4811,6 +4806,8 @@ lfsck_namespace_dump(const struct lu_env *env, struct lfsck_component *com,
 	lfsck_pos_dump(m, &ns->ln_pos_first_inconsistent,
 		       "first_failure_position");
 
+	seq_printf(m, "assistant_workers: %d\n", lad->lad_workers_used);
+
 	if (ns->ln_status == LS_SCANNING_PHASE1) {
 		struct lfsck_position pos;
 		time64_t duration = ktime_get_seconds() -
@@ -5589,23 +5586,31 @@ static int lfsck_namespace_assistant_handler_p1(const struct lu_env *env,
 	bool			    log      = false;
 	bool			    bad_hash = false;
 	bool			    bad_linkea = false;
+	bool			    linkea_repaired = false;
 	int			    idx      = 0;
 	int			    count    = 0;
 	int			    rc	     = 0;
+	__u32			    flags    = 0;
 	enum lfsck_namespace_inconsistency_type type = LNIT_NONE;
 	ENTRY;
 
 	if (lso->lso_dead)
 		RETURN(0);
 
+	/* The name entries under different directories may be handled by
+	 * several assistant workers in parallel. The statistics and repairing
+	 * are serialized by lad_mutex, which must not be taken with the ibits
+	 * lock or transaction held, so the flags found under them are applied
+	 * to the statistics at the end. */
 	la->la_nlink = 0;
-	if (lnr->lnr_attr & LUDA_UPGRADE) {
-		ns->ln_flags |= LF_UPGRADE;
-		ns->ln_dirent_repaired++;
-		repaired = true;
-	} else if (lnr->lnr_attr & LUDA_REPAIR) {
-		ns->ln_flags |= LF_INCONSISTENT;
+	if (lnr->lnr_attr & (LUDA_UPGRADE | LUDA_REPAIR)) {
+		mutex_lock(&lad->lad_mutex);
+		if (lnr->lnr_attr & LUDA_UPGRADE)
+			ns->ln_flags |= LF_UPGRADE;
+		else
+			ns->ln_flags |= LF_INCONSISTENT;
 		ns->ln_dirent_repaired++;
+		mutex_unlock(&lad->lad_mutex);
 		repaired = true;
 	}
 
@@ -5636,7 +5641,9 @@ static int lfsck_namespace_assistant_handler_p1(const struct lu_env *env,
 	}
 
 	if (unlikely(lnr->lnr_dir_cookie == MDS_DIR_END_OFF)) {
+		mutex_lock(&lad->lad_mutex);
 		rc = lfsck_namespace_striped_dir_rescan(env, com, lnr);
+		mutex_unlock(&lad->lad_mutex);
 
 		RETURN(rc);
 	}
@@ -5645,7 +5652,9 @@ static int lfsck_namespace_assistant_handler_p1(const struct lu_env *env,
 		GOTO(out, rc = 0);
 
 	if (lnr->lnr_lmv != NULL && lnr->lnr_lmv->ll_lmv_master) {
+		mutex_lock(&lad->lad_mutex);
 		rc = lfsck_namespace_handle_striped_master(env, com, lnr);
+		mutex_unlock(&lad->lad_mutex);
 
 		RETURN(rc);
 	}
@@ -5677,7 +5686,9 @@ static int lfsck_namespace_assistant_handler_p1(const struct lu_env *env,
 			CDEBUG(D_LFSCK, "%s: cannot talk with MDT %x which "
 			       "did not join the namespace LFSCK\n",
 			       lfsck_lfsck2name(lfsck), idx);
+			mutex_lock(&lad->lad_mutex);
 			lfsck_lad_set_bitmap(env, com, idx);
+			mutex_unlock(&lad->lad_mutex);
 
 			GOTO(out, rc = -ENODEV);
 		}
@@ -5697,6 +5708,7 @@ dangling:
 			dir = lfsck_assistant_object_load(env, lfsck, lso);
 			if (IS_ERR(dir)) {
 				rc = PTR_ERR(dir);
+				mutex_lock(&lad->lad_mutex);
 
 				GOTO(trace, rc == -ENOENT ? 0 : rc);
 			}
@@ -5712,8 +5724,10 @@ dangling:
 			}
 
 			type = LNIT_DANGLING;
+			mutex_lock(&lad->lad_mutex);
 			rc = lfsck_namespace_repair_dangling(env, com, dir,
 							     obj, lnr);
+			mutex_unlock(&lad->lad_mutex);
 			if (rc == 0)
 				repaired = true;
 		}
@@ -5768,7 +5782,7 @@ again:
 		    (count == 1 || !S_ISDIR(lfsck_object_type(obj)))) {
 			if ((lfsck_object_type(obj) & S_IFMT) !=
 			    lnr->lnr_type) {
-				ns->ln_flags |= LF_INCONSISTENT;
+				flags |= LF_INCONSISTENT;
 				type = LNIT_BAD_TYPE;
 			}
 
@@ -5780,7 +5794,7 @@ again:
 		 * it is quite possible that name entry is corrupted. */
 		if (!lfsck_is_valid_slave_name_entry(env, lnr->lnr_lmv,
 					lnr->lnr_name, lnr->lnr_namelen)) {
-			ns->ln_flags |= LF_INCONSISTENT;
+			flags |= LF_INCONSISTENT;
 			type = LNIT_BAD_DIRENT;
 
 			GOTO(stop, rc = 0);
@@ -5791,7 +5805,7 @@ again:
 		 * not recognize the name entry, then it is quite possible
 		 * that the name entry is corrupted. */
 		if ((lfsck_object_type(obj) & S_IFMT) != lnr->lnr_type) {
-			ns->ln_flags |= LF_INCONSISTENT;
+			flags |= LF_INCONSISTENT;
 			type = LNIT_BAD_DIRENT;
 
 			GOTO(stop, rc = 0);
@@ -5841,10 +5855,10 @@ nodata:
 
 		if (bk->lb_param & LPF_DRYRUN) {
 			if (rc == -ENODATA)
-				ns->ln_flags |= LF_UPGRADE;
+				flags |= LF_UPGRADE;
 			else
-				ns->ln_flags |= LF_INCONSISTENT;
-			ns->ln_linkea_repaired++;
+				flags |= LF_INCONSISTENT;
+			linkea_repaired = true;
 			repaired = true;
 			log = true;
 			goto stop;
@@ -5875,9 +5889,9 @@ nodata:
 
 		bad_linkea = true;
 		if (!remove && newdata)
-			ns->ln_flags |= LF_UPGRADE;
-		else if (remove || !(ns->ln_flags & LF_UPGRADE))
-			ns->ln_flags |= LF_INCONSISTENT;
+			flags |= LF_UPGRADE;
+		else if (remove || !((ns->ln_flags | flags) & LF_UPGRADE))
+			flags |= LF_INCONSISTENT;
 
 		if (remove) {
 			LASSERT(newdata);
@@ -5903,7 +5917,7 @@ nodata:
 		count = ldata.ld_leh->leh_reccount;
 		if (!S_ISDIR(lfsck_object_type(obj)) ||
 		    !dt_object_remote(obj)) {
-			ns->ln_linkea_repaired++;
+			linkea_repaired = true;
 			repaired = true;
 			log = true;
 		}
@@ -5920,6 +5934,7 @@ stop:
 
 out:
 	lfsck_ibits_unlock(&lh, LCK_EX);
+	mutex_lock(&lad->lad_mutex);
 
 	if (!name_is_dot_or_dotdot(lnr->lnr_name, lnr->lnr_namelen) &&
 	    !lfsck_is_valid_slave_name_entry(env, lnr->lnr_lmv,
@@ -5996,6 +6011,9 @@ out:
 
 trace:
 	down_write(&com->lc_sem);
+	ns->ln_flags |= flags;
+	if (linkea_repaired)
+		ns->ln_linkea_repaired++;
 	if (rc < 0) {
 		CDEBUG(D_LFSCK, "%s: namespace LFSCK assistant fail to handle "
 		       "the entry: "DFID", parent "DFID", name %.*s: rc = %d\n",
@@ -6073,6 +6091,7 @@ trace:
 		ns->ln_mul_linked_checked++;
 
 	up_write(&com->lc_sem);
+	mutex_unlock(&lad->lad_mutex);
 
 	if (obj != NULL && !IS_ERR(obj))
 		lfsck_object_put(env, obj);
@@ -6520,6 +6539,7 @@ out:
 	lar = list_entry(lad->lad_req_list.next, struct lfsck_assistant_req,
 			  lar_list);
 	list_del_init(&lar->lar_list);
+	list_del_init(&lar->lar_shard_list);
 	spin_unlock(&lad->lad_lock);
 
 	rc = lfsck_namespace_assistant_handler_p1(env, com, lar);
@@ -6859,6 +6879,14 @@ out:
 	EXIT;
 }
 
+/* Dispatch the requests by the directory, so the name entries under the
+ * same directory and the dummy request generated by close_dir() for the
+ * striped directory are handled in order by the same assistant worker. */
+static __u64 lfsck_namespace_assistant_req_key(struct lfsck_assistant_req *lar)
+{
+	return fid_flatten(&lar->lar_parent->lso_fid);
+}
+
 const struct lfsck_assistant_operations lfsck_namespace_assistant_ops = {
 	.la_handler_p1		= lfsck_namespace_assistant_handler_p1,
 	.la_handler_p2		= lfsck_namespace_assistant_handler_p2,
@@ -6866,6 +6894,7 @@ const struct lfsck_assistant_operations lfsck_namespace_assistant_ops = {
 	.la_double_scan_result	= lfsck_namespace_double_scan_result,
 	.la_req_fini		= lfsck_namespace_assistant_req_fini,
 	.la_sync_failures	= lfsck_namespace_assistant_sync_failures,
+	.la_req_key		= lfsck_namespace_assistant_req_key,
 };
 
 /**
@@ -1361,6 +1361,56 @@ free_lfa:
 	RETURN(rc);
 }
 
+/* Scan one directory on its MDT with lfs find predicates, see lu_find_scan */
+static int ll_dir_find_scan(struct inode *inode, void __user *arg)
+{
+	const struct lu_find_scan __user *ulfs = arg;
+	struct lu_find_scan *lfs;
+	__u32 buflen;
+	size_t size;
+	int rc;
+
+	ENTRY;
+
+	if (!capable(CAP_DAC_READ_SEARCH) &&
+	    !test_bit(LL_SBI_USER_FID2PATH, ll_i2sbi(inode)->ll_flags))
+		RETURN(-EPERM);
+
+	/* each stripe is a separate directory on its own MDT */
+	if (ll_dir_striped(inode))
+		RETURN(-EOPNOTSUPP);
+
+	if (get_user(buflen, &ulfs->lfs_buflen))
+		RETURN(-EFAULT);
+	if (buflen > LU_FIND_SCAN_MAX_BUF)
+		RETURN(-EINVAL);
+
+	size = sizeof(*lfs) + buflen;
+	OBD_ALLOC_LARGE(lfs, size);
+	if (!lfs)
+		RETURN(-ENOMEM);
+
+	if (copy_from_user(lfs, arg, sizeof(*lfs)))
+		GOTO(out, rc = -EFAULT);
+	lfs->lfs_fid = *ll_inode2fid(inode);
+	lfs->lfs_buflen = buflen;
+	/* let the MDT confine the scan to the fileset of this mount */
+	lfs->lfs_root_fid = ll_i2sbi(inode)->ll_root_fid;
+
+	/* Call mdc_iocontrol */
+	rc = obd_iocontrol(LL_IOC_FIND_SCAN, ll_i2mdexp(inode), size, lfs,
+			   NULL);
+	if (rc)
+		GOTO(out, rc);
+
+	if (copy_to_user(arg, lfs, sizeof(*lfs) + lfs->lfs_buflen))
+		rc = -EFAULT;
+out:
+	OBD_FREE_LARGE(lfs, size);
+
+	RETURN(rc);
+}
+
 /* This function tries to get a single name component,
  * to send to the server. No actual path traversal involved,
  * so we limit to NAME_MAX */
@@ -1744,6 +1794,8 @@ out_rmdir:
 	}
 	case LL_IOC_RMFID:
 		RETURN(ll_rmfid(file, (void __user *)arg));
+	case LL_IOC_FIND_SCAN:
+		RETURN(ll_dir_find_scan(inode, (void __user *)arg));
 	case LL_IOC_LOV_SWAP_LAYOUTS:
 		RETURN(-EPERM);
 	case IOC_OBD_STATFS:
@@ -3319,6 +3319,7 @@ static int ll_ladvise_sanity(struct inode *inode,
 		/* fallthrough */
 	case LU_LADVISE_WILLREAD:
 	case LU_LADVISE_DONTNEED:
+	case LU_LADVISE_WILLWRITE:
 	default:
 		/* Note fall through above - These checks apply to all advices
 		 * except LOCKNOEXPAND */
@@ -275,6 +275,13 @@ struct lod_recovery_data {
 	struct completion	*lrd_started;
 };
 
+/*
+ * Update records are sorted by batchid when they are added to the replay
+ * list, so plain update llogs can be read by several threads at once, with
+ * the next llogs opened ahead of time
+ */
+#define LOD_RECOVERY_LLOG_THREADS	4
+#define LOD_RECOVERY_LLOG_PREFETCH	4
 
 /**
  * process update recovery record
@@ -392,8 +399,11 @@ again:
 		LASSERT(ctxt != NULL);
 		LASSERT(ctxt->loc_handle != NULL);
 
-		rc = llog_cat_process(env, ctxt->loc_handle,
-				      lod_process_recovery_updates, lrd, 0, 0);
+		rc = llog_cat_process_parallel(env, ctxt->loc_handle,
+					       lod_process_recovery_updates,
+					       lrd, LOD_RECOVERY_LLOG_THREADS,
+					       LOD_RECOVERY_LLOG_PREFETCH,
+					       false);
 	}
 
 	if (rc < 0) {
@@ -1813,6 +1823,7 @@ static int lod_init0(const struct lu_env *env, struct lod_device *lod,
 
 	spin_lock_init(&lod->lod_lock);
 	spin_lock_init(&lod->lod_connects_lock);
+	atomic_set(&lod->lod_qos_busy_skipped, 0);
 	lu_tgt_descs_init(&lod->lod_mdt_descs, true);
 	lu_tgt_descs_init(&lod->lod_ost_descs, false);
 	lu_qos_rr_init(&lod->lod_mdt_descs.ltd_qos.lq_rr);
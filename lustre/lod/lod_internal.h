@@ -153,6 +153,9 @@ struct lod_device {
 	struct proc_dir_entry *lod_symlink;
 	struct dentry	       *lod_debugfs;
 
+	/* OSTs skipped by round-robin allocation because they were busy */
+	atomic_t		lod_qos_busy_skipped;
+
 	/* ROOT object, used to fetch FS default striping */
 	struct lod_object      *lod_md_root;
 };
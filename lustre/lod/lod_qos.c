@@ -115,6 +115,11 @@ static int lod_statfs_and_check(const struct lu_env *env, struct lod_device *d,
 		CERROR("%s: statfs: rc = %d\n", lod2obd(d)->obd_name, rc);
 
 	if (!rc) {
+		/* applied to the weight by lu_tgt_qos_weight_calc() */
+		tgt->ltd_qos.ltq_load_cut =
+			min_t(__u32, tgt->ltd_statfs.os_load, 100) *
+			ltd->ltd_qos.lq_prio_load / 100;
+
 		rc = lod_statfs_check(ltd, tgt);
 		if (rc == -ENOSPC)
 			return rc;
@@ -657,6 +662,17 @@ static int lod_check_and_reserve_ost(const struct lu_env *env,
 		RETURN(rc);
 	}
 
+	/*
+	 * try to use another OSP if this one is busy with other jobs
+	 */
+	if (speed == 0 && lod->lod_ost_descs.ltd_qos.lq_prio_load &&
+	    ost->ltd_statfs.os_load >= LOV_QOS_LOAD_BUSY) {
+		QOS_DEBUG("#%d: busy, load %u%%\n", ost_idx,
+			  ost->ltd_statfs.os_load);
+		atomic_inc(&lod->lod_qos_busy_skipped);
+		RETURN(rc);
+	}
+
 	/*
 	 * try not allocate on OST which has been used by other
 	 * component
@@ -1505,6 +1521,8 @@ static int lod_ost_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 		ost->ltd_qos.ltq_usable = 1;
 		lu_tgt_qos_weight_calc(ost);
 		total_weight += ost->ltd_qos.ltq_weight;
+		QOS_DEBUG("#%d: load %u%% weight %llu\n", osts->op_array[i],
+			  ost->ltd_statfs.os_load, ost->ltd_qos.ltq_weight);
 
 		good_osts++;
 	}
@@ -599,6 +599,66 @@ static ssize_t qos_prio_free_store(struct kobject *kobj, struct attribute *attr,
 LUSTRE_RW_ATTR(mdt_qos_prio_free);
 LUSTRE_RW_ATTR(qos_prio_free);
 
+/**
+ * Show QoS load priority parameter.
+ *
+ * The printed value is a percentage value (0-100%) indicating how much the
+ * short-term load reported by an OST reduces its chance to get new objects.
+ * 0% ignores the OST load, 100% stops allocating on fully loaded OSTs
+ * as long as other OSTs can be used.
+ */
+static ssize_t qos_prio_load_show(struct kobject *kobj,
+				  struct attribute *attr, char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct lod_device *lod = dt2lod_dev(dt);
+
+	return scnprintf(buf, PAGE_SIZE, "%d%%\n",
+			 (lod->lod_ost_descs.ltd_qos.lq_prio_load * 100 +
+			  255) >> 8);
+}
+
+/**
+ * Set QoS load priority parameter.
+ *
+ * See qos_prio_load_show() for description of this parameter. The new value
+ * is used from the next statfs update of each OST.
+ */
+static ssize_t qos_prio_load_store(struct kobject *kobj,
+				   struct attribute *attr,
+				   const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct lod_device *lod = dt2lod_dev(dt);
+	char buf[6], *tmp;
+	unsigned int val;
+	int rc;
+
+	/* "100%\n\0" should be largest string */
+	if (count >= sizeof(buf))
+		return -ERANGE;
+
+	strncpy(buf, buffer, sizeof(buf));
+	buf[sizeof(buf) - 1] = '\0';
+	tmp = strchr(buf, '%');
+	if (tmp)
+		*tmp = '\0';
+
+	rc = kstrtouint(buf, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > 100)
+		return -EINVAL;
+
+	lod->lod_ost_descs.ltd_qos.lq_prio_load = (val << 8) / 100;
+
+	return count;
+}
+LUSTRE_RW_ATTR(qos_prio_load);
+
 /**
  * Show threshold for "same space on all OSTs" rule.
  */
@@ -1162,6 +1222,41 @@ struct lprocfs_vars lprocfs_lod_spill_vars[] = {
 	{ NULL }
 };
 
+/**
+ * Show the load reported by each OST and its effect on object allocation.
+ *
+ * For each OST the load from the last statfs, the resulting weight cut
+ * (out of 256) and the current QoS weight and penalty are printed.
+ */
+static int lod_qos_ost_load_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *obd = m->private;
+	struct lod_device *lod = lu2lod_dev(obd->obd_lu_dev);
+	struct lu_tgt_descs *ltd = &lod->lod_ost_descs;
+	struct lu_tgt_desc *tgt;
+
+	seq_printf(m, "prio_load: %u%%\nbusy_skipped: %d\n",
+		   (ltd->ltd_qos.lq_prio_load * 100 + 255) >> 8,
+		   atomic_read(&lod->lod_qos_busy_skipped));
+
+	lod_getref(ltd);
+	ltd_foreach_tgt(ltd, tgt) {
+		struct lu_tgt_qos *ltq = &tgt->ltd_qos;
+
+		seq_printf(m, "%d: %s load: %u%% cut: %u weight: %llu penalty: %llu%s%s\n",
+			   tgt->ltd_index, obd_uuid2str(&tgt->ltd_uuid),
+			   tgt->ltd_statfs.os_load, ltq->ltq_load_cut,
+			   ltq->ltq_weight, ltq->ltq_penalty,
+			   tgt->ltd_active ? "" : " INACTIVE",
+			   tgt->ltd_statfs.os_state & OS_STATFS_DEGRADED ?
+			   " DEGRADED" : "");
+	}
+	lod_putref(lod, ltd);
+
+	return 0;
+}
+LDEBUGFS_SEQ_FOPS_RO(lod_qos_ost_load);
+
 static struct proc_ops lod_proc_target_fops = {
 	PROC_OWNER(THIS_MODULE)
 	.proc_open	= lod_osts_seq_open,
@@ -1185,6 +1280,7 @@ static struct attribute *lod_attrs[] = {
 	&lustre_attr_numobd.attr,
 	&lustre_attr_qos_maxage.attr,
 	&lustre_attr_qos_prio_free.attr,
+	&lustre_attr_qos_prio_load.attr,
 	&lustre_attr_qos_threshold_rr.attr,
 	&lustre_attr_mdt_stripecount.attr,
 	&lustre_attr_mdt_stripetype.attr,
@@ -1284,6 +1380,8 @@ int lod_procfs_init(struct lod_device *lod)
 
 	obd->obd_debugfs_entry = debugfs_create_dir(obd->obd_name,
 						    obd->obd_type->typ_debugfs_entry);
+	debugfs_create_file("qos_ost_load", 0444, obd->obd_debugfs_entry, obd,
+			    &lod_qos_ost_load_fops);
 
 	lod->lod_debugfs = ldebugfs_add_symlink(obd->obd_name, "lov",
 						"../lod/%s", obd->obd_name);
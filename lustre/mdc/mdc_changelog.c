@@ -95,9 +95,15 @@ struct chlg_reader_state {
 	__u64			    crs_rec_count;
 	/* List of prefetched enqueued_record::enq_linkage_items */
 	struct list_head	    crs_rec_queue;
+	/* Records read by the producer but not yet in crs_rec_queue */
+	struct list_head	    crs_rec_batch;
+	unsigned int		    crs_rec_batch_count;
 	unsigned int		    crs_last_catidx;
 	unsigned int		    crs_last_idx;
 	bool			    crs_poll;
+	/* Only records matching crs_filter are queued */
+	bool			    crs_filtered;
+	struct changelog_filter	    crs_filter;
 };
 
 struct chlg_rec_entry {
@@ -111,7 +117,9 @@ struct chlg_rec_entry {
 
 enum {
 	/* Number of records to prefetch locally. */
-	CDEV_CHLG_MAX_PREFETCH = 1024,
+	CDEV_CHLG_MAX_PREFETCH = 4096,
+	/* Number of records the producer queues at once. */
+	CDEV_CHLG_PRODUCER_BATCH = 64,
 };
 
 DEFINE_IDR(mdc_changelog_minor_idr);
@@ -189,6 +197,70 @@ static inline void chlg_obd_put(struct chlg_registered_dev *dev,
 	class_decref(obd, "changelog", dev);
 }
 
+/**
+ * Remove record from the list it is attached to and free it.
+ */
+static void enq_record_delete(struct chlg_rec_entry *rec)
+{
+	list_del(&rec->enq_linkage);
+	OBD_FREE(rec, sizeof(*rec) + rec->enq_length);
+}
+
+/**
+ * Check whether \a rec is excluded by the reader filter.
+ */
+static bool chlg_rec_filtered(const struct changelog_filter *cf,
+			      struct changelog_rec *rec)
+{
+	if (cf->cf_type_mask && (rec->cr_type >= CL_LAST ||
+				 !(cf->cf_type_mask & BIT(rec->cr_type))))
+		return true;
+
+	if (cf->cf_seq_end &&
+	    (fid_seq(&rec->cr_tfid) < cf->cf_seq_start ||
+	     fid_seq(&rec->cr_tfid) >= cf->cf_seq_end) &&
+	    (fid_seq(&rec->cr_pfid) < cf->cf_seq_start ||
+	     fid_seq(&rec->cr_pfid) >= cf->cf_seq_end))
+		return true;
+
+	if (cf->cf_jobid[0] != '\0' &&
+	    (!(rec->cr_flags & CLF_JOBID) ||
+	     strncmp(changelog_rec_jobid(rec)->cr_jobid, cf->cf_jobid,
+		     sizeof(cf->cf_jobid)) != 0))
+		return true;
+
+	return false;
+}
+
+/**
+ * Move the records batched by the producer to crs_rec_queue, so that they
+ * are visible to readers.  Taking crs_lock and waking readers once per
+ * batch rather than once per record keeps the producer off the lock.
+ */
+static void chlg_rec_batch_flush(struct chlg_reader_state *crs)
+{
+	struct chlg_rec_entry *rec;
+	struct chlg_rec_entry *tmp;
+
+	if (crs->crs_rec_batch_count == 0)
+		return;
+
+	mutex_lock(&crs->crs_lock);
+	/* drop records skipped by a seek since they were read */
+	list_for_each_entry_safe(rec, tmp, &crs->crs_rec_batch, enq_linkage) {
+		if (rec->enq_record->cr_index >= crs->crs_start_offset)
+			break;
+		enq_record_delete(rec);
+		crs->crs_rec_batch_count--;
+	}
+	list_splice_tail_init(&crs->crs_rec_batch, &crs->crs_rec_queue);
+	crs->crs_rec_count += crs->crs_rec_batch_count;
+	mutex_unlock(&crs->crs_lock);
+	crs->crs_rec_batch_count = 0;
+
+	wake_up(&crs->crs_waitq_cons);
+}
+
 /**
  * ChangeLog catalog processing callback invoked on each record.
  * If the current record is eligible to userland delivery, push
@@ -232,6 +304,9 @@ static int chlg_read_cat_process_cb(const struct lu_env *env,
 	if (rec->cr.cr_index < crs->crs_start_offset)
 		RETURN(0);
 
+	if (crs->crs_filtered && chlg_rec_filtered(&crs->crs_filter, &rec->cr))
+		RETURN(0);
+
 	CDEBUG(D_HSM, "%llu %02d%-5s %llu 0x%x t="DFID" p="DFID" %.*s\n",
 	       rec->cr.cr_index, rec->cr.cr_type,
 	       changelog_type2str(rec->cr.cr_type), rec->cr.cr_time,
@@ -239,9 +314,13 @@ static int chlg_read_cat_process_cb(const struct lu_env *env,
 	       PFID(&rec->cr.cr_tfid), PFID(&rec->cr.cr_pfid),
 	       rec->cr.cr_namelen, changelog_rec_name(&rec->cr));
 
-	wait_event_interruptible(crs->crs_waitq_prod,
-				 crs->crs_rec_count < CDEV_CHLG_MAX_PREFETCH ||
-				 kthread_should_stop());
+	if (crs->crs_rec_count + crs->crs_rec_batch_count >=
+	    CDEV_CHLG_MAX_PREFETCH) {
+		chlg_rec_batch_flush(crs);
+		wait_event_interruptible(crs->crs_waitq_prod,
+				crs->crs_rec_count < CDEV_CHLG_MAX_PREFETCH ||
+				kthread_should_stop());
+	}
 
 	if (kthread_should_stop())
 		RETURN(LLOG_PROC_BREAK);
@@ -251,29 +330,20 @@ static int chlg_read_cat_process_cb(const struct lu_env *env,
 	if (enq == NULL)
 		RETURN(-ENOMEM);
 
-	INIT_LIST_HEAD(&enq->enq_linkage);
 	enq->enq_length = len;
 	memcpy(enq->enq_record, &rec->cr, len);
 
-	mutex_lock(&crs->crs_lock);
-	list_add_tail(&enq->enq_linkage, &crs->crs_rec_queue);
-	crs->crs_rec_count++;
-	mutex_unlock(&crs->crs_lock);
+	list_add_tail(&enq->enq_linkage, &crs->crs_rec_batch);
+	crs->crs_rec_batch_count++;
 
-	wake_up(&crs->crs_waitq_cons);
+	/* do not keep records from an idle reader while the llog is read */
+	if (crs->crs_rec_batch_count >= CDEV_CHLG_PRODUCER_BATCH ||
+	    crs->crs_rec_count == 0)
+		chlg_rec_batch_flush(crs);
 
 	RETURN(0);
 }
 
-/**
- * Remove record from the list it is attached to and free it.
- */
-static void enq_record_delete(struct chlg_rec_entry *rec)
-{
-	list_del(&rec->enq_linkage);
-	OBD_FREE(rec, sizeof(*rec) + rec->enq_length);
-}
-
 /**
  * Record prefetch thread entry point. Opens the changelog catalog and starts
  * reading records.
@@ -331,6 +401,7 @@ again:
 
 	rc = llog_cat_process(NULL, llh, chlg_read_cat_process_cb, crs,
 				crs->crs_last_catidx, crs->crs_last_idx);
+	chlg_rec_batch_flush(crs);
 	if (rc < 0) {
 		CERROR("%s: fail to process llog: rc = %d\n", obd->obd_name, rc);
 		GOTO(err_out, rc);
@@ -410,6 +481,8 @@ static ssize_t chlg_read(struct file *file, char __user *buff, size_t count,
 	struct chlg_rec_entry *rec;
 	struct chlg_rec_entry *tmp;
 	size_t written_total = 0;
+	size_t batch_len = 0;
+	__u64 last_index = 0;
 	ssize_t rc;
 	LIST_HEAD(consumed);
 	ENTRY;
@@ -430,11 +503,23 @@ static ssize_t chlg_read(struct file *file, char __user *buff, size_t count,
 	rc = wait_event_interruptible(crs->crs_waitq_cons,
 			crs->crs_rec_count > 0 || crs->crs_eof || crs->crs_err);
 
+	/*
+	 * Take as many records as fit in the user buffer off the queue at
+	 * once, and copy them without holding crs_lock so that the producer
+	 * can keep queueing meanwhile.
+	 */
 	mutex_lock(&crs->crs_lock);
 	list_for_each_entry_safe(rec, tmp, &crs->crs_rec_queue, enq_linkage) {
-		if (written_total + rec->enq_length > count)
+		if (batch_len + rec->enq_length > count)
 			break;
 
+		batch_len += rec->enq_length;
+		crs->crs_rec_count--;
+		list_move_tail(&rec->enq_linkage, &consumed);
+	}
+	mutex_unlock(&crs->crs_lock);
+
+	list_for_each_entry_safe(rec, tmp, &consumed, enq_linkage) {
 		if (copy_to_user(buff, rec->enq_record, rec->enq_length)) {
 			rc = -EFAULT;
 			break;
@@ -442,12 +527,19 @@ static ssize_t chlg_read(struct file *file, char __user *buff, size_t count,
 
 		buff += rec->enq_length;
 		written_total += rec->enq_length;
+		last_index = rec->enq_record->cr_index;
+		enq_record_delete(rec);
+	}
 
-		crs->crs_rec_count--;
-		list_move_tail(&rec->enq_linkage, &consumed);
-
-		crs->crs_start_offset = rec->enq_record->cr_index + 1;
+	mutex_lock(&crs->crs_lock);
+	if (!list_empty(&consumed)) {
+		/* put back what could not be copied */
+		list_for_each_entry(rec, &consumed, enq_linkage)
+			crs->crs_rec_count++;
+		list_splice(&consumed, &crs->crs_rec_queue);
 	}
+	if (written_total > 0)
+		crs->crs_start_offset = last_index + 1;
 	mutex_unlock(&crs->crs_lock);
 
 	if (written_total > 0) {
@@ -457,9 +549,6 @@ static ssize_t chlg_read(struct file *file, char __user *buff, size_t count,
 		rc = crs->crs_err;
 	}
 
-	list_for_each_entry_safe(rec, tmp, &consumed, enq_linkage)
-		enq_record_delete(rec);
-
 	*ppos = crs->crs_start_offset;
 
 	RETURN(rc);
@@ -638,6 +727,7 @@ static int chlg_open(struct inode *inode, struct file *file)
 
 	mutex_init(&crs->crs_lock);
 	INIT_LIST_HEAD(&crs->crs_rec_queue);
+	INIT_LIST_HEAD(&crs->crs_rec_batch);
 	init_waitqueue_head(&crs->crs_waitq_prod);
 	init_waitqueue_head(&crs->crs_waitq_cons);
 	crs->crs_prod_task = NULL;
@@ -665,6 +755,8 @@ static int chlg_release(struct inode *inode, struct file *file)
 
 	list_for_each_entry_safe(rec, tmp, &crs->crs_rec_queue, enq_linkage)
 		enq_record_delete(rec);
+	list_for_each_entry_safe(rec, tmp, &crs->crs_rec_batch, enq_linkage)
+		enq_record_delete(rec);
 
 	kref_put(&crs->crs_ced->ced_refs, chlg_dev_clear);
 	OBD_FREE_PTR(crs);
@@ -702,6 +794,39 @@ static unsigned int chlg_poll(struct file *file, poll_table *wait)
 	return mask;
 }
 
+/**
+ * Set the client-side filter of this reader.  The whole changelog is still
+ * read from the MDT, records that do not match are dropped by chlg_load()
+ * before they are queued.  This has to be done before the first read,
+ * since records may be queued from then on.
+ */
+static int chlg_set_filter(struct chlg_reader_state *crs,
+			   const struct changelog_filter __user *ucf)
+{
+	struct changelog_filter cf;
+	int rc = 0;
+
+	if (copy_from_user(&cf, ucf, sizeof(cf)))
+		return -EFAULT;
+
+	if (cf.cf_type_mask & ~(BIT(CL_LAST) - 1) ||
+	    (cf.cf_seq_end && cf.cf_seq_end <= cf.cf_seq_start) ||
+	    strnlen(cf.cf_jobid, sizeof(cf.cf_jobid)) == sizeof(cf.cf_jobid))
+		return -EINVAL;
+
+	mutex_lock(&crs->crs_lock);
+	if (crs->crs_prod_task) {
+		rc = -EBUSY;
+	} else {
+		crs->crs_filter = cf;
+		crs->crs_filtered = cf.cf_type_mask || cf.cf_seq_end ||
+				    cf.cf_jobid[0] != '\0';
+	}
+	mutex_unlock(&crs->crs_lock);
+
+	return rc;
+}
+
 static long chlg_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 {
 	int rc;
@@ -712,6 +837,9 @@ static long chlg_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 		crs->crs_poll = !!arg;
 		rc = 0;
 		break;
+	case OBD_IOC_CHLG_SET_FILTER:
+		rc = chlg_set_filter(crs, (void __user *)arg);
+		break;
 	default:
 		rc = -EINVAL;
 		break;
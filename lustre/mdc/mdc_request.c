@@ -1713,6 +1713,56 @@ out:
 	return rc;
 }
 
+static int mdc_ioc_find_scan(struct obd_export *exp, struct lu_find_scan *lfs)
+{
+	__u32 keylen, vallen, buflen;
+	struct mdt_body *body;
+	void *key;
+	int rc;
+
+	ENTRY;
+
+	if (lfs->lfs_buflen > LU_FIND_SCAN_MAX_BUF)
+		RETURN(-EINVAL);
+	if (!fid_is_sane(&lfs->lfs_fid) || !fid_is_sane(&lfs->lfs_root_fid))
+		RETURN(-EINVAL);
+
+	/* Key is KEY_FIND_SCAN + lu_find_scan predicates + mdt_body holding
+	 * the credentials the MDT checks directory access with
+	 */
+	keylen = cfs_size_round(sizeof(KEY_FIND_SCAN)) + sizeof(*lfs) +
+		 sizeof(*body);
+	OBD_ALLOC(key, keylen);
+	if (key == NULL)
+		RETURN(-ENOMEM);
+	memcpy(key, KEY_FIND_SCAN, sizeof(KEY_FIND_SCAN));
+	memcpy(key + cfs_size_round(sizeof(KEY_FIND_SCAN)), lfs, sizeof(*lfs));
+
+	body = key + cfs_size_round(sizeof(KEY_FIND_SCAN)) + sizeof(*lfs);
+	body->mbo_fid1 = lfs->lfs_fid;
+	body->mbo_valid = OBD_MD_FLID;
+	body->mbo_suppgid = -1;
+	body->mbo_uid = from_kuid(&init_user_ns, current_uid());
+	body->mbo_gid = from_kgid(&init_user_ns, current_gid());
+	body->mbo_fsuid = from_kuid(&init_user_ns, current_fsuid());
+	body->mbo_fsgid = from_kgid(&init_user_ns, current_fsgid());
+	body->mbo_capability = current_cap().cap[0];
+
+	/* Val is struct lu_find_scan plus the entries found */
+	buflen = lfs->lfs_buflen;
+	vallen = sizeof(*lfs) + buflen;
+	rc = obd_get_info(NULL, exp, keylen, key, &vallen, lfs);
+	/* on return lfs_buflen is the part of lfs_ents actually used */
+	if (rc == 0 && lfs->lfs_buflen > buflen)
+		rc = -EPROTO;
+
+	CDEBUG(D_IOCTL, "find scan "DFID" got %u entries, next %#llx: rc = %d\n",
+	       PFID(&lfs->lfs_fid), lfs->lfs_count, lfs->lfs_cookie, rc);
+
+	OBD_FREE(key, keylen);
+	RETURN(rc);
+}
+
 static int mdc_ioc_hsm_progress(struct obd_export *exp,
 				struct hsm_progress_kernel *hpk)
 {
@@ -2144,6 +2194,9 @@ static int mdc_iocontrol(unsigned int cmd, struct obd_export *exp, int len,
 	case OBD_IOC_FID2PATH:
 		rc = mdc_ioc_fid2path(exp, karg);
 		GOTO(out, rc);
+	case LL_IOC_FIND_SCAN:
+		rc = mdc_ioc_find_scan(exp, karg);
+		GOTO(out, rc);
 	case LL_IOC_HSM_CT_START:
 		rc = mdc_ioc_hsm_ct_start(exp, karg);
 		/* ignore if it was already registered on this MDS. */
@@ -2293,6 +2346,8 @@ static int mdc_get_info_rpc(struct obd_export *exp,
 		if (req_capsule_rep_need_swab(&req->rq_pill)) {
 			if (KEY_IS(KEY_FID2PATH))
 				lustre_swab_fid2path(val);
+			else if (KEY_IS(KEY_FIND_SCAN))
+				lustre_swab_find_scan(val, vallen);
 		}
 	}
 	ptlrpc_req_finished(req);
@@ -428,8 +428,12 @@ static int llog_changelog_cancel(const struct lu_env *env,
 	/* This should only be called with the catalog handle */
 	LASSERT(cathandle->lgh_hdr->llh_flags & LLOG_F_IS_CAT);
 
-	rc = llog_cat_process(env, cathandle, llog_changelog_cancel_cb,
-			      cookie, 0, 0);
+	/* helpers open the next plain llogs while this thread cancels the
+	 * records of the current one, in catalog order */
+	rc = llog_cat_process_parallel(env, cathandle,
+				       llog_changelog_cancel_cb, cookie,
+				       MDD_CHLG_CANCEL_THREADS,
+				       MDD_CHLG_CANCEL_PREFETCH, true);
 	if (rc >= 0)
 		/* 0 or 1 means we're done */
 		rc = 0;
@@ -796,9 +796,14 @@ int mdd_changelog_write_rec(const struct lu_env *env,
 		mdd = lu2mdd_dev(loghandle->lgh_ctxt->loc_obd->obd_lu_dev);
 		rec = container_of(r, struct llog_changelog_rec, cr_hdr);
 
-		spin_lock(&mdd->mdd_cl.mc_lock);
+		/*
+		 * appends to the changelog catalog are serialized by the
+		 * lgh_lock of its current plain llog, so nobody else can
+		 * move mc_index between here and the update below, and
+		 * mc_lock is only needed to publish the new value to the
+		 * readers (purge, user registration, procfs)
+		 */
 		rec->cr.cr_index = mdd->mdd_cl.mc_index + 1;
-		spin_unlock(&mdd->mdd_cl.mc_lock);
 
 		rc = llog_osd_ops.lop_write_rec(env, loghandle, r,
 						cookie, idx, th);
@@ -811,7 +816,7 @@ int mdd_changelog_write_rec(const struct lu_env *env,
 		 */
 		if (!(rc == -ENOSPC && llog_is_full(loghandle))) {
 			spin_lock(&mdd->mdd_cl.mc_lock);
-			++mdd->mdd_cl.mc_index;
+			mdd->mdd_cl.mc_index = rec->cr.cr_index;
 			spin_unlock(&mdd->mdd_cl.mc_lock);
 		}
 	} else {
@@ -853,6 +858,13 @@ int mdd_changelog_store(const struct lu_env *env, struct mdd_device *mdd,
 		GOTO(out_put, rc = PTR_ERR(llog_th));
 
 	OBD_FAIL_TIMEOUT(OBD_FAIL_MDS_CHANGELOG_REORDER, cfs_fail_val);
+	/*
+	 * The record is not staged per CPU nor given its index at commit:
+	 * it has to be in the same transaction as the change it describes,
+	 * and readers expect indexes to grow along the llog. So the index
+	 * is assigned and the record appended under the lgh_lock of the
+	 * current plain llog, see mdd_changelog_write_rec().
+	 */
 	/* nested journal transaction */
 	rc = llog_add(env, ctxt->loc_handle, &rec->cr_hdr, NULL, llog_th);
 
@@ -83,6 +83,10 @@
 
 #define LLOG_CHANGELOG_HDR_SZ (sizeof(struct llog_changelog_rec) - \
 			       sizeof(struct changelog_rec))
+/** threads opening plain llogs ahead of a changelog purge */
+#define MDD_CHLG_CANCEL_THREADS 2
+/** plain llogs opened ahead of the one being purged */
+#define MDD_CHLG_CANCEL_PREFETCH 4
 /* mc_gc_task values */
 /** no GC thread to be started **/
 #define MDD_CHLG_GC_NONE NULL
@@ -586,6 +586,34 @@ static ssize_t lfsck_async_windows_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(lfsck_async_windows);
 
+static ssize_t lfsck_assistant_threads_show(struct kobject *kobj,
+					    struct attribute *attr, char *buf)
+{
+	struct mdd_device *mdd = container_of(kobj, struct mdd_device,
+					      mdd_kobj);
+
+	return lfsck_get_threads(buf, mdd->mdd_bottom);
+}
+
+static ssize_t lfsck_assistant_threads_store(struct kobject *kobj,
+					     struct attribute *attr,
+					     const char *buffer, size_t count)
+{
+	struct mdd_device *mdd = container_of(kobj, struct mdd_device,
+					      mdd_kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 10, &val);
+	if (rc)
+		return rc;
+
+	rc = lfsck_set_threads(mdd->mdd_bottom, val);
+
+	return rc != 0 ? rc : count;
+}
+LUSTRE_RW_ATTR(lfsck_assistant_threads);
+
 static int mdd_lfsck_namespace_seq_show(struct seq_file *m, void *data)
 {
 	struct mdd_device *mdd = m->private;
@@ -742,6 +770,7 @@ static struct attribute *mdd_attrs[] = {
 	&lustre_attr_changelog_min_free_cat_entries.attr,
 	&lustre_attr_changelog_deniednext.attr,
 	&lustre_attr_lfsck_async_windows.attr,
+	&lustre_attr_lfsck_assistant_threads.attr,
 	&lustre_attr_lfsck_speed_limit.attr,
 	&lustre_attr_sync_permission.attr,
 	&lustre_attr_append_stripe_count.attr,
@@ -0,0 +1,405 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.  A copy is
+ * included in the COPYING file that accompanied this code.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * GPL HEADER END
+ */
+/*
+ * lustre/mdt/mdt_find.c
+ *
+ * Evaluate lfs find predicates on the MDT, so that a namespace scan only
+ * transfers the directory entries which may match instead of fetching the
+ * attributes of every file to the client.
+ */
+
+#define DEBUG_SUBSYSTEM S_MDS
+
+#include "mdt_internal.h"
+
+/* directory data read per KEY_FIND_SCAN request */
+#define MDT_FIND_SCAN_READ	(16 * LU_PAGE_SIZE)
+
+/*
+ * Same as find_value_cmp() in liblustreapi: 1 if \a val matches, -1 if it
+ * does not, and 0 if it cannot be decided from MDT attributes (\a mds set
+ * and the file has OST objects whose timestamps may be newer).
+ */
+static int mdt_find_cmp(__u64 val, const struct lu_find_scan_cmp *cmp,
+			bool exclude, bool mds)
+{
+	int rc = -1;
+
+	if (cmp->lfsc_sign > 0) {
+		if (val + cmp->lfsc_margin <= cmp->lfsc_value)
+			rc = mds ? 0 : 1;
+	} else if (cmp->lfsc_sign == 0) {
+		if (val <= cmp->lfsc_value &&
+		    val + cmp->lfsc_margin > cmp->lfsc_value)
+			rc = mds ? 0 : 1;
+		else if (val + cmp->lfsc_margin <= cmp->lfsc_value)
+			rc = mds ? 0 : -1;
+	} else {
+		if (val > cmp->lfsc_value)
+			rc = 1;
+		else if (mds)
+			rc = 0;
+	}
+
+	return exclude ? -rc : rc;
+}
+
+static inline bool mdt_find_id_match(__u32 val, __u32 want, bool exclude)
+{
+	return (val == want) != exclude;
+}
+
+/**
+ * Check whether \a obj definitely fails one of the predicates in \a lfs.
+ *
+ * Only the attributes stored on the MDT are used.  Anything that needs OST
+ * attributes (size without strict SOM, timestamps which may be newer on the
+ * OSTs) or a composite layout is left to the client.
+ *
+ * \retval 1 if \a obj is rejected
+ * \retval 0 if \a obj may match
+ * \retval negative errno on failure
+ */
+static int mdt_find_scan_reject(struct mdt_thread_info *info,
+				struct mdt_object *obj,
+				const struct lu_find_scan *lfs)
+{
+	struct md_attr *ma = &info->mti_attr;
+	struct lu_attr *la = &ma->ma_attr;
+	__u32 valid = lfs->lfs_valid;
+	__u32 excl = lfs->lfs_exclude;
+	const char *pool = NULL;
+	bool has_ost = false;
+	bool layout = false;
+	__u32 pattern = 0;
+	__u16 stripes = 0;
+	int rc;
+
+	ma->ma_need = MA_INODE;
+	rc = mdt_attr_get_complex(info, obj, ma);
+	if (rc)
+		return rc;
+
+	if (valid & LFSV_UID &&
+	    !mdt_find_id_match(la->la_uid, lfs->lfs_uid, excl & LFSV_UID))
+		return 1;
+	if (valid & LFSV_GID &&
+	    !mdt_find_id_match(la->la_gid, lfs->lfs_gid, excl & LFSV_GID))
+		return 1;
+	if (valid & LFSV_PROJID &&
+	    !mdt_find_id_match(la->la_projid, lfs->lfs_projid,
+			       excl & LFSV_PROJID))
+		return 1;
+
+	if (S_ISREG(la->la_mode) &&
+	    valid & (LFSV_ATIME | LFSV_MTIME | LFSV_CTIME | LFSV_SIZE |
+		     LFSV_POOL | LFSV_LAYOUT | LFSV_STRIPE_COUNT)) {
+		struct lov_mds_md *lmm;
+
+		rc = mdt_stripe_get(info, obj, ma, XATTR_NAME_LOV);
+		if (rc)
+			return rc;
+
+		if (!(ma->ma_valid & MA_LOV)) {
+			/* lfs find sees a file without layout like this */
+			layout = true;
+			pattern = LOV_PATTERN_DEFAULT;
+		} else {
+			lmm = ma->ma_lmm;
+			switch (le32_to_cpu(lmm->lmm_magic)) {
+			case LOV_MAGIC_V3:
+				pool = ((struct lov_mds_md_v3 *)lmm)->lmm_pool_name;
+				/* fallthrough */
+			case LOV_MAGIC_V1:
+				layout = true;
+				pattern = le32_to_cpu(lmm->lmm_pattern);
+				stripes = le16_to_cpu(lmm->lmm_stripe_count);
+				has_ost = stripes != 0;
+				break;
+			default:
+				/* composite or foreign, leave it to the client */
+				has_ost = true;
+				break;
+			}
+		}
+	}
+
+	if (valid & LFSV_ATIME &&
+	    mdt_find_cmp(la->la_atime, &lfs->lfs_atime, excl & LFSV_ATIME,
+			 has_ost) < 0)
+		return 1;
+	if (valid & LFSV_MTIME &&
+	    mdt_find_cmp(la->la_mtime, &lfs->lfs_mtime, excl & LFSV_MTIME,
+			 has_ost) < 0)
+		return 1;
+	if (valid & LFSV_CTIME &&
+	    mdt_find_cmp(la->la_ctime, &lfs->lfs_ctime, excl & LFSV_CTIME,
+			 has_ost) < 0)
+		return 1;
+
+	/* mdt_get_som() already replaced la_size if SOM is strict */
+	if (valid & LFSV_SIZE &&
+	    (!has_ost || (ma->ma_valid & MA_SOM &&
+			  ma->ma_som.ms_valid & SOM_FL_STRICT)) &&
+	    mdt_find_cmp(la->la_size, &lfs->lfs_size, excl & LFSV_SIZE,
+			 false) < 0)
+		return 1;
+
+	if (!layout)
+		return 0;
+
+	if (valid & LFSV_STRIPE_COUNT &&
+	    mdt_find_cmp(stripes, &lfs->lfs_stripe_count,
+			 excl & LFSV_STRIPE_COUNT, false) < 0)
+		return 1;
+
+	if (valid & LFSV_POOL) {
+		bool found;
+
+		if (pool)
+			found = strncmp(pool, lfs->lfs_pool,
+					LOV_MAXPOOLNAME) == 0 ||
+				strcmp(lfs->lfs_pool, "*") == 0;
+		else
+			found = lfs->lfs_pool[0] == '\0';
+		if (found == !!(excl & LFSV_POOL))
+			return 1;
+	}
+
+	/* lfs find never matches a layout it could not get a pattern from */
+	if (valid & LFSV_LAYOUT &&
+	    (pattern == LOV_PATTERN_DEFAULT ||
+	     !!(pattern & lfs->lfs_layout) == !!(excl & LFSV_LAYOUT)))
+		return 1;
+
+	return 0;
+}
+
+static int mdt_find_scan_entry(struct mdt_thread_info *info,
+			       const struct lu_fid *fid, unsigned int type,
+			       const struct lu_find_scan *lfs)
+{
+	struct mdt_object *obj;
+	int rc = 0;
+
+	/* the client has to descend into every directory anyway */
+	if (type == DT_DIR || !fid_is_sane(fid))
+		return 0;
+
+	obj = mdt_object_find(info->mti_env, info->mti_mdt, fid);
+	if (IS_ERR(obj))
+		return 0;
+
+	if (!mdt_object_remote(obj) && mdt_object_exists(obj))
+		rc = mdt_find_scan_reject(info, obj, lfs);
+	mdt_object_put(info->mti_env, obj);
+
+	/* let the client report anything unexpected about this entry */
+	return rc > 0;
+}
+
+static int mdt_find_scan_dir(struct mdt_thread_info *info,
+			     struct mdt_object *dir, struct lu_find_scan *lfs)
+{
+	struct lu_rdpg *rdpg = &info->mti_u.rdpg.mti_rdpg;
+	struct lu_find_scan_ent *ent;
+	__u64 next = MDS_DIR_END_OFF;
+	__u64 run_hash = MDS_DIR_END_OFF;
+	__u32 run_count = 0;
+	size_t run_used = 0;
+	size_t used = 0;
+	bool full = false;
+	int nlupgs;
+	int rc;
+	int i;
+
+	ENTRY;
+
+	memset(rdpg, 0, sizeof(*rdpg));
+	rdpg->rp_hash = lfs->lfs_cookie;
+	rdpg->rp_attrs = LUDA_FID | LUDA_TYPE;
+	if (exp_connect_flags(info->mti_exp) & OBD_CONNECT_64BITHASH)
+		rdpg->rp_attrs |= LUDA_64BITHASH;
+	rdpg->rp_count = MDT_FIND_SCAN_READ;
+	rdpg->rp_npages = (rdpg->rp_count + PAGE_SIZE - 1) >> PAGE_SHIFT;
+	OBD_ALLOC_PTR_ARRAY(rdpg->rp_pages, rdpg->rp_npages);
+	if (rdpg->rp_pages == NULL)
+		RETURN(-ENOMEM);
+
+	for (i = 0; i < rdpg->rp_npages; i++) {
+		rdpg->rp_pages[i] = alloc_page(GFP_NOFS);
+		if (rdpg->rp_pages[i] == NULL)
+			GOTO(free_rdpg, rc = -ENOMEM);
+	}
+
+	rc = mo_readpage(info->mti_env, mdt_object_child(dir), rdpg);
+	if (rc < 0)
+		GOTO(free_rdpg, rc);
+
+	nlupgs = rc / LU_PAGE_SIZE;
+	lfs->lfs_count = 0;
+	ent = (struct lu_find_scan_ent *)lfs->lfs_ents;
+	for (i = 0, rc = 0; i < nlupgs && !full; i++) {
+		struct page *page = rdpg->rp_pages[i / LU_PAGE_COUNT];
+		struct lu_dirpage *dp;
+		struct lu_dirent *de;
+
+		dp = kmap(page) + (i % LU_PAGE_COUNT) * LU_PAGE_SIZE;
+		next = le64_to_cpu(dp->ldp_hash_end);
+		for (de = lu_dirent_start(dp); de != NULL;
+		     de = lu_dirent_next(de)) {
+			struct lu_fid *fid = &info->mti_tmp_fid1;
+			__u64 hash = le64_to_cpu(de->lde_hash);
+			int namelen = le16_to_cpu(de->lde_namelen);
+			unsigned int type = S_DT(lu_dirent_type_get(de));
+			size_t size;
+
+			if (namelen == 0 ||
+			    (namelen == 1 && de->lde_name[0] == '.') ||
+			    (namelen == 2 && de->lde_name[0] == '.' &&
+			     de->lde_name[1] == '.'))
+				continue;
+
+			fid_le_to_cpu(fid, &de->lde_fid);
+			if (mdt_find_scan_entry(info, fid, type, lfs))
+				continue;
+
+			size = lu_find_scan_ent_size(namelen);
+			if (used + size > lfs->lfs_buflen) {
+				next = hash;
+				full = true;
+				break;
+			}
+
+			if (hash != run_hash) {
+				run_hash = hash;
+				run_used = used;
+				run_count = lfs->lfs_count;
+			}
+
+			ent->lfse_fid = *fid;
+			ent->lfse_namelen = namelen;
+			ent->lfse_type = type;
+			ent->lfse_padding = 0;
+			memcpy(ent->lfse_name, de->lde_name, namelen);
+			memset(ent->lfse_name + namelen, 0,
+			       size - sizeof(*ent) - namelen);
+			ent = lu_find_scan_ent_next(ent);
+			used += size;
+			lfs->lfs_count++;
+		}
+		kunmap(page);
+	}
+
+	/*
+	 * The next request resumes at the first entry with hash @next, so
+	 * entries already packed with that hash would be returned twice.
+	 * If all of them have that hash the scan cannot make progress.
+	 */
+	if (next != MDS_DIR_END_OFF && next == run_hash) {
+		if (run_count == 0)
+			GOTO(free_rdpg, rc = -EOVERFLOW);
+		lfs->lfs_count = run_count;
+		used = run_used;
+	} else if (full && lfs->lfs_count == 0) {
+		GOTO(free_rdpg, rc = -EOVERFLOW);
+	}
+
+	lfs->lfs_cookie = next;
+	lfs->lfs_buflen = used;
+	EXIT;
+free_rdpg:
+	for (i = 0; i < rdpg->rp_npages; i++)
+		if (rdpg->rp_pages[i] != NULL)
+			__free_page(rdpg->rp_pages[i]);
+	OBD_FREE_PTR_ARRAY(rdpg->rp_pages, rdpg->rp_npages);
+
+	return rc;
+}
+
+int mdt_rpc_find_scan(struct mdt_thread_info *info, void *key, int keylen,
+		      void *val, int vallen)
+{
+	struct lu_find_scan *lfsin, *lfs;
+	struct mdt_object *dir;
+	struct mdt_body *body;
+	int rc;
+
+	ENTRY;
+
+	if (keylen < cfs_size_round(sizeof(KEY_FIND_SCAN)) + sizeof(*lfsin) +
+		     sizeof(*body) || vallen < sizeof(*lfs))
+		RETURN(-EPROTO);
+
+	lfsin = key + cfs_size_round(sizeof(KEY_FIND_SCAN));
+	body = (struct mdt_body *)(lfsin + 1);
+	if (req_capsule_req_need_swab(info->mti_pill)) {
+		lustre_swab_find_scan(lfsin, sizeof(*lfsin));
+		lustre_swab_mdt_body(body);
+	}
+
+	lfs = val;
+	memcpy(lfs, lfsin, sizeof(*lfs));
+	if (lfs->lfs_buflen != vallen - sizeof(*lfs) ||
+	    lfs->lfs_buflen > LU_FIND_SCAN_MAX_BUF)
+		RETURN(-EINVAL);
+	if (!fid_is_sane(&lfs->lfs_fid) || !fid_is_sane(&lfs->lfs_root_fid))
+		RETURN(-EINVAL);
+
+	rc = mdt_init_ucred(info, body);
+	if (rc)
+		RETURN(rc);
+
+	dir = mdt_object_find(info->mti_env, info->mti_mdt, &lfs->lfs_fid);
+	if (IS_ERR(dir))
+		GOTO(out_ucred, rc = PTR_ERR(dir));
+
+	if (mdt_object_remote(dir))
+		GOTO(out, rc = -EREMOTE);
+	if (!mdt_object_exists(dir))
+		GOTO(out, rc = -ENOENT);
+	if (!S_ISDIR(lu_object_attr(&dir->mot_obj)))
+		GOTO(out, rc = -ENOTDIR);
+
+	/* only scan directories inside the fileset the client mounted */
+	rc = mdt_path_check_root(info, dir, &lfs->lfs_root_fid);
+	if (rc)
+		GOTO(out, rc);
+
+	/* the entries are returned as readdir would, so check it is allowed */
+	rc = mo_permission(info->mti_env, NULL, mdt_object_child(dir), NULL,
+			   MAY_READ | MAY_EXEC);
+	if (rc)
+		GOTO(out, rc);
+
+	rc = mdt_find_scan_dir(info, dir, lfs);
+
+	CDEBUG(D_INFO, "%s: find scan "DFID" returned %u entries, next %#llx: rc = %d\n",
+	       mdt_obd_name(info->mti_mdt), PFID(&lfs->lfs_fid),
+	       lfs->lfs_count, lfs->lfs_cookie, rc);
+	EXIT;
+out:
+	mdt_object_put(info->mti_env, dir);
+out_ucred:
+	mdt_exit_ucred(info);
+	return rc;
+}
@@ -7151,6 +7151,42 @@ static int mdt_path(struct mdt_thread_info *info, struct mdt_object *obj,
 	RETURN(rc);
 }
 
+/**
+ * Check that \a obj is \a root_fid or lies below it in the namespace.
+ *
+ * This is used to keep requests naming an object by FID within the fileset
+ * the client mounted, using the same linkEA walk as fid2path.
+ *
+ * \param[in] info	Per-thread common data shared by mdt level handlers.
+ * \param[in] obj	Object to check
+ * \param[in] root_fid	Root FID of the client mount
+ *
+ * \retval 0 \a obj is within the subtree of \a root_fid
+ * \retval -ENOENT \a obj is outside the subtree of \a root_fid
+ * \retval negative errno if there was a problem
+ */
+int mdt_path_check_root(struct mdt_thread_info *info, struct mdt_object *obj,
+			struct lu_fid *root_fid)
+{
+	struct getinfo_fid2path *fp;
+	int rc;
+
+	ENTRY;
+
+	if (lu_fid_eq(root_fid, &info->mti_mdt->mdt_md_root_fid))
+		RETURN(0);
+
+	OBD_ALLOC(fp, sizeof(*fp) + PATH_MAX);
+	if (fp == NULL)
+		RETURN(-ENOMEM);
+
+	fp->gf_pathlen = PATH_MAX;
+	rc = mdt_path(info, obj, fp, root_fid);
+	OBD_FREE(fp, sizeof(*fp) + PATH_MAX);
+
+	RETURN(rc);
+}
+
 /**
  * Get the full path of the provided FID, as of changelog record recno.
  *
@@ -7309,6 +7345,11 @@ int mdt_get_info(struct tgt_session_info *tsi)
 
 		rc = mdt_rpc_fid2path(info, key, keylen, valout, *vallen);
 		mdt_thread_info_fini(info);
+	} else if (KEY_IS(KEY_FIND_SCAN)) {
+		struct mdt_thread_info	*info = tsi2mdt_info(tsi);
+
+		rc = mdt_rpc_find_scan(info, key, keylen, valout, *vallen);
+		mdt_thread_info_fini(info);
 	} else {
 		rc = -EINVAL;
 	}
@@ -892,6 +892,8 @@ int mdt_revoke_remote_lookup_lock(struct mdt_thread_info *info,
 				  struct mdt_object *obj);
 
 int mdt_get_info(struct tgt_session_info *tsi);
+int mdt_path_check_root(struct mdt_thread_info *info, struct mdt_object *obj,
+			struct lu_fid *root_fid);
 int mdt_attr_get_complex(struct mdt_thread_info *info,
 			 struct mdt_object *o, struct md_attr *ma);
 int mdt_big_xattr_get(struct mdt_thread_info *info, struct mdt_object *o,
@@ -1269,6 +1271,10 @@ int mdt_lsom_downgrade(struct mdt_thread_info *info, struct mdt_object *obj);
 int mdt_lsom_update(struct mdt_thread_info *info, struct mdt_object *obj,
 		    bool truncate);
 
+/* mdt_find.c */
+int mdt_rpc_find_scan(struct mdt_thread_info *info, void *key, int keylen,
+		      void *val, int vallen);
+
 /* mdt_lvb.c */
 extern struct ldlm_valblock_ops mdt_lvbo;
 int mdt_dom_lvb_is_valid(struct ldlm_resource *res);
@@ -43,6 +43,7 @@
 
 #define DEBUG_SUBSYSTEM S_LOG
 
+#include <linux/kthread.h>
 
 #include <obd_class.h>
 
@@ -970,6 +971,330 @@ int llog_cat_process(const struct lu_env *env, struct llog_handle *cat_llh,
 }
 EXPORT_SYMBOL(llog_cat_process);
 
+enum llog_cat_par_state {
+	LCPE_QUEUED,	/* waiting for a helper thread */
+	LCPE_BUSY,	/* a helper opens or processes the plain llog */
+	LCPE_READY,	/* ordered mode: plain llog is open, or will be
+			 * opened by the scanner itself */
+};
+
+/* one catalog record handed from the catalog scanner to the helpers */
+struct llog_cat_par_ent {
+	struct list_head	 lcpe_list;
+	struct llog_logid_rec	 lcpe_rec;
+	enum llog_cat_par_state	 lcpe_state;
+};
+
+struct llog_cat_par {
+	struct llog_handle	*lcp_cat;
+	struct llog_process_data lcp_pd;
+	__u32			 lcp_tags;
+	bool			 lcp_ordered;
+	/* the catalog scan is over, helpers exit once idle */
+	bool			 lcp_done;
+	/* first error of any thread, stops everybody */
+	int			 lcp_rc;
+	/* maximum number of catalog records in lcp_queue */
+	int			 lcp_window;
+	int			 lcp_queued;
+	spinlock_t		 lcp_lock;
+	struct list_head	 lcp_queue;
+	/* helpers wait here for new records */
+	wait_queue_head_t	 lcp_helper_waitq;
+	/* the scanner waits here for room or for a prefetched llog */
+	wait_queue_head_t	 lcp_waitq;
+	atomic_t		 lcp_threads;
+	struct completion	 lcp_finished;
+};
+
+static void llog_cat_par_error(struct llog_cat_par *lcp, int rc)
+{
+	spin_lock(&lcp->lcp_lock);
+	if (lcp->lcp_rc == 0)
+		lcp->lcp_rc = rc;
+	spin_unlock(&lcp->lcp_lock);
+	wake_up_all(&lcp->lcp_waitq);
+	wake_up_all(&lcp->lcp_helper_waitq);
+}
+
+/* pick the oldest record nobody works on yet, or tell the helper to exit */
+static bool llog_cat_par_next(struct llog_cat_par *lcp,
+			      struct llog_cat_par_ent **entp)
+{
+	struct llog_cat_par_ent *ent;
+	bool stop;
+
+	spin_lock(&lcp->lcp_lock);
+	stop = lcp->lcp_rc != 0;
+	if (!stop) {
+		list_for_each_entry(ent, &lcp->lcp_queue, lcpe_list) {
+			if (ent->lcpe_state != LCPE_QUEUED)
+				continue;
+
+			ent->lcpe_state = LCPE_BUSY;
+			if (!lcp->lcp_ordered) {
+				list_del_init(&ent->lcpe_list);
+				lcp->lcp_queued--;
+			}
+			*entp = ent;
+			spin_unlock(&lcp->lcp_lock);
+			return true;
+		}
+		stop = lcp->lcp_done;
+	}
+	spin_unlock(&lcp->lcp_lock);
+
+	return stop;
+}
+
+static int llog_cat_par_thread(void *arg)
+{
+	struct llog_cat_par *lcp = arg;
+	struct llog_process_data d = lcp->lcp_pd;
+	struct llog_cat_par_ent *ent;
+	struct llog_handle *llh;
+	struct lu_env env;
+	int rc;
+
+	rc = lu_env_init(&env, lcp->lcp_tags);
+	if (rc) {
+		llog_cat_par_error(lcp, rc);
+		goto out;
+	}
+
+	for (;;) {
+		ent = NULL;
+		wait_event_idle(lcp->lcp_helper_waitq,
+				llog_cat_par_next(lcp, &ent));
+		if (ent == NULL)
+			break;
+
+		if (lcp->lcp_ordered) {
+			/* open the plain llog and read its header, the
+			 * scanner finds it in the catalog handle list */
+			rc = llog_cat_id2handle(&env, lcp->lcp_cat, &llh,
+						&ent->lcpe_rec.lid_id);
+			if (rc == 0)
+				llog_handle_put(&env, llh);
+
+			spin_lock(&lcp->lcp_lock);
+			ent->lcpe_state = LCPE_READY;
+			spin_unlock(&lcp->lcp_lock);
+			wake_up_all(&lcp->lcp_waitq);
+			continue;
+		}
+
+		wake_up_all(&lcp->lcp_waitq);
+		rc = llog_cat_process_cb(&env, lcp->lcp_cat,
+					 &ent->lcpe_rec.lid_hdr, &d);
+		OBD_FREE_PTR(ent);
+		if (rc)
+			llog_cat_par_error(lcp, rc);
+	}
+
+	lu_env_fini(&env);
+out:
+	if (atomic_dec_and_test(&lcp->lcp_threads))
+		complete(&lcp->lcp_finished);
+	return 0;
+}
+
+static bool llog_cat_par_room(struct llog_cat_par *lcp)
+{
+	bool room;
+
+	spin_lock(&lcp->lcp_lock);
+	room = lcp->lcp_queued < lcp->lcp_window || lcp->lcp_rc != 0;
+	spin_unlock(&lcp->lcp_lock);
+
+	return room;
+}
+
+static bool llog_cat_par_ready(struct llog_cat_par *lcp,
+			       struct llog_cat_par_ent *ent)
+{
+	bool ready;
+
+	spin_lock(&lcp->lcp_lock);
+	ready = ent->lcpe_state == LCPE_READY;
+	spin_unlock(&lcp->lcp_lock);
+
+	return ready;
+}
+
+/* ordered mode: process the oldest queued plain llog in the scanner */
+static int llog_cat_par_process_first(const struct lu_env *env,
+				      struct llog_cat_par *lcp)
+{
+	struct llog_cat_par_ent *ent;
+	int rc;
+
+	spin_lock(&lcp->lcp_lock);
+	ent = list_first_entry(&lcp->lcp_queue, struct llog_cat_par_ent,
+			       lcpe_list);
+	list_del_init(&ent->lcpe_list);
+	lcp->lcp_queued--;
+	/* no helper got to it yet, llog_cat_process_cb() will open it */
+	if (ent->lcpe_state == LCPE_QUEUED)
+		ent->lcpe_state = LCPE_READY;
+	spin_unlock(&lcp->lcp_lock);
+
+	wait_event_idle(lcp->lcp_waitq, llog_cat_par_ready(lcp, ent));
+
+	rc = llog_cat_process_cb(env, lcp->lcp_cat, &ent->lcpe_rec.lid_hdr,
+				 &lcp->lcp_pd);
+	OBD_FREE_PTR(ent);
+
+	return rc;
+}
+
+static int llog_cat_par_cat_cb(const struct lu_env *env,
+			       struct llog_handle *cat_llh,
+			       struct llog_rec_hdr *rec, void *data)
+{
+	struct llog_process_data *d = data;
+	struct llog_cat_par *lcp = d->lpd_data;
+	struct llog_cat_par_ent *ent;
+	int rc;
+
+	ENTRY;
+	OBD_ALLOC_PTR(ent);
+	if (ent == NULL)
+		RETURN(-ENOMEM);
+
+	/* the chunk buffer is reused, llog_cat_process_common() checks
+	 * the record type when the plain llog is processed */
+	memcpy(&ent->lcpe_rec, rec,
+	       min_t(size_t, rec->lrh_len, sizeof(ent->lcpe_rec)));
+	ent->lcpe_state = LCPE_QUEUED;
+
+	if (!lcp->lcp_ordered)
+		wait_event_idle(lcp->lcp_waitq, llog_cat_par_room(lcp));
+
+	spin_lock(&lcp->lcp_lock);
+	rc = lcp->lcp_rc;
+	if (rc == 0) {
+		list_add_tail(&ent->lcpe_list, &lcp->lcp_queue);
+		lcp->lcp_queued++;
+	}
+	spin_unlock(&lcp->lcp_lock);
+	if (rc) {
+		OBD_FREE_PTR(ent);
+		RETURN(rc);
+	}
+	wake_up(&lcp->lcp_helper_waitq);
+
+	if (lcp->lcp_ordered && lcp->lcp_queued > lcp->lcp_window)
+		rc = llog_cat_par_process_first(env, lcp);
+
+	RETURN(rc);
+}
+
+/**
+ * Process all plain llogs of catalog \a cat_llh with help of \a nthreads
+ * threads.
+ *
+ * If \a ordered is set, the plain llogs are processed one after another in
+ * catalog order by the caller, exactly like llog_cat_process() does, and
+ * the helpers only open the next \a prefetch plain llogs and read their
+ * headers in advance.
+ *
+ * Otherwise the helpers process whole plain llogs concurrently, with up to
+ * \a prefetch more catalog records queued for them. Records keep their
+ * order within a plain llog only, and \a cb must be safe to call from
+ * several threads. It gets an environment with the context tags of \a env
+ * but without a session.
+ *
+ * \retval		0 or LLOG_PROC_BREAK on success, negative errno
+ *			otherwise, like llog_cat_process()
+ */
+int llog_cat_process_parallel(const struct lu_env *env,
+			      struct llog_handle *cat_llh, llog_cb_t cb,
+			      void *data, int nthreads, int prefetch,
+			      bool ordered)
+{
+	struct llog_cat_par *lcp;
+	struct llog_cat_par_ent *ent;
+	struct llog_cat_par_ent *tmp;
+	int started;
+	int rc;
+
+	ENTRY;
+
+	if (nthreads <= 0 || prefetch < 0 || (ordered && prefetch == 0))
+		RETURN(llog_cat_process(env, cat_llh, cb, data, 0, 0));
+
+	OBD_ALLOC_PTR(lcp);
+	if (lcp == NULL)
+		RETURN(-ENOMEM);
+
+	lcp->lcp_cat = cat_llh;
+	lcp->lcp_pd.lpd_data = data;
+	lcp->lcp_pd.lpd_cb = cb;
+	lcp->lcp_tags = LCT_LOCAL | (env != NULL ? env->le_ctx.lc_tags &
+				     (LCT_MD_THREAD | LCT_DT_THREAD |
+				      LCT_OSP_THREAD | LCT_MG_THREAD |
+				      LCT_CL_THREAD) : LCT_MG_THREAD);
+	lcp->lcp_ordered = ordered;
+	lcp->lcp_window = ordered ? prefetch : nthreads + prefetch;
+	spin_lock_init(&lcp->lcp_lock);
+	INIT_LIST_HEAD(&lcp->lcp_queue);
+	init_waitqueue_head(&lcp->lcp_helper_waitq);
+	init_waitqueue_head(&lcp->lcp_waitq);
+	/* one reference for the caller */
+	atomic_set(&lcp->lcp_threads, 1);
+	init_completion(&lcp->lcp_finished);
+
+	for (started = 0; started < nthreads; started++) {
+		struct task_struct *task;
+
+		atomic_inc(&lcp->lcp_threads);
+		task = kthread_run(llog_cat_par_thread, lcp, "llog_cat_%02d",
+				   started);
+		if (IS_ERR(task)) {
+			atomic_dec(&lcp->lcp_threads);
+			CWARN("%s: cannot start llog processing thread: rc = %ld\n",
+			      loghandle2name(cat_llh), PTR_ERR(task));
+			break;
+		}
+	}
+
+	if (started == 0) {
+		OBD_FREE_PTR(lcp);
+		RETURN(llog_cat_process(env, cat_llh, cb, data, 0, 0));
+	}
+
+	rc = llog_cat_process_or_fork(env, cat_llh, llog_cat_par_cat_cb, NULL,
+				      lcp, 0, 0, false);
+
+	/* ordered mode: the last prefetched llogs are still queued */
+	while (ordered && rc == 0 && !list_empty(&lcp->lcp_queue))
+		rc = llog_cat_par_process_first(env, lcp);
+
+	spin_lock(&lcp->lcp_lock);
+	lcp->lcp_done = true;
+	if (rc != 0 && lcp->lcp_rc == 0)
+		lcp->lcp_rc = rc;
+	spin_unlock(&lcp->lcp_lock);
+	wake_up_all(&lcp->lcp_helper_waitq);
+
+	if (!atomic_dec_and_test(&lcp->lcp_threads))
+		wait_for_completion(&lcp->lcp_finished);
+
+	/* records left behind after an error */
+	list_for_each_entry_safe(ent, tmp, &lcp->lcp_queue, lcpe_list) {
+		list_del(&ent->lcpe_list);
+		OBD_FREE_PTR(ent);
+	}
+
+	if (rc == 0)
+		rc = lcp->lcp_rc;
+	OBD_FREE_PTR(lcp);
+
+	RETURN(rc);
+}
+EXPORT_SYMBOL(llog_cat_process_parallel);
+
 static int llog_cat_size_cb(const struct lu_env *env,
 			     struct llog_handle *cat_llh,
 			     struct llog_rec_hdr *rec, void *data)
@@ -395,6 +395,7 @@ static int llog_osd_write_rec(const struct lu_env *env,
 	size_t left;
 	__u32 orig_last_idx;
 	bool pad = false;
+	loff_t rec_off;
 	ENTRY;
 
 	llh = loghandle->lgh_hdr;
@@ -562,6 +563,10 @@ static int llog_osd_write_rec(const struct lu_env *env,
 		RETURN(-ENOSPC);
 
 	LASSERT(lgi->lgi_attr.la_valid & LA_SIZE);
+	/* Appends must be exclusive: the caller holds lgh_lock for write
+	 * (llog_write(), llog_cat_add_rec()), so the size read above stays
+	 * valid until the record is written, see rec_off below. */
+	LASSERT(rwsem_is_locked(&loghandle->lgh_lock));
 	orig_last_idx = loghandle->lgh_last_idx;
 	lgi->lgi_off = lgi->lgi_attr.la_size;
 
@@ -588,6 +593,7 @@ static int llog_osd_write_rec(const struct lu_env *env,
 		loghandle->lgh_last_idx++; /* for pad rec */
 		pad = true;
 	}
+	rec_off = lgi->lgi_off;
 	/* if it's the last idx in log file, then return -ENOSPC
 	 * or wrap around if a catalog */
 	if (llog_is_full(loghandle) ||
@@ -710,6 +716,12 @@ out_unlock:
 	 * records. This also allows to handle Catalog wrap around case */
 	if (llh->llh_flags & LLOG_F_IS_FIXSIZE) {
 		lgi->lgi_off = llh->llh_hdr.lrh_len + (index - 1) * reclen;
+	} else if (lgi->lgi_attr.la_size != 0 && !dt_object_remote(o)) {
+		/* the header update above does not change the size of a
+		 * local llog and appends are serialized by lgh_lock (asserted
+		 * above), so the record goes right after the padding without
+		 * another attr_get */
+		lgi->lgi_off = rec_off;
 	} else {
 		rc = dt_attr_get(env, o, &lgi->lgi_attr);
 		if (rc) {
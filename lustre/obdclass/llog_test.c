@@ -2096,6 +2096,235 @@ ctxt_release:
 	RETURN(rc);
 }
 
+#define LLOG_TEST_11_LOGS	64
+#define LLOG_TEST_11_RECS	512
+
+struct llog_test_11_rec {
+	struct llog_rec_hdr	ltr_hdr;
+	__u64			ltr_seq;
+	struct llog_rec_tail	ltr_tail;
+} __attribute__((packed));
+
+struct llog_test_11_data {
+	atomic_t	ltd_count;
+	atomic64_t	ltd_sum;
+	/* last sequence seen, checked by the ordered passes only */
+	__u64		ltd_last;
+	bool		ltd_ordered;
+	bool		ltd_cancel;
+};
+
+static int test_11_cb(const struct lu_env *env, struct llog_handle *llh,
+		      struct llog_rec_hdr *rec, void *data)
+{
+	struct llog_test_11_rec *ltr = (struct llog_test_11_rec *)rec;
+	struct llog_test_11_data *ltd = data;
+
+	if (rec->lrh_type != LLOG_OP_MAGIC ||
+	    rec->lrh_len != sizeof(*ltr)) {
+		CERROR("invalid record type %x len %u at index %u\n",
+		       rec->lrh_type, rec->lrh_len, rec->lrh_index);
+		RETURN(-EINVAL);
+	}
+
+	if (ltd->ltd_ordered) {
+		if (ltr->ltr_seq != ltd->ltd_last + 1) {
+			CERROR("record %llu processed after %llu\n",
+			       ltr->ltr_seq, ltd->ltd_last);
+			RETURN(-ERANGE);
+		}
+		ltd->ltd_last = ltr->ltr_seq;
+	}
+	atomic_inc(&ltd->ltd_count);
+	atomic64_add(ltr->ltr_seq, &ltd->ltd_sum);
+
+	RETURN(ltd->ltd_cancel ? LLOG_DEL_RECORD : 0);
+}
+
+/* reopen the catalog, which drops all its cached plain llog handles */
+static int llog_test_11_reopen(const struct lu_env *env,
+			       struct llog_ctxt *ctxt,
+			       struct llog_handle **cath,
+			       struct llog_logid *logid)
+{
+	int rc;
+
+	if (*cath != NULL) {
+		rc = llog_cat_close(env, *cath);
+		*cath = NULL;
+		if (rc)
+			return rc;
+	}
+
+	rc = llog_open(env, ctxt, cath, logid, NULL, LLOG_OPEN_EXISTS);
+	if (rc) {
+		*cath = NULL;
+		return rc;
+	}
+
+	rc = llog_init_handle(env, *cath, LLOG_F_IS_CAT, &uuid);
+	if (rc) {
+		llog_cat_close(env, *cath);
+		*cath = NULL;
+	}
+	return rc;
+}
+
+static int llog_test_11_pass(const struct lu_env *env, char *pass,
+			     struct llog_handle *cath, int nthreads,
+			     int prefetch, bool ordered, bool cancel)
+{
+	const int total = LLOG_TEST_11_LOGS * LLOG_TEST_11_RECS;
+	struct llog_test_11_data ltd = {
+		.ltd_ordered = ordered,
+		.ltd_cancel = cancel,
+	};
+	ktime_t start;
+	int rc;
+
+	atomic_set(&ltd.ltd_count, 0);
+	atomic64_set(&ltd.ltd_sum, 0);
+
+	start = ktime_get();
+	if (nthreads == 0)
+		rc = llog_cat_process(env, cath, test_11_cb, &ltd, 0, 0);
+	else
+		rc = llog_cat_process_parallel(env, cath, test_11_cb, &ltd,
+					       nthreads, prefetch, ordered);
+	if (rc) {
+		CERROR("%s: processing failed: rc = %d\n", pass, rc);
+		return rc;
+	}
+
+	/* the sequence numbers are 1..total, each must be seen once */
+	if (atomic_read(&ltd.ltd_count) != total ||
+	    atomic64_read(&ltd.ltd_sum) != (__s64)total * (total + 1) / 2) {
+		CERROR("%s: processed %d records, sum %lld, expected %d\n",
+		       pass, atomic_read(&ltd.ltd_count),
+		       (long long)atomic64_read(&ltd.ltd_sum), total);
+		return -ERANGE;
+	}
+
+	CWARN("%s: %d threads %d prefetch %s: %d records in %lld usecs\n",
+	      pass, nthreads, prefetch, ordered ? "ordered" : "unordered",
+	      total, ktime_us_delta(ktime_get(), start));
+	return 0;
+}
+
+/* test parallel catalog processing and compare it with llog_cat_process() */
+static int llog_test_11(const struct lu_env *env, struct obd_device *obd)
+{
+	struct llog_handle *cath = NULL;
+	struct llog_test_11_rec ltr;
+	struct llog_logid logid;
+	struct llog_ctxt *ctxt;
+	struct dt_device *dt;
+	char name[10];
+	__u64 seq = 0;
+	int rc, rc2, i, j;
+
+	ENTRY;
+
+	ctxt = llog_get_context(obd, LLOG_TEST_ORIG_CTXT);
+	LASSERT(ctxt);
+
+	memset(&ltr, 0, sizeof(ltr));
+	ltr.ltr_hdr.lrh_len = ltr.ltr_tail.lrt_len = sizeof(ltr);
+	ltr.ltr_hdr.lrh_type = LLOG_OP_MAGIC;
+
+	snprintf(name, sizeof(name), "%x", llog_test_rand + 3);
+	CWARN("11a: create a catalog %s with %d plain llogs\n", name,
+	      LLOG_TEST_11_LOGS);
+	rc = llog_open_create(env, ctxt, &cath, NULL, name);
+	if (rc) {
+		CERROR("11a: llog_create with name %s failed: %d\n", name, rc);
+		GOTO(ctxt_release, rc);
+	}
+	rc = llog_init_handle(env, cath, LLOG_F_IS_CAT, &uuid);
+	if (rc) {
+		CERROR("11a: can't init llog handle: %d\n", rc);
+		GOTO(out, rc);
+	}
+	logid = cath->lgh_id;
+	dt = lu2dt_dev(cath->lgh_obj->do_lu.lo_dev);
+
+	for (i = 0; i < LLOG_TEST_11_LOGS; i++) {
+		for (j = 0; j < LLOG_TEST_11_RECS; j++) {
+			ltr.ltr_seq = ++seq;
+			rc = llog_cat_add(env, cath, &ltr.ltr_hdr, NULL);
+			if (rc) {
+				CERROR("11a: add record %llu failed: %d\n",
+				       seq, rc);
+				GOTO(out, rc);
+			}
+		}
+		/* a reopened catalog starts a new plain llog */
+		rc = llog_test_11_reopen(env, ctxt, &cath, &logid);
+		if (rc) {
+			CERROR("11a: reopen catalog failed: %d\n", rc);
+			GOTO(out, rc);
+		}
+	}
+
+	rc = verify_handle("11a", cath, LLOG_TEST_11_LOGS + 1);
+	if (rc)
+		GOTO(out, rc);
+
+	rc = dt_sync(env, dt);
+	if (rc) {
+		CERROR("11a: sync failed: %d\n", rc);
+		GOTO(out, rc);
+	}
+
+	CWARN("11b: process the catalog sequentially\n");
+	rc = llog_test_11_pass(env, "11b", cath, 0, 0, true, false);
+	if (rc)
+		GOTO(out, rc);
+
+	CWARN("11c: process the catalog in order with prefetch\n");
+	rc = llog_test_11_reopen(env, ctxt, &cath, &logid);
+	if (rc)
+		GOTO(out, rc);
+	rc = llog_test_11_pass(env, "11c", cath, 4, 8, true, false);
+	if (rc)
+		GOTO(out, rc);
+
+	CWARN("11d: process plain llogs in parallel\n");
+	rc = llog_test_11_reopen(env, ctxt, &cath, &logid);
+	if (rc)
+		GOTO(out, rc);
+	rc = llog_test_11_pass(env, "11d", cath, 4, 4, false, false);
+	if (rc)
+		GOTO(out, rc);
+
+	CWARN("11e: cancel all records in parallel\n");
+	rc = llog_test_11_pass(env, "11e", cath, 4, 4, false, true);
+	if (rc)
+		GOTO(out, rc);
+
+	/* all plain llogs are gone, only the catalog header is left */
+	rc = verify_handle("11e", cath, 1);
+	if (rc)
+		GOTO(out, rc);
+
+	rc = llog_destroy(env, cath);
+	if (rc)
+		CERROR("11e: destroy catalog failed: %d\n", rc);
+out:
+	if (cath != NULL) {
+		CWARN("11: close the catalog\n");
+		rc2 = llog_cat_close(env, cath);
+		if (rc2) {
+			CERROR("11: close catalog %s failed: %d\n", name, rc2);
+			if (rc == 0)
+				rc = rc2;
+		}
+	}
+ctxt_release:
+	llog_ctxt_put(ctxt);
+	RETURN(rc);
+}
+
 /*
  * -------------------------------------------------------------------------
  * Tests above, boring obd functions below
@@ -2154,6 +2383,10 @@ static int llog_run_tests(const struct lu_env *env, struct obd_device *obd)
 	if (rc)
 		GOTO(cleanup, rc);
 
+	rc = llog_test_11(env, obd);
+	if (rc)
+		GOTO(cleanup, rc);
+
 cleanup:
 	err = llog_destroy(env, llh);
 	if (err)
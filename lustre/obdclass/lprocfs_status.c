@@ -648,6 +648,21 @@ static const char *const obd_connect_names[] = {
 	"mne_nid_type",		/* 0x1000000 */
 	"lock_contend",		/* 0x2000000 */
 	"atomic_open_lock",	/* 0x4000000 */
+	"name_encryption",	/* 0x8000000 */
+	"mkdir_replay",		/* 0x10000000 */
+	"dmv_inherit",		/* 0x20000000 */
+	"encryption_fid2path",	/* 0x40000000 */
+	"replay_create",	/* 0x80000000 */
+	"large_nid",		/* 0x100000000 */
+	"compress",		/* 0x200000000 */
+	"unaligned_dio",	/* 0x400000000 */
+	"conn_policy",		/* 0x800000000 */
+	"mirror_id_fix",	/* 0x1000000000 */
+	"readdir_open",		/* 0x2000000000 */
+	"flr_ec",		/* 0x4000000000 */
+	"pipe_precreate",	/* 0x8000000000 */
+	"destroy_batch",	/* 0x10000000000 */
+	"quota_batch",		/* 0x20000000000 */
 	NULL
 };
 
@@ -222,6 +222,8 @@ static inline __u64 tgt_statfs_iavail(struct lu_tgt_desc *tgt)
  *
  * The final tgt weight is bavail >> 16 * iavail >> 8 minus the tgt and server
  * penalties.  See ltd_qos_penalties_calc() for how penalties are calculated.
+ * It is then reduced by ltq_load_cut/256, which the caller derives from the
+ * load reported by the target in obd_statfs::os_load.
  *
  * \param[in] tgt	target descriptor
  */
@@ -237,6 +239,9 @@ void lu_tgt_qos_weight_calc(struct lu_tgt_desc *tgt)
 		ltq->ltq_weight = 0;
 	else
 		ltq->ltq_weight = ltq->ltq_avail - penalty;
+
+	/* busy targets get proportionally fewer new objects */
+	ltq->ltq_weight -= (ltq->ltq_weight >> 8) * ltq->ltq_load_cut;
 }
 EXPORT_SYMBOL(lu_tgt_qos_weight_calc);
 
@@ -286,6 +291,7 @@ int lu_tgt_descs_init(struct lu_tgt_descs *ltd, bool is_mdt)
 			LMV_QOS_DEF_THRESHOLD_RR_PCT * 256 / 100;
 	} else {
 		ltd->ltd_qos.lq_prio_free = LOV_QOS_DEF_PRIO_FREE * 256 / 100;
+		ltd->ltd_qos.lq_prio_load = LOV_QOS_DEF_PRIO_LOAD * 256 / 100;
 		ltd->ltd_qos.lq_threshold_rr =
 			LOV_QOS_DEF_THRESHOLD_RR_PCT * 256 / 100;
 	}
@@ -584,7 +584,9 @@ static int lustre_lwp_connect(struct obd_device *lwp, bool is_mdt)
 	data->ocd_connect_flags |= OBD_CONNECT_FID | OBD_CONNECT_AT |
 		OBD_CONNECT_LRU_RESIZE | OBD_CONNECT_FULL20 |
 		OBD_CONNECT_LVB_TYPE | OBD_CONNECT_LIGHTWEIGHT |
-		OBD_CONNECT_LFSCK | OBD_CONNECT_BULK_MBITS;
+		OBD_CONNECT_LFSCK | OBD_CONNECT_BULK_MBITS |
+		OBD_CONNECT_FLAGS2;
+	data->ocd_connect_flags2 = OBD_CONNECT2_QUOTA_BATCH;
 
 	if (is_mdt)
 		data->ocd_connect_flags |= OBD_CONNECT_MDS_MDS;
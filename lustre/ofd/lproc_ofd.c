@@ -288,6 +288,69 @@ static ssize_t degraded_store(struct kobject *kobj, struct attribute *attr,
 }
 LUSTRE_RW_ATTR(degraded);
 
+/**
+ * Show the current short-term load of the OST.
+ *
+ * This is the value reported to the MDTs in obd_statfs::os_load, see
+ * ofd_load() for how it is calculated.
+ *
+ * \retval		number of bytes written
+ */
+static ssize_t load_show(struct kobject *kobj, struct attribute *attr,
+			 char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct ofd_device *ofd = ofd_dev(obd->obd_lu_dev);
+
+	return sprintf(buf, "%u\n", ofd_load(ofd));
+}
+LUSTRE_RO_ATTR(load);
+
+/**
+ * Show the number of BRW RPCs in progress at which the OST is 100% loaded.
+ *
+ * \retval		number of bytes written
+ */
+static ssize_t load_brw_busy_show(struct kobject *kobj, struct attribute *attr,
+				  char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct ofd_device *ofd = ofd_dev(obd->obd_lu_dev);
+
+	return sprintf(buf, "%u\n", ofd->ofd_load_brw_busy);
+}
+
+/**
+ * Set the number of BRW RPCs in progress at which the OST is 100% loaded.
+ *
+ * This should roughly match the number of requests the OST storage can
+ * serve concurrently. 0 disables the queue depth part of the load.
+ *
+ * \param[in] count	\a buffer length
+ *
+ * \retval		\a count on success
+ * \retval		negative number on error
+ */
+static ssize_t load_brw_busy_store(struct kobject *kobj, struct attribute *attr,
+				   const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct ofd_device *ofd = ofd_dev(obd->obd_lu_dev);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	ofd->ofd_load_brw_busy = val;
+	return count;
+}
+LUSTRE_RW_ATTR(load_brw_busy);
+
 /**
  * Show if the OFD is in no precreate mode.
  *
@@ -1107,6 +1170,8 @@ static struct attribute *ofd_attrs[] = {
 	&lustre_attr_precreate_batch.attr,
 	&lustre_attr_atime_diff.attr,
 	&lustre_attr_degraded.attr,
+	&lustre_attr_load.attr,
+	&lustre_attr_load_brw_busy.attr,
 	&lustre_attr_fstype.attr,
 	&lustre_attr_no_precreate.attr,
 	&lustre_attr_sync_journal.attr,
@@ -1468,6 +1468,56 @@ out_put:
 	return rc;
 }
 
+/**
+ * Remember the highest precreate request served on this connection
+ *
+ * The MDT may keep several precreate RPCs in flight, each one asking for
+ * the objects after the previous one. They can be handled out of order.
+ *
+ * \param[in] exp	export of the MDT
+ * \param[in] req	precreate request
+ * \param[in] seq	sequence of the objects
+ * \param[in] oid	highest object id asked for
+ */
+static void ofd_precreate_track(struct obd_export *exp,
+				struct ptlrpc_request *req, u64 seq, u64 oid)
+{
+	struct filter_export_data *fed = &exp->exp_filter_data;
+	__u32 conn_cnt = lustre_msg_get_conn_cnt(req->rq_reqmsg);
+
+	if (fed->fed_precreate_conn_cnt != conn_cnt ||
+	    fed->fed_precreate_seq != seq || fed->fed_precreate_oid < oid) {
+		fed->fed_precreate_conn_cnt = conn_cnt;
+		fed->fed_precreate_seq = seq;
+		fed->fed_precreate_oid = oid;
+	}
+}
+
+/**
+ * Check whether a precreate below LAST_ID was overtaken by a later one
+ *
+ * Such a request is harmless, all the objects it asks for already exist.
+ * A request below LAST_ID from a new connection still means the LAST_ID on
+ * the MDT is corrupted, see LU-5648.
+ *
+ * \param[in] exp	export of the MDT
+ * \param[in] req	precreate request
+ * \param[in] seq	sequence of the objects
+ * \param[in] oid	highest object id asked for
+ *
+ * \retval		true if a later precreate was already served
+ */
+static bool ofd_precreate_overtaken(struct obd_export *exp,
+				    struct ptlrpc_request *req, u64 seq,
+				    u64 oid)
+{
+	struct filter_export_data *fed = &exp->exp_filter_data;
+
+	return fed->fed_precreate_conn_cnt ==
+		lustre_msg_get_conn_cnt(req->rq_reqmsg) &&
+	       fed->fed_precreate_seq == seq && fed->fed_precreate_oid >= oid;
+}
+
 /**
  * OFD request handler for OST_CREATE RPC.
  *
@@ -1623,6 +1673,17 @@ static int ofd_create_hdl(struct tgt_session_info *tsi)
 				GOTO(out, rc = -EINVAL);
 			}
 
+			if (diff < 0 && ofd_precreate_overtaken(exp, req,
+								  seq, oid)) {
+				CDEBUG(D_HA, "%s: precreate "DOSTID
+				       " overtaken, last_id %llu\n",
+				       ofd_name(ofd), POSTID(&oa->o_oi),
+				       ofd_seq_last_oid(oseq));
+				rc = ostid_set_id(&rep_oa->o_oi,
+						  ofd_seq_last_oid(oseq));
+				GOTO(out, rc);
+			}
+
 			if (diff < 0) {
 				/* LU-5648 */
 				CERROR("%s: invalid precreate request for "
@@ -1632,6 +1693,7 @@ static int ofd_create_hdl(struct tgt_session_info *tsi)
 				       ofd_seq_last_oid(oseq));
 				GOTO(out, rc = -EINVAL);
 			}
+			ofd_precreate_track(exp, req, seq, oid);
 		}
 	}
 	if (diff > 0) {
@@ -1745,7 +1807,9 @@ out_sem:
  * OFD request handler for OST_DESTROY RPC.
  *
  * This is OFD-specific part of request handling. It destroys data objects
- * related to destroyed object on MDT.
+ * related to destroyed object on MDT. An MDT supporting the
+ * OBD_CONNECT2_DESTROY_BATCH feature may pass the FIDs of many objects in
+ * a single request, the number of objects handled is returned in o_misc.
  *
  * \param[in] tsi	target session environment for this request
  *
@@ -1787,6 +1851,65 @@ static int ofd_destroy_hdl(struct tgt_session_info *tsi)
 
 	repbody = req_capsule_server_get(tsi->tsi_pill, &RMF_OST_BODY);
 
+	/* batched destroy from MDT, FIDs of all the objects are in array */
+	if (exp_connect_flags2(tsi->tsi_exp) & OBD_CONNECT2_DESTROY_BATCH &&
+	    req_capsule_field_present(tsi->tsi_pill, &RMF_FID_ARRAY,
+				      RCL_CLIENT) &&
+	    req_capsule_get_size(tsi->tsi_pill, &RMF_FID_ARRAY,
+				 RCL_CLIENT) > 0) {
+		struct lu_fid *fids;
+		int size;
+		int handled;
+		int nr;
+		int i;
+
+		size = req_capsule_get_size(tsi->tsi_pill, &RMF_FID_ARRAY,
+					    RCL_CLIENT);
+		nr = size / sizeof(*fids);
+		if (nr * sizeof(*fids) != size)
+			GOTO(out, rc = -EPROTO);
+
+		fids = req_capsule_client_get(tsi->tsi_pill, &RMF_FID_ARRAY);
+		if (fids == NULL)
+			GOTO(out, rc = -EPROTO);
+
+		for (i = 0; i < nr; i++) {
+			struct ost_id oi;
+
+			if (req_capsule_req_need_swab(tsi->tsi_pill))
+				lustre_swab_lu_fid(&fids[i]);
+
+			/* IDIF FIDs may come without OST index */
+			rc = fid_to_ostid(&fids[i], &oi);
+			if (rc == 0)
+				rc = ostid_to_fid(&fids[i], &oi,
+					ofd->ofd_lut.lut_lsd.lsd_osd_index);
+			if (rc != 0)
+				GOTO(out, rc = -EPROTO);
+		}
+
+		CDEBUG(D_HA, "%s: Destroy %d objects from "DFID"\n",
+		       ofd_name(ofd), nr, PFID(&fids[0]));
+
+		rc = ofd_destroy_by_fids(tsi->tsi_env, ofd, fids, nr,
+					 &handled);
+		if (rc < 0)
+			CERROR("%s: error destroying object "DFID": rc = %d\n",
+			       ofd_name(ofd), PFID(&fids[handled]), rc);
+		else
+			/* missing objects are counted as handled too */
+			rc = 0;
+
+		/* the MDT keeps the records for the objects not handled */
+		repbody->oa.o_misc = handled;
+		repbody->oa.o_valid |= OBD_MD_FLOBJCOUNT;
+
+		ofd_counter_incr(tsi->tsi_exp, LPROC_OFD_STATS_DESTROY,
+				 tsi->tsi_jobid,
+				 ktime_us_delta(ktime_get(), kstart));
+		GOTO(out, rc);
+	}
+
 	/* check that o_misc makes sense */
 	if (body->oa.o_valid & OBD_MD_FLOBJCOUNT)
 		count = body->oa.o_misc;
@@ -2334,6 +2457,10 @@ static int ofd_ladvise_hdl(struct tgt_session_info *tsi)
 			rc = dt_ladvise(env, dob, ladvise->lla_start,
 					ladvise->lla_end, LU_LADVISE_DONTNEED);
 			break;
+		case LU_LADVISE_WILLWRITE:
+			rc = dt_ladvise(env, dob, ladvise->lla_start,
+					ladvise->lla_end, LU_LADVISE_WILLWRITE);
+			break;
 		}
 		if (rc != 0)
 			break;
@@ -2965,6 +3092,8 @@ static int ofd_init0(const struct lu_env *env, struct ofd_device *m,
 	m->ofd_sync_journal = 0;
 	ofd_slc_set(m);
 	m->ofd_soft_sync_limit = OFD_SOFT_SYNC_LIMIT_DEFAULT;
+	atomic_set(&m->ofd_brw_inflight, 0);
+	m->ofd_load_brw_busy = OFD_LOAD_BRW_BUSY_DEFAULT;
 
 	m->ofd_seq_count = 0;
 	INIT_LIST_HEAD(&m->ofd_inconsistency_list);
@@ -53,6 +53,13 @@
 
 #define OFD_SOFT_SYNC_LIMIT_DEFAULT 16
 
+/* number of objects destroyed in a single transaction by a batched
+ * OST_DESTROY, keep it small to not overflow the transaction */
+#define OFD_DESTROY_BATCH	16
+
+/* number of BRW RPCs in progress at which the OST is reported 100% loaded */
+#define OFD_LOAD_BRW_BUSY_DEFAULT 64
+
 /*
  * update atime if on-disk value older than client's one
  * by OFD_ATIME_DIFF or more
@@ -159,6 +166,13 @@ struct ofd_device {
 	struct attribute	*ofd_read_cache_max_filesize;
 	struct attribute	*ofd_write_cache_enable;
 	time64_t		 ofd_atime_diff;
+
+	/* short-term load reported to the MDTs in obd_statfs::os_load */
+	atomic_t		 ofd_brw_inflight;
+	unsigned int		 ofd_load_brw_busy;
+	/* BRW service time per page in nsec, fast average and baseline */
+	__u64			 ofd_brw_lat_avg;
+	__u64			 ofd_brw_lat_base;
 };
 
 static inline struct ofd_device *ofd_dev(struct lu_device *d)
@@ -289,6 +303,7 @@ struct ofd_thread_info {
 	};
 	struct range_lock		 fti_write_range;
 	unsigned			 fti_range_locked:1;
+	ktime_t				 fti_brw_start;
 };
 
 extern void target_recovery_fini(struct obd_device *obd);
@@ -316,6 +331,8 @@ int ofd_fiemap_get(const struct lu_env *env, struct ofd_device *ofd,
 extern const struct obd_ops ofd_obd_ops;
 int ofd_destroy_by_fid(const struct lu_env *env, struct ofd_device *ofd,
 		       const struct lu_fid *fid, int orphan);
+int ofd_destroy_by_fids(const struct lu_env *env, struct ofd_device *ofd,
+			const struct lu_fid *fids, int nr, int *handled);
 int ofd_statfs(const struct lu_env *env,  struct obd_export *exp,
 	       struct obd_statfs *osfs, time64_t max_age, __u32 flags);
 int ofd_obd_disconnect(struct obd_export *exp);
@@ -353,6 +370,7 @@ int ofd_commitrw(const struct lu_env *env, int cmd, struct obd_export *exp,
 		 struct obdo *oa, int objcount, struct obd_ioobj *obj,
 		 struct niobuf_remote *rnb, int npages,
 		 struct niobuf_local *lnb, int old_rc);
+__u32 ofd_load(struct ofd_device *ofd);
 
 /* ofd_trans.c */
 struct thandle *ofd_trans_create(const struct lu_env *env,
@@ -398,6 +416,8 @@ int ofd_object_fallocate(const struct lu_env *env, struct ofd_object *fo,
 			 __u64 start, __u64 end, int mode, struct lu_attr *la,
 			 struct obdo *oa);
 int ofd_destroy(const struct lu_env *, struct ofd_object *, int);
+int ofd_destroy_objects(const struct lu_env *env, struct ofd_device *ofd,
+			struct ofd_object **fos, int nr);
 int ofd_attr_get(const struct lu_env *env, struct ofd_object *fo,
 		 struct lu_attr *la);
 int ofd_attr_handle_id(const struct lu_env *env, struct ofd_object *fo,
@@ -971,9 +971,80 @@ int ofd_preprw(const struct lu_env *env, int cmd, struct obd_export *exp,
 		       exp->exp_obd->obd_name, cmd);
 		rc = -EPROTO;
 	}
+
+	/* ofd_commitrw() is called for every successful ofd_preprw() */
+	if (rc == 0) {
+		atomic_inc(&ofd->ofd_brw_inflight);
+		info->fti_brw_start = ktime_get();
+	}
 	RETURN(rc);
 }
 
+/**
+ * Account the service time of a finished BRW in the OST load.
+ *
+ * Two moving averages of the time between ofd_preprw() and the end of
+ * ofd_commitrw() per page are kept: a fast one following the current
+ * service time, and a slow baseline which reflects the usual service time
+ * of this OST. The ratio between the two is what ofd_load() reports, so
+ * that slow storage is not considered busy as such.
+ *
+ * The time is divided by the BRW size so that an OST doing large BRWs is
+ * not compared with the service time of its smallest ones. The baseline
+ * follows the samples slowly in both directions for the same reason, a
+ * single fast BRW does not reset it.
+ *
+ * \param[in] ofd	OFD device
+ * \param[in] start	time ofd_preprw() completed
+ * \param[in] npages	number of local pages of the BRW
+ */
+static void ofd_brw_load_account(struct ofd_device *ofd, ktime_t start,
+				 int npages)
+{
+	__u64 lat = max_t(s64, ktime_to_ns(ktime_sub(ktime_get(), start)), 1);
+	__u64 avg = READ_ONCE(ofd->ofd_brw_lat_avg);
+	__u64 base = READ_ONCE(ofd->ofd_brw_lat_base);
+
+	atomic_dec(&ofd->ofd_brw_inflight);
+
+	lat = max_t(__u64, div_u64(lat, max(npages, 1)), 1);
+	/* racy updates may lose a sample, which is fine for an estimate */
+	WRITE_ONCE(ofd->ofd_brw_lat_avg, avg ? avg - (avg >> 3) + (lat >> 3) :
+						lat);
+	WRITE_ONCE(ofd->ofd_brw_lat_base, base ? base - (base >> 12) +
+						 (lat >> 12) : lat);
+}
+
+/**
+ * Short-term load of the OST, in percent.
+ *
+ * This is the larger of the BRW queue depth relative to ofd_load_brw_busy
+ * and of the slowdown of the recent BRW service time compared to its
+ * baseline. It is reported to the MDTs in obd_statfs::os_load so the
+ * object allocator can steer new files away from busy OSTs.
+ *
+ * \param[in] ofd	OFD device
+ *
+ * \retval		load in range 0-100
+ */
+__u32 ofd_load(struct ofd_device *ofd)
+{
+	unsigned int busy = READ_ONCE(ofd->ofd_load_brw_busy);
+	__u64 avg = READ_ONCE(ofd->ofd_brw_lat_avg);
+	__u64 base = READ_ONCE(ofd->ofd_brw_lat_base);
+	__u32 queue = 0;
+	__u32 lat = 0;
+
+	if (busy > 0)
+		queue = min_t(__u32, 100, atomic_read(&ofd->ofd_brw_inflight) *
+					  100 / busy);
+	/* the service time doubling from the baseline is 50% busy */
+	if (base > 0 && avg > base)
+		lat = div64_u64((avg - base) * 100, avg);
+
+	return max(queue, lat);
+}
+
 /**
  * Drop reference on local buffers for read bulk IO.
  *
@@ -1465,8 +1536,11 @@ int ofd_commitrw(const struct lu_env *env, int cmd, struct obd_export *exp,
 		__u32 mapped_uid, mapped_gid, mapped_projid;
 
 		nodemap = nodemap_get_from_exp(exp);
-		if (IS_ERR(nodemap))
+		if (IS_ERR(nodemap)) {
+			ofd_brw_load_account(ofd, info->fti_brw_start,
+					     npages);
 			RETURN(PTR_ERR(nodemap));
+		}
 		mapped_uid = nodemap_map_id(nodemap, NODEMAP_UID,
 					    NODEMAP_FS_TO_CLIENT,
 					    oa->o_uid);
@@ -1569,5 +1643,6 @@ int ofd_commitrw(const struct lu_env *env, int cmd, struct obd_export *exp,
 		rc = -EPROTO;
 	}
 
+	ofd_brw_load_account(ofd, info->fti_brw_start, npages);
 	RETURN(rc);
 }
@@ -776,6 +776,12 @@ int ofd_statfs(const struct lu_env *env,  struct obd_export *exp,
 	if (ofd->ofd_no_precreate)
 		osfs->os_state |= OS_STATFS_NOPRECREATE;
 
+	osfs->os_load = ofd_load(ofd);
+	CDEBUG(D_CACHE, "%s: load %u%%: %d BRWs in progress, latency %llu/%lluns per page\n",
+	       ofd_name(ofd), osfs->os_load,
+	       atomic_read(&ofd->ofd_brw_inflight),
+	       ofd->ofd_brw_lat_avg, ofd->ofd_brw_lat_base);
+
 	if (obd->obd_self_export != exp && !exp_grant_param_supp(exp) &&
 	    current_blockbits > COMPAT_BSIZE_SHIFT) {
 		/*
@@ -950,6 +956,89 @@ int ofd_destroy_by_fid(const struct lu_env *env, struct ofd_device *ofd,
 	RETURN(rc);
 }
 
+/**
+ * Destroy a set of OFD objects by their FIDs.
+ *
+ * Used by the batched OST_DESTROY request handler. Objects are destroyed
+ * by groups of OFD_DESTROY_BATCH in a single transaction, the clients
+ * holding locks on them are told to drop their cache first just like
+ * ofd_destroy_by_fid() does. Processing stops at the first error other
+ * than missing object, all the FIDs before it are handled.
+ *
+ * \param[in] env	execution environment
+ * \param[in] ofd	OFD device
+ * \param[in] fids	FIDs of objects
+ * \param[in] nr	number of FIDs
+ * \param[out] handled	number of FIDs handled
+ *
+ * \retval		number of objects destroyed
+ * \retval		negative value on error
+ */
+int ofd_destroy_by_fids(const struct lu_env *env, struct ofd_device *ofd,
+			const struct lu_fid *fids, int nr, int *handled)
+{
+	struct ofd_thread_info *info = ofd_info(env);
+	union ldlm_policy_data policy = { .l_extent = { 0, OBD_OBJECT_EOF } };
+	struct ofd_object *fos[OFD_DESTROY_BATCH];
+	struct lustre_handle lockh;
+	int destroyed = 0;
+	int rc = 0;
+	int i = 0;
+
+	ENTRY;
+
+	*handled = 0;
+	while (i < nr && rc == 0) {
+		int start = i;
+		int count = 0;
+		int j;
+
+		for (; i < nr && count < OFD_DESTROY_BATCH; i++) {
+			struct ofd_object *fo;
+			__u64 flags = LDLM_FL_AST_DISCARD_DATA;
+
+			fo = ofd_object_find_exists(env, ofd, &fids[i]);
+			if (IS_ERR(fo)) {
+				if (PTR_ERR(fo) == -ENOENT)
+					continue;
+				rc = PTR_ERR(fo);
+				break;
+			}
+
+			ost_fid_build_resid(&fids[i], &info->fti_resid);
+			if (ldlm_cli_enqueue_local(env, ofd->ofd_namespace,
+						   &info->fti_resid,
+						   LDLM_EXTENT, &policy, LCK_PW,
+						   &flags, ldlm_blocking_ast,
+						   ldlm_completion_ast, NULL,
+						   NULL, 0, LVB_T_NONE, NULL,
+						   &lockh) == ELDLM_OK)
+				ldlm_lock_decref(&lockh, LCK_PW);
+
+			fos[count++] = fo;
+		}
+
+		if (count > 0) {
+			int rc2 = ofd_destroy_objects(env, ofd, fos, count);
+
+			if (rc2 < 0) {
+				/* nothing in this group was destroyed */
+				rc = rc2;
+				i = start;
+			} else {
+				destroyed += rc2;
+			}
+		}
+
+		for (j = 0; j < count; j++)
+			ofd_object_put(env, fos[j]);
+
+		*handled = i;
+	}
+
+	RETURN(destroyed > 0 || rc == 0 ? destroyed : rc);
+}
+
 /**
  * Implementation of obd_ops::o_destroy.
  *
@@ -1044,6 +1044,79 @@ out:
 	RETURN(rc);
 }
 
+/**
+ * Destroy a set of OFD objects in a single transaction.
+ *
+ * This function is used by the batched OST_DESTROY to save the transaction
+ * overhead per object. Objects which don't exist anymore are skipped.
+ *
+ * \param[in] env	execution environment
+ * \param[in] ofd	OFD device
+ * \param[in] fos	OFD objects
+ * \param[in] nr	number of objects, up to OFD_DESTROY_BATCH
+ *
+ * \retval		number of objects destroyed
+ * \retval		negative value on error
+ */
+int ofd_destroy_objects(const struct lu_env *env, struct ofd_device *ofd,
+			struct ofd_object **fos, int nr)
+{
+	struct thandle *th;
+	int destroyed = 0;
+	int rc = 0;
+	int rc2;
+	int i;
+
+	ENTRY;
+
+	LASSERT(nr <= OFD_DESTROY_BATCH);
+
+	th = ofd_trans_create(env, ofd);
+	if (IS_ERR(th))
+		RETURN(PTR_ERR(th));
+
+	for (i = 0; i < nr; i++) {
+		if (!ofd_object_exists(fos[i]))
+			continue;
+
+		rc = dt_declare_ref_del(env, ofd_object_child(fos[i]), th);
+		if (rc < 0)
+			GOTO(stop, rc);
+
+		rc = dt_declare_destroy(env, ofd_object_child(fos[i]), th);
+		if (rc < 0)
+			GOTO(stop, rc);
+	}
+
+	rc = ofd_trans_start(env, ofd, NULL, th);
+	if (rc)
+		GOTO(stop, rc);
+
+	for (i = 0; i < nr; i++) {
+		struct ofd_object *fo = fos[i];
+
+		ofd_write_lock(env, fo);
+		if (ofd_object_exists(fo)) {
+			tgt_fmd_drop(ofd_info(env)->fti_exp,
+				     &fo->ofo_header.loh_fid);
+			dt_ref_del(env, ofd_object_child(fo), th);
+			dt_destroy(env, ofd_object_child(fo), th);
+			destroyed++;
+		}
+		ofd_write_unlock(env, fo);
+	}
+stop:
+	/* no transno is needed if all the objects are gone meanwhile */
+	rc2 = ofd_trans_stop(env, ofd, th, rc ? rc : destroyed ? 0 : -ENOENT);
+	if (rc2)
+		CERROR("%s failed to stop transaction: %d\n",
+		       ofd_name(ofd), rc2);
+	if (!rc)
+		rc = rc2;
+
+	RETURN(rc ? rc : destroyed);
+}
+
 /**
  * Get OFD object attributes.
  *
@@ -1837,6 +1837,7 @@ static struct thandle *osd_trans_create(const struct lu_env *env,
 	th->th_result = 0;
 	oh->ot_credits = 0;
 	oh->oh_declared_ext = 0;
+	oh->oh_write_hint_quota = 0;
 	INIT_LIST_HEAD(&oh->ot_commit_dcb_list);
 	INIT_LIST_HEAD(&oh->ot_stop_dcb_list);
 	INIT_LIST_HEAD(&oh->ot_trunc_locks);
@@ -8139,6 +8140,7 @@ static int osd_device_init0(const struct lu_env *env,
 
 	o->od_full_scrub_ratio = OFSR_DEFAULT;
 	o->od_full_scrub_threshold_rate = FULL_SCRUB_THRESHOLD_RATE_DEFAULT;
+	o->od_scrub_ra_window = OSD_SCRUB_RA_WINDOW_DEFAULT;
 	rc = osd_mount(env, o, cfg);
 	if (rc != 0)
 		GOTO(out, rc);
@@ -156,6 +156,11 @@ struct osd_object {
 	struct list_head	oo_xattr_list;
 	struct lu_object_header *oo_header;
 	__u64			oo_dirent_count;
+
+	/* end of the range hinted by LU_LADVISE_WILLWRITE */
+	__u64			oo_write_hint_end;
+	/* offset up to which the hinted range was preallocated */
+	__u64			oo_write_hint_pos;
 };
 
 struct osd_obj_seq {
@@ -337,6 +342,9 @@ struct osd_device {
 	 * exceeds the osd_device::od_full_scrub_threshold_rate,
 	 * then trigger OI scrub to scan the whole device. */
 	__u64			 od_full_scrub_threshold_rate;
+	/* How many inodes ahead of the OI scrub position to read their
+	 * inode table blocks asynchronously, 0 to disable readahead. */
+	__u32			 od_scrub_ra_window;
 
 	/* a list of orphaned agent inodes, protected with od_osfs_lock */
 	struct list_head	 od_orphan_list;
@@ -375,6 +383,9 @@ enum osd_full_scrub_ratio {
 
 #define FULL_SCRUB_THRESHOLD_RATE_DEFAULT	60
 
+#define OSD_SCRUB_RA_WINDOW_DEFAULT	4096
+#define OSD_SCRUB_RA_WINDOW_MAX		(1U << 20)
+
 /* There are at most 15 uid/gid/projids are affected in a transaction, and
  * that's rename case:
  * - 3 for source parent uid & gid & projid;
@@ -424,6 +435,8 @@ struct osd_thandle {
 	struct lu_ref_link      ot_dev_link;
 	unsigned int		ot_credits;
 	unsigned int		oh_declared_ext;
+	/* bytes of write-intent preallocation charged to quota */
+	__u64			oh_write_hint_quota;
 
 	/* quota IDs related to the transaction */
 	unsigned short		ot_id_cnt;
@@ -472,6 +472,27 @@ static void osd_mark_page_io_done(struct osd_iobuf *iobuf,
 	}
 }
 
+/*
+ * Number of bio vectors needed for the run of physically contiguous blocks
+ * starting at @block_idx. A new bio is sized to this run rather than to the
+ * rest of the I/O, so fragmented I/O doesn't take a full BIO_MAX_PAGES
+ * vector from the bio pool for every fragment.
+ */
+static unsigned int osd_bio_run_vecs(const sector_t *blocks, int block_idx,
+				     int block_idx_end, int blocks_per_page)
+{
+	int max_blocks = BIO_MAX_PAGES * blocks_per_page;
+	int end = block_idx + 1;
+
+	while (end < block_idx_end && end - block_idx < max_blocks &&
+	       blocks[end] != 0 && blocks[end] == blocks[end - 1] + 1)
+		end++;
+
+	/* the run may start and end in the middle of a page */
+	return min_t(unsigned int, BIO_MAX_PAGES,
+		     DIV_ROUND_UP(end - block_idx, blocks_per_page) + 1);
+}
+
 static int osd_do_bio(struct osd_device *osd, struct inode *inode,
 		      struct osd_iobuf *iobuf, sector_t start_blocks,
 		      sector_t count)
@@ -499,6 +520,7 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
 	bool integrity_enabled;
 	struct blk_plug plug;
 	int blocks_left_page;
+	unsigned int nr_vecs;
 
 	ENTRY;
 
@@ -580,14 +602,14 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
 			}
 
 			bio_start_page_idx = page_idx;
-			/* allocate new bio */
-			bio = bio_alloc(GFP_NOIO, min(BIO_MAX_PAGES,
-					(block_idx_end - block_idx +
-					 blocks_left_page - 1)));
+			/* allocate new bio covering the contiguous run */
+			nr_vecs = osd_bio_run_vecs(blocks, block_idx + i,
+						   block_idx_end,
+						   blocks_per_page);
+			bio = bio_alloc(GFP_NOIO, nr_vecs);
 			if (bio == NULL) {
 				CERROR("Can't allocate bio %u pages\n",
-				       block_idx_end - block_idx +
-				       blocks_left_page - 1);
+				       nr_vecs);
 				rc = -ENOMEM;
 				goto out;
 			}
@@ -693,6 +715,49 @@ static int osd_map_remote_to_local(loff_t offset, ssize_t len, int *nrpages,
 	RETURN(rc);
 }
 
+/* order of the chunks backing the per-thread DIO pages, 1MB for 4KB pages */
+#define OSD_DIO_PAGES_ORDER	8
+
+/*
+ * Fill the per-thread DIO pages from index @cur with a physically contiguous
+ * chunk, so that adjacent pages of a large BRW are merged into one bio
+ * segment by bio_add_page(). The chunk is split into independent pages so
+ * they are released one by one in osd_key_fini(). Smaller chunks are tried
+ * when memory is fragmented.
+ */
+static int osd_dio_pages_alloc(struct osd_thread_info *oti, int cur,
+			       gfp_t gfp_mask)
+{
+	struct page *page = NULL;
+	int order;
+	int i;
+
+	order = min_t(int, OSD_DIO_PAGES_ORDER,
+		      ilog2(PTLRPC_MAX_BRW_PAGES - cur));
+	for (; order > 0; order--) {
+		page = alloc_pages(gfp_mask | __GFP_NORETRY | __GFP_NOWARN,
+				   order);
+		if (page) {
+			split_page(page, order);
+			break;
+		}
+	}
+	if (!page) {
+		page = alloc_page(gfp_mask);
+		if (!page)
+			return -ENOMEM;
+	}
+
+	for (i = 0; i < (1 << order); i++, page++) {
+		LASSERT(oti->oti_dio_pages[cur + i] == NULL);
+		oti->oti_dio_pages[cur + i] = page;
+		SetPagePrivate2(page);
+		lock_page(page);
+	}
+
+	return 0;
+}
+
 static struct page *osd_get_page(const struct lu_env *env, struct dt_object *dt,
 				 loff_t offset, gfp_t gfp_mask, bool cache)
 {
@@ -734,12 +799,9 @@ static struct page *osd_get_page(const struct lu_env *env, struct dt_object *dt,
 
 	if (unlikely(!page)) {
 		LASSERT(cur < PTLRPC_MAX_BRW_PAGES);
-		page = alloc_page(gfp_mask);
-		if (!page)
+		if (osd_dio_pages_alloc(oti, cur, gfp_mask))
 			return NULL;
-		oti->oti_dio_pages[cur] = page;
-		SetPagePrivate2(page);
-		lock_page(page);
+		page = oti->oti_dio_pages[cur];
 	}
 
 	ClearPageUptodate(page);
@@ -1369,6 +1431,107 @@ static int osd_is_mapped(struct dt_object *dt, __u64 offset,
 	return cached_extent->mapped;
 }
 
+/* how far beyond the current write a write-intent hint is preallocated */
+#define OSD_WRITE_HINT_WINDOW	(32ULL << 20)
+
+/*
+ * Whether a write ending at \a end falls into a LU_LADVISE_WILLWRITE range
+ * which has not been preallocated far enough ahead yet.
+ */
+static bool osd_write_hint_pending(struct osd_object *obj, __u64 end)
+{
+	return READ_ONCE(obj->oo_write_hint_end) > end &&
+	       READ_ONCE(obj->oo_write_hint_pos) <
+	       end + OSD_WRITE_HINT_WINDOW / 2;
+}
+
+/*
+ * Bytes of the write-intent hint of \a obj to preallocate after a write
+ * ending at \a end, starting at \a start. Never more than
+ * OSD_WRITE_HINT_WINDOW past the write, nor past the hinted range.
+ */
+static __u64 osd_write_hint_len(struct osd_object *obj, __u64 end,
+				__u64 *start)
+{
+	unsigned int blksize = 1 << obj->oo_inode->i_blkbits;
+	__u64 limit;
+
+	*start = max_t(__u64, round_up(end, blksize),
+		       READ_ONCE(obj->oo_write_hint_pos));
+	limit = min_t(__u64, READ_ONCE(obj->oo_write_hint_end),
+		      end + OSD_WRITE_HINT_WINDOW);
+	limit = round_up(limit, blksize);
+
+	return limit > *start ? limit - *start : 0;
+}
+
+/*
+ * Preallocate unwritten blocks past the end of the current write up to
+ * OSD_WRITE_HINT_WINDOW ahead, within the range the client announced
+ * with LU_LADVISE_WILLWRITE. Streaming writers then fill a few large
+ * extents instead of the many small ones mballoc picks for each RPC when
+ * several objects are written concurrently.
+ *
+ * This is best effort: it only uses the extent credit and the quota
+ * reserved for it in osd_declare_write_commit() and any failure is
+ * ignored, the write itself has already been mapped.
+ */
+static void osd_write_hint_prealloc(struct osd_object *obj,
+				    struct osd_thandle *oh, __u64 end)
+{
+	struct inode *inode = obj->oo_inode;
+	struct osd_device *osd = osd_obj2dev(obj);
+	struct ldiskfs_sb_info *sbi = LDISKFS_SB(inode->i_sb);
+	handle_t *handle = oh->ot_handle;
+	struct ldiskfs_map_blocks map;
+	__u64 start;
+	__u64 len;
+	int flags;
+	int rc;
+
+	if (!osd_write_hint_pending(obj, end) || oh->oh_declared_ext == 0 ||
+	    oh->oh_write_hint_quota == 0)
+		return;
+
+	if (osd->od_fallocate_zero_blocks ||
+	    !ldiskfs_test_inode_flag(inode, LDISKFS_INODE_EXTENTS))
+		return;
+
+	/* leave the remaining space to granted writes */
+	if (percpu_counter_read_positive(&sbi->s_freeclusters_counter) <
+	    ldiskfs_blocks_count(sbi->s_es) >> 3)
+		return;
+
+	/* don't allocate more than was charged to quota */
+	len = min(osd_write_hint_len(obj, end, &start),
+		  oh->oh_write_hint_quota);
+	if (len == 0)
+		return;
+
+	flags = LDISKFS_GET_BLOCKS_CREATE_UNWRIT_EXT |
+		LDISKFS_GET_BLOCKS_NO_NORMALIZE;
+#ifndef HAVE_LDISKFS_GET_BLOCKS_KEEP_SIZE
+	flags |= LDISKFS_GET_BLOCKS_KEEP_SIZE;
+#endif
+	map.m_lblk = start >> inode->i_blkbits;
+	map.m_len = len >> inode->i_blkbits;
+
+	oh->oh_declared_ext--;
+	rc = ldiskfs_map_blocks(handle, inode, &map, flags);
+	if (rc <= 0) {
+		CDEBUG(D_INODE, "%s: inode #%lu: prealloc %u+%u: rc = %d\n",
+		       osd_name(osd), inode->i_ino, map.m_lblk, map.m_len, rc);
+		return;
+	}
+
+#ifndef HAVE_LDISKFS_GET_BLOCKS_KEEP_SIZE
+	ldiskfs_set_inode_flag(inode, LDISKFS_INODE_EOFBLOCKS);
+#endif
+	WRITE_ONCE(obj->oo_write_hint_pos,
+		   (__u64)(map.m_lblk + rc) << inode->i_blkbits);
+	ldiskfs_mark_inode_dirty(handle, inode);
+}
+
 #define MAX_EXTENTS_PER_WRITE 100
 static int osd_declare_write_commit(const struct lu_env *env,
 				    struct dt_object *dt,
@@ -1385,6 +1548,8 @@ static int osd_declare_write_commit(const struct lu_env *env,
 	int			rc = 0;
 	int			credits = 0;
 	long long		quota_space = 0;
+	__u64			hint_start;
+	__u64			hint_len = 0;
 	struct osd_fextent	mapped = { 0 }, extent = { 0 };
 	enum osd_quota_local_flags local_flags = 0;
 	enum osd_qid_declare_flags declare_flags = OSD_QID_BLK;
@@ -1456,6 +1621,13 @@ static int osd_declare_write_commit(const struct lu_env *env,
 
 	extents += (extent.end - extent.start +
 		    extent_bytes - 1) / extent_bytes;
+	/* one more extent for preallocation of the write-intent hint */
+	if (osd_write_hint_pending(osd_dt_obj(dt), extent.end)) {
+		hint_len = osd_write_hint_len(osd_dt_obj(dt), extent.end,
+					      &hint_start);
+		if (hint_len > 0)
+			extents++;
+	}
 	/**
 	 * with system space usage growing up, mballoc codes won't
 	 * try best to scan block group to align best free extent as
@@ -1548,6 +1720,19 @@ out_declare:
 	if (local_flags & QUOTA_FL_OVER_PRJQUOTA)
 		lnb[0].lnb_flags |= OBD_BRW_OVER_PRJQUOTA;
 
+	/*
+	 * Preallocated blocks are charged to the file owner like written
+	 * ones, so reserve quota for them as well. Nothing is preallocated
+	 * if the owner is close to its limit or the reservation fails.
+	 */
+	oh->oh_write_hint_quota = 0;
+	if (rc == 0 && hint_len > 0 &&
+	    !(lnb[0].lnb_flags & OBD_BRW_OVER_ALLQUOTA) &&
+	    osd_declare_inode_qid(env, i_uid_read(inode), i_gid_read(inode),
+				  i_projid_read(inode), toqb(hint_len), oh,
+				  osd_dt_obj(dt), NULL, declare_flags) == 0)
+		oh->oh_write_hint_quota = hint_len;
+
 	if (rc == 0)
 		rc = osd_trunc_lock(osd_dt_obj(dt), oh, true);
 
@@ -1563,6 +1748,7 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
 	struct osd_iobuf *iobuf = &oti->oti_iobuf;
 	struct inode *inode = osd_dt_obj(dt)->oo_inode;
 	struct osd_device  *osd = osd_obj2dev(osd_dt_obj(dt));
+	__u64 end = 0;
 	int rc = 0, i, check_credits = 0;
 
 	LASSERT(inode);
@@ -1610,6 +1796,7 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
 		SetPageUptodate(lnb[i].lnb_page);
 
 		osd_iobuf_add_page(iobuf, &lnb[i]);
+		end = max(end, lnb[i].lnb_file_offset + lnb[i].lnb_len);
 	}
 
 	osd_trans_exec_op(env, thandle, OSD_OT_WRITE);
@@ -1621,6 +1808,10 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
 						 1, user_size,
 						 check_credits,
 						 thandle);
+		if (rc == 0 && check_credits)
+			osd_write_hint_prealloc(osd_dt_obj(dt),
+				container_of(thandle, struct osd_thandle,
+					     ot_super), end);
 	} else {
 		/* no pages to write, no transno is needed */
 		thandle->th_local = 1;
@@ -2502,11 +2693,18 @@ static int osd_punch(const struct lu_env *env, struct dt_object *dt,
 	 * this optimization on MDS till the client stop
 	 * to sent MDS_REINT (LU-11033) -bzzz
 	 */
-	if (osd->od_is_ost && i_size_read(inode) == start)
+	if (osd->od_is_ost && i_size_read(inode) == start &&
+	    READ_ONCE(obj->oo_write_hint_pos) <= start)
 		RETURN(0);
 
 	osd_trans_exec_op(env, th, OSD_OT_PUNCH);
 
+	/* truncate drops the write-intent hint and frees the blocks that
+	 * were preallocated for it past the new size
+	 */
+	WRITE_ONCE(obj->oo_write_hint_end, 0);
+	WRITE_ONCE(obj->oo_write_hint_pos, 0);
+
 	spin_lock(&inode->i_lock);
 	if (i_size_read(inode) < start)
 		grow = true;
@@ -2630,6 +2828,13 @@ static int osd_ladvise(const struct lu_env *env, struct dt_object *dt,
 						 start >> PAGE_SHIFT,
 						 (end - 1) >> PAGE_SHIFT);
 		break;
+	case LU_LADVISE_WILLWRITE:
+		/* remembered here, preallocated by osd_write_commit() */
+		if (end > READ_ONCE(obj->oo_write_hint_end))
+			WRITE_ONCE(obj->oo_write_hint_end, end);
+		if (start < READ_ONCE(obj->oo_write_hint_pos))
+			WRITE_ONCE(obj->oo_write_hint_pos, start);
+		break;
 	default:
 		rc = -ENOTSUPP;
 		break;
@@ -573,6 +573,46 @@ static ssize_t full_scrub_threshold_rate_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(full_scrub_threshold_rate);
 
+static ssize_t scrub_ra_window_show(struct kobject *kobj,
+				    struct attribute *attr, char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *dev = osd_dt_dev(dt);
+
+	LASSERT(dev);
+	if (unlikely(!dev->od_mnt))
+		return -EINPROGRESS;
+
+	return sprintf(buf, "%u\n", dev->od_scrub_ra_window);
+}
+
+static ssize_t scrub_ra_window_store(struct kobject *kobj,
+				     struct attribute *attr,
+				     const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *dev = osd_dt_dev(dt);
+	unsigned int val;
+	int rc;
+
+	LASSERT(dev);
+	if (unlikely(!dev->od_mnt))
+		return -EINPROGRESS;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc != 0)
+		return rc;
+
+	if (val > OSD_SCRUB_RA_WINDOW_MAX)
+		return -ERANGE;
+
+	dev->od_scrub_ra_window = val;
+	return count;
+}
+LUSTRE_RW_ATTR(scrub_ra_window);
+
 static ssize_t extent_bytes_allocation_show(struct kobject *kobj,
 					    struct attribute *attr, char *buf)
 {
@@ -880,6 +920,7 @@ static struct attribute *ldiskfs_attrs[] = {
 	&lustre_attr_pdo.attr,
 	&lustre_attr_full_scrub_ratio.attr,
 	&lustre_attr_full_scrub_threshold_rate.attr,
+	&lustre_attr_scrub_ra_window.attr,
 	&lustre_attr_extent_bytes_allocation.attr,
 	NULL,
 };
@@ -902,6 +902,98 @@ static void osd_scrub_join(const struct lu_env *env, struct osd_device *dev,
 	EXIT;
 }
 
+/* Same as ldiskfs_inode_table() and ldiskfs_inode_bitmap(), which are not
+ * exported by ldiskfs. */
+static inline ldiskfs_fsblk_t
+osd_scrub_itable_block(struct super_block *sb, struct ldiskfs_group_desc *desc)
+{
+	return le32_to_cpu(desc->bg_inode_table_lo) |
+	       (LDISKFS_DESC_SIZE(sb) >= LDISKFS_MIN_DESC_SIZE_64BIT ?
+		(ldiskfs_fsblk_t)le32_to_cpu(desc->bg_inode_table_hi) << 32 : 0);
+}
+
+static inline ldiskfs_fsblk_t
+osd_scrub_ibitmap_block(struct super_block *sb, struct ldiskfs_group_desc *desc)
+{
+	return le32_to_cpu(desc->bg_inode_bitmap_lo) |
+	       (LDISKFS_DESC_SIZE(sb) >= LDISKFS_MIN_DESC_SIZE_64BIT ?
+		(ldiskfs_fsblk_t)le32_to_cpu(desc->bg_inode_bitmap_hi) << 32 : 0);
+}
+
+/**
+ * Read ahead the inode table blocks for the inodes after \a pos.
+ *
+ * The scanner handles the inodes one by one, each osd_iget() may wait for
+ * its inode table block to be read, that makes the scanning bound to the
+ * device latency. Submit the reads for the inode table blocks (and inode
+ * bitmaps of the next groups) in a window ahead of the scanner without
+ * waiting, then the scanner handles the inodes as their blocks arrive.
+ *
+ * The window is refilled when half of it has been scanned. If the OI scrub
+ * is not running in full speed, then it is driven by the LFSCK with its
+ * speed limit, do not read ahead more than the otable-based iteration can
+ * prefetch, to avoid the read-ahead blocks being evicted before used.
+ */
+static void osd_scrub_readahead(struct osd_device *dev,
+				struct osd_iit_param *param,
+				__u64 pos, __u32 limit)
+{
+	struct super_block *sb = param->sb;
+	__u32 ipg = LDISKFS_INODES_PER_GROUP(sb);
+	__u32 ipb = LDISKFS_INODES_PER_BLOCK(sb);
+	__u32 window = dev->od_scrub_ra_window;
+	struct blk_plug plug;
+	__u64 end;
+
+	if (window == 0)
+		return;
+
+	if (!dev->od_scrub.os_scrub.os_full_speed)
+		window = min_t(__u32, window, OSD_OTABLE_IT_CACHE_SIZE);
+
+	if (param->ra_pos < pos || param->ra_pos > pos + window)
+		param->ra_pos = pos;
+	else if (param->ra_pos > pos + window / 2)
+		return;
+
+	end = min_t(__u64, pos + window, (__u64)limit + 1);
+	blk_start_plug(&plug);
+	while (param->ra_pos < end) {
+		struct ldiskfs_group_desc *desc;
+		ldiskfs_group_t bg = (param->ra_pos - 1) / ipg;
+		__u64 gbase = 1 + (__u64)bg * ipg;
+		__u64 gend = gbase + ipg;
+		ldiskfs_fsblk_t itable;
+		__u32 first;
+		__u32 last;
+
+		desc = ldiskfs_get_group_desc(sb, bg, NULL);
+		if (!desc)
+			break;
+
+		if (desc->bg_flags & cpu_to_le16(LDISKFS_BG_INODE_UNINIT))
+			goto next;
+
+		/* The bitmap of current group has been read by the caller. */
+		if (param->ra_pos == gbase && bg != param->bg)
+			sb_breadahead(sb, osd_scrub_ibitmap_block(sb, desc));
+
+		gend -= ldiskfs_itable_unused_count(sb, desc);
+		if (param->ra_pos >= min(gend, end))
+			goto next;
+
+		itable = osd_scrub_itable_block(sb, desc);
+		first = (param->ra_pos - gbase) / ipb;
+		last = (min(gend, end) - 1 - gbase) / ipb;
+		for (; first <= last; first++)
+			sb_breadahead(sb, itable + first);
+
+next:
+		param->ra_pos = min(gbase + ipg, end);
+	}
+	blk_finish_plug(&plug);
+}
+
 static int osd_inode_iteration(struct osd_thread_info *info,
 			       struct osd_device *dev, __u32 max, bool preload)
 {
@@ -1064,6 +1156,7 @@ full:
 				goto next_group;
 			}
 
+			osd_scrub_readahead(dev, param, *pos, limit);
 			rc = next(info, dev, param, &oic, noslot);
 			switch (rc) {
 			case SCRUB_NEXT_BREAK:
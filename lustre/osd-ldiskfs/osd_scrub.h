@@ -49,6 +49,8 @@ struct osd_iit_param {
 	__u32 gbase;
 	__u32 offset;
 	__u32 start;
+	/* the next inode whose inode table block is not read ahead yet */
+	__u64 ra_pos;
 };
 
 struct osd_scrub {
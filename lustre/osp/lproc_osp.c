@@ -298,6 +298,60 @@ static ssize_t max_rpcs_in_progress_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(max_rpcs_in_progress);
 
+/**
+ * Show maximum number of objects destroyed by a single RPC
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[out] buf	output buffer
+ * \retval		number of bytes written on success
+ * \retval		negative number on error
+ */
+static ssize_t max_destroy_batch_show(struct kobject *kobj,
+				      struct attribute *attr,
+				      char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+
+	return sprintf(buf, "%d\n", osp->opd_sync_max_destroy_batch);
+}
+
+/**
+ * Change maximum number of objects destroyed by a single RPC,
+ * 1 disables batching
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[in] buffer	string which represents the new maximum
+ * \param[in] count	\a buffer length
+ * \retval		\a count on success
+ * \retval		negative number on error
+ */
+static ssize_t max_destroy_batch_store(struct kobject *kobj,
+				       struct attribute *attr,
+				       const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > OSP_SYNC_DESTROY_BATCH_MAX)
+		return -ERANGE;
+
+	osp->opd_sync_max_destroy_batch = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(max_destroy_batch);
+
 /**
  * Show number of objects to precreate next time
  *
@@ -441,6 +495,66 @@ static ssize_t max_create_count_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(max_create_count);
 
+/**
+ * Show maximum number of precreate RPCs in flight
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[out] buf	output buffer
+ * \retval		number of bytes written on success
+ * \retval		negative number on error
+ */
+static ssize_t create_rpcs_in_flight_show(struct kobject *kobj,
+					  struct attribute *attr,
+					  char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+
+	if (!osp->opd_pre)
+		return -EINVAL;
+
+	return sprintf(buf, "%d\n", osp->opd_pre_max_rpcs_in_flight);
+}
+
+/**
+ * Change maximum number of precreate RPCs in flight
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[in] buffer	string which represents the new maximum
+ * \param[in] count	\a buffer length
+ * \retval		\a count on success
+ * \retval		negative number on error
+ */
+static ssize_t create_rpcs_in_flight_store(struct kobject *kobj,
+					   struct attribute *attr,
+					   const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+	unsigned int val;
+	int rc;
+
+	if (!osp->opd_pre)
+		return -EINVAL;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > OSP_PRE_RPCS_IN_FLIGHT_MAX)
+		return -ERANGE;
+
+	osp->opd_pre_max_rpcs_in_flight = val;
+	wake_up(&osp->opd_pre_waitq);
+
+	return count;
+}
+LUSTRE_RW_ATTR(create_rpcs_in_flight);
+
 /**
  * Show last id to assign in creation
  *
@@ -941,6 +1055,79 @@ osp_reserved_mb_low_seq_write(struct file *file, const char __user *buffer,
 }
 LDEBUGFS_SEQ_FOPS(osp_reserved_mb_low);
 
+/**
+ * Show precreate statistics: current create rate, precreate RPC latency
+ * and the histogram of the time spent waiting for precreated objects
+ *
+ * \param[in] m		seq_file handle
+ * \param[in] data	unused for single entry
+ * \retval		0 on success
+ * \retval		negative number on error
+ */
+static int osp_create_stats_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device *dev = m->private;
+	struct osp_device *osp = lu2osp_dev(dev->obd_lu_dev);
+	struct obd_histogram *hist;
+	unsigned long tot, cum = 0;
+	int i;
+
+	if (osp == NULL || osp->opd_pre == NULL)
+		return -EINVAL;
+
+	hist = &osp->opd_pre_wait_hist;
+	lprocfs_stats_header(m, ktime_get(), osp->opd_pre_stats_init, 25,
+			     ":", 1);
+	seq_printf(m, "create_count:        %d\n",
+		   osp->opd_pre_create_count);
+	seq_printf(m, "create_rate:         %u objs/s\n",
+		   osp->opd_pre_create_rate);
+	seq_printf(m, "rpc_latency:         %u usec\n",
+		   osp->opd_pre_rpc_latency);
+	seq_printf(m, "rpcs_in_flight:      %d\n",
+		   osp->opd_pre_rpcs_in_flight);
+
+	seq_puts(m, "\nreserve wait (usec)  waits   % cum %\n");
+	tot = lprocfs_oh_sum(hist);
+	for (i = 0; i < OBD_HIST_MAX && cum < tot; i++) {
+		unsigned long w = hist->oh_buckets[i];
+
+		cum += w;
+		seq_printf(m, "%u:\t\t%10lu %3u %3u\n",
+			   1U << i, w, pct(w, tot), pct(cum, tot));
+	}
+
+	return 0;
+}
+
+/**
+ * Reset precreate wait histogram
+ *
+ * \param[in] file	proc file
+ * \param[in] buffer	unused
+ * \param[in] count	\a buffer length
+ * \param[in] off	unused for single entry
+ * \retval		\a count on success
+ * \retval		negative number on error
+ */
+static ssize_t
+osp_create_stats_seq_write(struct file *file, const char __user *buffer,
+			   size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct obd_device *dev = m->private;
+	struct osp_device *osp = lu2osp_dev(dev->obd_lu_dev);
+
+	if (osp == NULL || osp->opd_pre == NULL)
+		return -EINVAL;
+
+	lprocfs_oh_clear(&osp->opd_pre_wait_hist);
+	osp->opd_pre_stats_init = ktime_get();
+
+	return count;
+}
+LDEBUGFS_SEQ_FOPS(osp_create_stats);
+
 static ssize_t force_sync_store(struct kobject *kobj, struct attribute *attr,
 				const char *buffer, size_t count)
 {
@@ -975,6 +1162,8 @@ static struct ldebugfs_vars ldebugfs_osp_obd_vars[] = {
 	  .fops =	&osp_reserved_mb_high_fops	},
 	{ .name =	"reserved_mb_low",
 	  .fops =	&osp_reserved_mb_low_fops	},
+	{ .name =	"create_stats",
+	  .fops =	&osp_create_stats_fops		},
 	{ NULL }
 };
 
@@ -1015,6 +1204,8 @@ static struct attribute *osp_obd_attrs[] = {
 	&lustre_attr_old_sync_processed.attr,
 	&lustre_attr_create_count.attr,
 	&lustre_attr_max_create_count.attr,
+	&lustre_attr_create_rpcs_in_flight.attr,
+	&lustre_attr_max_destroy_batch.attr,
 	NULL,
 };
 
@@ -62,6 +62,10 @@ struct osp_id_tracker {
 	atomic_t		 otr_refcount;
 };
 
+/* default and maximum number of precreate RPCs in flight per OST */
+#define OSP_PRE_RPCS_IN_FLIGHT_DEF	2
+#define OSP_PRE_RPCS_IN_FLIGHT_MAX	8
+
 struct osp_precreate {
 	/*
 	 * Precreation pool
@@ -85,6 +89,21 @@ struct osp_precreate {
 	int				 osp_pre_create_slow;
 	/* cleaning up orphans or recreating missing objects */
 	int				 osp_pre_recovering;
+	/* precreate RPCs sent and not replied yet, and the limit */
+	int				 osp_pre_rpcs_in_flight;
+	int				 osp_pre_max_rpcs_in_flight;
+	/* highest id asked for by the precreate RPCs in flight */
+	struct lu_fid			 osp_pre_requested_fid;
+	/* ids handed out since osp_pre_rate_stamp, used to estimate
+	 * the create rate (objects/s) */
+	__u64				 osp_pre_consumed;
+	ktime_t				 osp_pre_rate_stamp;
+	__u32				 osp_pre_create_rate;
+	/* average precreate RPC round trip time, usec */
+	__u32				 osp_pre_rpc_latency;
+	/* time spent by osp_precreate_reserve() waiting for objects */
+	struct obd_histogram		 osp_pre_wait_hist;
+	ktime_t				 osp_pre_stats_init;
 };
 
 struct osp_update_request_sub {
@@ -154,6 +173,11 @@ struct osp_rpc_lock {
 	unsigned int		rpcl_fakes;
 };
 
+/* max number of objects destroyed by a single OST_DESTROY RPC */
+#define OSP_SYNC_DESTROY_BATCH_MAX	128
+
+struct osp_sync_batch;
+
 struct osp_device {
 	struct dt_device		 opd_dt_dev;
 	/* corresponded OST index */
@@ -228,6 +252,11 @@ struct osp_device {
 	/* number of RPC in processing (including non-committed by OST) */
 	atomic_t			 opd_sync_rpcs_in_progress;
 	int				 opd_sync_max_rpcs_in_progress;
+	/* unlinks being collected into a single OST_DESTROY RPC,
+	 * accessed by the sync thread only */
+	struct osp_sync_batch		*opd_sync_batch;
+	/* max number of objects in the batch, 1 disables batching */
+	int				 opd_sync_max_destroy_batch;
 	/* osd api's commit cb control structure */
 	struct dt_txn_callback		 opd_sync_txn_cb;
 	/* last used change number -- semantically similar to transno */
@@ -287,6 +316,15 @@ struct osp_device {
 #define opd_pre_max_create_count	opd_pre->osp_pre_max_create_count
 #define opd_pre_create_slow		opd_pre->osp_pre_create_slow
 #define opd_pre_recovering		opd_pre->osp_pre_recovering
+#define opd_pre_rpcs_in_flight		opd_pre->osp_pre_rpcs_in_flight
+#define opd_pre_max_rpcs_in_flight	opd_pre->osp_pre_max_rpcs_in_flight
+#define opd_pre_requested_fid		opd_pre->osp_pre_requested_fid
+#define opd_pre_consumed		opd_pre->osp_pre_consumed
+#define opd_pre_rate_stamp		opd_pre->osp_pre_rate_stamp
+#define opd_pre_create_rate		opd_pre->osp_pre_create_rate
+#define opd_pre_rpc_latency		opd_pre->osp_pre_rpc_latency
+#define opd_pre_wait_hist		opd_pre->osp_pre_wait_hist
+#define opd_pre_stats_init		opd_pre->osp_pre_stats_init
 
 extern struct kmem_cache *osp_object_kmem;
 
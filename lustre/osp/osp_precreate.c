@@ -321,18 +321,49 @@ static inline int osp_objs_precreated(const struct lu_env *env,
  * because then there will be a long period of OSP being unavailable for the
  * new creations due to lenghty precreate RPC. Instead we ask for another
  * precreation ahead and hopefully have it ready before the current pool is
- * empty. Notice this function relies on an external locking.
+ * empty. The objects asked for by precreate RPCs still in flight count as
+ * part of the pool, so another RPC is only sent while those are not going
+ * to be enough, and never more than osp_precreate_max_rpcs() at once.
+ * Notice this function relies on an external locking.
  *
  * \param[in] env	LU environment provided by the caller
  * \param[in] d		OSP device
  *
  * \retval		0 - current pool is good enough, 1 - time to precreate
  */
+/**
+ * Return how many precreate RPCs may be in flight to the target
+ *
+ * Only OSTs with OBD_CONNECT2_PIPE_PRECREATE answer a precreate overtaken
+ * by a later one with their LAST_ID, older ones may take it for LAST_ID
+ * corruption, so they are sent one precreate RPC at a time.
+ *
+ * \param[in] d		OSP device
+ *
+ * \retval		maximum number of precreate RPCs in flight
+ */
+static inline int osp_precreate_max_rpcs(struct osp_device *d)
+{
+	if (d->opd_exp == NULL ||
+	    !(exp_connect_flags2(d->opd_exp) & OBD_CONNECT2_PIPE_PRECREATE))
+		return 1;
+
+	return d->opd_pre_max_rpcs_in_flight;
+}
+
 static inline int osp_precreate_near_empty_nolock(const struct lu_env *env,
 						  struct osp_device *d)
 {
 	int window = osp_objs_precreated(env, d);
 
+	if (d->opd_pre_rpcs_in_flight > 0) {
+		if (d->opd_pre_rpcs_in_flight >= osp_precreate_max_rpcs(d) ||
+		    osp_fid_end_seq(env, &d->opd_pre_requested_fid))
+			return 0;
+		window = osp_fid_diff(&d->opd_pre_requested_fid,
+				      &d->opd_pre_used_fid);
+	}
+
 	/* don't consider new precreation till OST is healty and
 	 * has free space */
 	return ((window - d->opd_pre_reserved < d->opd_pre_create_count / 2) &&
@@ -529,14 +560,32 @@ static int osp_precreate_rollover_new_seq(struct lu_env *env,
 	RETURN(rc);
 }
 
+/**
+ * Return the FID the next precreate RPC should start from
+ *
+ * Notice this function relies on an external locking.
+ *
+ * \param[in] osp	OSP device
+ *
+ * \retval		the last FID created or already asked for
+ */
+static inline struct lu_fid *osp_precreate_next_fid(struct osp_device *osp)
+{
+	if (osp->opd_pre_rpcs_in_flight > 0)
+		return &osp->opd_pre_requested_fid;
+
+	return &osp->opd_pre_last_created_fid;
+}
+
 /**
  * Find IDs available in current sequence
  *
  * The function calculates the highest possible ID and the number of IDs
  * available in the current sequence OSP is using. The number is limited
  * artifically by the caller (grow param) and the number of IDs available
- * in the sequence by nature. The function doesn't require an external
- * locking.
+ * in the sequence by nature. The IDs start right after the last one created
+ * or, if there are precreate RPCs in flight, after the last one requested.
+ * The function doesn't require an external locking.
  *
  * \param[in] env	LU environment provided by the caller
  * \param[in] osp	OSP device
@@ -560,7 +609,7 @@ static int osp_precreate_fids(const struct lu_env *env, struct osp_device *osp,
 		int rc;
 
 		spin_lock(&osp->opd_pre_lock);
-		last_fid = &osp->opd_pre_last_created_fid;
+		last_fid = osp_precreate_next_fid(osp);
 		fid_to_ostid(last_fid, oi);
 		end = min(ostid_id(oi) + *grow, IDIF_MAX_OID);
 		*grow = end - ostid_id(oi);
@@ -575,7 +624,7 @@ static int osp_precreate_fids(const struct lu_env *env, struct osp_device *osp,
 	}
 
 	spin_lock(&osp->opd_pre_lock);
-	*fid = osp->opd_pre_last_created_fid;
+	*fid = *osp_precreate_next_fid(osp);
 	end = fid->f_oid;
 	end = min((end + *grow), (__u64)LUSTRE_DATA_SEQ_MAX_WIDTH);
 	*grow = end - fid->f_oid;
@@ -589,13 +638,227 @@ static int osp_precreate_fids(const struct lu_env *env, struct osp_device *osp,
 }
 
 /**
- * Prepare and send precreate RPC
+ * Adjust the number of objects to precreate to the current create rate
  *
- * The function finds how many objects should be precreated.  Then allocates,
- * prepares and schedules precreate RPC synchronously. Upon reply the function
- * wakes up the threads waiting for the new objects on this target. If the
+ * The batch asked for by a precreate RPC should cover the objects consumed
+ * while the RPC is in flight, otherwise the MDT threads end up waiting in
+ * osp_precreate_reserve(). The create rate and the precreate RPC latency
+ * are both measured, so the batch is sized to last for two round trips.
+ * The count only grows while the OST is able to create all the objects it
+ * was asked for, and shrinks slowly once the rate drops. Notice this
+ * function relies on an external locking.
+ *
+ * \param[in] d		OSP device
+ */
+static void osp_precreate_adjust_count(struct osp_device *d)
+{
+	ktime_t now = ktime_get();
+	s64 elapsed = ktime_us_delta(now, d->opd_pre_rate_stamp);
+	u64 want;
+
+	if (elapsed >= USEC_PER_SEC / 10) {
+		u64 rate = div64_u64(d->opd_pre_consumed * USEC_PER_SEC,
+				     elapsed);
+
+		if (d->opd_pre_create_rate == 0)
+			d->opd_pre_create_rate = rate;
+		else
+			d->opd_pre_create_rate =
+				(d->opd_pre_create_rate * 3 + rate) / 4;
+		d->opd_pre_consumed = 0;
+		d->opd_pre_rate_stamp = now;
+	}
+
+	if (d->opd_pre_create_rate == 0 || d->opd_pre_rpc_latency == 0)
+		return;
+
+	want = div64_u64((u64)d->opd_pre_create_rate *
+			 d->opd_pre_rpc_latency * 2, USEC_PER_SEC);
+	want = clamp_t(u64, want, d->opd_pre_min_create_count,
+		       d->opd_pre_max_create_count / 2);
+
+	if (want > d->opd_pre_create_count && !d->opd_pre_create_slow)
+		d->opd_pre_create_count = want;
+	else if (want < d->opd_pre_create_count / 2)
+		d->opd_pre_create_count = max_t(int, want,
+					d->opd_pre_create_count / 2);
+}
+
+/**
+ * Update the precreate pool with the result of a precreate RPC
+ *
+ * The function moves the end of the pool to the last object reported by
+ * the target, then wakes up the threads waiting for the new objects. If the
  * target wasn't able to create all the objects requested, then the next
  * precreate will be asking for fewer objects (i.e. slow precreate down).
+ * With several precreate RPCs in flight a reply may be overtaken by a later
+ * one, in which case it brings nothing new and is just dropped.
+ *
+ * \param[in] d		OSP device
+ * \param[in] fid	last object created by the target
+ * \param[in] end	last object asked for
+ * \param[in] grow	number of objects asked for
+ * \param[in] rc	result of the precreate RPC
+ *
+ * \retval 0		on success
+ * \retval negative	negated errno on error
+ */
+static int osp_precreate_update_pool(struct osp_device *d, struct lu_fid *fid,
+				     struct lu_fid *end, int grow, int rc)
+{
+	int created;
+
+	ENTRY;
+
+	if (rc)
+		GOTO(out, rc);
+
+	if (osp_fid_diff(fid, &d->opd_pre_used_fid) <= 0) {
+		CERROR("%s: precreate fid "DFID" <= local used fid "DFID
+		       ": rc = %d\n", d->opd_obd->obd_name,
+		       PFID(fid), PFID(&d->opd_pre_used_fid), -ESTALE);
+		GOTO(out, rc = -ESTALE);
+	}
+
+	spin_lock(&d->opd_pre_lock);
+	if (osp_fid_diff(fid, &d->opd_pre_last_created_fid) <= 0) {
+		spin_unlock(&d->opd_pre_lock);
+		CDEBUG(D_HA, "%s: precreate "DFID" overtaken by "DFID"\n",
+		       d->opd_obd->obd_name, PFID(fid),
+		       PFID(&d->opd_pre_last_created_fid));
+		GOTO(out, rc = 0);
+	}
+
+	created = grow + osp_fid_diff(fid, end);
+	if (created < grow) {
+		/* the OST has not managed to create all the
+		 * objects we asked for */
+		d->opd_pre_create_count = max(created, OST_MIN_PRECREATE);
+		d->opd_pre_create_slow = 1;
+	} else {
+		/* the OST is able to keep up with the work,
+		 * we could consider increasing create_count
+		 * next time if needed */
+		d->opd_pre_create_slow = 0;
+	}
+
+	d->opd_pre_last_created_fid = *fid;
+	spin_unlock(&d->opd_pre_lock);
+
+	CDEBUG(D_HA, "%s: current precreated pool: "DFID"-"DFID"\n",
+	       d->opd_obd->obd_name, PFID(&d->opd_pre_used_fid),
+	       PFID(&d->opd_pre_last_created_fid));
+out:
+	/* now we can wakeup all users awaiting for objects */
+	osp_pre_update_status(d, rc);
+	wake_up(&d->opd_pre_user_waitq);
+
+	RETURN(rc);
+}
+
+struct osp_precreate_args {
+	struct osp_device	*opa_dev;
+	struct lu_fid		 opa_fid;
+	int			 opa_grow;
+	ktime_t			 opa_sent;
+};
+
+/**
+ * RPC interpret callback for OST_CREATE RPC
+ *
+ * Called by ptlrpcd once the precreate RPC is replied or failed. Updates
+ * the precreate pool and the RPC latency estimation, then lets the
+ * precreate thread send more RPCs.
+ *
+ * \param[in] env	LU environment provided by the caller
+ * \param[in] req	RPC replied
+ * \param[in] args	callback data
+ * \param[in] rc	RPC result
+ *
+ * \retval 0		on success
+ * \retval negative	negated errno on error
+ */
+static int osp_precreate_interpret(const struct lu_env *env,
+				   struct ptlrpc_request *req, void *args,
+				   int rc)
+{
+	struct osp_precreate_args *opa = args;
+	struct osp_device *d = opa->opa_dev;
+	struct ost_body *body;
+	struct lu_fid fid;
+	s64 latency;
+
+	ENTRY;
+
+	if (rc == -EINVAL &&
+	    osp_fid_diff(&opa->opa_fid, &d->opd_pre_requested_fid) < 0) {
+		/* older OSTs refuse a precreate overtaken by a later one */
+		CDEBUG(D_HA, "%s: precreate "DFID" overtaken: rc = %d\n",
+		       d->opd_obd->obd_name, PFID(&opa->opa_fid), rc);
+		GOTO(out, rc = 0);
+	}
+
+	if (rc) {
+		CERROR("%s: can't precreate: rc = %d\n", d->opd_obd->obd_name,
+		       rc);
+		if (req->rq_net_err)
+			/* have osp_precreate_reserve() to wait for repeat */
+			rc = -ENOTCONN;
+		GOTO(update, rc);
+	}
+	LASSERT(req->rq_transno == 0);
+
+	body = req_capsule_server_get(&req->rq_pill, &RMF_OST_BODY);
+	if (body == NULL)
+		GOTO(update, rc = -EPROTO);
+
+	ostid_to_fid(&fid, &body->oa.o_oi, d->opd_index);
+
+	latency = ktime_us_delta(ktime_get(), opa->opa_sent);
+	spin_lock(&d->opd_pre_lock);
+	if (d->opd_pre_rpc_latency == 0)
+		d->opd_pre_rpc_latency = latency;
+	else
+		d->opd_pre_rpc_latency = (d->opd_pre_rpc_latency * 3 +
+					  latency) / 4;
+	spin_unlock(&d->opd_pre_lock);
+
+update:
+	rc = osp_precreate_update_pool(d, &fid, &opa->opa_fid, opa->opa_grow,
+				       rc);
+out:
+	spin_lock(&d->opd_pre_lock);
+	d->opd_pre_rpcs_in_flight--;
+	spin_unlock(&d->opd_pre_lock);
+	wake_up(&d->opd_pre_waitq);
+
+	RETURN(rc);
+}
+
+/**
+ * Wait till all the precreate RPCs in flight are replied
+ *
+ * Orphan cleanup, sequence rollover and shutdown need a stable view of
+ * the precreate pool.
+ *
+ * \param[in] d		OSP device
+ */
+static void osp_precreate_wait_rpcs(struct osp_device *d)
+{
+	if (d->opd_pre == NULL)
+		return;
+
+	wait_event_idle(d->opd_pre_waitq, d->opd_pre_rpcs_in_flight == 0);
+}
+
+/**
+ * Prepare and send precreate RPC
+ *
+ * The function finds how many objects should be precreated.  Then allocates,
+ * prepares and schedules precreate RPC to ptlrpcd, the reply is handled by
+ * osp_precreate_interpret(). Up to osp_precreate_max_rpcs() precreate RPCs
+ * may be in flight, each one asking for the objects after the ones requested
+ * by the previous RPC, so the pool is refilled while an RPC is being served.
  *
  * \param[in] env	LU environment provided by the caller
  * \param[in] d		OSP device
@@ -606,10 +869,11 @@ static int osp_precreate_fids(const struct lu_env *env, struct osp_device *osp,
 static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 {
 	struct osp_thread_info	*oti = osp_env_info(env);
+	struct osp_precreate_args *opa;
 	struct ptlrpc_request	*req;
 	struct obd_import	*imp;
 	struct ost_body		*body;
-	int			 rc, grow, diff;
+	int			 rc, grow;
 	struct lu_fid		*fid = &oti->osi_fid;
 	ENTRY;
 
@@ -641,6 +905,7 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 	}
 
 	spin_lock(&d->opd_pre_lock);
+	osp_precreate_adjust_count(d);
 	if (d->opd_pre_create_count > d->opd_pre_max_create_count / 2)
 		d->opd_pre_create_count = d->opd_pre_max_create_count / 2;
 	grow = d->opd_pre_create_count;
@@ -649,12 +914,16 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
 	LASSERT(body);
 
-	*fid = d->opd_pre_last_created_fid;
 	rc = osp_precreate_fids(env, d, fid, &grow);
 	if (rc == 1)
 		/* Current seq has been used up*/
 		GOTO(out_req, rc = -ENOSPC);
 
+	opa = ptlrpc_req_async_args(opa, req);
+	opa->opa_dev = d;
+	opa->opa_fid = *fid;
+	opa->opa_grow = grow;
+
 	if (!osp_is_fid_client(d)) {
 		/* Non-FID client will always send seq 0 because of
 		 * compatiblity */
@@ -667,66 +936,27 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 
 	ptlrpc_request_set_replen(req);
 
-	if (OBD_FAIL_CHECK(OBD_FAIL_OSP_FAKE_PRECREATE))
-		GOTO(ready, rc = 0);
-
-	rc = ptlrpc_queue_wait(req);
-	if (rc) {
-		CERROR("%s: can't precreate: rc = %d\n", d->opd_obd->obd_name,
-		       rc);
-		if (req->rq_net_err)
-			/* have osp_precreate_reserve() to wait for repeat */
-			rc = -ENOTCONN;
-		GOTO(out_req, rc);
-	}
-	LASSERT(req->rq_transno == 0);
-
-	body = req_capsule_server_get(&req->rq_pill, &RMF_OST_BODY);
-	if (body == NULL)
-		GOTO(out_req, rc = -EPROTO);
-
-	ostid_to_fid(fid, &body->oa.o_oi, d->opd_index);
-
-ready:
-	if (osp_fid_diff(fid, &d->opd_pre_used_fid) <= 0) {
-		CERROR("%s: precreate fid "DFID" <= local used fid "DFID
-		       ": rc = %d\n", d->opd_obd->obd_name,
-		       PFID(fid), PFID(&d->opd_pre_used_fid), -ESTALE);
-		GOTO(out_req, rc = -ESTALE);
+	if (OBD_FAIL_CHECK(OBD_FAIL_OSP_FAKE_PRECREATE)) {
+		rc = osp_precreate_update_pool(d, &opa->opa_fid, &opa->opa_fid,
+					       grow, 0);
+		ptlrpc_req_finished(req);
+		RETURN(rc);
 	}
 
-	diff = osp_fid_diff(fid, &d->opd_pre_last_created_fid);
-
 	spin_lock(&d->opd_pre_lock);
-	if (diff < grow) {
-		/* the OST has not managed to create all the
-		 * objects we asked for */
-		d->opd_pre_create_count = max(diff, OST_MIN_PRECREATE);
-		d->opd_pre_create_slow = 1;
-	} else {
-		/* the OST is able to keep up with the work,
-		 * we could consider increasing create_count
-		 * next time if needed */
-		d->opd_pre_create_slow = 0;
-	}
+	d->opd_pre_requested_fid = opa->opa_fid;
+	d->opd_pre_rpcs_in_flight++;
+	spin_unlock(&d->opd_pre_lock);
 
-	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
-	fid_to_ostid(fid, &body->oa.o_oi);
+	req->rq_interpret_reply = osp_precreate_interpret;
+	opa->opa_sent = ktime_get();
+	ptlrpcd_add_req(req);
 
-	d->opd_pre_last_created_fid = *fid;
-	spin_unlock(&d->opd_pre_lock);
+	RETURN(0);
 
-	CDEBUG(D_HA, "%s: current precreated pool: "DFID"-"DFID"\n",
-	       d->opd_obd->obd_name, PFID(&d->opd_pre_used_fid),
-	       PFID(&d->opd_pre_last_created_fid));
 out_req:
-	/* now we can wakeup all users awaiting for objects */
 	osp_pre_update_status(d, rc);
 	wake_up(&d->opd_pre_user_waitq);
-
-	/* pause to let osp_precreate_reserve to go first */
-	CFS_FAIL_TIMEOUT(OBD_FAIL_OSP_PRECREATE_PAUSE, 2);
-
 	ptlrpc_req_finished(req);
 	RETURN(rc);
 }
@@ -1270,6 +1500,7 @@ static int osp_precreate_thread(void *_args)
 			/*
 			 * Clean up orphans or recreate missing objects.
 			 */
+			osp_precreate_wait_rpcs(d);
 			rc = osp_precreate_cleanup_orphans(env, d);
 			if (rc != 0) {
 				schedule_timeout_interruptible(cfs_time_seconds(1));
@@ -1311,6 +1542,7 @@ static int osp_precreate_thread(void *_args)
 
 			if (unlikely(osp_precreate_end_seq(env, d) &&
 				     osp_create_end_seq(env, d))) {
+				osp_precreate_wait_rpcs(d);
 				LCONSOLE_INFO("%s:%#llx is used up."
 					      " Update to new seq\n",
 					      d->opd_obd->obd_name,
@@ -1330,10 +1562,21 @@ static int osp_precreate_thread(void *_args)
 					CERROR("%s: cannot precreate objects:"
 					       " rc = %d\n",
 					       d->opd_obd->obd_name, rc);
+
+				/* pause to let osp_precreate_reserve to go
+				 * first, once the new objects are in the pool
+				 */
+				if (CFS_FAIL_PRECHECK(
+					OBD_FAIL_OSP_PRECREATE_PAUSE)) {
+					osp_precreate_wait_rpcs(d);
+					CFS_FAIL_TIMEOUT(
+						OBD_FAIL_OSP_PRECREATE_PAUSE, 2);
+				}
 			}
 		}
 	}
 
+	osp_precreate_wait_rpcs(d);
 	lu_env_fini(env);
 	OBD_FREE_PTR(args);
 
@@ -1415,6 +1658,7 @@ int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d,
 			  bool can_block)
 {
 	time64_t expire = ktime_get_seconds() + obd_timeout;
+	ktime_t wait_start = 0;
 	int precreated, rc, synced = 0;
 
 	ENTRY;
@@ -1506,6 +1750,8 @@ int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d,
 			break;
 		}
 
+		if (!wait_start)
+			wait_start = ktime_get();
 		if (wait_event_idle_timeout(
 			    d->opd_pre_user_waitq,
 			    osp_precreate_ready_condition(env, d),
@@ -1523,6 +1769,10 @@ int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d,
 		}
 	}
 
+	if (wait_start)
+		lprocfs_oh_tally_log2(&d->opd_pre_wait_hist,
+				      ktime_us_delta(ktime_get(), wait_start));
+
 	RETURN(rc);
 }
 
@@ -1578,6 +1828,7 @@ int osp_precreate_get_fid(const struct lu_env *env, struct osp_device *d,
 	d->opd_pre_used_fid.f_oid++;
 	memcpy(fid, &d->opd_pre_used_fid, sizeof(*fid));
 	d->opd_pre_reserved--;
+	d->opd_pre_consumed++;
 	/*
 	 * last_used_id must be changed along with getting new id otherwise
 	 * we might miscalculate gap causing object loss or leak
@@ -1734,6 +1985,11 @@ int osp_init_precreate(struct osp_device *d)
 	d->opd_pre_max_create_count = OST_MAX_PRECREATE;
 	d->opd_reserved_mb_high = 0;
 	d->opd_reserved_mb_low = 0;
+	d->opd_pre_rpcs_in_flight = 0;
+	d->opd_pre_max_rpcs_in_flight = OSP_PRE_RPCS_IN_FLIGHT_DEF;
+	d->opd_pre_rate_stamp = ktime_get();
+	d->opd_pre_stats_init = d->opd_pre_rate_stamp;
+	spin_lock_init(&d->opd_pre_wait_hist.oh_lock);
 
 	RETURN(0);
 }
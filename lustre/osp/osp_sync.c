@@ -75,6 +75,13 @@
  *
  * opd_sync_rpcs_in_flight is a number of RPC in flight.
  * we control this with OSP_MAX_RPCS_IN_FLIGHT
+ *
+ * if OST supports OBD_CONNECT2_DESTROY_BATCH, unlink records are collected
+ * in opd_sync_batch and sent as a single OST_DESTROY RPC carrying FIDs of
+ * up to opd_sync_max_destroy_batch objects. such RPC is counted once in
+ * opd_sync_rpcs_in_flight, but every record is counted in
+ * opd_sync_rpcs_in_progress. the batch is sent once it's full, any other
+ * record is found or the thread is going to sleep.
  */
 
 /* XXX: do math to learn reasonable threshold
@@ -86,12 +93,22 @@
 
 #define OSP_JOB_MAGIC		0x26112005
 
+/* unlink records collected for a single OST_DESTROY RPC */
+struct osp_sync_batch {
+	int			osb_count;
+	struct lu_fid		osb_fid[OSP_SYNC_DESTROY_BATCH_MAX];
+	struct ost_id		osb_oi[OSP_SYNC_DESTROY_BATCH_MAX];
+	struct llog_cookie	osb_cookie[OSP_SYNC_DESTROY_BATCH_MAX];
+};
+
 struct osp_job_req_args {
 	/** bytes reserved for ptlrpc_replay_req() */
 	struct ptlrpc_replay_async_args	jra_raa;
 	struct list_head		jra_committed_link;
 	struct list_head		jra_in_flight_link;
 	struct llog_cookie		jra_lcookie;
+	/* records of batched destroy, jra_lcookie is unused then */
+	struct osp_sync_batch		*jra_batch;
 	__u32				jra_magic;
 };
 
@@ -112,6 +129,18 @@ static inline int osp_sync_has_new_job(struct osp_device *d)
 		d->opd_sync_prev_done == 0;
 }
 
+static inline bool osp_sync_batch_conflict(struct osp_sync_batch *batch,
+					    struct ost_id *ostid)
+{
+	int i;
+
+	for (i = 0; i < batch->osb_count; i++)
+		if (memcmp(ostid, &batch->osb_oi[i], sizeof(*ostid)) == 0)
+			return true;
+
+	return false;
+}
+
 static inline int osp_sync_in_flight_conflict(struct osp_device *d,
 					     struct llog_rec_hdr *h)
 {
@@ -120,7 +149,8 @@ static inline int osp_sync_in_flight_conflict(struct osp_device *d,
 	int			 conflict = 0;
 
 	if (h == NULL || h->lrh_type == LLOG_GEN_REC ||
-	    list_empty(&d->opd_sync_in_flight_list))
+	    (list_empty(&d->opd_sync_in_flight_list) &&
+	     d->opd_sync_batch == NULL))
 		return conflict;
 
 	memset(&ostid, 0, sizeof(ostid));
@@ -147,6 +177,11 @@ static inline int osp_sync_in_flight_conflict(struct osp_device *d,
 		LBUG();
 	}
 
+	/* not sent yet, the batch is flushed before waiting */
+	if (d->opd_sync_batch != NULL &&
+	    osp_sync_batch_conflict(d->opd_sync_batch, &ostid))
+		return 1;
+
 	spin_lock(&d->opd_sync_lock);
 	list_for_each_entry(jra, &d->opd_sync_in_flight_list,
 			    jra_in_flight_link) {
@@ -155,6 +190,14 @@ static inline int osp_sync_in_flight_conflict(struct osp_device *d,
 
 		LASSERT(jra->jra_magic == OSP_JOB_MAGIC);
 
+		if (jra->jra_batch != NULL) {
+			if (osp_sync_batch_conflict(jra->jra_batch, &ostid)) {
+				conflict = 1;
+				break;
+			}
+			continue;
+		}
+
 		req = container_of((void *)jra, struct ptlrpc_request,
 				   rq_async_args);
 		body = req_capsule_client_get(&req->rq_pill,
@@ -542,6 +585,7 @@ static int osp_sync_interpret(const struct lu_env *env,
 {
 	struct osp_job_req_args *jra = args;
 	struct osp_device *d = req->rq_cb_data;
+	struct osp_sync_batch *batch = NULL;
 
 	if (jra->jra_magic != OSP_JOB_MAGIC) {
 		DEBUG_REQ(D_ERROR, req, "bad magic %u", jra->jra_magic);
@@ -553,10 +597,13 @@ static int osp_sync_interpret(const struct lu_env *env,
 	       atomic_read(&req->rq_refcount),
 	       rc, (unsigned) req->rq_transno);
 
-	if (rc == -ENOENT) {
+	if (rc == -ENOENT ||
+	    (rc == 0 && req->rq_transno == 0 && jra->jra_batch != NULL)) {
 		/*
 		 * we tried to destroy object or update attributes,
-		 * but object doesn't exist anymore - cancell llog record
+		 * but object doesn't exist anymore - cancell llog record.
+		 * A batch of objects all gone already is destroyed without
+		 * a transaction, no commit callback will come for it.
 		 */
 		LASSERT(req->rq_transno == 0);
 		LASSERT(list_empty(&jra->jra_committed_link));
@@ -580,11 +627,18 @@ static int osp_sync_interpret(const struct lu_env *env,
 			 req->rq_transno, rc, req->rq_import_generation,
 			 imp->imp_generation);
 		if (req->rq_transno == 0) {
+			int nr = 1;
+
 			/* this is the last time we see the request
 			 * if transno is not zero, then commit cb
 			 * will be called at some point */
-			LASSERT(atomic_read(&d->opd_sync_rpcs_in_progress) > 0);
-			atomic_dec(&d->opd_sync_rpcs_in_progress);
+			if (jra->jra_batch != NULL) {
+				nr = jra->jra_batch->osb_count;
+				batch = jra->jra_batch;
+			}
+			LASSERT(atomic_read(&d->opd_sync_rpcs_in_progress) >=
+				nr);
+			atomic_sub(nr, &d->opd_sync_rpcs_in_progress);
 		}
 
 		wake_up(&d->opd_sync_waitq);
@@ -600,7 +654,11 @@ static int osp_sync_interpret(const struct lu_env *env,
 
 	spin_lock(&d->opd_sync_lock);
 	list_del_init(&jra->jra_in_flight_link);
+	if (batch != NULL)
+		jra->jra_batch = NULL;
 	spin_unlock(&d->opd_sync_lock);
+	if (batch != NULL)
+		OBD_FREE_LARGE(batch, sizeof(*batch));
 	LASSERT(atomic_read(&d->opd_sync_rpcs_in_flight) > 0);
 	atomic_dec(&d->opd_sync_rpcs_in_flight);
 	if (unlikely(atomic_read(&d->opd_sync_barrier) > 0))
@@ -624,10 +682,10 @@ static int osp_sync_interpret(const struct lu_env *env,
  * \param[in] h		llog record
  * \param[in] req	request
  */
-static void osp_sync_send_new_rpc(struct osp_device *d,
-				  struct llog_handle *llh,
-				  struct llog_rec_hdr *h,
-				  struct ptlrpc_request *req)
+static void osp_sync_queue_rpc(struct osp_device *d,
+			       struct ptlrpc_request *req,
+			       struct llog_cookie *cookie,
+			       struct osp_sync_batch *batch)
 {
 	struct osp_job_req_args *jra;
 
@@ -636,9 +694,8 @@ static void osp_sync_send_new_rpc(struct osp_device *d,
 
 	jra = ptlrpc_req_async_args(jra, req);
 	jra->jra_magic = OSP_JOB_MAGIC;
-	jra->jra_lcookie.lgc_lgl = llh->lgh_id;
-	jra->jra_lcookie.lgc_subsys = LLOG_MDS_OST_ORIG_CTXT;
-	jra->jra_lcookie.lgc_index = h->lrh_index;
+	jra->jra_lcookie = *cookie;
+	jra->jra_batch = batch;
 	INIT_LIST_HEAD(&jra->jra_committed_link);
 	spin_lock(&d->opd_sync_lock);
 	list_add_tail(&jra->jra_in_flight_link, &d->opd_sync_in_flight_list);
@@ -647,6 +704,20 @@ static void osp_sync_send_new_rpc(struct osp_device *d,
 	ptlrpcd_add_req(req);
 }
 
+static void osp_sync_send_new_rpc(struct osp_device *d,
+				  struct llog_handle *llh,
+				  struct llog_rec_hdr *h,
+				  struct ptlrpc_request *req)
+{
+	struct llog_cookie cookie;
+
+	cookie.lgc_lgl = llh->lgh_id;
+	cookie.lgc_subsys = LLOG_MDS_OST_ORIG_CTXT;
+	cookie.lgc_index = h->lrh_index;
+
+	osp_sync_queue_rpc(d, req, &cookie, NULL);
+}
+
 
 /**
  * Allocate and prepare RPC for a new change.
@@ -659,13 +730,15 @@ static void osp_sync_send_new_rpc(struct osp_device *d,
  * \param[in] d		OSP device
  * \param[in] op	type of the change
  * \param[in] format	request format to be used
+ * \param[in] nr_fids	number of FIDs for batched OST_DESTROY, 0 otherwise
  *
  * \retval pointer		new request on success
  * \retval ERR_PTR(errno)	on error
  */
 static struct ptlrpc_request *osp_sync_new_job(struct osp_device *d,
 					       enum ost_cmd op,
-					       const struct req_format *format)
+					       const struct req_format *format,
+					       int nr_fids)
 {
 	struct ptlrpc_request	*req;
 	struct obd_import	*imp;
@@ -682,6 +755,10 @@ static struct ptlrpc_request *osp_sync_new_job(struct osp_device *d,
 	if (req == NULL)
 		RETURN(ERR_PTR(-ENOMEM));
 
+	if (nr_fids > 0)
+		req_capsule_set_size(&req->rq_pill, &RMF_FID_ARRAY, RCL_CLIENT,
+				     nr_fids * sizeof(struct lu_fid));
+
 	rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, op);
 	if (rc) {
 		ptlrpc_req_finished(req);
@@ -735,7 +812,7 @@ static int osp_sync_new_setattr_job(struct osp_device *d,
 		RETURN(1);
 	}
 
-	req = osp_sync_new_job(d, OST_SETATTR, &RQF_OST_SETATTR);
+	req = osp_sync_new_job(d, OST_SETATTR, &RQF_OST_SETATTR, 0);
 	if (IS_ERR(req))
 		RETURN(PTR_ERR(req));
 
@@ -796,7 +873,7 @@ static int osp_sync_new_unlink_job(struct osp_device *d,
 	ENTRY;
 	LASSERT(h->lrh_type == MDS_UNLINK_REC);
 
-	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY);
+	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY, 0);
 	if (IS_ERR(req))
 		RETURN(PTR_ERR(req));
 
@@ -822,9 +899,9 @@ static int osp_sync_new_unlink_job(struct osp_device *d,
  * specific bits and sends the RPC. Depending on the target (MDT or OST)
  * two different protocols are used. For MDT we use OUT (basically OSD API
  * updates transferred via a network). For OST we still use the old
- * protocol (OBD?), originally for compatibility. Later we can start to
- * use OUT for OST as well, this will allow batching and better code
- * unification.
+ * protocol (OBD?), originally for compatibility. OSTs supporting
+ * OBD_CONNECT2_DESTROY_BATCH get unlinks batched instead, see
+ * osp_sync_batch_add().
  *
  * \param[in] d		OSP device
  * \param[in] llh	llog handle where the record is stored
@@ -844,7 +921,7 @@ static int osp_sync_new_unlink64_job(struct osp_device *d,
 
 	ENTRY;
 	LASSERT(h->lrh_type == MDS_UNLINK64_REC);
-	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY);
+	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY, 0);
 	if (IS_ERR(req))
 		RETURN(PTR_ERR(req));
 
@@ -861,6 +938,167 @@ static int osp_sync_new_unlink64_job(struct osp_device *d,
 	RETURN(0);
 }
 
+/**
+ * Check whether unlink records can be batched.
+ *
+ * Only single object unlink records to OST supporting multi-object
+ * OST_DESTROY are batched. Records for a range of objects (left by
+ * precreate gaps) are sent as is.
+ *
+ * \param[in] d		OSP device
+ * \param[in] h		llog record
+ *
+ * \retval true		the record can be added to the batch
+ * \retval false		the record should be sent separately
+ */
+static bool osp_sync_can_batch(struct osp_device *d, struct llog_rec_hdr *h)
+{
+	struct llog_unlink64_rec *rec = (struct llog_unlink64_rec *)h;
+
+	if (h->lrh_type != MDS_UNLINK64_REC || rec->lur_count != 1)
+		return false;
+
+	if (d->opd_pre == NULL || d->opd_sync_max_destroy_batch <= 1)
+		return false;
+
+	return d->opd_exp != NULL &&
+	       exp_connect_flags2(d->opd_exp) & OBD_CONNECT2_DESTROY_BATCH;
+}
+
+/**
+ * Send the batch of unlink records.
+ *
+ * The function prepares a single OST_DESTROY RPC with FIDs of all the
+ * objects in the batch and sends it. The batch is attached to the RPC
+ * and released once the RPC is committed by OST or failed. If the RPC
+ * can't be allocated, the records are left in the llog to be processed
+ * on the next boot, just like for a failed RPC.
+ *
+ * \param[in] d		OSP device
+ */
+static void osp_sync_batch_send(struct osp_device *d)
+{
+	struct osp_sync_batch *batch = d->opd_sync_batch;
+	struct ptlrpc_request *req;
+	struct ost_body *body;
+	struct lu_fid *fids;
+
+	ENTRY;
+
+	if (batch == NULL)
+		RETURN_EXIT;
+
+	d->opd_sync_batch = NULL;
+	LASSERT(batch->osb_count > 0);
+
+	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY,
+			       batch->osb_count);
+	if (IS_ERR(req)) {
+		CDEBUG(D_HA, "%s: can't send batch of %d: rc = %ld\n",
+		       d->opd_obd->obd_name, batch->osb_count, PTR_ERR(req));
+		GOTO(out_free, 0);
+	}
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+	LASSERT(body);
+	body->oa.o_oi = batch->osb_oi[0];
+	body->oa.o_valid = OBD_MD_FLGROUP | OBD_MD_FLID;
+
+	fids = req_capsule_client_get(&req->rq_pill, &RMF_FID_ARRAY);
+	LASSERT(fids);
+	memcpy(fids, batch->osb_fid, batch->osb_count * sizeof(*fids));
+
+	CDEBUG(D_OTHER, "%s: destroy %d objects from "DOSTID"\n",
+	       d->opd_obd->obd_name, batch->osb_count,
+	       POSTID(&batch->osb_oi[0]));
+
+	osp_sync_queue_rpc(d, req, &batch->osb_cookie[0], batch);
+	RETURN_EXIT;
+
+out_free:
+	LASSERT(atomic_read(&d->opd_sync_rpcs_in_progress) >=
+		batch->osb_count);
+	atomic_sub(batch->osb_count, &d->opd_sync_rpcs_in_progress);
+	LASSERT(atomic_read(&d->opd_sync_rpcs_in_flight) > 0);
+	atomic_dec(&d->opd_sync_rpcs_in_flight);
+	OBD_FREE_LARGE(batch, sizeof(*batch));
+	EXIT;
+}
+
+/**
+ * Forget the batch not sent yet.
+ *
+ * Called when the sync thread is stopping, the records stay in the llog
+ * and will be processed on the next boot.
+ *
+ * \param[in] d		OSP device
+ */
+static void osp_sync_batch_abort(struct osp_device *d)
+{
+	struct osp_sync_batch *batch = d->opd_sync_batch;
+
+	if (batch == NULL)
+		return;
+
+	d->opd_sync_batch = NULL;
+	atomic_sub(batch->osb_count, &d->opd_sync_rpcs_in_progress);
+	atomic_dec(&d->opd_sync_rpcs_in_flight);
+	OBD_FREE_LARGE(batch, sizeof(*batch));
+}
+
+/**
+ * Add unlink record to the batch.
+ *
+ * The batch is allocated by the first record and sent once it's full.
+ *
+ * \param[in] d		OSP device
+ * \param[in] llh	llog handle where the record is stored
+ * \param[in] h		llog record
+ *
+ * \retval 0		on success
+ * \retval negative	negated errno on error
+ */
+static int osp_sync_batch_add(struct osp_device *d, struct llog_handle *llh,
+			      struct llog_rec_hdr *h)
+{
+	struct llog_unlink64_rec *rec = (struct llog_unlink64_rec *)h;
+	struct osp_sync_batch *batch = d->opd_sync_batch;
+	struct llog_cookie *cookie;
+	int rc;
+
+	ENTRY;
+	LASSERT(h->lrh_type == MDS_UNLINK64_REC);
+
+	if (batch == NULL) {
+		OBD_ALLOC_LARGE(batch, sizeof(*batch));
+		if (batch == NULL)
+			RETURN(-ENOMEM);
+		d->opd_sync_batch = batch;
+	}
+
+	rc = fid_to_ostid(&rec->lur_fid, &batch->osb_oi[batch->osb_count]);
+	if (rc < 0) {
+		if (batch->osb_count == 0) {
+			d->opd_sync_batch = NULL;
+			OBD_FREE_LARGE(batch, sizeof(*batch));
+		}
+		RETURN(rc);
+	}
+
+	batch->osb_fid[batch->osb_count] = rec->lur_fid;
+	cookie = &batch->osb_cookie[batch->osb_count];
+	cookie->lgc_lgl = llh->lgh_id;
+	cookie->lgc_subsys = LLOG_MDS_OST_ORIG_CTXT;
+	cookie->lgc_index = h->lrh_index;
+	batch->osb_count++;
+
+	if (batch->osb_count >= min(d->opd_sync_max_destroy_batch,
+				    OSP_SYNC_DESTROY_BATCH_MAX))
+		osp_sync_batch_send(d);
+
+	RETURN(0);
+}
+
 /**
  * Process llog records.
  *
@@ -884,6 +1122,7 @@ static void osp_sync_process_record(const struct lu_env *env,
 {
 	struct llog_handle	*cathandle = llh->u.phd.phd_cat_handle;
 	struct llog_cookie	 cookie;
+	bool			 batch;
 	int			 rc = 0;
 
 	ENTRY;
@@ -921,7 +1160,16 @@ static void osp_sync_process_record(const struct lu_env *env,
 
 	/* notice we increment counters before sending RPC, to be consistent
 	 * in RPC interpret callback which may happen very quickly */
-	atomic_inc(&d->opd_sync_rpcs_in_flight);
+	batch = osp_sync_can_batch(d, rec);
+	if (batch) {
+		/* the whole batch is a single RPC in flight */
+		if (d->opd_sync_batch == NULL)
+			atomic_inc(&d->opd_sync_rpcs_in_flight);
+	} else {
+		/* keep the order of changes */
+		osp_sync_batch_send(d);
+		atomic_inc(&d->opd_sync_rpcs_in_flight);
+	}
 	atomic_inc(&d->opd_sync_rpcs_in_progress);
 
 	switch (rec->lrh_type) {
@@ -930,7 +1178,10 @@ static void osp_sync_process_record(const struct lu_env *env,
 		rc = osp_sync_new_unlink_job(d, llh, rec);
 		break;
 	case MDS_UNLINK64_REC:
-		rc = osp_sync_new_unlink64_job(d, llh, rec);
+		if (batch)
+			rc = osp_sync_batch_add(d, llh, rec);
+		else
+			rc = osp_sync_new_unlink64_job(d, llh, rec);
 		break;
 	case MDS_SETATTR64_REC:
 		rc = osp_sync_new_setattr_job(d, llh, rec);
@@ -953,7 +1204,9 @@ static void osp_sync_process_record(const struct lu_env *env,
 	}
 	atomic64_inc(&d->opd_sync_processed_recs);
 	if (rc != 0) {
-		atomic_dec(&d->opd_sync_rpcs_in_flight);
+		/* the batch holds the slot in flight for the others */
+		if (!batch || d->opd_sync_batch == NULL)
+			atomic_dec(&d->opd_sync_rpcs_in_flight);
 		atomic_dec(&d->opd_sync_rpcs_in_progress);
 	}
 
@@ -978,6 +1231,48 @@ static void osp_sync_process_record(const struct lu_env *env,
 	RETURN_EXIT;
 }
 
+/**
+ * Find how many records of the committed batch can be cancelled.
+ *
+ * OST handles the objects in order and stops at the first error, the
+ * number of objects handled (destroyed or found missing) is returned
+ * in o_misc. The records not handled are kept in the llog.
+ *
+ * \param[in] req	batched OST_DESTROY request
+ * \param[in] batch	records of the request
+ *
+ * \retval		number of records to cancel
+ */
+static int osp_sync_batch_handled(struct ptlrpc_request *req,
+				  struct osp_sync_batch *batch)
+{
+	struct ost_body *repbody;
+
+	repbody = req_capsule_server_get(&req->rq_pill, &RMF_OST_BODY);
+	if (repbody != NULL && repbody->oa.o_valid & OBD_MD_FLOBJCOUNT)
+		return min_t(__u32, repbody->oa.o_misc, batch->osb_count);
+
+	if (req->rq_status == -ENOENT)
+		return batch->osb_count;
+
+	return 1;
+}
+
+static void osp_sync_cancel_arr(const struct lu_env *env,
+				struct osp_device *d, struct llog_handle *llh,
+				struct llog_logid *lgid, int *arr, int nr)
+{
+	int rc;
+
+	rc = llog_cat_cancel_arr_rec(env, llh, lgid, nr, arr);
+	if (rc)
+		CERROR("%s: can't cancel %d records: rc = %d\n",
+		       d->opd_obd->obd_name, nr, rc);
+	else
+		CDEBUG(D_OTHER, "%s: massive records cancel id "DFID" num %d\n",
+		       d->opd_obd->obd_name, PFID(&lgid->lgl_oi.oi_fid), nr);
+}
+
 /**
  * Cancel llog records for the committed changes.
  *
@@ -999,7 +1294,7 @@ static void osp_sync_process_committed(const struct lu_env *env,
 	struct llog_handle	*llh;
 	int			*arr, arr_size;
 	LIST_HEAD(list);
-	struct list_head	 *le;
+	struct osp_job_req_args	*jra;
 	struct llog_logid	 lgid;
 	int			 rc, i, count = 0, done = 0;
 
@@ -1035,8 +1330,8 @@ static void osp_sync_process_committed(const struct lu_env *env,
 	INIT_LIST_HEAD(&d->opd_sync_committed_there);
 	spin_unlock(&d->opd_sync_lock);
 
-	list_for_each(le, &list)
-		count++;
+	list_for_each_entry(jra, &list, jra_committed_link)
+		count += jra->jra_batch ? jra->jra_batch->osb_count : 1;
 	if (count > 2) {
 		arr_size = sizeof(int) * count;
 		/* limit cookie array to order 2 */
@@ -1049,7 +1344,9 @@ static void osp_sync_process_committed(const struct lu_env *env,
 	}
 	i = 0;
 	while (!list_empty(&list)) {
-		struct osp_job_req_args	*jra;
+		struct osp_sync_batch	*batch;
+		struct llog_cookie	*cookies;
+		int			 nr, j;
 
 		jra = list_entry(list.next, struct osp_job_req_args,
 				 jra_committed_link);
@@ -1061,44 +1358,60 @@ static void osp_sync_process_committed(const struct lu_env *env,
 		body = req_capsule_client_get(&req->rq_pill,
 					      &RMF_OST_BODY);
 		LASSERT(body);
+
+		batch = jra->jra_batch;
+		if (batch != NULL) {
+			cookies = batch->osb_cookie;
+			nr = osp_sync_batch_handled(req, batch);
+			done += batch->osb_count;
+		} else {
+			cookies = &jra->jra_lcookie;
+			nr = 1;
+			done++;
+		}
+
 		/* import can be closing, thus all commit cb's are
 		 * called we can check committness directly */
-		if (req->rq_import_generation == imp->imp_generation) {
+		if (req->rq_import_generation != imp->imp_generation) {
+			DEBUG_REQ(D_OTHER, req, "imp_committed = %llu",
+				  imp->imp_peer_committed_transno);
+			nr = 0;
+		}
+
+		for (j = 0; j < nr; j++) {
 			if (arr && (!i ||
-				    !memcmp(&jra->jra_lcookie.lgc_lgl, &lgid,
+				    !memcmp(&cookies[j].lgc_lgl, &lgid,
 					   sizeof(lgid)))) {
 				if (unlikely(!i))
-					lgid = jra->jra_lcookie.lgc_lgl;
+					lgid = cookies[j].lgc_lgl;
 
-				arr[i++] = jra->jra_lcookie.lgc_index;
+				arr[i++] = cookies[j].lgc_index;
 			} else {
 				rc = llog_cat_cancel_records(env, llh, 1,
-							     &jra->jra_lcookie);
+							     &cookies[j]);
 				if (rc)
 					CERROR("%s: can't cancel record: rc = %d\n",
 					       obd->obd_name, rc);
 			}
-		} else {
-			DEBUG_REQ(D_OTHER, req, "imp_committed = %llu",
-				  imp->imp_peer_committed_transno);
+			if (arr && (i * sizeof(int)) == arr_size) {
+				osp_sync_cancel_arr(env, d, llh, &lgid, arr, i);
+				i = 0;
+			}
 		}
-		ptlrpc_req_finished(req);
-		done++;
-		if (arr &&
-		    ((i * sizeof(int)) == arr_size ||
-		     (list_empty(&list) && i > 0))) {
-			rc = llog_cat_cancel_arr_rec(env, llh, &lgid, i, arr);
 
-			if (rc)
-				CERROR("%s: can't cancel %d records: rc = %d\n",
-				       obd->obd_name, i, rc);
-			else
-				CDEBUG(D_OTHER, "%s: massive records cancel id "DFID" num %d\n",
-				       obd->obd_name, PFID(&lgid.lgl_oi.oi_fid),
-				       i);
+		if (batch != NULL) {
+			/* the request can be still in flight if committed
+			 * before the reply is interpreted */
+			spin_lock(&d->opd_sync_lock);
+			jra->jra_batch = NULL;
+			spin_unlock(&d->opd_sync_lock);
+			OBD_FREE_LARGE(batch, sizeof(*batch));
+		}
+		ptlrpc_req_finished(req);
+		if (arr && list_empty(&list) && i > 0) {
+			osp_sync_cancel_arr(env, d, llh, &lgid, arr, i);
 			i = 0;
 		}
-
 	}
 
 	if (arr)
@@ -1174,6 +1487,9 @@ static int osp_sync_process_queues(const struct lu_env *env,
 			    cfs_fail_val != 1)
 			msleep(1 * MSEC_PER_SEC);
 
+		/* no more records for now, don't hold the batch */
+		osp_sync_batch_send(d);
+
 		wait_event_idle(d->opd_sync_waitq,
 				!d->opd_sync_task ||
 				osp_sync_can_process_new(d, rec) ||
@@ -1299,6 +1615,8 @@ next:
 		 atomic_read(&d->opd_sync_rpcs_in_flight));
 
 wait:
+	osp_sync_batch_abort(d);
+
 	/* wait till all the requests are completed */
 	count = 0;
 	while (atomic_read(&d->opd_sync_rpcs_in_progress) > 0) {
@@ -1520,6 +1838,8 @@ int osp_sync_init(const struct lu_env *env, struct osp_device *d)
 
 	d->opd_sync_max_rpcs_in_flight = OSP_MAX_RPCS_IN_FLIGHT;
 	d->opd_sync_max_rpcs_in_progress = OSP_MAX_RPCS_IN_PROGRESS;
+	d->opd_sync_max_destroy_batch = OSP_SYNC_DESTROY_BATCH_MAX;
+	d->opd_sync_batch = NULL;
 	spin_lock_init(&d->opd_sync_lock);
 	init_waitqueue_head(&d->opd_sync_waitq);
 	init_waitqueue_head(&d->opd_sync_barrier_waitq);
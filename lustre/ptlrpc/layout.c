@@ -102,9 +102,10 @@ static const struct req_msg_field *quotactl_only[] = {
 	&RMF_OBD_QUOTACTL
 };
 
-static const struct req_msg_field *quota_body_only[] = {
+static const struct req_msg_field *quota_dqacq_only[] = {
 	&RMF_PTLRPC_BODY,
-	&RMF_QUOTA_BODY
+	&RMF_QUOTA_BODY,
+	&RMF_QUOTA_BODY_ARRAY
 };
 
 static const struct req_msg_field *ldlm_intent_quota_client[] = {
@@ -627,10 +628,11 @@ static const struct req_msg_field *ost_body_capa[] = {
 };
 
 static const struct req_msg_field *ost_destroy_client[] = {
-        &RMF_PTLRPC_BODY,
-        &RMF_OST_BODY,
-        &RMF_DLM_REQ,
-        &RMF_CAPA1
+	&RMF_PTLRPC_BODY,
+	&RMF_OST_BODY,
+	&RMF_DLM_REQ,
+	&RMF_CAPA1,
+	&RMF_FID_ARRAY
 };
 
 
@@ -1004,6 +1006,11 @@ struct req_msg_field RMF_QUOTA_BODY =
 		    sizeof(struct quota_body), lustre_swab_quota_body, NULL);
 EXPORT_SYMBOL(RMF_QUOTA_BODY);
 
+struct req_msg_field RMF_QUOTA_BODY_ARRAY =
+	DEFINE_MSGF("quota_body_array", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct quota_body), lustre_swab_quota_body, NULL);
+EXPORT_SYMBOL(RMF_QUOTA_BODY_ARRAY);
+
 struct req_msg_field RMF_MDT_EPOCH =
         DEFINE_MSGF("mdt_ioepoch", 0,
                     sizeof(struct mdt_ioepoch), lustre_swab_mdt_ioepoch, NULL);
@@ -1407,7 +1414,7 @@ struct req_format RQF_OST_QUOTACTL =
 EXPORT_SYMBOL(RQF_OST_QUOTACTL);
 
 struct req_format RQF_QUOTA_DQACQ =
-	DEFINE_REQ_FMT0("QUOTA_DQACQ", quota_body_only, quota_body_only);
+	DEFINE_REQ_FMT0("QUOTA_DQACQ", quota_dqacq_only, quota_dqacq_only);
 EXPORT_SYMBOL(RQF_QUOTA_DQACQ);
 
 struct req_format RQF_LDLM_INTENT_QUOTA =
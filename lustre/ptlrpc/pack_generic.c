@@ -1845,7 +1845,7 @@ void lustre_swab_obd_statfs(struct obd_statfs *os)
 	__swab32s(&os->os_state);
 	__swab32s(&os->os_fprecreated);
 	__swab32s(&os->os_granted);
-	BUILD_BUG_ON(offsetof(typeof(*os), os_spare3) == 0);
+	__swab32s(&os->os_load);
 	BUILD_BUG_ON(offsetof(typeof(*os), os_spare4) == 0);
 	BUILD_BUG_ON(offsetof(typeof(*os), os_spare5) == 0);
 	BUILD_BUG_ON(offsetof(typeof(*os), os_spare6) == 0);
@@ -2088,6 +2088,53 @@ void lustre_swab_fid2path(struct getinfo_fid2path *gf)
 }
 EXPORT_SYMBOL(lustre_swab_fid2path);
 
+static void lustre_swab_find_scan_cmp(struct lu_find_scan_cmp *cmp)
+{
+	__swab64s(&cmp->lfsc_value);
+	__swab64s(&cmp->lfsc_margin);
+	__swab32s(&cmp->lfsc_sign);
+	BUILD_BUG_ON(offsetof(typeof(*cmp), lfsc_padding) == 0);
+}
+
+/**
+ * Swab a lu_find_scan header and, if \a len covers them, the entries
+ * following it.
+ */
+void lustre_swab_find_scan(struct lu_find_scan *lfs, __u32 len)
+{
+	struct lu_find_scan_ent *ent;
+	void *end = (void *)lfs + len;
+	__u32 i;
+
+	lustre_swab_lu_fid(&lfs->lfs_fid);
+	__swab64s(&lfs->lfs_cookie);
+	__swab32s(&lfs->lfs_valid);
+	__swab32s(&lfs->lfs_exclude);
+	__swab32s(&lfs->lfs_uid);
+	__swab32s(&lfs->lfs_gid);
+	__swab32s(&lfs->lfs_projid);
+	__swab32s(&lfs->lfs_layout);
+	lustre_swab_find_scan_cmp(&lfs->lfs_atime);
+	lustre_swab_find_scan_cmp(&lfs->lfs_mtime);
+	lustre_swab_find_scan_cmp(&lfs->lfs_ctime);
+	lustre_swab_find_scan_cmp(&lfs->lfs_size);
+	lustre_swab_find_scan_cmp(&lfs->lfs_stripe_count);
+	__swab32s(&lfs->lfs_count);
+	__swab32s(&lfs->lfs_buflen);
+	lustre_swab_lu_fid(&lfs->lfs_root_fid);
+
+	ent = (struct lu_find_scan_ent *)lfs->lfs_ents;
+	for (i = 0; i < lfs->lfs_count; i++) {
+		if ((void *)(ent + 1) > end)
+			break;
+		lustre_swab_lu_fid(&ent->lfse_fid);
+		__swab16s(&ent->lfse_namelen);
+		__swab16s(&ent->lfse_type);
+		ent = lu_find_scan_ent_next(ent);
+	}
+}
+EXPORT_SYMBOL(lustre_swab_find_scan);
+
 static void lustre_swab_fiemap_extent(struct fiemap_extent *fm_extent)
 {
 	__swab64s(&fm_extent->fe_logical);
@@ -2640,6 +2687,7 @@ void lustre_swab_quota_body(struct quota_body *b)
 	lustre_swab_lu_fid(&b->qb_fid);
 	lustre_swab_lu_fid((struct lu_fid *)&b->qb_id);
 	__swab32s(&b->qb_flags);
+	__swab32s(&b->qb_rc);
 	__swab64s(&b->qb_count);
 	__swab64s(&b->qb_usage);
 	__swab64s(&b->qb_slv_ver);
@@ -749,6 +749,8 @@ void lustre_assert_wire_constants(void)
 		 (long long)LU_LADVISE_LOCKNOEXPAND);
 	LASSERTF(LU_LADVISE_LOCKAHEAD == 4, "found %lld\n",
 		 (long long)LU_LADVISE_LOCKAHEAD);
+	LASSERTF(LU_LADVISE_WILLWRITE == 5, "found %lld\n",
+		 (long long)LU_LADVISE_WILLWRITE);
 
 	/* Checks for struct ladvise_hdr */
 	LASSERTF((int)sizeof(struct ladvise_hdr) == 32, "found %lld\n",
@@ -1400,6 +1402,12 @@ void lustre_assert_wire_constants(void)
 		 OBD_CONNECT2_PCCRO);
 	LASSERTF(OBD_CONNECT2_ATOMIC_OPEN_LOCK == 0x4000000ULL, "found 0x%.16llxULL\n",
 		 OBD_CONNECT2_ATOMIC_OPEN_LOCK);
+	LASSERTF(OBD_CONNECT2_PIPE_PRECREATE == 0x8000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_PIPE_PRECREATE);
+	LASSERTF(OBD_CONNECT2_DESTROY_BATCH == 0x10000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_DESTROY_BATCH);
+	LASSERTF(OBD_CONNECT2_QUOTA_BATCH == 0x20000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_QUOTA_BATCH);
 	LASSERTF(OBD_CKSUM_CRC32 == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32);
 	LASSERTF(OBD_CKSUM_ADLER == 0x00000002UL, "found 0x%.8xUL\n",
@@ -1995,10 +2003,10 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct obd_statfs, os_granted));
 	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_granted) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_granted));
-	LASSERTF((int)offsetof(struct obd_statfs, os_spare3) == 116, "found %lld\n",
-		 (long long)(int)offsetof(struct obd_statfs, os_spare3));
-	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare3) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_spare3));
+	LASSERTF((int)offsetof(struct obd_statfs, os_load) == 116, "found %lld\n",
+		 (long long)(int)offsetof(struct obd_statfs, os_load));
+	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_load) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_load));
 	LASSERTF((int)offsetof(struct obd_statfs, os_spare4) == 120, "found %lld\n",
 		 (long long)(int)offsetof(struct obd_statfs, os_spare4));
 	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare4) == 4, "found %lld\n",
@@ -4682,6 +4690,146 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)sizeof(((struct getinfo_fid2path *)0)->gf_u.gf_path[0]));
 #endif /* HAVE_FID2PATH_ANON_UNIONS */
 
+	/* Checks for struct lu_find_scan_cmp */
+	LASSERTF((int)sizeof(struct lu_find_scan_cmp) == 24, "found %lld\n",
+		 (long long)(int)sizeof(struct lu_find_scan_cmp));
+	LASSERTF((int)offsetof(struct lu_find_scan_cmp, lfsc_value) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan_cmp, lfsc_value));
+	LASSERTF((int)sizeof(((struct lu_find_scan_cmp *)0)->lfsc_value) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan_cmp *)0)->lfsc_value));
+	LASSERTF((int)offsetof(struct lu_find_scan_cmp, lfsc_margin) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan_cmp, lfsc_margin));
+	LASSERTF((int)sizeof(((struct lu_find_scan_cmp *)0)->lfsc_margin) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan_cmp *)0)->lfsc_margin));
+	LASSERTF((int)offsetof(struct lu_find_scan_cmp, lfsc_sign) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan_cmp, lfsc_sign));
+	LASSERTF((int)sizeof(((struct lu_find_scan_cmp *)0)->lfsc_sign) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan_cmp *)0)->lfsc_sign));
+	LASSERTF((int)offsetof(struct lu_find_scan_cmp, lfsc_padding) == 20, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan_cmp, lfsc_padding));
+	LASSERTF((int)sizeof(((struct lu_find_scan_cmp *)0)->lfsc_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan_cmp *)0)->lfsc_padding));
+
+	/* Checks for struct lu_find_scan_ent */
+	LASSERTF((int)sizeof(struct lu_find_scan_ent) == 24, "found %lld\n",
+		 (long long)(int)sizeof(struct lu_find_scan_ent));
+	LASSERTF((int)offsetof(struct lu_find_scan_ent, lfse_fid) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan_ent, lfse_fid));
+	LASSERTF((int)sizeof(((struct lu_find_scan_ent *)0)->lfse_fid) == 16, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan_ent *)0)->lfse_fid));
+	LASSERTF((int)offsetof(struct lu_find_scan_ent, lfse_namelen) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan_ent, lfse_namelen));
+	LASSERTF((int)sizeof(((struct lu_find_scan_ent *)0)->lfse_namelen) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan_ent *)0)->lfse_namelen));
+	LASSERTF((int)offsetof(struct lu_find_scan_ent, lfse_type) == 18, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan_ent, lfse_type));
+	LASSERTF((int)sizeof(((struct lu_find_scan_ent *)0)->lfse_type) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan_ent *)0)->lfse_type));
+	LASSERTF((int)offsetof(struct lu_find_scan_ent, lfse_padding) == 20, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan_ent, lfse_padding));
+	LASSERTF((int)sizeof(((struct lu_find_scan_ent *)0)->lfse_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan_ent *)0)->lfse_padding));
+	LASSERTF((int)offsetof(struct lu_find_scan_ent, lfse_name[0]) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan_ent, lfse_name[0]));
+	LASSERTF((int)sizeof(((struct lu_find_scan_ent *)0)->lfse_name[0]) == 1, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan_ent *)0)->lfse_name[0]));
+
+	/* Checks for struct lu_find_scan */
+	LASSERTF((int)sizeof(struct lu_find_scan) == 208, "found %lld\n",
+		 (long long)(int)sizeof(struct lu_find_scan));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_fid) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_fid));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_fid) == 16, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_fid));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_cookie) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_cookie));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_cookie) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_cookie));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_valid) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_valid));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_valid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_valid));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_exclude) == 28, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_exclude));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_exclude) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_exclude));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_uid) == 32, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_uid));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_uid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_uid));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_gid) == 36, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_gid));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_gid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_gid));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_projid) == 40, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_projid));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_projid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_projid));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_layout) == 44, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_layout));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_layout) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_layout));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_atime) == 48, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_atime));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_atime) == 24, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_atime));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_mtime) == 72, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_mtime));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_mtime) == 24, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_mtime));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_ctime) == 96, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_ctime));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_ctime) == 24, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_ctime));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_size) == 120, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_size));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_size) == 24, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_size));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_stripe_count) == 144, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_stripe_count));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_stripe_count) == 24, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_stripe_count));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_pool) == 168, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_pool));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_pool) == 16, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_pool));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_count) == 184, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_count));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_count) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_count));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_buflen) == 188, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_buflen));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_buflen) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_buflen));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_root_fid) == 192, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_root_fid));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_root_fid) == 16, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_root_fid));
+	LASSERTF((int)offsetof(struct lu_find_scan, lfs_ents[0]) == 208, "found %lld\n",
+		 (long long)(int)offsetof(struct lu_find_scan, lfs_ents[0]));
+	LASSERTF((int)sizeof(((struct lu_find_scan *)0)->lfs_ents[0]) == 1, "found %lld\n",
+		 (long long)(int)sizeof(((struct lu_find_scan *)0)->lfs_ents[0]));
+	LASSERTF(LFSV_ATIME == 0x00000001UL, "found 0x%.8xUL\n",
+		(unsigned)LFSV_ATIME);
+	LASSERTF(LFSV_MTIME == 0x00000002UL, "found 0x%.8xUL\n",
+		(unsigned)LFSV_MTIME);
+	LASSERTF(LFSV_CTIME == 0x00000004UL, "found 0x%.8xUL\n",
+		(unsigned)LFSV_CTIME);
+	LASSERTF(LFSV_SIZE == 0x00000008UL, "found 0x%.8xUL\n",
+		(unsigned)LFSV_SIZE);
+	LASSERTF(LFSV_UID == 0x00000010UL, "found 0x%.8xUL\n",
+		(unsigned)LFSV_UID);
+	LASSERTF(LFSV_GID == 0x00000020UL, "found 0x%.8xUL\n",
+		(unsigned)LFSV_GID);
+	LASSERTF(LFSV_PROJID == 0x00000040UL, "found 0x%.8xUL\n",
+		(unsigned)LFSV_PROJID);
+	LASSERTF(LFSV_POOL == 0x00000080UL, "found 0x%.8xUL\n",
+		(unsigned)LFSV_POOL);
+	LASSERTF(LFSV_LAYOUT == 0x00000100UL, "found 0x%.8xUL\n",
+		(unsigned)LFSV_LAYOUT);
+	LASSERTF(LFSV_STRIPE_COUNT == 0x00000200UL, "found 0x%.8xUL\n",
+		(unsigned)LFSV_STRIPE_COUNT);
+
 	/* Checks for struct fiemap */
 	LASSERTF((int)sizeof(struct fiemap) == 32, "found %lld\n",
 		 (long long)(int)sizeof(struct fiemap));
@@ -147,6 +147,15 @@ struct lquota_slv_entry {
 
 	/* when latest edquot set */
 	time64_t		lse_edquot_time;
+
+	/* space consumed since lse_rate_time, in inodes or kbytes */
+	__u64			lse_consumed;
+
+	/* start of the current consumption sampling period */
+	time64_t		lse_rate_time;
+
+	/* smoothed consumption rate, in inodes or kbytes per second */
+	__u64			lse_rate;
 };
 
 /* In-memory entry for each enforced quota id
@@ -255,6 +264,9 @@ struct lquota_site {
 #define lqe_acq_rc		u.se.lse_acq_rc
 #define lqe_acq_time		u.se.lse_acq_time
 #define lqe_edquot_time		u.se.lse_edquot_time
+#define lqe_consumed		u.se.lse_consumed
+#define lqe_rate_time		u.se.lse_rate_time
+#define lqe_rate		u.se.lse_rate
 
 #define LQUOTA_BUMP_VER 0x1
 #define LQUOTA_SET_VER  0x2
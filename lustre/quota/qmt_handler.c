@@ -895,45 +895,26 @@ int qmt_uuid2idx(struct obd_uuid *uuid, int *idx)
 }
 
 /*
- * Handle quota request from slave.
+ * Handle the quota request of a single ID from slave.
  *
- * \param env  - is the environment passed by the caller
- * \param ld   - is the lu device associated with the qmt
- * \param req  - is the quota acquire request
+ * \param env     - is the environment passed by the caller
+ * \param qmt     - is the quota master device
+ * \param req     - is the quota acquire request
+ * \param stype   - is the type of the slave, QMT_STYPE_MDT or QMT_STYPE_OST
+ * \param idx     - is the index of the slave
+ * \param qbody   - is the quota body of the ID packed in the request
+ * \param repbody - is the quota body of the ID to fill in the reply
  */
-static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
-		     struct ptlrpc_request *req)
+static int qmt_dqacq_one(const struct lu_env *env, struct qmt_device *qmt,
+			 struct ptlrpc_request *req, int stype, int idx,
+			 struct quota_body *qbody, struct quota_body *repbody)
 {
-	struct qmt_device *qmt = lu2qmt_dev(ld);
-	struct quota_body *qbody, *repbody;
-	struct obd_uuid	*uuid;
+	struct obd_uuid	*uuid = &req->rq_export->exp_client_uuid;
 	struct ldlm_lock *lock;
 	int rtype, qtype;
-	int rc, idx, stype;
+	int rc;
 	ENTRY;
 
-	qbody = req_capsule_client_get(&req->rq_pill, &RMF_QUOTA_BODY);
-	if (qbody == NULL)
-		RETURN(err_serious(-EPROTO));
-
-	repbody = req_capsule_server_get(&req->rq_pill, &RMF_QUOTA_BODY);
-	if (repbody == NULL)
-		RETURN(err_serious(-EFAULT));
-
-	/* verify if global lock is stale */
-	if (!lustre_handle_is_used(&qbody->qb_glb_lockh))
-		RETURN(-ENOLCK);
-
-	lock = ldlm_handle2lock(&qbody->qb_glb_lockh);
-	if (lock == NULL)
-		RETURN(-ENOLCK);
-	LDLM_LOCK_PUT(lock);
-
-	uuid = &req->rq_export->exp_client_uuid;
-	stype = qmt_uuid2idx(uuid, &idx);
-	if (stype < 0)
-		RETURN(stype);
-
 	if (req_is_rel(qbody->qb_flags) + req_is_acq(qbody->qb_flags) +
 	    req_is_preacq(qbody->qb_flags) > 1) {
 		CERROR("%s: malformed quota request with conflicting flags set "
@@ -1002,6 +983,80 @@ static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
 	RETURN(rc);
 }
 
+/*
+ * Handle quota request from slave.
+ *
+ * A slave supporting OBD_CONNECT2_QUOTA_BATCH may pack the quota bodies of
+ * several IDs sharing the same global lock in RMF_QUOTA_BODY_ARRAY after the
+ * first one. Each ID is then processed independently and its result is
+ * returned in qb_rc of the matching reply body.
+ *
+ * \param env  - is the environment passed by the caller
+ * \param ld   - is the lu device associated with the qmt
+ * \param req  - is the quota acquire request
+ */
+static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
+		     struct ptlrpc_request *req)
+{
+	struct qmt_device *qmt = lu2qmt_dev(ld);
+	struct req_capsule *pill = &req->rq_pill;
+	struct quota_body *qbody, *repbody;
+	struct quota_body *qbodies = NULL, *repbodies = NULL;
+	struct ldlm_lock *lock;
+	int rc, idx, stype;
+	int nr = 0, i;
+	ENTRY;
+
+	qbody = req_capsule_client_get(pill, &RMF_QUOTA_BODY);
+	if (qbody == NULL)
+		RETURN(err_serious(-EPROTO));
+
+	repbody = req_capsule_server_get(pill, &RMF_QUOTA_BODY);
+	if (repbody == NULL)
+		RETURN(err_serious(-EFAULT));
+
+	if (exp_connect_flags2(req->rq_export) & OBD_CONNECT2_QUOTA_BATCH &&
+	    req_capsule_field_present(pill, &RMF_QUOTA_BODY_ARRAY,
+				      RCL_CLIENT))
+		nr = req_capsule_get_size(pill, &RMF_QUOTA_BODY_ARRAY,
+					  RCL_CLIENT) / sizeof(*qbodies);
+	if (nr > 0) {
+		qbodies = req_capsule_client_get(pill, &RMF_QUOTA_BODY_ARRAY);
+		repbodies = req_capsule_server_get(pill,
+						   &RMF_QUOTA_BODY_ARRAY);
+		if (qbodies == NULL || repbodies == NULL)
+			RETURN(err_serious(-EPROTO));
+	}
+
+	/* verify if global lock is stale */
+	if (!lustre_handle_is_used(&qbody->qb_glb_lockh))
+		RETURN(-ENOLCK);
+
+	lock = ldlm_handle2lock(&qbody->qb_glb_lockh);
+	if (lock == NULL)
+		RETURN(-ENOLCK);
+	LDLM_LOCK_PUT(lock);
+
+	stype = qmt_uuid2idx(&req->rq_export->exp_client_uuid, &idx);
+	if (stype < 0)
+		RETURN(stype);
+
+	rc = qmt_dqacq_one(env, qmt, req, stype, idx, qbody, repbody);
+	if (nr == 0)
+		RETURN(rc);
+
+	/* the result of each ID of a batch is returned in its reply body, the
+	 * request itself succeeds so that the slave gets all of them */
+	repbody->qb_rc = rc;
+	for (i = 0; i < nr; i++)
+		repbodies[i].qb_rc = qmt_dqacq_one(env, qmt, req, stype, idx,
+						   &qbodies[i], &repbodies[i]);
+	CDEBUG(D_QUOTA, "%s: processed DQACQ batch of %d IDs from %s\n",
+	       qmt->qmt_svname, nr + 1,
+	       obd_uuid2str(&req->rq_export->exp_client_uuid));
+	RETURN(0);
+}
+
 /* Vector of quota request handlers. This vector is used by the MDT to forward
  * requests to the quota master. */
 struct qmt_handlers qmt_hdls = {
@@ -142,6 +142,44 @@ static int qsd_ready(struct lquota_entry *lqe, struct lustre_handle *lockh)
 	RETURN(0);
 }
 
+/**
+ * Account quota space consumed by an operation to estimate how fast this ID
+ * consumes quota space on this slave. Must be called with lqe write lock held.
+ */
+static void qsd_update_rate(struct lquota_entry *lqe, __u64 space)
+{
+	time64_t now = ktime_get_seconds();
+	time64_t elapsed = now - lqe->lqe_rate_time;
+
+	lqe->lqe_consumed += space;
+	if (elapsed <= 0)
+		return;
+
+	if (elapsed > QSD_PREFETCH_HORIZON)
+		/* previous rate is too old to be relevant */
+		lqe->lqe_rate = div_u64(lqe->lqe_consumed, elapsed);
+	else
+		lqe->lqe_rate = (lqe->lqe_rate +
+				 div_u64(lqe->lqe_consumed, elapsed)) >> 1;
+	lqe->lqe_consumed = 0;
+	lqe->lqe_rate_time = now;
+}
+
+/**
+ * Return how much spare quota space the slave should own for this ID before
+ * pre-acquiring more. This is qtune, extended up to one qunit for IDs which
+ * would consume qtune within QSD_PREFETCH_HORIZON seconds at their current
+ * rate, so that quota space is fetched before service threads have to wait.
+ */
+static inline __u64 qsd_preacq_window(struct lquota_entry *lqe)
+{
+	__u64 window = lqe->lqe_rate * QSD_PREFETCH_HORIZON;
+
+	if (window <= lqe->lqe_qtune)
+		return lqe->lqe_qtune;
+	return min(window, lqe->lqe_qunit);
+}
+
 /**
  * Check whether any quota space adjustment (pre-acquire/release/report) is
  * needed for a given quota ID. If a non-null \a qbody is passed, then the
@@ -265,13 +303,17 @@ static bool qsd_calc_adjust(struct lquota_entry *lqe, struct quota_body *qbody)
 
 	/* 3. Time to pre-acquire? */
 	if (!lqe->lqe_edquot && !lqe->lqe_nopreacq && usage > 0 &&
-	    lqe->lqe_qunit != 0 && granted < usage + lqe->lqe_qtune) {
+	    lqe->lqe_qunit != 0 && granted < usage + qsd_preacq_window(lqe)) {
 		/* To pre-acquire quota space, we report how much spare quota
 		 * space the slave currently owns, then the master will grant us
 		 * back how much we can pretend given the current state of
 		 * affairs */
 		if (qbody == NULL)
 			RETURN(true);
+		if (granted >= usage + lqe->lqe_qtune)
+			/* only needed because of the consumption rate */
+			qsd_stats_add(lqe2qqi(lqe)->qqi_qsd,
+				      QSD_STATS_PREFETCH, 1);
 		if (granted <= usage)
 			qbody->qb_count = 0;
 		else
@@ -707,6 +749,7 @@ static int qsd_op_begin0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 {
 	struct lquota_entry *lqe;
 	enum osd_quota_local_flags qtype_flag = 0;
+	ktime_t kstart;
 	int rc, ret = -EINPROGRESS;
 	ENTRY;
 
@@ -742,6 +785,7 @@ static int qsd_op_begin0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 
 	LQUOTA_DEBUG(lqe, "op_begin space:%lld", space);
 
+	kstart = ktime_get();
 	lqe_write_lock(lqe);
 	lqe->lqe_waiting_write += space;
 	lqe_write_unlock(lqe);
@@ -751,6 +795,8 @@ static int qsd_op_begin0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 	rc = wait_event_idle_timeout(
 		lqe->lqe_waiters, qsd_acquire(env, lqe, space, &ret),
 		cfs_time_seconds(qsd_wait_timeout(qqi->qqi_qsd)));
+	qsd_stats_add(qqi->qqi_qsd, QSD_STATS_OP_BEGIN_WAIT,
+		      ktime_us_delta(ktime_get(), kstart));
 
 	if (rc > 0 && ret == 0) {
 		qid->lqi_space += space;
@@ -922,12 +968,19 @@ EXPORT_SYMBOL(qsd_op_begin);
  * Space adjustment is aborted if there is already a quota request in flight
  * for this ID.
  *
+ * If \a batch is not NULL and the master supports OBD_CONNECT2_QUOTA_BATCH,
+ * the DQACQ request is added to the batch instead of being sent at once, the
+ * batch is sent when it is full or by qsd_batch_flush(). Intent requests
+ * (to enqueue the per-ID lock) are never batched.
+ *
  * \param env    - the environment passed by the caller
  * \param lqe    - is the qid entry to be processed
+ * \param batch  - is the batch being filled, allocated on demand
  *
  * \retval 0 on success, appropriate errors on failure
  */
-int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
+int qsd_adjust_batch(const struct lu_env *env, struct lquota_entry *lqe,
+		     struct qsd_dqacq_batch **batch)
 {
 	struct qsd_thread_info	*qti = qsd_info(env);
 	struct quota_body	*qbody = &qti->qti_body;
@@ -1009,6 +1062,35 @@ int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
 		memset(&qti->qti_lockh, 0, sizeof(qti->qti_lockh));
 	}
 
+	if (!intent && batch != NULL && qsd_batch_enabled(qsd)) {
+		struct qsd_dqacq_batch *b;
+
+		/* all IDs of a batch must share the global lock */
+		if (*batch != NULL && (*batch)->qdb_qqi != qqi)
+			qsd_batch_flush(env, batch);
+		if (*batch == NULL) {
+			OBD_ALLOC_LARGE(*batch, sizeof(**batch));
+			if (*batch != NULL)
+				(*batch)->qdb_qqi = qqi;
+		}
+
+		b = *batch;
+		if (b != NULL) {
+			b->qdb_body[b->qdb_count] = *qbody;
+			lustre_handle_copy(&b->qdb_lockh[b->qdb_count],
+					   &qti->qti_lockh);
+			b->qdb_lqe[b->qdb_count] = lqe;
+			b->qdb_count++;
+			if (b->qdb_count >= min(qsd->qsd_dqacq_batch_max,
+						QSD_DQACQ_BATCH_MAX))
+				qsd_batch_flush(env, batch);
+			/* the completion function will be called on batch
+			 * completion */
+			RETURN(0);
+		}
+		/* no memory for a batch, send this request alone */
+	}
+
 	if (!intent) {
 		rc = qsd_send_dqacq(env, qsd->qsd_exp, qbody, false,
 				    qsd_req_completion, qqi, &qti->qti_lockh,
@@ -1033,6 +1115,45 @@ out:
 	return rc;
 }
 
+/* adjust quota space of a single ID, see qsd_adjust_batch() */
+int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
+{
+	return qsd_adjust_batch(env, lqe, NULL);
+}
+
+/**
+ * Send the DQACQ requests gathered in \a batch by qsd_adjust_batch(). The
+ * batch is consumed and \a batch is reset to NULL.
+ *
+ * \param env    - the environment passed by the caller
+ * \param batch  - is the batch to send, may point to NULL
+ */
+void qsd_batch_flush(const struct lu_env *env, struct qsd_dqacq_batch **batch)
+{
+	struct qsd_dqacq_batch	*b = *batch;
+	struct qsd_instance	*qsd;
+	int			 i;
+	ENTRY;
+
+	if (b == NULL)
+		RETURN_EXIT;
+	*batch = NULL;
+	qsd = b->qdb_qqi->qqi_qsd;
+
+	if (b->qdb_count > 1 && qsd_batch_enabled(qsd)) {
+		qsd_send_dqacq_batch(env, qsd->qsd_exp, b, qsd_req_completion);
+		RETURN_EXIT;
+	}
+
+	/* single request, or the master lost batch support on reconnect */
+	for (i = 0; i < b->qdb_count; i++)
+		qsd_send_dqacq(env, qsd->qsd_exp, &b->qdb_body[i], false,
+			       qsd_req_completion, b->qdb_qqi,
+			       &b->qdb_lockh[i], b->qdb_lqe[i]);
+	OBD_FREE_LARGE(b, sizeof(*b));
+	EXIT;
+}
+
 /**
  * Post quota operation, pre-acquire/release quota from master.
  *
@@ -1064,8 +1185,10 @@ static void qsd_op_end0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 		qsd_refresh_usage(env, lqe);
 
 	lqe_write_lock(lqe);
-	if (qid->lqi_space > 0)
+	if (qid->lqi_space > 0) {
 		lqe->lqe_pending_write -= qid->lqi_space;
+		qsd_update_rate(lqe, qid->lqi_space);
+	}
 	if (env != NULL)
 		adjust = qsd_adjust_needed(lqe);
 	else
@@ -1073,12 +1196,14 @@ static void qsd_op_end0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 	lqe_write_unlock(lqe);
 
 	if (adjust) {
-		/* pre-acquire/release quota space is needed */
-		if (env != NULL)
+		/* pre-acquire/release quota space is needed. If the master
+		 * supports batched DQACQ, let the writeback thread gather the
+		 * adjustments of many IDs in a single RPC */
+		if (env != NULL && !qsd_batch_enabled(qqi->qqi_qsd))
 			qsd_adjust(env, lqe);
 		else
-			/* no suitable environment, handle adjustment in
-			 * separate thread context */
+			/* no suitable environment or batching, handle
+			 * adjustment in separate thread context */
 			qsd_adjust_schedule(lqe, false, false);
 	}
 	lqe_putref(lqe);
@@ -106,6 +106,13 @@ struct qsd_instance {
 	 * enforced here (via procfs) */
 	int			 qsd_timeout;
 
+	/* maximum number of IDs adjusted with a single DQACQ request when
+	 * the master supports OBD_CONNECT2_QUOTA_BATCH, 1 disables batching */
+	int			 qsd_dqacq_batch_max;
+
+	/* statistics on quota requests sent by this slave */
+	struct lprocfs_stats	*qsd_stats;
+
 	unsigned long		qsd_is_md:1,    /* managing quota for mdt */
 				qsd_started:1,  /* instance is now started */
 				qsd_prepared:1, /* qsd_prepare() successfully
@@ -115,6 +122,31 @@ struct qsd_instance {
 
 };
 
+/* counters of qsd_stats */
+enum qsd_stats_idx {
+	QSD_STATS_QUOTA_RPC = 0,	/* DQACQ & intent RPCs sent */
+	QSD_STATS_BATCH_ID,		/* IDs adjusted by batched DQACQ */
+	QSD_STATS_RPC_SAVED,		/* DQACQ RPCs saved by batching */
+	QSD_STATS_PREFETCH,		/* pre-acquires forced by usage rate */
+	QSD_STATS_OP_BEGIN_WAIT,	/* time spent in qsd_op_begin() */
+	QSD_STATS_LAST,
+};
+
+/* maximum number of IDs packed in a single batched DQACQ request */
+#define QSD_DQACQ_BATCH_MAX	64
+
+/*
+ * Quota bodies of IDs adjusted with a single DQACQ request. All IDs of a batch
+ * belong to the same quota type and thus share the global quota lock.
+ */
+struct qsd_dqacq_batch {
+	struct qsd_qtype_info	*qdb_qqi;
+	int			 qdb_count;
+	struct quota_body	 qdb_body[QSD_DQACQ_BATCH_MAX];
+	struct lustre_handle	 qdb_lockh[QSD_DQACQ_BATCH_MAX];
+	struct lquota_entry	*qdb_lqe[QSD_DQACQ_BATCH_MAX];
+};
+
 /*
  * Per-type quota information.
  * Quota slave instance for a specific quota type. The qsd instance has one such
@@ -323,6 +355,24 @@ static inline void qsd_set_edquot(struct lquota_entry *lqe, bool edquot)
 
 #define QSD_WB_INTERVAL	60 /* 60 seconds */
 
+/* pre-acquire enough quota space to cover the usage of an ID for that many
+ * seconds at its current consumption rate, within one qunit */
+#define QSD_PREFETCH_HORIZON	5
+
+static inline void qsd_stats_add(struct qsd_instance *qsd, int idx, long val)
+{
+	if (qsd->qsd_stats != NULL)
+		lprocfs_counter_add(qsd->qsd_stats, idx, val);
+}
+
+/* helper function checking whether DQACQ requests of several IDs can be
+ * packed in a single RPC */
+static inline bool qsd_batch_enabled(struct qsd_instance *qsd)
+{
+	return qsd->qsd_dqacq_batch_max > 1 && qsd->qsd_exp_valid &&
+	       exp_connect_flags2(qsd->qsd_exp) & OBD_CONNECT2_QUOTA_BATCH;
+}
+
 /* helper function calculating how long a service thread should be waiting for
  * quota space */
 static inline int qsd_wait_timeout(struct qsd_instance *qsd)
@@ -364,6 +414,8 @@ int qsd_send_dqacq(const struct lu_env *, struct obd_export *,
 		   struct quota_body *, bool, qsd_req_completion_t,
 		   struct qsd_qtype_info *, struct lustre_handle *,
 		   struct lquota_entry *);
+int qsd_send_dqacq_batch(const struct lu_env *, struct obd_export *,
+			 struct qsd_dqacq_batch *, qsd_req_completion_t);
 int qsd_intent_lock(const struct lu_env *, struct obd_export *,
 		    struct quota_body *, bool, int, qsd_req_completion_t,
 		    struct qsd_qtype_info *, struct lquota_lvb *, void *);
@@ -382,6 +434,9 @@ int qsd_process_config(struct lustre_cfg *);
 
 /* qsd_handler.c */
 int qsd_adjust(const struct lu_env *, struct lquota_entry *);
+int qsd_adjust_batch(const struct lu_env *, struct lquota_entry *,
+		     struct qsd_dqacq_batch **);
+void qsd_batch_flush(const struct lu_env *, struct qsd_dqacq_batch **);
 
 /* qsd_writeback.c */
 void qsd_upd_schedule(struct qsd_qtype_info *, struct lquota_entry *,
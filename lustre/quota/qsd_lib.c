@@ -267,6 +267,37 @@ qsd_timeout_seq_write(struct file *file, const char __user *buffer,
 }
 LPROC_SEQ_FOPS(qsd_timeout);
 
+static int qsd_max_dqacq_batch_seq_show(struct seq_file *m, void *data)
+{
+	struct qsd_instance *qsd = m->private;
+	LASSERT(qsd != NULL);
+
+	seq_printf(m, "%d\n", qsd->qsd_dqacq_batch_max);
+	return 0;
+}
+
+static ssize_t
+qsd_max_dqacq_batch_seq_write(struct file *file, const char __user *buffer,
+			      size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct qsd_instance *qsd = m->private;
+	unsigned int val;
+	int rc;
+
+	LASSERT(qsd != NULL);
+	rc = kstrtouint_from_user(buffer, count, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > QSD_DQACQ_BATCH_MAX)
+		return -ERANGE;
+
+	qsd->qsd_dqacq_batch_max = val;
+	return count;
+}
+LPROC_SEQ_FOPS(qsd_max_dqacq_batch);
+
 static struct lprocfs_vars lprocfs_quota_qsd_vars[] = {
 	{ .name	=	"info",
 	  .fops	=	&qsd_state_fops		},
@@ -276,6 +307,8 @@ static struct lprocfs_vars lprocfs_quota_qsd_vars[] = {
 	  .fops	=	&qsd_force_reint_fops	},
 	{ .name	=	"timeout",
 	  .fops	=	&qsd_timeout_fops	},
+	{ .name	=	"max_dqacq_batch",
+	  .fops	=	&qsd_max_dqacq_batch_fops	},
 	{ NULL }
 };
 
@@ -630,6 +663,9 @@ void qsd_fini(const struct lu_env *env, struct qsd_instance *qsd)
 		qsd->qsd_dev = NULL;
 	}
 
+	if (qsd->qsd_stats != NULL)
+		lprocfs_free_stats(&qsd->qsd_stats);
+
 	CDEBUG(D_QUOTA, "%s: QSD shutdown completed\n", qsd->qsd_svname);
 	OBD_FREE_PTR(qsd);
 	EXIT;
@@ -677,6 +713,7 @@ struct qsd_instance *qsd_init(const struct lu_env *env, char *svname,
 	qsd->qsd_prepared = false;
 	qsd->qsd_started = false;
 	qsd->qsd_is_md = is_md;
+	qsd->qsd_dqacq_batch_max = QSD_DQACQ_BATCH_MAX;
 
 	/* copy service name */
 	if (strlcpy(qsd->qsd_svname, svname, sizeof(qsd->qsd_svname))
@@ -727,6 +764,29 @@ struct qsd_instance *qsd_init(const struct lu_env *env, char *svname,
 		       svname, rc);
 		GOTO(out, rc);
         }
+
+	qsd->qsd_stats = lprocfs_alloc_stats(QSD_STATS_LAST, 0);
+	if (qsd->qsd_stats == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	lprocfs_counter_init(qsd->qsd_stats, QSD_STATS_QUOTA_RPC, 0,
+			     "quota_rpcs", "reqs");
+	lprocfs_counter_init(qsd->qsd_stats, QSD_STATS_BATCH_ID, 0,
+			     "batched_ids", "ids");
+	lprocfs_counter_init(qsd->qsd_stats, QSD_STATS_RPC_SAVED, 0,
+			     "rpcs_saved", "reqs");
+	lprocfs_counter_init(qsd->qsd_stats, QSD_STATS_PREFETCH, 0,
+			     "prefetch", "reqs");
+	lprocfs_counter_init(qsd->qsd_stats, QSD_STATS_OP_BEGIN_WAIT,
+			     LPROCFS_CNTR_AVGMINMAX | LPROCFS_CNTR_STDDEV,
+			     "op_begin_wait", "usec");
+
+	rc = lprocfs_register_stats(qsd->qsd_proc, "stats", qsd->qsd_stats);
+	if (rc) {
+		CERROR("%s: fail to register quota slave stats: rc = %d\n",
+		       svname, rc);
+		GOTO(out, rc);
+	}
 	EXIT;
 out:
 	if (rc) {
@@ -107,6 +107,8 @@ int qsd_send_dqacq(const struct lu_env *env, struct obd_export *exp,
 
 	req->rq_no_resend = req->rq_no_delay = 1;
 	req->rq_no_retry_einprogress = 1;
+	req_capsule_set_size(&req->rq_pill, &RMF_QUOTA_BODY_ARRAY, RCL_CLIENT,
+			     0);
 	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, QUOTA_DQACQ);
 	if (rc) {
 		ptlrpc_request_free(req);
@@ -117,6 +119,8 @@ int qsd_send_dqacq(const struct lu_env *env, struct obd_export *exp,
 	req_qbody = req_capsule_client_get(&req->rq_pill, &RMF_QUOTA_BODY);
 	*req_qbody = *qbody;
 
+	req_capsule_set_size(&req->rq_pill, &RMF_QUOTA_BODY_ARRAY, RCL_SERVER,
+			     0);
 	ptlrpc_request_set_replen(req);
 
 	aa = ptlrpc_req_async_args(aa, req);
@@ -125,6 +129,7 @@ int qsd_send_dqacq(const struct lu_env *env, struct obd_export *exp,
 	aa->aa_arg = (void *)lqe;
 	aa->aa_completion = completion;
 	lustre_handle_copy(&aa->aa_lockh, lockh);
+	qsd_stats_add(qqi->qqi_qsd, QSD_STATS_QUOTA_RPC, 1);
 
 	if (sync) {
 		rc = ptlrpc_queue_wait(req);
@@ -141,6 +146,140 @@ out:
 	return rc;
 }
 
+/*
+ * Batched quota request interpret callback. The completion callback is called
+ * for each ID of the batch with the result of this ID returned by the master.
+ *
+ * \param env    - the environment passed by the caller
+ * \param req    - the batched quota request
+ * \param arg    - qsd_async_args
+ * \param rc     - request status
+ *
+ * \retval 0     - success
+ * \retval -ve   - appropriate errors
+ */
+static int qsd_dqacq_batch_interpret(const struct lu_env *env,
+				     struct ptlrpc_request *req, void *arg,
+				     int rc)
+{
+	struct qsd_async_args	*aa = (struct qsd_async_args *)arg;
+	struct qsd_dqacq_batch	*batch = aa->aa_arg;
+	struct quota_body	*rep_qbody = NULL, *rep_array = NULL;
+	int			 nr = batch->qdb_count - 1;
+	int			 i;
+	ENTRY;
+
+	if (rc == 0) {
+		rep_qbody = req_capsule_server_get(&req->rq_pill,
+						   &RMF_QUOTA_BODY);
+		if (req_capsule_get_size(&req->rq_pill, &RMF_QUOTA_BODY_ARRAY,
+					 RCL_SERVER) ==
+		    nr * sizeof(struct quota_body))
+			rep_array = req_capsule_server_get(&req->rq_pill,
+							&RMF_QUOTA_BODY_ARRAY);
+		if (rep_qbody == NULL || rep_array == NULL)
+			rc = -EPROTO;
+	}
+
+	for (i = 0; i < batch->qdb_count; i++) {
+		struct quota_body *rep = NULL;
+		int ret = rc;
+
+		if (rc == 0) {
+			rep = i == 0 ? rep_qbody : &rep_array[i - 1];
+			ret = (int)rep->qb_rc;
+			/* see qsd_dqacq_interpret() */
+			if (ret != 0 && ret != -EDQUOT && ret != -EINPROGRESS)
+				rep = NULL;
+		}
+		aa->aa_completion(env, batch->qdb_qqi, &batch->qdb_body[i],
+				  rep, &batch->qdb_lockh[i], NULL,
+				  batch->qdb_lqe[i], ret);
+	}
+	OBD_FREE_LARGE(batch, sizeof(*batch));
+	RETURN(rc);
+}
+
+/*
+ * Send the quota requests of several IDs to master in a single RPC. The master
+ * must support OBD_CONNECT2_QUOTA_BATCH. The request is always asynchronous
+ * and \a batch is freed once the completion callback has been called for each
+ * ID of the batch.
+ *
+ * \param env    - the environment passed by the caller
+ * \param exp    - is the export to use to send the RPC
+ * \param batch  - quota bodies, lock handles and qid entries to be processed
+ * \param completion - completion callback
+ *
+ * \retval 0     - success
+ * \retval -ve   - appropriate errors
+ */
+int qsd_send_dqacq_batch(const struct lu_env *env, struct obd_export *exp,
+			 struct qsd_dqacq_batch *batch,
+			 qsd_req_completion_t completion)
+{
+	struct ptlrpc_request	*req;
+	struct quota_body	*req_qbody;
+	struct qsd_async_args	*aa;
+	int			 size;
+	int			 rc, i;
+	ENTRY;
+
+	LASSERT(exp);
+	LASSERT(batch->qdb_count > 1);
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp), &RQF_QUOTA_DQACQ);
+	if (req == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	/* the first ID is packed as for a single ID request, the others are
+	 * packed in the array */
+	size = (batch->qdb_count - 1) * sizeof(struct quota_body);
+	req->rq_no_resend = req->rq_no_delay = 1;
+	req->rq_no_retry_einprogress = 1;
+	req_capsule_set_size(&req->rq_pill, &RMF_QUOTA_BODY_ARRAY, RCL_CLIENT,
+			     size);
+	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, QUOTA_DQACQ);
+	if (rc) {
+		ptlrpc_request_free(req);
+		GOTO(out, rc);
+	}
+
+	req->rq_request_portal = MDS_READPAGE_PORTAL;
+	req_qbody = req_capsule_client_get(&req->rq_pill, &RMF_QUOTA_BODY);
+	*req_qbody = batch->qdb_body[0];
+	req_qbody = req_capsule_client_get(&req->rq_pill,
+					   &RMF_QUOTA_BODY_ARRAY);
+	memcpy(req_qbody, &batch->qdb_body[1], size);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_QUOTA_BODY_ARRAY, RCL_SERVER,
+			     size);
+	ptlrpc_request_set_replen(req);
+
+	aa = ptlrpc_req_async_args(aa, req);
+	aa->aa_exp = exp;
+	aa->aa_qqi = batch->qdb_qqi;
+	aa->aa_arg = batch;
+	aa->aa_completion = completion;
+
+	qsd_stats_add(batch->qdb_qqi->qqi_qsd, QSD_STATS_QUOTA_RPC, 1);
+	qsd_stats_add(batch->qdb_qqi->qqi_qsd, QSD_STATS_BATCH_ID,
+		      batch->qdb_count);
+	qsd_stats_add(batch->qdb_qqi->qqi_qsd, QSD_STATS_RPC_SAVED,
+		      batch->qdb_count - 1);
+
+	req->rq_interpret_reply = qsd_dqacq_batch_interpret;
+	ptlrpcd_add_req(req);
+
+	RETURN(0);
+out:
+	for (i = 0; i < batch->qdb_count; i++)
+		completion(env, batch->qdb_qqi, &batch->qdb_body[i], NULL,
+			   &batch->qdb_lockh[i], NULL, batch->qdb_lqe[i], rc);
+	OBD_FREE_LARGE(batch, sizeof(*batch));
+	return rc;
+}
+
 /*
  * intent quota request interpret callback.
  *
@@ -332,6 +471,7 @@ int qsd_intent_lock(const struct lu_env *env, struct obd_export *exp,
 	aa->aa_lvb = lvb;
 	aa->aa_completion = completion;
 	lustre_handle_copy(&aa->aa_lockh, &qti->qti_lockh);
+	qsd_stats_add(qqi->qqi_qsd, QSD_STATS_QUOTA_RPC, 1);
 
 	if (sync) {
 		/* send lock enqueue request and wait for completion */
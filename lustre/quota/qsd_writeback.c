@@ -456,6 +456,7 @@ static int qsd_upd_thread(void *_args)
 	struct qsd_instance	*qsd = args->qua_inst;
 	LIST_HEAD(queue);
 	struct qsd_upd_rec	*upd, *n;
+	struct qsd_dqacq_batch	*batch = NULL;
 	struct lu_env		*env = &args->qua_env;
 	int			 qtype, rc = 0;
 	bool			 uptodate;
@@ -494,13 +495,15 @@ static int qsd_upd_thread(void *_args)
 				if (lqe->lqe_adjust_time == 0)
 					qsd_id_lock_cancel(env, lqe);
 				else
-					qsd_adjust(env, lqe);
+					qsd_adjust_batch(env, lqe, &batch);
 			}
 
 			lqe_putref(lqe);
 			spin_lock(&qsd->qsd_adjust_lock);
 		}
 		spin_unlock(&qsd->qsd_adjust_lock);
+		/* send the DQACQ requests gathered for the remaining IDs */
+		qsd_batch_flush(env, &batch);
 
 		if (uptodate || kthread_should_stop())
 			continue;
@@ -64,6 +64,8 @@
  * - grant allocation strategy
  * - maintaining per-client as well as global grant space accounting
  * - processing grant information packed in incoming requests
+ * - sharding grant accounting per CPT, so that bulk I/Os from exports hashed
+ *   to different CPTs do not contend on a single grant lock
  * - allocating server-side grant space for synchronous write RPCs which did not
  *   consume grant on the client side (OBD_BRW_FROM_GRANT flag not set). If not
  *   enough space is available, such RPCs fail with ENOSPC
@@ -132,6 +134,106 @@ static inline u64 tgt_grant_chunk(struct obd_export *exp,
 	return chunk;
 }
 
+/* Index of the grant lock protecting the grant counters of \a exp */
+static inline int tgt_grant_cpt(struct tg_grants_data *tgd,
+				struct obd_export *exp)
+{
+	return hash_ptr(exp, 16) % cfs_percpt_lock_num(tgd->tgd_grant_lock);
+}
+
+static inline struct tg_grants_shard *
+tgt_grant_shard(struct tg_grants_data *tgd, struct obd_export *exp)
+{
+	return tgd->tgd_grant_shards[tgt_grant_cpt(tgd, exp)];
+}
+
+/* Account \a grant bytes newly granted to an export hashed to \a tgs.
+ * The space is taken out of the CPT reservation if \a budget is set (CPT
+ * lock held), out of the space left on the target otherwise (exclusive
+ * lock held) */
+static inline void tgt_grant_take(struct tg_grants_data *tgd,
+				  struct tg_grants_shard *tgs, u64 grant,
+				  bool budget)
+{
+	tgs->tgs_granted += grant;
+	if (budget)
+		tgs->tgs_avail -= grant;
+	else
+		tgd->tgd_tot_reserved += grant;
+}
+
+/* Return \a grant bytes released by an export to the CPT reservation */
+static inline void tgt_grant_release(struct tg_grants_shard *tgs, u64 grant)
+{
+	tgs->tgs_granted -= grant;
+	tgs->tgs_avail += grant;
+}
+
+/**
+ * Fold per-CPT grant accounting into the global counters.
+ *
+ * Grant counters changed under a CPT lock are only recorded in the shard of
+ * that CPT. This function applies those changes to tgd_tot_dirty,
+ * tgd_tot_granted and tgd_tot_pending and takes the space written by
+ * committed I/Os out of the cached statfs data. It is run whenever exact
+ * totals are needed and, at the latest, on each statfs refresh.
+ * Caller must hold the exclusive grant lock.
+ *
+ * \param[in] lut	LU target to fold grant accounting for
+ * \param[in] reclaim	also release the free space reserved by each CPT
+ */
+static void tgt_grant_fold(struct lu_target *lut, bool reclaim)
+{
+	struct tg_grants_data	*tgd = &lut->lut_tgd;
+	struct tg_grants_shard	*tgs;
+	s64			 dirty = 0;
+	s64			 granted = 0;
+	s64			 pending = 0;
+	u64			 written = 0;
+	int			 i;
+
+	cfs_percpt_for_each(tgs, i, tgd->tgd_grant_shards) {
+		dirty += tgs->tgs_dirty;
+		granted += tgs->tgs_granted;
+		pending += tgs->tgs_pending;
+		written += tgs->tgs_written;
+		tgd->tgd_tot_reserved -= tgs->tgs_granted + tgs->tgs_written;
+		tgs->tgs_dirty = 0;
+		tgs->tgs_granted = 0;
+		tgs->tgs_pending = 0;
+		tgs->tgs_written = 0;
+		if (reclaim) {
+			tgd->tgd_tot_reserved -= tgs->tgs_avail;
+			tgs->tgs_avail = 0;
+		}
+	}
+
+	if (unlikely((granted < 0 && tgd->tgd_tot_granted < -granted) ||
+		     (pending < 0 && tgd->tgd_tot_pending < -pending))) {
+		CERROR("%s: tot_granted(%llu) %+lld, tot_pending(%llu) %+lld\n",
+		       tgt_name(lut), tgd->tgd_tot_granted, granted,
+		       tgd->tgd_tot_pending, pending);
+		if (tgd->tgd_lbug_on_grant_miscount)
+			LBUG();
+	}
+	tgd->tgd_tot_dirty += dirty;
+	tgd->tgd_tot_granted += granted;
+	tgd->tgd_tot_pending += pending;
+
+	if (written == 0)
+		return;
+
+	spin_lock(&tgd->tgd_osfs_lock);
+	/* Take written space out of cached statfs data */
+	tgd->tgd_osfs.os_bavail -= min_t(u64, tgd->tgd_osfs.os_bavail,
+					 written >> tgd->tgd_blockbits);
+	if (tgd->tgd_statfs_inflight)
+		/* someone is running statfs and want to be notified of
+		 * writes happening meanwhile */
+		tgd->tgd_osfs_inflight += written;
+	spin_unlock(&tgd->tgd_osfs_lock);
+}
+
 static int tgt_check_export_grants(struct obd_export *exp, u64 *dirty,
 				   u64 *pending, u64 *granted, u64 maxsize)
 {
@@ -170,7 +272,8 @@ static int tgt_check_export_grants(struct obd_export *exp, u64 *dirty,
  * and verifies accuracy of global grant accounting. If an inconsistency is
  * found, a CERROR is printed with the function name \func that was passed as
  * argument. LBUG is only called in case of serious counter corruption (i.e.
- * value larger than the device size).
+ * value larger than the device size), or if the totals don't match the sum
+ * of the export counters and lbug_on_grant_miscount is set.
  * Those sanity checks can be pretty expensive and are disabled if the OBD
  * device has more than 100 connected exports.
  *
@@ -204,7 +307,8 @@ void tgt_grant_sanity_check(struct obd_device *obd, const char *func)
 	maxsize = tgd->tgd_osfs.os_blocks << tgd->tgd_blockbits;
 
 	spin_lock(&obd->obd_dev_lock);
-	spin_lock(&tgd->tgd_grant_lock);
+	cfs_percpt_lock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
+	tgt_grant_fold(lut, false);
 	exp = obd->obd_self_export;
 	ted = &exp->exp_target_data;
 	CDEBUG(D_CACHE, "%s: processing self export: %ld %ld "
@@ -219,7 +323,8 @@ void tgt_grant_sanity_check(struct obd_device *obd, const char *func)
 						&tot_granted, maxsize);
 		if (error < 0) {
 			spin_unlock(&obd->obd_dev_lock);
-			spin_unlock(&tgd->tgd_grant_lock);
+			cfs_percpt_unlock(tgd->tgd_grant_lock,
+					  CFS_PERCPT_LOCK_EX);
 			LBUG();
 		}
 	}
@@ -232,7 +337,8 @@ void tgt_grant_sanity_check(struct obd_device *obd, const char *func)
 						&tot_granted, maxsize);
 		if (error < 0) {
 			spin_unlock(&obd->obd_dev_lock);
-			spin_unlock(&tgd->tgd_grant_lock);
+			cfs_percpt_unlock(tgd->tgd_grant_lock,
+					  CFS_PERCPT_LOCK_EX);
 			LBUG();
 		}
 	}
@@ -241,7 +347,7 @@ void tgt_grant_sanity_check(struct obd_device *obd, const char *func)
 	fo_tot_pending = tgd->tgd_tot_pending;
 	fo_tot_dirty = tgd->tgd_tot_dirty;
 	spin_unlock(&obd->obd_dev_lock);
-	spin_unlock(&tgd->tgd_grant_lock);
+	cfs_percpt_unlock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
 
 	if (tot_granted != fo_tot_granted)
 		CERROR("%s: tot_granted %llu != fo_tot_granted %llu\n",
@@ -261,6 +367,12 @@ void tgt_grant_sanity_check(struct obd_device *obd, const char *func)
 	if (tot_dirty > maxsize)
 		CERROR("%s: tot_dirty %llu > maxsize %llu\n",
 		       func, tot_dirty, maxsize);
+
+	/* a shard delta lost or counted twice by the fold or the reclaim */
+	if (tgd->tgd_lbug_on_grant_miscount &&
+	    (tot_granted != fo_tot_granted || tot_pending != fo_tot_pending ||
+	     tot_dirty != fo_tot_dirty))
+		LBUG();
 }
 EXPORT_SYMBOL(tgt_grant_sanity_check);
 
@@ -286,6 +398,15 @@ int tgt_statfs_internal(const struct lu_env *env, struct lu_target *lut,
 	int rc = 0;
 	ENTRY;
 
+	if (tgd->tgd_osfs_age < max_age || max_age == 0) {
+		/* writes committed so far are accounted in the per-CPT
+		 * grant data only, take them out of the cached statfs data
+		 * before the refresh so they are not seen as unstable */
+		cfs_percpt_lock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
+		tgt_grant_fold(lut, false);
+		cfs_percpt_unlock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
+	}
+
 	spin_lock(&tgd->tgd_osfs_lock);
 	if (tgd->tgd_osfs_age < max_age || max_age == 0) {
 		u64 unstable;
@@ -315,7 +436,8 @@ int tgt_statfs_internal(const struct lu_env *env, struct lu_target *lut,
 
 		osfs->os_namelen = min_t(__u32, osfs->os_namelen, NAME_MAX);
 
-		spin_lock(&tgd->tgd_grant_lock);
+		cfs_percpt_lock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
+		tgt_grant_fold(lut, false);
 		spin_lock(&tgd->tgd_osfs_lock);
 		/* calculate how much space was written while we released the
 		 * tgd_osfs_lock */
@@ -340,7 +462,7 @@ int tgt_statfs_internal(const struct lu_env *env, struct lu_target *lut,
 		/* similarly, there is some uncertainty on write requests
 		 * between prepare & commit */
 		tgd->tgd_osfs_unstable += tgd->tgd_tot_pending;
-		spin_unlock(&tgd->tgd_grant_lock);
+		cfs_percpt_unlock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
 
 		/* finally udpate cached statfs data */
 		tgd->tgd_osfs = *osfs;
@@ -419,8 +541,8 @@ static void tgt_grant_statfs(const struct lu_env *env, struct obd_export *exp,
  *
  * This is done by accessing cached statfs data previously populated by
  * tgt_grant_statfs(), from which we withdraw the space already granted to
- * clients and the reserved space.
- * Caller must hold tgd_grant_lock spinlock.
+ * clients, the space reserved by the CPTs and the reserved space.
+ * Caller must hold the exclusive grant lock.
  *
  * \param[in] exp	export associated with the device for which the amount
  *			of available space is requested
@@ -438,7 +560,6 @@ static u64 tgt_grant_space_left(struct obd_export *exp)
 	u64			 reserved;
 
 	ENTRY;
-	assert_spin_locked(&tgd->tgd_grant_lock);
 
 	spin_lock(&tgd->tgd_osfs_lock);
 	/* get available space from cached statfs data */
@@ -447,7 +568,7 @@ static u64 tgt_grant_space_left(struct obd_export *exp)
 	spin_unlock(&tgd->tgd_osfs_lock);
 
 	reserved = left * tgd->tgd_reserved_pcnt / 100;
-	tot_granted = tgd->tgd_tot_granted + reserved;
+	tot_granted = tgd->tgd_tot_granted + tgd->tgd_tot_reserved + reserved;
 
 	if (left < tot_granted) {
 		int mask = (left + unstable <
@@ -479,6 +600,58 @@ static u64 tgt_grant_space_left(struct obd_export *exp)
 	RETURN(left);
 }
 
+/**
+ * Same as tgt_grant_space_left(), but take back the free space reserved by
+ * all the CPTs if less than \a want bytes are left.
+ * Caller must hold the exclusive grant lock.
+ *
+ * \param[in] exp	export associated with the device
+ * \param[in] want	amount of space the caller would like to be left
+ * \retval		amount of non-allocated space, in bytes
+ */
+static u64 tgt_grant_space_left_reclaim(struct obd_export *exp, u64 want)
+{
+	struct lu_target *lut = exp->exp_obd->u.obt.obt_lut;
+	u64 left;
+
+	left = tgt_grant_space_left(exp);
+	if (left < want) {
+		tgt_grant_fold(lut, true);
+		left = tgt_grant_space_left(exp);
+	}
+	return left;
+}
+
+/**
+ * Reserve free space for the CPT an export is hashed to.
+ *
+ * Writes granted out of the reservation of their CPT only need the lock of
+ * that CPT. When the reservation runs short, move a fair share of the space
+ * left on the target to it, at least \a want bytes if possible.
+ * Caller must hold the exclusive grant lock.
+ *
+ * \param[in] exp	export for which space is needed
+ * \param[in] tgs	grant shard of the export
+ * \param[in] want	amount of space the CPT should have reserved
+ */
+static void tgt_grant_refill(struct obd_export *exp,
+			     struct tg_grants_shard *tgs, u64 want)
+{
+	struct tg_grants_data *tgd = &exp->exp_obd->u.obt.obt_lut->lut_tgd;
+	u64 left;
+	u64 give;
+
+	left = tgt_grant_space_left_reclaim(exp, want);
+	give = left / (2 * cfs_percpt_lock_num(tgd->tgd_grant_lock));
+	give = min(max(give, want), left);
+
+	tgs->tgs_avail += give;
+	tgd->tgd_tot_reserved += give;
+	CDEBUG(D_CACHE, "%s: cli %s/%p reserve %llu avail %lld left %llu\n",
+	       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid, exp, give,
+	       tgs->tgs_avail, left - give);
+}
+
 /**
  * Process grant information from obdo structure packed in incoming BRW
  * and inflate grant counters if required.
@@ -487,7 +660,7 @@ static u64 tgt_grant_space_left(struct obd_export *exp)
  * inflate all grant counters passed in the request if the client does not
  * support the grant parameters.
  * We will later calculate the client's new grant and return it.
- * Caller must hold tgd_grant_lock spinlock.
+ * Caller must hold the grant lock of the export CPT or the exclusive one.
  *
  * \param[in] env	LU environment supplying osfs storage
  * \param[in] exp	export for which we received the request
@@ -499,11 +672,10 @@ static void tgt_grant_incoming(const struct lu_env *env, struct obd_export *exp,
 	struct tg_export_data	*ted = &exp->exp_target_data;
 	struct obd_device	*obd = exp->exp_obd;
 	struct tg_grants_data	*tgd = &obd->u.obt.obt_lut->lut_tgd;
+	struct tg_grants_shard	*tgs = tgt_grant_shard(tgd, exp);
 	long long		 dirty, dropped;
 	ENTRY;
 
-	assert_spin_locked(&tgd->tgd_grant_lock);
-
 	if ((oa->o_valid & (OBD_MD_FLBLOCKS|OBD_MD_FLGRANT)) !=
 					(OBD_MD_FLBLOCKS|OBD_MD_FLGRANT)) {
 		oa->o_valid &= ~OBD_MD_FLGRANT;
@@ -547,7 +719,7 @@ static void tgt_grant_incoming(const struct lu_env *env, struct obd_export *exp,
 	 * on ted_dirty however, but we must check sanity to not assert. */
 	if (dirty > ted->ted_grant + 4 * chunk)
 		dirty = ted->ted_grant + 4 * chunk;
-	tgd->tgd_tot_dirty += dirty - ted->ted_dirty;
+	tgs->tgs_dirty += dirty - ted->ted_dirty;
 	if (ted->ted_grant < dropped) {
 		CDEBUG(D_CACHE,
 		       "%s: cli %s/%p reports %llu dropped > grant %lu\n",
@@ -555,13 +727,7 @@ static void tgt_grant_incoming(const struct lu_env *env, struct obd_export *exp,
 		       ted->ted_grant);
 		dropped = 0;
 	}
-	if (tgd->tgd_tot_granted < dropped) {
-		CERROR("%s: cli %s/%p reports %llu dropped > tot_grant %llu\n",
-		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
-		       dropped, tgd->tgd_tot_granted);
-		dropped = 0;
-	}
-	tgd->tgd_tot_granted -= dropped;
+	tgt_grant_release(tgs, dropped);
 	ted->ted_grant -= dropped;
 	ted->ted_dirty = dirty;
 
@@ -569,7 +735,6 @@ static void tgt_grant_incoming(const struct lu_env *env, struct obd_export *exp,
 		CERROR("%s: cli %s/%p dirty %ld pend %ld grant %ld\n",
 		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
 		       ted->ted_dirty, ted->ted_pending, ted->ted_grant);
-		spin_unlock(&tgd->tgd_grant_lock);
 		LBUG();
 	}
 	EXIT;
@@ -582,7 +747,7 @@ static void tgt_grant_incoming(const struct lu_env *env, struct obd_export *exp,
  * shrinking). This function proceeds with the shrink request when there is
  * less ungranted space remaining than the amount all of the connected clients
  * would consume if they used their full grant.
- * Caller must hold tgd_grant_lock spinlock.
+ * Caller must hold the exclusive grant lock.
  *
  * \param[in] exp		export releasing grant space
  * \param[in,out] oa		incoming obdo sent by the client
@@ -597,7 +762,6 @@ static void tgt_grant_shrink(struct obd_export *exp, struct obdo *oa,
 	struct tg_grants_data	*tgd = &obd->u.obt.obt_lut->lut_tgd;
 	long			 grant_shrink;
 
-	assert_spin_locked(&tgd->tgd_grant_lock);
 	LASSERT(exp);
 	if (left_space >= tgd->tgd_tot_granted_clients *
 			  TGT_GRANT_SHRINK_LIMIT(exp))
@@ -614,11 +778,11 @@ static void tgt_grant_shrink(struct obd_export *exp, struct obdo *oa,
 	}
 
 	ted->ted_grant -= grant_shrink;
-	tgd->tgd_tot_granted -= grant_shrink;
+	tgt_grant_release(tgt_grant_shard(tgd, exp), grant_shrink);
 
-	CDEBUG(D_CACHE, "%s: cli %s/%p shrink %ld ted_grant %ld total %llu\n",
+	CDEBUG(D_CACHE, "%s: cli %s/%p shrink %ld ted_grant %ld\n",
 	       obd->obd_name, exp->exp_client_uuid.uuid, exp, grant_shrink,
-	       ted->ted_grant, tgd->tgd_tot_granted);
+	       ted->ted_grant);
 
 	/* client has just released some grant, don't grant any space back */
 	oa->o_grant = 0;
@@ -694,7 +858,8 @@ static inline u64 tgt_grant_rnb_size(struct obd_export *exp,
  * The OBD_BRW_GRANTED flag will be set in the rnb_flags of each network
  * buffer which has been granted enough space to proceed. Buffers without
  * this flag will fail to be written with -ENOSPC (see tgt_preprw_write().
- * Caller must hold tgd_grant_lock spinlock.
+ * Caller must hold the grant lock of the export CPT if \a budget is set, the
+ * exclusive one otherwise.
  *
  * \param[in] env	LU environment passed by the caller
  * \param[in] exp	export identifying the client which sent the RPC
@@ -704,15 +869,17 @@ static inline u64 tgt_grant_rnb_size(struct obd_export *exp,
  * \param[in] niocount	the number of network buffers in the list
  * \param[in] left	the remaining free space with space already granted
  *			taken out
+ * \param[in] budget	\a left is the space reserved by the export CPT
  */
 static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
 			    struct obdo *oa, struct niobuf_remote *rnb,
-			    int niocount, u64 *left)
+			    int niocount, u64 *left, bool budget)
 {
 	struct tg_export_data	*ted = &exp->exp_target_data;
 	struct obd_device	*obd = exp->exp_obd;
 	struct lu_target	*lut = obd->u.obt.obt_lut;
 	struct tg_grants_data	*tgd = &lut->lut_tgd;
+	struct tg_grants_shard	*tgs = tgt_grant_shard(tgd, exp);
 	unsigned long		 ungranted = 0;
 	unsigned long		 granted = 0;
 	int			 i;
@@ -720,8 +887,6 @@ static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
 
 	ENTRY;
 
-	assert_spin_locked(&tgd->tgd_grant_lock);
-
 	if (obd->obd_recovering) {
 		/* Replaying write. Grant info have been processed already so no
 		 * need to do any enforcement here. It is worth noting that only
@@ -839,8 +1004,8 @@ static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
 	 * happens in tgt_grant_commit() after the writes are done. */
 	ted->ted_grant -= granted;
 	ted->ted_pending += oa->o_grant_used;
-	tgd->tgd_tot_granted += ungranted;
-	tgd->tgd_tot_pending += oa->o_grant_used;
+	tgt_grant_take(tgd, tgs, ungranted, budget);
+	tgs->tgs_pending += oa->o_grant_used;
 
 	CDEBUG(D_CACHE,
 	       "%s: cli %s/%p granted: %lu ungranted: %lu grant: %lu dirty: %lu"
@@ -858,14 +1023,13 @@ static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
 		       granted, ted->ted_dirty);
 		granted = ted->ted_dirty;
 	}
-	tgd->tgd_tot_dirty -= granted;
+	tgs->tgs_dirty -= granted;
 	ted->ted_dirty -= granted;
 
 	if (ted->ted_dirty < 0 || ted->ted_grant < 0 || ted->ted_pending < 0) {
 		CERROR("%s: cli %s/%p dirty %ld pend %ld grant %ld\n",
 		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
 		       ted->ted_dirty, ted->ted_pending, ted->ted_grant);
-		spin_unlock(&tgd->tgd_grant_lock);
 		LBUG();
 	}
 	EXIT;
@@ -876,7 +1040,8 @@ static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
  *
  * Calculate how much grant space to return to client, based on how much space
  * is currently free and how much of that is already granted.
- * Caller must hold tgd_grant_lock spinlock.
+ * Caller must hold the grant lock of the export CPT if \a budget is set, the
+ * exclusive one otherwise.
  *
  * \param[in] exp		export of the client which sent the request
  * \param[in] curgrant		current grant claimed by the client
@@ -889,12 +1054,13 @@ static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
  *				and limit how much space is granted back to the
  *				client. Otherwise, the server should try hard to
  *				satisfy the client request.
+ * \param[in] budget		\a left is the space reserved by the export CPT
  *
  * \retval			amount of grant space allocated
  */
 static long tgt_grant_alloc(struct obd_export *exp, u64 curgrant,
 			    u64 want, u64 left, long chunk,
-			    bool conservative)
+			    bool conservative, bool budget)
 {
 	struct obd_device	*obd = exp->exp_obd;
 	struct tg_grants_data	*tgd = &obd->u.obt.obt_lut->lut_tgd;
@@ -962,14 +1128,13 @@ static long tgt_grant_alloc(struct obd_export *exp, u64 curgrant,
 	if (ted->ted_grant + grant > want + chunk)
 		grant = want + chunk - ted->ted_grant;
 
-	tgd->tgd_tot_granted += grant;
+	tgt_grant_take(tgd, tgt_grant_shard(tgd, exp), grant, budget);
 	ted->ted_grant += grant;
 
 	if (unlikely(ted->ted_grant < 0 || ted->ted_grant > want + chunk)) {
 		CERROR("%s: cli %s/%p grant %ld want %llu current %llu\n",
 		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
 		       ted->ted_grant, want, curgrant);
-		spin_unlock(&tgd->tgd_grant_lock);
 		if (tgd->tgd_lbug_on_grant_miscount)
 			LBUG();
 	}
@@ -1032,21 +1197,22 @@ void tgt_grant_connect(const struct lu_env *env, struct obd_export *exp,
 refresh:
 	tgt_grant_statfs(env, exp, force, &from_cache);
 
-	spin_lock(&tgd->tgd_grant_lock);
+	cfs_percpt_lock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
 
 	/* Grab free space from cached info and take out space already granted
 	 * to clients as well as reserved space */
-	left = tgt_grant_space_left(exp);
+	left = tgt_grant_space_left_reclaim(exp, 32 * chunk);
 
 	/* get fresh statfs data if we are short in ungranted space */
 	if (from_cache && left < 32 * chunk) {
-		spin_unlock(&tgd->tgd_grant_lock);
+		cfs_percpt_unlock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
 		CDEBUG(D_CACHE, "fs has no space left and statfs too old\n");
 		force = 1;
 		goto refresh;
 	}
 
-	tgt_grant_alloc(exp, (u64)ted->ted_grant, want, left, chunk, new_conn);
+	tgt_grant_alloc(exp, (u64)ted->ted_grant, want, left, chunk, new_conn,
+			false);
 
 	/* return to client its current grant */
 	if (OCD_HAS_FLAG(data, GRANT_PARAM))
@@ -1056,13 +1222,13 @@ refresh:
 		data->ocd_grant = tgt_grant_deflate(tgd, (u64)ted->ted_grant);
 
 	/* reset dirty accounting */
-	tgd->tgd_tot_dirty -= ted->ted_dirty;
+	tgt_grant_shard(tgd, exp)->tgs_dirty -= ted->ted_dirty;
 	ted->ted_dirty = 0;
 
 	if (new_conn && OCD_HAS_FLAG(data, GRANT))
 		tgd->tgd_tot_granted_clients++;
 
-	spin_unlock(&tgd->tgd_grant_lock);
+	cfs_percpt_unlock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
 
 	CDEBUG(D_CACHE, "%s: cli %s/%p ocd_grant: %d want: %llu left: %llu\n",
 	       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid,
@@ -1093,7 +1259,8 @@ void tgt_grant_discard(struct obd_export *exp)
 		return;
 
 	tgd = &lut->lut_tgd;
-	spin_lock(&tgd->tgd_grant_lock);
+	cfs_percpt_lock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
+	tgt_grant_fold(lut, false);
 	if (unlikely(tgd->tgd_tot_granted < ted->ted_grant ||
 		     tgd->tgd_tot_dirty < ted->ted_dirty)) {
 		struct obd_export *e;
@@ -1130,7 +1297,7 @@ void tgt_grant_discard(struct obd_export *exp)
 	}
 	/* tgd_tot_pending is handled in tgt_grant_commit as bulk
 	 * commmits */
-	spin_unlock(&tgd->tgd_grant_lock);
+	cfs_percpt_unlock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
 }
 EXPORT_SYMBOL(tgt_grant_discard);
 
@@ -1153,6 +1320,7 @@ void tgt_grant_prepare_read(const struct lu_env *env,
 	struct lu_target	*lut = exp->exp_obd->u.obt.obt_lut;
 	struct tg_grants_data	*tgd = &lut->lut_tgd;
 	int			 do_shrink;
+	int			 idx;
 	u64			 left = 0;
 
 	ENTRY;
@@ -1174,11 +1342,14 @@ void tgt_grant_prepare_read(const struct lu_env *env,
 		tgt_grant_statfs(env, exp, 1, NULL);
 
 		/* protect all grant counters */
-		spin_lock(&tgd->tgd_grant_lock);
+		idx = CFS_PERCPT_LOCK_EX;
+		cfs_percpt_lock(tgd->tgd_grant_lock, idx);
 
 		/* Grab free space from cached statfs data and take out space
 		 * already granted to clients as well as reserved space */
-		left = tgt_grant_space_left(exp);
+		left = tgt_grant_space_left_reclaim(exp,
+				tgd->tgd_tot_granted_clients *
+				TGT_GRANT_SHRINK_LIMIT(exp));
 
 		/* all set now to proceed with shrinking */
 		do_shrink = 1;
@@ -1186,8 +1357,10 @@ void tgt_grant_prepare_read(const struct lu_env *env,
 		/* no grant shrinking request packed in the obdo and
 		 * since we don't grant space back on reads, no point
 		 * in running statfs, so just skip it and process
-		 * incoming grant data directly. */
-		spin_lock(&tgd->tgd_grant_lock);
+		 * incoming grant data directly, only the grant counters of
+		 * this export are involved. */
+		idx = tgt_grant_cpt(tgd, exp);
+		cfs_percpt_lock(tgd->tgd_grant_lock, idx);
 		do_shrink = 0;
 	}
 
@@ -1204,7 +1377,7 @@ void tgt_grant_prepare_read(const struct lu_env *env,
 
 	if (!exp_grant_param_supp(exp))
 		oa->o_grant = tgt_grant_deflate(tgd, oa->o_grant);
-	spin_unlock(&tgd->tgd_grant_lock);
+	cfs_percpt_unlock(tgd->tgd_grant_lock, idx);
 	EXIT;
 }
 EXPORT_SYMBOL(tgt_grant_prepare_read);
@@ -1223,6 +1396,9 @@ EXPORT_SYMBOL(tgt_grant_prepare_read);
  * the backend storage. This function works in pair with tgt_grant_commit()
  * which must be invoked once all buffers have been written to disk in order
  * to release space from the pending grant counter.
+ * Grant space is allocated out of the space reserved by the CPT the export is
+ * hashed to, so that only the grant lock of that CPT is needed as long as
+ * the reservation lasts.
  *
  * \param[in] env	LU environment provided by the caller
  * \param[in] exp	export of the client which sent the request
@@ -1237,26 +1413,49 @@ void tgt_grant_prepare_write(const struct lu_env *env,
 	struct obd_device	*obd = exp->exp_obd;
 	struct lu_target	*lut = obd->u.obt.obt_lut;
 	struct tg_grants_data	*tgd = &lut->lut_tgd;
+	struct tg_grants_shard	*tgs = tgt_grant_shard(tgd, exp);
 	u64			 left;
+	u64			 shrink_left = 0;
 	int			 from_cache;
 	int			 force = 0; /* can use cached data intially */
+	int			 idx;
 	long			 chunk = tgt_grant_chunk(exp, lut, NULL);
+	bool			 shrink;
 
 	ENTRY;
 
+	shrink = (oa->o_valid & OBD_MD_FLFLAGS) &&
+		 (oa->o_flags & OBD_FL_SHRINK_GRANT);
 refresh:
 	/* get statfs information from OSD layer */
 	tgt_grant_statfs(env, exp, force, &from_cache);
 
-	spin_lock(&tgd->tgd_grant_lock); /* protect all grant counters */
+	/* protect the grant counters of the export CPT */
+	idx = tgt_grant_cpt(tgd, exp);
+	cfs_percpt_lock(tgd->tgd_grant_lock, idx);
+
+	if (shrink || tgs->tgs_avail < 32 * chunk) {
+		/* shrink needs the space left on the whole target, refilling
+		 * the space reserved by the CPT needs it as well */
+		cfs_percpt_unlock(tgd->tgd_grant_lock, idx);
+		idx = CFS_PERCPT_LOCK_EX;
+		cfs_percpt_lock(tgd->tgd_grant_lock, idx);
+
+		if (shrink)
+			shrink_left = tgt_grant_space_left_reclaim(exp,
+					tgd->tgd_tot_granted_clients *
+					TGT_GRANT_SHRINK_LIMIT(exp));
+		if (tgs->tgs_avail < 32 * chunk)
+			tgt_grant_refill(exp, tgs, 32 * chunk - tgs->tgs_avail);
+	}
 
-	/* Grab free space from cached statfs data and take out space already
-	 * granted to clients as well as reserved space */
-	left = tgt_grant_space_left(exp);
+	/* Grab free space reserved by the CPT, space already granted to
+	 * clients as well as reserved space were taken out of it */
+	left = max_t(s64, tgs->tgs_avail, 0);
 
 	/* Get fresh statfs data if we are short in ungranted space */
 	if (from_cache && left < 32 * chunk) {
-		spin_unlock(&tgd->tgd_grant_lock);
+		cfs_percpt_unlock(tgd->tgd_grant_lock, idx);
 		CDEBUG(D_CACHE, "%s: fs has no space left and statfs too old\n",
 		       obd->obd_name);
 		force = 1;
@@ -1280,7 +1479,7 @@ refresh:
 		if (!from_grant) {
 			/* at least one network buffer requires acquiring grant
 			 * space on the server */
-			spin_unlock(&tgd->tgd_grant_lock);
+			cfs_percpt_unlock(tgd->tgd_grant_lock, idx);
 			/* discard errors, at least we tried ... */
 			dt_sync(env, lut->lut_bottom);
 			force = 2;
@@ -1293,26 +1492,25 @@ refresh:
 	tgt_grant_incoming(env, exp, oa, chunk);
 
 	/* check limit */
-	tgt_grant_check(env, exp, oa, rnb, niocount, &left);
+	tgt_grant_check(env, exp, oa, rnb, niocount, &left, true);
 
 	if (!(oa->o_valid & OBD_MD_FLGRANT)) {
-		spin_unlock(&tgd->tgd_grant_lock);
+		cfs_percpt_unlock(tgd->tgd_grant_lock, idx);
 		RETURN_EXIT;
 	}
 
 	/* if OBD_FL_SHRINK_GRANT is set, the client is willing to release some
 	 * grant space. */
-	if ((oa->o_valid & OBD_MD_FLFLAGS) &&
-	    (oa->o_flags & OBD_FL_SHRINK_GRANT))
-		tgt_grant_shrink(exp, oa, left);
+	if (shrink)
+		tgt_grant_shrink(exp, oa, shrink_left);
 	else
 		/* grant more space back to the client if possible */
 		oa->o_grant = tgt_grant_alloc(exp, oa->o_grant, oa->o_undirty,
-					      left, chunk, true);
+					      left, chunk, true, true);
 
 	if (!exp_grant_param_supp(exp))
 		oa->o_grant = tgt_grant_deflate(tgd, oa->o_grant);
-	spin_unlock(&tgd->tgd_grant_lock);
+	cfs_percpt_unlock(tgd->tgd_grant_lock, idx);
 	EXIT;
 }
 EXPORT_SYMBOL(tgt_grant_prepare_write);
@@ -1354,26 +1552,27 @@ long tgt_grant_create(const struct lu_env *env, struct obd_export *exp, s64 *nr)
 	tgt_grant_statfs(env, exp, 1, NULL);
 
 	/* protect all grant counters */
-	spin_lock(&tgd->tgd_grant_lock);
+	cfs_percpt_lock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
 
 	/* fail precreate request if there is not enough blocks available for
 	 * writing */
 	if (tgd->tgd_osfs.os_bavail - (ted->ted_grant >> tgd->tgd_blockbits) <
 	    (tgd->tgd_osfs.os_blocks >> 10)) {
-		spin_unlock(&tgd->tgd_grant_lock);
+		cfs_percpt_unlock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
 		CDEBUG(D_RPCTRACE, "%s: not enough space for create %llu\n",
 		       exp->exp_obd->obd_name,
 		       tgd->tgd_osfs.os_bavail * tgd->tgd_osfs.os_blocks);
 		RETURN(-ENOSPC);
 	}
 
-	/* Grab free space from cached statfs data and take out space
-	 * already granted to clients as well as reserved space */
-	left = tgt_grant_space_left(exp);
-
 	/* compute how much space is required to handle the precreation
 	 * request */
 	wanted = *nr * lut->lut_dt_conf.ddp_inodespace;
+
+	/* Grab free space from cached statfs data and take out space
+	 * already granted to clients as well as reserved space */
+	left = tgt_grant_space_left_reclaim(exp, wanted);
+
 	if (wanted > ted->ted_grant + left) {
 		/* that's beyond what remains, adjust the number of objects that
 		 * can be safely precreated */
@@ -1382,7 +1581,8 @@ long tgt_grant_create(const struct lu_env *env, struct obd_export *exp, s64 *nr)
 		if (*nr == 0) {
 			/* we really have no space any more for precreation,
 			 * fail the precreate request with ENOSPC */
-			spin_unlock(&tgd->tgd_grant_lock);
+			cfs_percpt_unlock(tgd->tgd_grant_lock,
+					  CFS_PERCPT_LOCK_EX);
 			RETURN(-ENOSPC);
 		}
 		/* compute space needed for the new number of creations */
@@ -1395,13 +1595,14 @@ long tgt_grant_create(const struct lu_env *env, struct obd_export *exp, s64 *nr)
 		ted->ted_grant -= wanted;
 	} else {
 		/* we need to take some space from the ungranted pool */
-		tgd->tgd_tot_granted += wanted - ted->ted_grant;
+		tgt_grant_take(tgd, tgt_grant_shard(tgd, exp),
+			       wanted - ted->ted_grant, false);
 		left -= wanted - ted->ted_grant;
 		ted->ted_grant = 0;
 	}
 	granted = wanted;
 	ted->ted_pending += granted;
-	tgd->tgd_tot_pending += granted;
+	tgt_grant_shard(tgd, exp)->tgs_pending += granted;
 
 	/* grant more space for precreate purpose if possible. */
 	wanted = OST_MAX_PRECREATE * lut->lut_dt_conf.ddp_inodespace / 2;
@@ -1413,9 +1614,9 @@ long tgt_grant_create(const struct lu_env *env, struct obd_export *exp, s64 *nr)
 		chunk = tgt_grant_chunk(exp, lut, NULL);
 		wanted -= ted->ted_grant;
 		tgt_grant_alloc(exp, ted->ted_grant, wanted, left, chunk,
-				false);
+				false, false);
 	}
-	spin_unlock(&tgd->tgd_grant_lock);
+	cfs_percpt_unlock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
 	RETURN(granted);
 }
 EXPORT_SYMBOL(tgt_grant_create);
@@ -1424,6 +1625,8 @@ EXPORT_SYMBOL(tgt_grant_create);
  * Release grant space added to the pending counter by tgt_grant_prepare_write()
  *
  * Update pending grant counter once buffers have been written to the disk.
+ * Only the grant lock of the export CPT is taken, space written is taken out
+ * of cached statfs data when the CPT accounting is folded.
  *
  * \param[in] exp	export of the client which sent the request
  * \param[in] pending	amount of reserved space to be released
@@ -1433,6 +1636,8 @@ void tgt_grant_commit(struct obd_export *exp, unsigned long pending,
 		      int rc)
 {
 	struct tg_grants_data *tgd = &exp->exp_obd->u.obt.obt_lut->lut_tgd;
+	struct tg_grants_shard *tgs;
+	int idx;
 
 	ENTRY;
 
@@ -1441,53 +1646,32 @@ void tgt_grant_commit(struct obd_export *exp, unsigned long pending,
 	if (pending == 0)
 		RETURN_EXIT;
 
-	spin_lock(&tgd->tgd_grant_lock);
-	/* Don't update statfs data for errors raised before commit (e.g.
-	 * bulk transfer failed, ...) since we know those writes have not been
-	 * processed. For other errors hit during commit, we cannot really tell
-	 * whether or not something was written, so we update statfs data.
-	 * In any case, this should not be fatal since we always get fresh
-	 * statfs data before failing a request with ENOSPC */
-	if (rc == 0) {
-		spin_lock(&tgd->tgd_osfs_lock);
-		/* Take pending out of cached statfs data */
-		tgd->tgd_osfs.os_bavail -= min_t(u64,
-						 tgd->tgd_osfs.os_bavail,
-						 pending >> tgd->tgd_blockbits);
-		if (tgd->tgd_statfs_inflight)
-			/* someone is running statfs and want to be notified of
-			 * writes happening meanwhile */
-			tgd->tgd_osfs_inflight += pending;
-		spin_unlock(&tgd->tgd_osfs_lock);
-	}
-
+	idx = tgt_grant_cpt(tgd, exp);
+	tgs = tgd->tgd_grant_shards[idx];
+	cfs_percpt_lock(tgd->tgd_grant_lock, idx);
 	if (exp->exp_target_data.ted_pending < pending) {
 		CERROR("%s: cli %s/%p ted_pending(%lu) < grant_used(%lu)\n",
 		       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid, exp,
 		       exp->exp_target_data.ted_pending, pending);
-		spin_unlock(&tgd->tgd_grant_lock);
+		cfs_percpt_unlock(tgd->tgd_grant_lock, idx);
 		LBUG();
 	}
 	exp->exp_target_data.ted_pending -= pending;
+	tgs->tgs_granted -= pending;
+	tgs->tgs_pending -= pending;
 
-	if (tgd->tgd_tot_granted < pending) {
-		CERROR("%s: cli %s/%p tot_granted(%llu) < grant_used(%lu)\n",
-		       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid, exp,
-		       tgd->tgd_tot_granted, pending);
-		spin_unlock(&tgd->tgd_grant_lock);
-		LBUG();
-	}
-	tgd->tgd_tot_granted -= pending;
-
-	if (tgd->tgd_tot_pending < pending) {
-		CERROR("%s: cli %s/%p tot_pending(%llu) < grant_used(%lu)\n",
-		       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid, exp,
-		       tgd->tgd_tot_pending, pending);
-		spin_unlock(&tgd->tgd_grant_lock);
-		LBUG();
-	}
-	tgd->tgd_tot_pending -= pending;
-	spin_unlock(&tgd->tgd_grant_lock);
+	/* Don't update statfs data for errors raised before commit (e.g.
+	 * bulk transfer failed, ...) since we know those writes have not been
+	 * processed, the space is given back to the CPT reservation. For other
+	 * errors hit during commit, we cannot really tell whether or not
+	 * something was written, so we update statfs data.
+	 * In any case, this should not be fatal since we always get fresh
+	 * statfs data before failing a request with ENOSPC */
+	if (rc == 0)
+		tgs->tgs_written += pending;
+	else
+		tgs->tgs_avail += pending;
+	cfs_percpt_unlock(tgd->tgd_grant_lock, idx);
 	EXIT;
 }
 EXPORT_SYMBOL(tgt_grant_commit);
@@ -1565,6 +1749,21 @@ int tgt_grant_commit_cb_add(struct thandle *th, struct obd_export *exp,
 }
 EXPORT_SYMBOL(tgt_grant_commit_cb_add);
 
+/* Fold CPT grant accounting and return one of the global grant counters */
+static u64 tgt_grant_total(struct obd_device *obd, u64 *counter)
+{
+	struct lu_target *lut = obd->u.obt.obt_lut;
+	struct tg_grants_data *tgd = &lut->lut_tgd;
+	u64 val;
+
+	cfs_percpt_lock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
+	tgt_grant_fold(lut, false);
+	val = *counter;
+	cfs_percpt_unlock(tgd->tgd_grant_lock, CFS_PERCPT_LOCK_EX);
+
+	return val;
+}
+
 /**
  * Show estimate of total amount of dirty data on clients.
  *
@@ -1583,7 +1782,8 @@ ssize_t tot_dirty_show(struct kobject *kobj, struct attribute *attr,
 	struct tg_grants_data *tgd;
 
 	tgd = &obd->u.obt.obt_lut->lut_tgd;
-	return scnprintf(buf, PAGE_SIZE, "%llu\n", tgd->tgd_tot_dirty);
+	return scnprintf(buf, PAGE_SIZE, "%llu\n",
+			 tgt_grant_total(obd, &tgd->tgd_tot_dirty));
 }
 EXPORT_SYMBOL(tot_dirty_show);
 
@@ -1605,7 +1805,8 @@ ssize_t tot_granted_show(struct kobject *kobj, struct attribute *attr,
 	struct tg_grants_data *tgd;
 
 	tgd = &obd->u.obt.obt_lut->lut_tgd;
-	return scnprintf(buf, PAGE_SIZE, "%llu\n", tgd->tgd_tot_granted);
+	return scnprintf(buf, PAGE_SIZE, "%llu\n",
+			 tgt_grant_total(obd, &tgd->tgd_tot_granted));
 }
 EXPORT_SYMBOL(tot_granted_show);
 
@@ -1627,7 +1828,8 @@ ssize_t tot_pending_show(struct kobject *kobj, struct attribute *attr,
 	struct tg_grants_data *tgd;
 
 	tgd = &obd->u.obt.obt_lut->lut_tgd;
-	return scnprintf(buf, PAGE_SIZE, "%llu\n", tgd->tgd_tot_pending);
+	return scnprintf(buf, PAGE_SIZE, "%llu\n",
+			 tgt_grant_total(obd, &tgd->tgd_tot_pending));
 }
 EXPORT_SYMBOL(tot_pending_show);
 
@@ -459,6 +459,22 @@ static int tgt_handle_request0(struct tgt_session_info *tsi,
 					 remote_nb[0].rnb_len : 0);
 		}
 
+		/* batched QUOTA_DQACQ replies one body per requested ID */
+		if (req_capsule_has_field(tsi->tsi_pill, &RMF_QUOTA_BODY_ARRAY,
+					  RCL_SERVER)) {
+			int size = 0;
+
+			if (req_capsule_field_present(tsi->tsi_pill,
+						      &RMF_QUOTA_BODY_ARRAY,
+						      RCL_CLIENT))
+				size = req_capsule_get_size(tsi->tsi_pill,
+							&RMF_QUOTA_BODY_ARRAY,
+							RCL_CLIENT);
+			req_capsule_set_size(tsi->tsi_pill,
+					     &RMF_QUOTA_BODY_ARRAY,
+					     RCL_SERVER, size);
+		}
+
 		rc = req_capsule_server_pack(tsi->tsi_pill);
 	}
 
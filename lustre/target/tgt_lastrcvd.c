@@ -72,9 +72,8 @@ static int tgt_bitmap_chunk_alloc(struct lu_target *lut, int chunk)
 /* Look for an available reply data slot in the bitmap
  * of the target @lut
  * Allocate bitmap chunk when first used
- * XXX algo could be improved if this routine limits performance
  */
-static int tgt_find_free_reply_slot(struct lu_target *lut)
+static int tgt_bitmap_find_free_slot(struct lu_target *lut)
 {
 	unsigned long *bmp;
 	int chunk = 0;
@@ -105,6 +104,108 @@ static int tgt_find_free_reply_slot(struct lu_target *lut)
 	return -ENOSPC;
 }
 
+#define LUT_REPLY_WORDS_PER_CHUNK BITS_TO_LONGS(LUT_REPLY_SLOTS_PER_CHUNK)
+
+/* Claim a whole word of free slots in the reply bitmap of the target @lut,
+ * looking from the @cursor word onwards and then from the beginning.
+ * Return the index of the first slot of the word, which is marked used.
+ * The other slots of the word are left clear for the cache of the caller,
+ * other CPTs don't claim the word as it is not empty anymore.
+ */
+static int tgt_bitmap_claim_slots(struct lu_target *lut, int *cursor)
+{
+	int start = *cursor;
+	int end = LUT_REPLY_SLOTS_MAX_CHUNKS * LUT_REPLY_WORDS_PER_CHUNK;
+	int pass;
+	int w;
+	int rc;
+
+	/* the first chunk is allocated on first use, later chunks are only
+	 * allocated by tgt_bitmap_find_free_slot() once previous ones are full
+	 * to keep the reply_data file as small as possible */
+	if (unlikely(lut->lut_reply_bitmap[0] == NULL)) {
+		rc = tgt_bitmap_chunk_alloc(lut, 0);
+		if (rc != 0)
+			return rc;
+	}
+
+	for (pass = 0; pass < 2; pass++) {
+		for (w = start; w < end; w++) {
+			unsigned long *bmp;
+
+			bmp = lut->lut_reply_bitmap[w / LUT_REPLY_WORDS_PER_CHUNK];
+			if (bmp == NULL) {
+				/* skip the whole chunk */
+				w += LUT_REPLY_WORDS_PER_CHUNK - 1 -
+				     w % LUT_REPLY_WORDS_PER_CHUNK;
+				continue;
+			}
+
+			bmp += w % LUT_REPLY_WORDS_PER_CHUNK;
+			if (READ_ONCE(*bmp) == 0 && cmpxchg(bmp, 0, 1UL) == 0) {
+				*cursor = w + 1 < end ? w + 1 : 0;
+				return w * BITS_PER_LONG;
+			}
+		}
+		end = start;
+		start = 0;
+	}
+
+	return -ENOSPC;
+}
+
+/* Get an available reply data slot for the target @lut
+ * Slots are taken from the cache of the current CPT, which is refilled
+ * with a whole bitmap word of slots when empty. If no such word is
+ * available, fall back to looking for a single slot in the bitmap.
+ *
+ * Cached slots are clear in the bitmap, so that clearing a slot twice is
+ * still caught by tgt_clear_reply_slot(). A cached slot is only used once
+ * its bit is set here, it may have been taken by the single slot search
+ * meanwhile or be cached twice.
+ */
+static int tgt_find_free_reply_slot(struct lu_target *lut)
+{
+	struct tg_reply_slot_cache *trsc;
+	int idx;
+	int i;
+
+	if (lut->lut_reply_cache == NULL)
+		return tgt_bitmap_find_free_slot(lut);
+
+	trsc = lut->lut_reply_cache[cfs_cpt_current(cfs_cpt_tab, 0)];
+	spin_lock(&trsc->trsc_lock);
+	while (trsc->trsc_count > 0) {
+		idx = trsc->trsc_slots[--trsc->trsc_count];
+		if (test_and_set_bit(idx % LUT_REPLY_SLOTS_PER_CHUNK,
+			lut->lut_reply_bitmap[idx / LUT_REPLY_SLOTS_PER_CHUNK])
+		    == 0) {
+			spin_unlock(&trsc->trsc_lock);
+			return idx;
+		}
+	}
+	i = trsc->trsc_cursor;
+	spin_unlock(&trsc->trsc_lock);
+
+	idx = tgt_bitmap_claim_slots(lut, &i);
+	if (idx < 0)
+		return tgt_bitmap_find_free_slot(lut);
+
+	/* keep the first slot, cache the other ones in reverse order so that
+	 * they are used in ascending order, slots freed meanwhile may have
+	 * filled the cache already */
+	spin_lock(&trsc->trsc_lock);
+	trsc->trsc_cursor = i;
+	for (i = BITS_PER_LONG - 1; i > 0; i--) {
+		if (trsc->trsc_count == LUT_REPLY_SLOTS_CACHE)
+			break;
+		trsc->trsc_slots[trsc->trsc_count++] = idx + i;
+	}
+	spin_unlock(&trsc->trsc_lock);
+
+	return idx;
+}
+
 /* Mark the reply data slot @idx 'used' in the corresponding bitmap chunk
  * of the target @lut
  * Allocate the bitmap chunk if necessary
@@ -172,6 +273,17 @@ static int tgt_clear_reply_slot(struct lu_target *lut, int idx)
 		return -EALREADY;
 	}
 
+	if (lut->lut_reply_cache != NULL) {
+		struct tg_reply_slot_cache *trsc;
+
+		/* reuse the slot from the cache of the current CPT first */
+		trsc = lut->lut_reply_cache[cfs_cpt_current(cfs_cpt_tab, 0)];
+		spin_lock(&trsc->trsc_lock);
+		if (trsc->trsc_count < LUT_REPLY_SLOTS_CACHE)
+			trsc->trsc_slots[trsc->trsc_count++] = idx;
+		spin_unlock(&trsc->trsc_lock);
+	}
+
 	return 0;
 }
 
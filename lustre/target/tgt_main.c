@@ -467,6 +467,16 @@ void tgt_cancel_slc_locks(struct lu_target *lut, __u64 transno)
 	}
 }
 
+static void tgt_grants_data_free(struct tg_grants_data *tgd)
+{
+	if (tgd->tgd_grant_shards != NULL)
+		cfs_percpt_free(tgd->tgd_grant_shards);
+	tgd->tgd_grant_shards = NULL;
+	if (tgd->tgd_grant_lock != NULL)
+		cfs_percpt_lock_free(tgd->tgd_grant_lock);
+	tgd->tgd_grant_lock = NULL;
+}
+
 int tgt_init(const struct lu_env *env, struct lu_target *lut,
 	     struct obd_device *obd, struct dt_device *dt,
 	     struct tgt_opc_slice *slice, int request_fail_id,
@@ -477,6 +487,7 @@ int tgt_init(const struct lu_env *env, struct lu_target *lut,
 	struct lu_fid		 fid;
 	struct dt_object	*o;
 	struct tg_grants_data	*tgd = &lut->lut_tgd;
+	struct tg_reply_slot_cache *trsc;
 	struct obd_statfs	*osfs;
 	int i, rc = 0;
 
@@ -492,6 +503,9 @@ int tgt_init(const struct lu_env *env, struct lu_target *lut,
 	atomic_set(&lut->lut_client_generation, 0);
 	lut->lut_reply_data = NULL;
 	lut->lut_reply_bitmap = NULL;
+	lut->lut_reply_cache = NULL;
+	tgd->tgd_grant_lock = NULL;
+	tgd->tgd_grant_shards = NULL;
 	obd->u.obt.obt_lut = lut;
 	obd->u.obt.obt_magic = OBT_MAGIC;
 
@@ -528,10 +542,17 @@ int tgt_init(const struct lu_env *env, struct lu_target *lut,
 	tgd->tgd_osfs_inflight = 0;
 
 	/* grant data */
-	spin_lock_init(&tgd->tgd_grant_lock);
+	tgd->tgd_grant_lock = cfs_percpt_lock_alloc(cfs_cpt_tab);
+	if (tgd->tgd_grant_lock == NULL)
+		GOTO(out_put, rc = -ENOMEM);
+	tgd->tgd_grant_shards = cfs_percpt_alloc(cfs_cpt_tab,
+					sizeof(struct tg_grants_shard));
+	if (tgd->tgd_grant_shards == NULL)
+		GOTO(out_put, rc = -ENOMEM);
 	tgd->tgd_tot_dirty = 0;
 	tgd->tgd_tot_granted = 0;
 	tgd->tgd_tot_pending = 0;
+	tgd->tgd_tot_reserved = 0;
 	tgd->tgd_grant_compat_disable = 0;
 	tgd->tgd_lbug_on_grant_miscount = 0;
 
@@ -601,6 +622,13 @@ int tgt_init(const struct lu_env *env, struct lu_target *lut,
 	if (lut->lut_reply_bitmap == NULL)
 		GOTO(out, rc = -ENOMEM);
 
+	lut->lut_reply_cache = cfs_percpt_alloc(cfs_cpt_tab,
+					sizeof(struct tg_reply_slot_cache));
+	if (lut->lut_reply_cache == NULL)
+		GOTO(out, rc = -ENOMEM);
+	cfs_percpt_for_each(trsc, i, lut->lut_reply_cache)
+		spin_lock_init(&trsc->trsc_lock);
+
 	memset(&attr, 0, sizeof(attr));
 	attr.la_valid = LA_MODE;
 	attr.la_mode = S_IFREG | S_IRUGO | S_IWUSR;
@@ -628,6 +656,7 @@ out:
 out_put:
 	obd->u.obt.obt_magic = 0;
 	obd->u.obt.obt_lut = NULL;
+	tgt_grants_data_free(tgd);
 	if (lut->lut_last_rcvd != NULL) {
 		dt_object_put(env, lut->lut_last_rcvd);
 		lut->lut_last_rcvd = NULL;
@@ -650,6 +679,9 @@ out_put:
 			 LUT_REPLY_SLOTS_MAX_CHUNKS * sizeof(unsigned long *));
 	}
 	lut->lut_reply_bitmap = NULL;
+	if (lut->lut_reply_cache != NULL)
+		cfs_percpt_free(lut->lut_reply_cache);
+	lut->lut_reply_cache = NULL;
 	return rc;
 }
 EXPORT_SYMBOL(tgt_init);
@@ -689,6 +721,9 @@ void tgt_fini(const struct lu_env *env, struct lu_target *lut)
 			 LUT_REPLY_SLOTS_MAX_CHUNKS * sizeof(unsigned long *));
 	}
 	lut->lut_reply_bitmap = NULL;
+	if (lut->lut_reply_cache != NULL)
+		cfs_percpt_free(lut->lut_reply_cache);
+	lut->lut_reply_cache = NULL;
 	if (lut->lut_client_bitmap) {
 		OBD_FREE(lut->lut_client_bitmap, LR_MAX_CLIENTS >> 3);
 		lut->lut_client_bitmap = NULL;
@@ -698,6 +733,7 @@ void tgt_fini(const struct lu_env *env, struct lu_target *lut)
 		dt_object_put(env, lut->lut_last_rcvd);
 		lut->lut_last_rcvd = NULL;
 	}
+	tgt_grants_data_free(&lut->lut_tgd);
 	EXIT;
 }
 EXPORT_SYMBOL(tgt_fini);
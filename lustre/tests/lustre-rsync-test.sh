@@ -674,6 +674,39 @@ test_9() {
 }
 run_test 9 "Replicate recursive directory removal"
 
+# Test 10 - Replicate a mixed workload with the parallel pipeline
+test_10() {
+	init_src
+	init_changelog
+
+	local numfiles=500
+	local i
+
+	for i in $(seq 4); do
+		mkdir $DIR/$tdir/d$i || error "mkdir d$i failed"
+		createmany -o $DIR/$tdir/d$i/$tfile $numfiles ||
+			error "createmany in d$i failed"
+		dd if=/dev/urandom of=$DIR/$tdir/d$i/data bs=1M count=4 ||
+			error "write to d$i failed"
+	done
+	unlinkmany $DIR/$tdir/d2/$tfile $numfiles || error "unlinkmany failed"
+	mv $DIR/$tdir/d3 $DIR/$tdir/d1/d3 || error "mv d3 failed"
+	ln $DIR/$tdir/d4/data $DIR/$tdir/d1/data_link || error "link failed"
+	echo overwrite > $DIR/$tdir/d4/${tfile}0 || error "overwrite failed"
+
+	local LRSYNC_LOG=$(generate_logname "lrsync_log")
+	# Replicate the changes to $TGT with several threads
+	$LRSYNC -s $DIR -t $TGT -t $TGT2 -m $MDT0 -u $CL_USER -l $LREPL_LOG \
+		-D $LRSYNC_LOG --threads=8 || error "lustre_rsync failed"
+	check_diff $DIR/$tdir $TGT/$tdir
+	check_diff $DIR/$tdir $TGT2/$tdir
+
+	fini_changelog
+	cleanup_src_tgt
+	return 0
+}
+run_test 10 "Replicate with parallel threads"
+
 cd $ORIG_PWD
 complete $SECONDS
 check_and_cleanup_lustre
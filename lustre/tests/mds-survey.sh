@@ -124,6 +124,34 @@ test_2() {
 }
 run_test 2 "Metadata survey with stripe_count = 1"
 
+test_3() {
+	local masks=()
+	local rc=0
+	local i
+
+	for ((i = 1; i <= MDSCOUNT; i++)); do
+		masks[$i]=$(do_facet mds$i $LCTL get_param -n \
+			    mdd.$(facet_svc mds$i).changelog_mask)
+	done
+
+	# same workload as test_1 while every MDT records a changelog,
+	# the difference gives the cost of the changelog producer
+	changelog_register || error "changelog_register failed"
+
+	mds_survey_run "mdd" "0"
+
+	# mds_survey_run() replaces the EXIT trap of changelog_register(),
+	# undo the registration here
+	changelog_clear 0 || rc=$?
+	changelog_deregister || error "changelog_deregister failed"
+	for ((i = 1; i <= MDSCOUNT; i++)); do
+		do_facet mds$i $LCTL set_param -n \
+			mdd.$(facet_svc mds$i).changelog_mask="'${masks[$i]}'"
+	done
+	((rc == 0)) || error "changelog_clear failed: rc = $rc"
+}
+run_test 3 "Metadata survey with changelog enabled"
+
 # remount the clients
 restore_mount $MOUNT
 
@@ -6021,6 +6021,88 @@ test_41()
 }
 run_test 41 "SEL support in LFSCK"
 
+test_42() {
+	(( $MDS1_VERSION >= $(version_code 2.14.55) )) ||
+		skip "MDS older than 2.14.55 has no parallel LFSCK assistant"
+
+	local param=mdd.${MDT_DEV}.lfsck_assistant_threads
+	local old_threads=$(do_facet $SINGLEMDS $LCTL get_param -n $param)
+	local workers
+	local repaired
+	local i
+
+	stack_trap "do_facet $SINGLEMDS $LCTL set_param $param=$old_threads"
+
+	do_facet $SINGLEMDS $LCTL set_param $param=17 &&
+		error "(1) should fail to set too many assistant threads"
+	do_facet $SINGLEMDS $LCTL set_param $param=4 ||
+		error "(2) fail to set assistant threads"
+
+	check_mount_and_prep
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir
+
+	for ((i = 0; i < 64; i++)); do
+		dd if=/dev/zero of=$DIR/$tdir/f$i bs=4k count=1 2>/dev/null ||
+			error "(3) Fail to write $DIR/$tdir/f$i"
+	done
+	cancel_lru_locks osc
+
+	createmany -d $DIR/$tdir/d 8 || error "(4) Fail to create dirs"
+
+	echo "Inject failure stub to skip OST-object owner changing"
+	#define OBD_FAIL_LFSCK_BAD_OWNER	0x1613
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0x1613
+	chown 1.1 $DIR/$tdir/f*
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0
+
+	echo "Inject failure stub to create files without linkEA"
+	#define OBD_FAIL_LFSCK_NO_LINKEA	0x161d
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0x161d
+	for ((i = 0; i < 8; i++)); do
+		createmany -o $DIR/$tdir/d$i/f 8 > /dev/null ||
+			error "(5) Fail to create files under d$i"
+	done
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0
+
+	echo "trigger LFSCK for namespace with 4 assistant threads"
+	$START_NAMESPACE -r || error "(6) Fail to start LFSCK for namespace!"
+
+	wait_update_facet $SINGLEMDS "$LCTL get_param -n \
+		mdd.${MDT_DEV}.lfsck_namespace |
+		awk '/^status/ { print \\\$2 }'" "completed" 32 || {
+		$SHOW_NAMESPACE
+		error "(7) unexpected status"
+	}
+
+	repaired=$($SHOW_NAMESPACE | awk '/^linkea_repaired/ { print $2 }')
+	(( repaired == 64 )) ||
+		error "(8) expect 64 linkEA repaired, got $repaired"
+
+	workers=$($SHOW_NAMESPACE | awk '/^assistant_workers/ { print $2 }')
+	(( workers > 1 )) ||
+		error "(9) expect more than one namespace worker, got $workers"
+
+	echo "trigger LFSCK for layout with 4 assistant threads"
+	$START_LAYOUT -r || error "(10) Fail to start LFSCK for layout!"
+
+	wait_update_facet $SINGLEMDS "$LCTL get_param -n \
+		mdd.${MDT_DEV}.lfsck_layout |
+		awk '/^status/ { print \\\$2 }'" "completed" 32 || {
+		$SHOW_LAYOUT
+		error "(11) unexpected status"
+	}
+
+	repaired=$($SHOW_LAYOUT |
+		   awk '/^repaired_inconsistent_owner/ { print $2 }')
+	(( repaired == 64 )) ||
+		error "(12) expect 64 inconsistent owner repaired, got $repaired"
+
+	workers=$($SHOW_LAYOUT | awk '/^assistant_workers/ { print $2 }')
+	(( workers > 1 )) ||
+		error "(13) expect more than one layout worker, got $workers"
+}
+run_test 42 "LFSCK repairs with multiple assistant threads"
+
 # restore MDS/OST size
 MDSSIZE=${SAVED_MDSSIZE}
 OSTSIZE=${SAVED_OSTSIZE}
@@ -2045,6 +2045,99 @@ test_214() {
 }
 run_test 214 "Check local NI status when link is downed"
 
+test_215() {
+	local param=/sys/module/lnet/parameters/lnet_path_selection
+
+	reinit_dlc || return $?
+	add_net "tcp" "${INTERFACES[0]}" || return $?
+
+	[[ -f $param ]] || skip "lnet_path_selection not supported"
+	local old=$(cat $param)
+	stack_trap "echo $old > $param"
+
+	echo 1 > $param || error "failed to enable measured path selection"
+
+	local lnid="$(lctl list_nids | head -n 1)"
+	do_lnetctl ping "$lnid" || error "failed to ping myself"
+
+	local rtt=$($LNETCTL peer show -v --nid $lnid |
+		    awk '/rtt_usec:/{print $NF; exit}')
+
+	echo "rtt_usec for $lnid: $rtt"
+	[[ -n $rtt ]] || error "no path stats reported for $lnid"
+	(( rtt > 0 )) || error "expected a measured rtt for $lnid"
+}
+run_test 215 "Check measured path stats are reported"
+
+test_216() {
+	local param=/sys/module/lnet/parameters/lnet_max_discovery_pings
+
+	reinit_dlc || return $?
+	add_net "tcp" "${INTERFACES[0]}" || return $?
+
+	[[ -f $param ]] || skip "lnet_max_discovery_pings not supported"
+	local old=$(cat $param)
+	stack_trap "echo $old > $param"
+
+	# a single ping slot must still let every discovery through
+	echo 1 > $param || error "failed to set lnet_max_discovery_pings"
+
+	local lnid="$(lctl list_nids | head -n 1)"
+	local skipped
+	local i
+
+	$LCTL set_param debug=+net
+	$LCTL clear
+	for ((i = 0; i < 5; i++)); do
+		do_lnetctl discover --force $lnid ||
+			error "failed to discover myself ($i)"
+	done
+
+	# the same ping buffer is pushed every time, only the first one
+	# needs to be merged
+	skipped=$($LCTL dk | grep -c "Unchanged Push")
+	echo "$skipped unchanged pushes skipped"
+	(( skipped > 0 )) || error "identical pushes were not skipped"
+}
+run_test 216 "Discovery with paced pings"
+
+test_217() {
+	local rxe=rxe_lnet
+	local nid
+
+	which rdma > /dev/null 2>&1 || skip "Need rdma tool"
+	modprobe rdma_rxe 2> /dev/null || skip "Need rdma_rxe module"
+
+	cleanup_netns || error "Failed to cleanup netns before test execution"
+	cleanup_lnet || error "Failed to unload modules before test execution"
+
+	setup_fakeif || error "Failed to add fake IF"
+	stack_trap cleanup_fakeif
+	rdma link add $rxe type rxe netdev $FAKE_IF ||
+		skip "Can't add rxe device on $FAKE_IF"
+	stack_trap "rdma link delete $rxe"
+
+	MODOPTS_KO2IBLND="use_srq=1 srq_rx_init=4" \
+		LNETLND="o2iblnd/ko2iblnd" load_lnet
+	stack_trap cleanup_lnet
+	[[ $(cat /sys/module/ko2iblnd/parameters/use_srq) == 1 ]] ||
+		skip "ko2iblnd does not support use_srq"
+
+	$LCTL clear
+	do_lnetctl lnet configure || error "lnet configure failed"
+	do_lnetctl net add --net o2ib100 --if $FAKE_IF ||
+		error "Failed to add o2ib100 on $FAKE_IF"
+	$LCTL dk | grep -q "$rxe: using SRQs" ||
+		error "SRQs were not set up on $rxe"
+
+	nid=$($LCTL list_nids | grep o2ib100)
+	do_lnetctl ping $nid || error "Failed to ping $nid"
+
+	do_lnetctl net del --net o2ib100 ||
+		error "Failed to delete o2ib100 with SRQs"
+}
+run_test 217 "o2iblnd shared receive queues over rdma_rxe"
+
 test_230() {
 	# LU-12815
 	echo "Check valid values; Should succeed"
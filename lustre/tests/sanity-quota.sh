@@ -5163,6 +5163,100 @@ test_77()
 }
 run_test 77 "lfs setquota should fail in Lustre mount with 'ro'"
 
+# sum of a quota slave stats counter over all MDTs, 0 if never incremented
+qsd_stats_sum()
+{
+	local name=$1
+
+	do_nodes $(comma_list $(mdts_nodes)) \
+		"$LCTL get_param -n osd-*.$FSNAME-MDT*.quota_slave.stats" |
+		awk -v name=$name '{
+			for (i = 1; i < NF; i++)
+				if ($i == name)
+					sum += $(i + 1)
+		} END { print sum + 0 }'
+}
+
+test_78()
+{
+	(( $MDS1_VERSION >= $(version_code 2.14.55) )) ||
+		skip "Need MDS version at least 2.14.55 for batched DQACQ"
+
+	local mdts=$(comma_list $(mdts_nodes))
+	local nr_ids=32
+	local base=60000
+	local files=100
+	local pids=""
+	local old_batch
+	local batched
+	local saved
+	local used
+	local id
+
+	old_batch=$(do_facet mds1 $LCTL get_param -n \
+		osd-*.$FSNAME-MDT0000.quota_slave.max_dqacq_batch)
+	[[ -n "$old_batch" ]] || skip "no quota_slave.max_dqacq_batch on MDT"
+
+	setup_quota_test || error "setup quota failed with $?"
+	set_mdt_qtype $QTYPE || error "enable mdt quota failed"
+
+	for ((id = base; id < base + nr_ids; id++)); do
+		$LFS setquota -u $id -b 0 -B 0 -i 0 -I $((files * 10)) $DIR ||
+			error "set quota for user $id failed"
+	done
+
+	do_nodes $mdts $LCTL set_param -n osd-*.*.quota_slave.stats=clear
+
+	# many IDs acquiring inode quota at the same time
+	for ((id = base; id < base + nr_ids; id++)); do
+		runas -u $id -g $id createmany -m $DIR/$tdir/f$id- $files \
+			> /dev/null &
+		pids+=" $!"
+	done
+	for pid in $pids; do
+		wait $pid || error "createmany failed"
+	done
+
+	for ((id = base; id < base + nr_ids; id++)); do
+		used=$(getquota -u $id global curinodes)
+		(( used == files )) ||
+			error "user $id uses $used inodes, expected $files"
+	done
+
+	do_nodes $mdts $LCTL get_param osd-*.*.quota_slave.stats
+	batched=$(qsd_stats_sum batched_ids)
+	saved=$(qsd_stats_sum rpcs_saved)
+	echo "IDs sent in batches: $batched, RPCs saved: $saved"
+	(( batched > 0 )) || error "no ID was acquired by a batched DQACQ"
+	(( saved > 0 )) || error "batched DQACQ saved no RPC"
+
+	# batching disabled, every ID is adjusted with its own RPC
+	stack_trap "do_nodes $mdts $LCTL set_param \
+		osd-*.*.quota_slave.max_dqacq_batch=$old_batch" EXIT
+	do_nodes $mdts $LCTL set_param osd-*.*.quota_slave.max_dqacq_batch=1 ||
+		error "cannot disable batched DQACQ"
+	do_nodes $mdts $LCTL set_param -n osd-*.*.quota_slave.stats=clear
+	for ((id = base; id < base + nr_ids; id++)); do
+		runas -u $id -g $id createmany -m $DIR/$tdir/g$id- $files \
+			> /dev/null || error "createmany failed"
+		used=$(getquota -u $id global curinodes)
+		(( used == files * 2 )) ||
+			error "user $id uses $used inodes, expected $((files * 2))"
+	done
+
+	do_nodes $mdts $LCTL get_param osd-*.*.quota_slave.stats
+	batched=$(qsd_stats_sum batched_ids)
+	saved=$(qsd_stats_sum rpcs_saved)
+	(( batched == 0 && saved == 0 )) ||
+		error "$batched IDs batched, $saved RPCs saved with batch=1"
+
+	cleanup_quota_test
+	for ((id = base; id < base + nr_ids; id++)); do
+		resetquota -u $id
+	done
+}
+run_test 78 "quota acquire of many IDs with batched DQACQ"
+
 quota_fini()
 {
 	do_nodes $(comma_list $(nodes_list)) \
@@ -1382,6 +1382,42 @@ test_19() {
 }
 run_test 19 "LFSCK can fix multiple linked files on OST"
 
+test_20() {
+	[ "$mds1_FSTYPE" != "ldiskfs" ] &&
+		skip "ldiskfs special test"
+	(( $MDS1_VERSION >= $(version_code 2.14.55) )) ||
+		skip "Need MDS version at least 2.14.55"
+
+	local param=osd-ldiskfs.$(facet_svc $SINGLEMDS).scrub_ra_window
+	local old_window=$(do_facet $SINGLEMDS $LCTL get_param -n $param)
+	local checked
+	local window
+
+	stack_trap "do_facet $SINGLEMDS $LCTL set_param $param=$old_window"
+
+	check_mount_and_prep
+	createmany -o $DIR/$tdir/f 1024 || error "(1) Fail to create files"
+
+	for window in 0 16384; do
+		do_facet $SINGLEMDS $LCTL set_param $param=$window ||
+			error "(2) Fail to set readahead window $window"
+
+		$START_SCRUB -r || error "(3) Fail to start OI scrub"
+		wait_update_facet $SINGLEMDS "$LCTL get_param -n \
+			osd-*.${MDT_DEV}.oi_scrub |
+			awk '/^status/ { print \\\$2 }'" "completed" 30 ||
+			error "(4) OI scrub not completed with window $window"
+
+		local count=$($SHOW_SCRUB | awk '/^checked/ { print $2 }')
+
+		echo "window $window: checked $count"
+		[[ -z "$checked" ]] || (( count == checked )) ||
+			error "(5) checked $count with readahead, expect $checked"
+		checked=$count
+	done
+}
+run_test 20 "OI scrub with inode table readahead"
+
 # restore MDS/OST size
 MDSSIZE=${SAVED_MDSSIZE}
 OSTSIZE=${SAVED_OSTSIZE}
@@ -3395,6 +3395,137 @@ test_27Q() {
 }
 run_test 27Q "llapi_file_get_stripe() works on symlinks"
 
+test_27R() {
+	remote_mds_nodsh && skip "remote MDS with nodsh"
+	[ $MDS1_VERSION -lt $(version_code 2.14.55) ] &&
+		skip "Need MDS version at least 2.14.55"
+
+	local osp="osp.$FSNAME-OST0000-osc-MDT0000"
+	local old=$(do_facet mds1 "$LCTL get_param -n \
+		    $osp.create_rpcs_in_flight")
+
+	# without it the OSP keeps a single precreate RPC in flight
+	do_facet mds1 "$LCTL get_param -n $osp.import" |
+		grep -q pipe_precreate ||
+		skip "OST does not support pipelined precreate"
+
+	do_facet mds1 "$LCTL set_param $osp.create_rpcs_in_flight=4" ||
+		error "set create_rpcs_in_flight failed"
+	stack_trap "do_facet mds1 $LCTL set_param \
+		    $osp.create_rpcs_in_flight=$old"
+	do_facet mds1 "$LCTL set_param $osp.create_rpcs_in_flight=9" &&
+		error "create_rpcs_in_flight over the limit accepted"
+	do_facet mds1 "$LCTL set_param $osp.create_stats=clear"
+
+	test_mkdir -i 0 $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir
+	createmany -o $DIR/$tdir/f 5000 || error "createmany failed"
+	do_facet mds1 "$LCTL get_param $osp.create_stats"
+
+	local dups=$($LFS getstripe $DIR/$tdir |
+		     awk '$1 == 0 { print $2 }' | sort | uniq -d | wc -l)
+	(( dups == 0 )) || error "$dups objects allocated twice"
+
+	local status=$(do_facet mds1 "$LCTL get_param -n \
+		       $osp.prealloc_status")
+	(( status == 0 )) || error "prealloc_status $status"
+
+	unlinkmany $DIR/$tdir/f 5000 || error "unlinkmany failed"
+}
+run_test 27R "precreate with several RPCs in flight"
+
+test_27S() {
+	remote_mds_nodsh && skip "remote MDS with nodsh"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+	[ $MDS1_VERSION -lt $(version_code 2.14.55) ] &&
+		skip "Need MDS version at least 2.14.55"
+	[ $OST1_VERSION -lt $(version_code 2.14.55) ] &&
+		skip "Need OST version at least 2.14.55"
+
+	local osp="osp.$FSNAME-OST0000-osc-MDT0000"
+	local nr=1000
+
+	do_facet mds1 "$LCTL get_param -n $osp.import" |
+		grep -q destroy_batch || skip "OST has no batched destroy"
+
+	test_mkdir -i 0 $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir
+	createmany -o $DIR/$tdir/f $nr || error "createmany failed"
+	wait_delete_completed
+	do_facet ost1 $LCTL set_param obdfilter.*.stats=clear
+
+	unlinkmany $DIR/$tdir/f $nr || error "unlinkmany failed"
+	wait_delete_completed
+
+	local rpcs=$(do_facet ost1 $LCTL get_param -n \
+		     obdfilter.$FSNAME-OST0000.stats |
+		     awk '/^destroy/ { print $2 }')
+	echo "$nr objects destroyed by ${rpcs:-0} RPCs"
+	(( ${rpcs:-0} > 0 && rpcs < nr / 2 )) ||
+		error "destroys were not batched: $rpcs RPCs"
+
+	local left=$(do_facet mds1 "$LCTL get_param -n $osp.sync_changes")
+	(( left == 0 )) || error "$left changes not synced"
+}
+run_test 27S "batched destroy of OST objects"
+
+test_27T() {
+	remote_mds_nodsh && skip "remote MDS with nodsh"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+	[ "$ost1_FSTYPE" == ldiskfs ] || skip "ldiskfs only test"
+	[ $MDS1_VERSION -lt $(version_code 2.14.55) ] &&
+		skip "Need MDS version at least 2.14.55"
+	[ $OST1_VERSION -lt $(version_code 2.14.55) ] &&
+		skip "Need OST version at least 2.14.55"
+
+	local osp="osp.$FSNAME-OST0000-osc-MDT0000"
+	local mntpt=$(facet_mntpt ost1)
+	local nr=100
+	local objs=()
+	local obdidx
+	local oid
+	local hex
+	local seq
+	local f
+	local i
+
+	do_facet mds1 "$LCTL get_param -n $osp.import" |
+		grep -q destroy_batch || skip "OST has no batched destroy"
+
+	test_mkdir -i 0 $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir
+	createmany -o $DIR/$tdir/f $nr || error "createmany failed"
+	sync
+	wait_delete_completed
+
+	for ((i = 0; i < nr; i++)); do
+		read obdidx oid hex seq < <($LFS getstripe $DIR/$tdir/f$i |
+					    awk '$1 == 0 { print }')
+		[[ -n "$seq" ]] || error "no OST object for f$i"
+		seq=${seq#0x}
+		(( 16#$seq == 0 )) && f=$oid || f=${hex#0x}
+		objs+=("$mntpt/O/$seq/d$((oid % 32))/$f")
+	done
+
+	# remove the OST objects behind the back of the MDT, so the
+	# whole destroy batch finds nothing to destroy
+	stop ost1 || error "stop ost1 failed"
+	mount_fstype ost1 || error "mount ost1 as $ost1_FSTYPE failed"
+	do_facet ost1 "rm -f ${objs[*]}"
+	unmount_fstype ost1 || error "umount ost1 as $ost1_FSTYPE failed"
+	start ost1 $(ostdevname 1) $OST_MOUNT_OPTS || error "start ost1 failed"
+	clients_up
+
+	unlinkmany $DIR/$tdir/f $nr || error "unlinkmany failed"
+	wait_delete_completed || error "destroys of missing objects hang"
+
+	local left=$(do_facet mds1 "$LCTL get_param -n $osp.sync_changes")
+	(( left == 0 )) || error "$left changes not synced"
+	local busy=$(do_facet mds1 "$LCTL get_param -n $osp.sync_in_progress")
+	(( busy == 0 )) || error "$busy destroys still in progress"
+}
+run_test 27T "batched destroy of missing OST objects"
+
 # createtest also checks that device nodes are created and
 # then visible correctly (#2091)
 test_28() { # bug 2091
@@ -8133,6 +8264,76 @@ test_56da() { # LU-14179
 }
 run_test 56da "test lfs find with long paths"
 
+test_56db() {
+	local dir=$DIR/$tdir
+	local expected
+	local inflight
+	local threads
+	local found
+	local cmd
+
+	setup_56 $dir $NUMFILES $NUMDIRS "-c 1"
+	test_mkdir -p $dir/dir1/sub1/sub2
+	touch $dir/dir1/sub1/sub2/file0
+
+	expected=$($LFS find $dir --type f | sort)
+	[[ -n "$expected" ]] || error "serial lfs find found nothing"
+
+	for threads in 1 2 8; do
+		cmd="$LFS find $dir --type f --threads $threads"
+		found=$($cmd | sort)
+		[[ "$found" == "$expected" ]] ||
+			error "'$cmd' output differs from serial lfs find"
+	done
+
+	cmd="$LFS find $dir --type f --threads 8 --sorted"
+	found=$($cmd)
+	[[ "$found" == "$(LC_ALL=C sort <<< "$expected")" ]] ||
+		error "'$cmd' output is not sorted"
+
+	for inflight in 0 1; do
+		cmd="$LFS find $dir --type f --threads 4 --mdt-inflight $inflight"
+		found=$($cmd | sort)
+		[[ "$found" == "$expected" ]] ||
+			error "'$cmd' output differs from serial lfs find"
+	done
+
+	cmd="$LFS find $dir --maxdepth 1 --threads 4"
+	found=$($cmd | sort)
+	[[ "$found" == "$($LFS find $dir --maxdepth 1 | sort)" ]] ||
+		error "'$cmd' does not honour --maxdepth"
+
+	$LFS find $dir --threads 0 2>/dev/null &&
+		error "lfs find --threads 0 should fail"
+	return 0
+}
+run_test 56db "lfs find --threads matches serial lfs find"
+
+test_56dc() {
+	local dir=$DIR/$tdir
+	local expected
+	local found
+	local opts
+
+	setup_56 $dir $NUMFILES $NUMDIRS "-c 1"
+	$LFS setstripe -c 2 $dir/file_c2 || error "setstripe $dir/file_c2"
+	dd if=/dev/zero of=$dir/file_c2 bs=1M count=2 || error "write file_c2"
+	touch $dir/empty
+	chown $RUNAS_ID $dir/empty || error "chown $dir/empty"
+	touch -a -d "2 days ago" $dir/file1
+
+	for opts in "--size 0" "--size +1M" "! --size -1M" "-c 2" "-c +1" \
+		    "--layout raid0" "! --layout raid0" "--uid $RUNAS_ID" \
+		    "! --user 0" "--gid 0" "--atime +1" "--mtime -1" \
+		    "--type f --ctime -1 -c 1"; do
+		expected=$($LFS find $dir $opts | sort)
+		found=$($LFS find $dir --mdt-scan $opts | sort)
+		[[ "$found" == "$expected" ]] ||
+			error "'lfs find --mdt-scan $opts' differs from lfs find"
+	done
+}
+run_test 56dc "lfs find --mdt-scan matches lfs find"
+
 test_57a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
 	# note test will not do anything if MDS is not local
@@ -8873,6 +9074,79 @@ test_64g() {
 }
 run_test 64g "grant shrink on MDT"
 
+test_64h() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+	(( $(check_cpt_number ost1) > 1 )) ||
+		skip "need more than one CPT on ost1"
+
+	local ost=$(facet_svc ost1)
+	local param=obdfilter.$ost
+	local avail=$($LFS df $DIR | awk '/OST0000/ { print $4 }')
+	local nmnt=4
+	local mnts=()
+	local pids=()
+	local old
+	local i
+
+	(( avail < 4 * 1024 * 1024 )) || skip "OST0000 too large to fill"
+
+	old=$(do_facet ost1 $LCTL get_param -n $param.lbug_on_grant_miscount)
+	do_facet ost1 $LCTL set_param $param.lbug_on_grant_miscount=1
+	stack_trap "do_facet ost1 $LCTL set_param \
+		    $param.lbug_on_grant_miscount=$old"
+
+	# every mount has its own export, the exports are hashed to CPTs
+	for ((i = 0; i < nmnt; i++)); do
+		mnts[i]=$(mktemp -d /tmp/lustre-XXXXXX)
+		stack_trap "rmdir ${mnts[i]}"
+		mount_client ${mnts[i]} || error "mount ${mnts[i]} failed"
+		# disconnecting the export runs the sanity check once more,
+		# before lbug_on_grant_miscount is restored
+		stack_trap "umount_client ${mnts[i]}"
+	done
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir || error "setstripe failed"
+	stack_trap "rm -rf $DIR/$tdir; wait_delete_completed"
+
+	# drive OST0000 to ENOSPC from all the exports at once, the shard
+	# reservations are reclaimed on the way
+	for ((i = 0; i < nmnt; i++)); do
+		dd if=/dev/zero of=${mnts[i]}/$tdir/f$i bs=1M \
+			count=$((avail / 1024 / nmnt + 16)) 2>/dev/null &
+		pids[i]=$!
+	done
+
+	# statfs folds the shards and runs tgt_grant_sanity_check()
+	while ps -p ${pids[*]} > /dev/null; do
+		do_facet ost1 $LCTL get_param -n $param.tot_granted > /dev/null
+		$LFS df $DIR > /dev/null
+		sleep 1
+	done
+	wait ${pids[*]}
+	sync
+
+	local granted
+	local sum
+
+	# tot_granted is the sum of the export grants once nothing is pending
+	for ((i = 0; i < 10; i++)); do
+		granted=$(do_facet ost1 $LCTL get_param -n $param.tot_granted)
+		sum=$(do_facet ost1 $LCTL get_param -n $param.grant_precreate)
+		sum=$((sum + $(do_facet ost1 $LCTL get_param -n \
+			$param.exports.*.export |
+			awk '/granted:|pending:/ { sum += $2 }
+			     END { print sum + 0 }')))
+		(( granted == sum )) && break
+		sleep 1
+	done
+	echo "tot_granted $granted, sum of export grants $sum"
+	(( granted == sum )) ||
+		error "tot_granted $granted != sum of export grants $sum"
+}
+run_test 64h "grant accounting of per-CPT shards near ENOSPC"
+
 # bug 1414 - set/get directories' stripe info
 test_65a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
@@ -11913,6 +12187,53 @@ test_116b() { # LU-2093
 }
 run_test 116b "QoS shouldn't LBUG if not enough OSTs found on the 2nd pass"
 
+test_116c() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run"
+	remote_mds_nodsh && skip "remote MDS with nodsh"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+	(( $OSTCOUNT >= 2 )) || skip "needs >= 2 OSTs"
+	(( $OST1_VERSION >= $(version_code 2.14.55) )) ||
+		skip "Need OST version at least 2.14.55"
+
+	local ost0=$FSNAME-OST0000
+	local busy_param=obdfilter.$ost0.load_brw_busy
+	local load_param=lod.$FSNAME-MDT0000-mdtlov.qos_ost_load
+	local old_busy=$(do_facet ost1 $LCTL get_param -n $busy_param)
+	local nfiles=$((OSTCOUNT * 10))
+	local pid
+
+	mkdir -p $DIR/$tdir || error "mkdir $tdir failed"
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir/busy || error "setstripe failed"
+
+	# keep one BRW in progress on OST0000 and make it count as 100% load
+	do_facet ost1 $LCTL set_param $busy_param=1
+	stack_trap "do_facet ost1 $LCTL set_param $busy_param=$old_busy"
+	#define OBD_FAIL_OST_BRW_PAUSE_BULK2	0x227
+	do_facet ost1 $LCTL set_param fail_loc=0x227 fail_val=30
+	stack_trap "do_facet ost1 $LCTL set_param fail_loc=0 fail_val=0"
+	dd if=/dev/zero of=$DIR/$tdir/busy bs=1M count=1 oflag=direct &
+	pid=$!
+	stack_trap "kill $pid 2>/dev/null; wait $pid"
+
+	wait_update_facet ost1 "$LCTL get_param -n obdfilter.$ost0.load" \
+		"100" 20 || error "$ost0 did not report full load"
+	wait_update_facet $SINGLEMDS \
+		"$LCTL get_param -n $load_param | grep -c '$ost0.* load: 100%'" \
+		"1" 30 || error "MDT0000 did not get $ost0 load"
+	do_facet $SINGLEMDS $LCTL get_param -n $load_param
+
+	mkdir $DIR/$tdir/new || error "mkdir new failed"
+	$LFS setstripe -c 1 $DIR/$tdir/new || error "setstripe new failed"
+	createmany -o $DIR/$tdir/new/f- $nfiles || error "createmany failed"
+
+	local on_ost0=$($LFS getstripe -i $DIR/$tdir/new/f-* | grep -c "^0$")
+
+	echo "$on_ost0 of $nfiles new files on busy $ost0"
+	(( on_ost0 < nfiles / OSTCOUNT )) ||
+		error "$on_ost0 of $nfiles files allocated on busy $ost0"
+}
+run_test 116c "stripe QOS: avoid OSTs reporting high load"
+
 test_117() # bug 10891
 {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
@@ -16672,6 +16993,41 @@ test_160q() {
 }
 run_test 160q "changelog effective mask is DEFMASK if not set"
 
+test_160r() {
+	remote_mds_nodsh && skip "remote MDS with nodsh"
+
+	local mdt="$(facet_svc $SINGLEMDS)"
+	local expected
+	local found
+	local seq
+
+	changelog_register || error "changelog_register failed"
+
+	test_mkdir -i0 -c1 $DIR/$tdir || error "mkdir $tdir failed"
+	createmany -o $DIR/$tdir/f 100 || error "createmany failed"
+	test_mkdir -i0 -c1 $DIR/$tdir/d || error "mkdir $tdir/d failed"
+	unlinkmany $DIR/$tdir/f 50 || error "unlinkmany failed"
+
+	expected=$($LFS changelog $mdt | awk '$2 ~ /CREAT|UNLNK/')
+	found=$($LFS changelog --type CREAT,UNLNK $mdt)
+	[[ -n "$found" && "$found" == "$expected" ]] ||
+		error "--type CREAT,UNLNK returned wrong records"
+
+	seq=$($LFS path2fid $DIR/$tdir | sed -e 's/\[\(0x[0-9a-f]*\):.*/\1/')
+	expected=$($LFS changelog $mdt | grep -E "[tp]=\[$seq:")
+	found=$($LFS changelog --seq $seq $mdt)
+	[[ -n "$found" && "$found" == "$expected" ]] ||
+		error "--seq $seq returned wrong records"
+
+	found=$($LFS changelog --jobid no_such_job.$$ $mdt)
+	[[ -z "$found" ]] || error "--jobid returned unexpected records"
+
+	$LFS changelog --type NOSUCH $mdt 2>/dev/null &&
+		error "--type NOSUCH should fail"
+	return 0
+}
+run_test 160r "client-side changelog reader filters"
+
 test_161a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
 
@@ -21528,6 +21884,77 @@ test_255c() {
 }
 run_test 255c "suite of ladvise lockahead tests"
 
+test_255d() {
+	[ $OST1_VERSION -lt $(version_code 2.14.55) ] &&
+		skip "lustre < 2.14.55 does not support ladvise willwrite"
+	[ "$ost1_FSTYPE" = "ldiskfs" ] || skip "ldiskfs only test"
+
+	local hinted=$DIR/$tfile
+	local plain=$DIR/$tfile.plain
+	local count=64
+	# OSD_WRITE_HINT_WINDOW, in MB
+	local window=32
+
+	stack_trap "rm -f $hinted $plain"
+	$LFS setstripe -c 1 -i 0 $hinted || error "setstripe $hinted failed"
+	$LFS setstripe -c 1 -i 0 $plain || error "setstripe $plain failed"
+	# only the hinted file is charged to $RUNAS_ID
+	chown $RUNAS_ID $hinted || error "chown $hinted failed"
+
+	ladvise_no_type willwrite $hinted &&
+		skip "willwrite ladvise is not supported"
+
+	# hint twice the size that is written, to leave a preallocated tail
+	$LFS ladvise -a willwrite -s 0 -e $((count * 2))M $hinted ||
+		error "ladvise willwrite failed"
+
+	# interleave sync writes to both objects so mballoc alternates
+	for ((i = 0; i < count; i++)); do
+		dd if=/dev/zero of=$hinted bs=1M count=1 seek=$i \
+			conv=notrunc oflag=sync status=none ||
+			error "write $hinted failed"
+		dd if=/dev/zero of=$plain bs=1M count=1 seek=$i \
+			conv=notrunc oflag=sync status=none ||
+			error "write $plain failed"
+	done
+
+	cmp $hinted $plain || error "$hinted and $plain differ"
+	(( $(stat -c %s $hinted) == count * 1048576 )) ||
+		error "$hinted has wrong size $(stat -c %s $hinted)"
+
+	local ext_hinted=$(filefrag $hinted | awk '{ print $2 }')
+	local ext_plain=$(filefrag $plain | awk '{ print $2 }')
+
+	echo "extents: hinted $ext_hinted, plain $ext_plain"
+	# one write plus a few preallocation windows, not one per RPC
+	(( ext_hinted <= 2 + count / (window / 2) )) ||
+		error "$hinted has $ext_hinted extents, expected preallocation"
+
+	local used
+
+	# the preallocated tail is charged to quota, up to one window
+	sync_all_data
+	used=$($LFS quota -q -u $RUNAS_ID $DIR |
+	       awk 'NF == 1 { getline; print $1; exit } { print $2; exit }' |
+	       tr -d '*')
+	echo "quota usage after writes: ${used}KB"
+	(( used > count * 1024 )) ||
+		error "preallocation not charged to quota, used ${used}KB"
+	(( used <= (count + window + 1) * 1024 )) ||
+		error "preallocated more than the window, used ${used}KB"
+
+	# truncate to the current size drops the preallocated tail
+	$TRUNCATE $hinted $((count * 1048576)) || error "truncate $hinted failed"
+	sync_all_data
+	used=$($LFS quota -q -u $RUNAS_ID $DIR |
+	       awk 'NF == 1 { getline; print $1; exit } { print $2; exit }' |
+	       tr -d '*')
+	echo "quota usage after truncate: ${used}KB"
+	(( used <= (count + 1) * 1024 )) ||
+		error "truncate kept the preallocated tail, used ${used}KB"
+}
+run_test 255d "check 'lfs ladvise -a willwrite'"
+
 test_256() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
 	remote_mds_nodsh && skip "remote MDS with nodsh"
@@ -26323,6 +26750,218 @@ test_432() {
 }
 run_test 432 "mv dir from outside Lustre"
 
+reply_data_size() {
+	local facet=$1
+
+	do_facet $facet sync
+	do_facet $facet "$DEBUGFS -c -R 'stat reply_data' \
+		$(facet_device $facet) 2>/dev/null" |
+		awk '{ for (i = 1; i < NF; i++) if ($i == "Size:") print $(i+1) }'
+}
+
+test_433() {
+	(( $MDS1_VERSION >= $(version_code 2.14.55) )) ||
+		skip "Need MDS version at least 2.14.55"
+
+	local nthreads=8
+	local nfiles=5000
+	local mmr=8
+	local mdc=$FSNAME-MDT0000-mdc-*
+	local old_mmr=$($LCTL get_param -n mdc.$mdc.max_mod_rpcs_in_flight)
+	local old_mrif=$($LCTL get_param -n mdc.$mdc.max_rpcs_in_flight)
+	local ncpts=$(check_cpt_number mds1)
+	local size_before
+	local size_after
+	local max_growth
+	local pids=()
+	local start
+	local count
+	local i
+
+	stack_trap "$LCTL set_param mdc.$mdc.max_rpcs_in_flight=$old_mrif"
+	stack_trap "$LCTL set_param mdc.$mdc.max_mod_rpcs_in_flight=$old_mmr"
+	$LCTL set_param mdc.$mdc.max_rpcs_in_flight=16 \
+		mdc.$mdc.max_mod_rpcs_in_flight=$mmr ||
+		skip "cannot raise max_mod_rpcs_in_flight"
+	for i in $($LCTL get_param -n mdc.$mdc.max_mod_rpcs_in_flight); do
+		(( i == mmr )) ||
+			error "max_mod_rpcs_in_flight is $i, expected $mmr"
+	done
+
+	[[ "$mds1_FSTYPE" == ldiskfs ]] && size_before=$(reply_data_size mds1)
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	for ((i = 0; i < nthreads; i++)); do
+		mkdir $DIR/$tdir/d$i || error "mkdir d$i failed"
+	done
+
+	# each modifying RPC allocates a reply data slot on the MDT
+	start=$SECONDS
+	for ((i = 0; i < nthreads; i++)); do
+		createmany -o $DIR/$tdir/d$i/f $nfiles > /dev/null &
+		pids+=($!)
+	done
+	for i in ${!pids[@]}; do
+		wait ${pids[$i]} || error "createmany in d$i failed"
+	done
+	echo "created $((nthreads * nfiles)) files in $((SECONDS - start))s"
+	for ((i = 0; i < nthreads; i++)); do
+		count=$(ls $DIR/$tdir/d$i | wc -l)
+		(( count == nfiles )) ||
+			error "d$i has $count files, expected $nfiles"
+	done
+
+	pids=()
+	start=$SECONDS
+	for ((i = 0; i < nthreads; i++)); do
+		unlinkmany $DIR/$tdir/d$i/f $nfiles > /dev/null &
+		pids+=($!)
+	done
+	for i in ${!pids[@]}; do
+		wait ${pids[$i]} || error "unlinkmany in d$i failed"
+	done
+	echo "unlinked $((nthreads * nfiles)) files in $((SECONDS - start))s"
+	for ((i = 0; i < nthreads; i++)); do
+		count=$(ls $DIR/$tdir/d$i | wc -l)
+		(( count == 0 )) || error "d$i still has $count files"
+	done
+
+	do_facet mds1 "dmesg | grep -q \"couldn't find a slot for reply data\"" &&
+		error "MDT ran out of reply data slots"
+
+	[[ "$mds1_FSTYPE" == ldiskfs ]] || return 0
+	size_after=$(reply_data_size mds1)
+	[[ -n "$size_before" && -n "$size_after" ]] ||
+		error "cannot get reply_data size on mds1"
+
+	# Slots held at once are bounded by the modifying RPCs in flight.
+	# On top of that each CPT may keep one 64-slot bitmap word claimed
+	# plus LUT_REPLY_SLOTS_CACHE (128) freed slots in its cache. Allow
+	# 1024 more slots for other clients and MDT-MDT updates. Each
+	# lsd_reply_data record is 32 bytes.
+	max_growth=$(((nthreads * mmr + ncpts * (64 + 128) + 1024) * 32))
+	echo "reply_data size $size_before -> $size_after, max growth $max_growth"
+	(( size_after - size_before <= max_growth )) ||
+		error "reply_data grew $((size_after - size_before)) > $max_growth"
+}
+run_test 433 "parallel modifying RPCs with per-CPT reply slots"
+
+test_434() {
+	(( $MDSCOUNT >= 2 )) || skip "needs >= 2 MDTs"
+	(( $CLIENT_VERSION >= $(version_code 2.14.55) )) ||
+		skip "Need client version at least 2.14.55"
+
+	local nfiles=200
+	local flush_pid
+	local pids=()
+	local idx
+	local mdt
+	local i
+
+	# the FID sequences of files on each MDT are only known by FLD
+	test_mkdir $DIR/$tdir
+	for ((idx = 0; idx < MDSCOUNT; idx++)); do
+		$LFS mkdir -i $idx -c 1 $DIR/$tdir/d$idx ||
+			error "mkdir d$idx on MDT$idx failed"
+		createmany -o $DIR/$tdir/d$idx/f $nfiles > /dev/null ||
+			error "createmany on MDT$idx failed"
+	done
+
+	$LCTL set_param -n fld.*.cache_flush=1 ||
+		error "cannot flush client FLD cache"
+
+	# keep dropping the cache, lookups insert the ranges back
+	( while true; do
+		$LCTL set_param -n fld.*.cache_flush=1 > /dev/null 2>&1
+		sleep 0.1
+	done ) &
+	flush_pid=$!
+	stack_trap "kill $flush_pid 2> /dev/null"
+
+	for ((idx = 0; idx < MDSCOUNT; idx++)); do
+		( for ((i = 0; i < nfiles; i++)); do
+			mdt=$($LFS getstripe -m $DIR/$tdir/d$idx/f$i) ||
+				exit 1
+			if (( mdt != idx )); then
+				echo "d$idx/f$i on MDT$mdt, expected MDT$idx"
+				exit 1
+			fi
+		done ) &
+		pids+=($!)
+	done
+	for idx in ${!pids[@]}; do
+		wait ${pids[$idx]} || error "wrong MDT for files in d$idx"
+	done
+
+	kill $flush_pid
+	wait $flush_pid 2> /dev/null
+
+	# once more with the cache built from scratch by a single thread
+	$LCTL set_param -n fld.*.cache_flush=1 ||
+		error "cannot flush client FLD cache"
+	for ((idx = MDSCOUNT - 1; idx >= 0; idx--)); do
+		mdt=$($LFS getstripe -m $DIR/$tdir/d$idx/f0) ||
+			error "getstripe d$idx/f0 failed"
+		(( mdt == idx )) ||
+			error "d$idx/f0 on MDT$mdt, expected MDT$idx"
+	done
+}
+run_test 434 "FLD cache lookup across MDTs with cache flush and insert"
+
+test_435() {
+	(( $CLIENT_VERSION >= $(version_code 2.14.55) )) ||
+		skip "Need client version at least 2.14.55"
+
+	local param="seq.cli-cli-*MDT0000-mdc-*"
+	local old_width=$($LCTL get_param -n $param.width | head -n1)
+	local old_lowat=$($LCTL get_param -n $param.prefetch_lowat | head -n1)
+	local nfiles=5000
+	local hits
+	local nseq
+
+	[[ -n "$old_lowat" ]] || skip "client does not support FID prefetch"
+
+	# width first, prefetch_lowat cannot be set above it
+	stack_trap "$LCTL set_param $param.width=$old_width \
+		$param.prefetch_lowat=$old_lowat" EXIT
+
+	# small sequences to force many sequence switches during create
+	$LCTL set_param $param.width=1000 ||
+		error "set width failed"
+	$LCTL set_param $param.prefetch_lowat=2000 &&
+		error "lowat above width should be rejected"
+	(( $($LCTL get_param -n $param.prefetch_lowat | head -n1) <= 1000 )) ||
+		error "prefetch_lowat not clamped to the new width"
+	$LCTL set_param $param.prefetch_lowat=250 ||
+		error "set prefetch_lowat failed"
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	hits=$($LCTL get_param -n $param.prefetch_hits | head -n1)
+	createmany -o $DIR/$tdir/f $nfiles || error "createmany failed"
+	hits=$(($($LCTL get_param -n $param.prefetch_hits | head -n1) - hits))
+	echo "$hits sequence switches used a prefetched range"
+	(( hits > 0 )) || error "no prefetched sequence was used"
+
+	nseq=$(for f in $DIR/$tdir/*; do $LFS path2fid $f; done |
+	       awk -F: '{ print $1 }' | sort -u | wc -l)
+	echo "$nfiles files created in $nseq sequences"
+	(( nseq >= nfiles / 1000 )) ||
+		error "expected at least $((nfiles / 1000)) sequences, got $nseq"
+
+	# prefetch disabled must still switch sequences synchronously
+	$LCTL set_param $param.prefetch_lowat=0 ||
+		error "disable prefetch failed"
+	hits=$($LCTL get_param -n $param.prefetch_hits | head -n1)
+	createmany -o $DIR/$tdir/g 2000 || error "createmany without prefetch"
+	# only the range prefetched before it was disabled may be used
+	hits=$(($($LCTL get_param -n $param.prefetch_hits | head -n1) - hits))
+	(( hits <= 1 )) ||
+		error "$hits prefetched sequences used with prefetch disabled"
+	unlinkmany $DIR/$tdir/f $nfiles || error "unlinkmany failed"
+	unlinkmany $DIR/$tdir/g 2000 || error "unlinkmany failed"
+}
+run_test 435 "FID sequence prefetch at low-water mark"
+
 prep_801() {
 	[[ $MDS1_VERSION -lt $(version_code 2.9.55) ]] ||
 	[[ $OST1_VERSION -lt $(version_code 2.9.55) ]] &&
@@ -27020,6 +27659,49 @@ test_807() {
 }
 run_test 807 "verify LSOM syncing tool"
 
+test_807b() {
+	[ -n "$FILESET" ] && skip "Not functional for FILESET set"
+	[ $MDS1_VERSION -lt $(version_code 2.11.52) ] &&
+		skip "Need MDS version at least 2.11.52"
+
+	changelog_register || error "changelog_register failed"
+	local cl_user="${CL_USERS[$SINGLEMDS]%% *}"
+
+	local save="$TMP/$TESTSUITE-$TESTNAME.parameters"
+	save_lustre_params client "llite.*.xattr_cache" > $save
+	lctl set_param llite.*.xattr_cache=0
+	stack_trap "restore_lustre_params < $save; rm -f $save" EXIT
+
+	local nfiles=64
+	local i
+
+	mkdir_on_mdt0 $DIR/$tdir || error "mkdir $tdir failed"
+	for ((i = 0; i < nfiles; i++)); do
+		dd if=/dev/zero of=$DIR/$tdir/f$i bs=4k count=$((i + 1)) \
+			conv=fsync 2>/dev/null || error "write f$i failed"
+		# a second update of the same file is coalesced
+		$TRUNCATE $DIR/$tdir/f$i $(((i + 1) * 2048)) ||
+			error "truncate f$i failed"
+	done
+
+	cancel_lru_locks osc
+	# several threads and batches, each ending with a changelog clear
+	$LSOM_SYNC -j 8 -b 5 -u $cl_user -m $FSNAME-MDT0000 $MOUNT ||
+		error "llsom_sync failed"
+	for ((i = 0; i < nfiles; i++)); do
+		check_lsom_data $DIR/$tdir/f$i
+	done
+
+	local left=$($LFS changelog $FSNAME-MDT0000 |
+		grep -c -E "CLOSE|TRUNC|SATTR")
+
+	(( left == 0 )) || error "$left SOM records not cleared"
+
+	rm -rf $DIR/$tdir
+	changelog_deregister || error "changelog_deregister failed"
+}
+run_test 807b "verify LSOM syncing tool with parallel threads"
+
 check_som_nologged()
 {
 	local lines=$($LFS changelog $FSNAME-MDT0000 |
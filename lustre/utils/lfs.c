@@ -488,15 +488,16 @@ command_t cmdlist[] = {
 	 "     [[!] --btime|--Btime|-B [+-]N[smhdwy]] [--help|-h]\n"
 	 "     [[!] --newer[XY] <reference>] [[!] --blocks|-b N]\n"
 	 "     [--maxdepth|-D N] [[!] --mdt-index|--mdt|-m <uuid|index,...>]\n"
-	 "     [[!] --name|-n <pattern>] [[!] --ost|-O <uuid|index,...>]\n"
+	 "     [--mdt-scan] [[!] --name|-n <pattern>] [[!] --ost|-O <uuid|index,...>]\n"
 	 "     [[!] --perm [/-]mode] [[!] --pool <pool>] [--print|-P]\n"
 	 "     [--print0|-0] [[!] --projid <projid>]\n"
-	 "     [[!] --size|-s [+-]N[bkMGTPE]]\n"
+	 "     [[!] --size|-s [+-]N[bkMGTPE]] [--sorted]\n"
 	 "     [[!] --stripe-count|-c [+-]<stripes>]\n"
 	 "     [[!] --stripe-index|-i <index,...>]\n"
 	 "     [[!] --stripe-size|-S [+-]N[kMGT]] [[!] --type|-t <filetype>]\n"
 	 "     [[!] --extension-size|--ext-size|-z [+-]N[kMGT]]\n"
-	 "     [[!] --gid|-g|--group|-G <gid>|<gname>]\n"
+	 "     [[!] --gid|-g|--group|-G <gid>|<gname>] [--threads N]\n"
+	 "     [--mdt-inflight N]\n"
 	 "     [[!] --uid|-u|--user|-U <uid>|<uname>]\n"
 	 "     [[!] --layout|-L released,raid0,mdt]\n"
 	 "     [[!] --foreign[=<foreign_type>]]\n"
@@ -590,7 +591,8 @@ command_t cmdlist[] = {
 	 "usage: flushctx [-k] [-r] [mountpoint...]"},
 	{"changelog", lfs_changelog, 0,
 	 "Show the metadata changes on an MDT."
-	 "\nusage: changelog <mdtname> [startrec [endrec]]"},
+	 "\nusage: changelog [--follow] [--type <type>[,...]] [--jobid <jobid>]\n"
+	 "                 [--seq <start>[:<end>]] <mdtname> [startrec [endrec]]"},
 	{"changelog_clear", lfs_changelog_clear, 0,
 	 "Indicate that old changelog records up to <endrec> are no longer of "
 	 "interest to consumer <id>, allowing the system to free up space.\n"
@@ -3457,6 +3459,10 @@ enum {
 	LFS_NEWERXY_OPT,
 	LFS_INHERIT_RR_OPT,
 	LFS_FIND_PERM,
+	LFS_FIND_THREADS_OPT,
+	LFS_FIND_SORTED_OPT,
+	LFS_FIND_MDT_INFLIGHT_OPT,
+	LFS_FIND_MDT_SCAN_OPT,
 };
 
 #ifndef LCME_USER_MIRROR_FLAGS
@@ -5005,6 +5011,8 @@ static int lfs_find(int argc, char **argv)
 	{ .val = 'm',	.name = "mdt",		.has_arg = required_argument },
 	{ .val = 'm',	.name = "mdt-index",	.has_arg = required_argument },
 	{ .val = 'm',	.name = "mdt_index",	.has_arg = required_argument },
+	{ .val = LFS_FIND_MDT_SCAN_OPT,
+			.name = "mdt-scan",	.has_arg = no_argument },
 	{ .val = 'M',	.name = "mtime",	.has_arg = required_argument },
 	{ .val = 'n',	.name = "name",		.has_arg = required_argument },
 	{ .val = 'N',	.name = "mirror-count",	.has_arg = required_argument },
@@ -5022,11 +5030,17 @@ static int lfs_find(int argc, char **argv)
 /* getstripe { .val = 'r', .name = "recursive",	.has_arg = no_argument }, */
 /* getstripe { .val = 'R', .name = "raw",	.has_arg = no_argument }, */
 	{ .val = 's',	.name = "size",		.has_arg = required_argument },
+	{ .val = LFS_FIND_SORTED_OPT,
+			.name = "sorted",	.has_arg = no_argument },
 	{ .val = 'S',	.name = "stripe-size",	.has_arg = required_argument },
 	{ .val = 'S',	.name = "stripe_size",	.has_arg = required_argument },
 	{ .val = 't',	.name = "type",		.has_arg = required_argument },
 	{ .val = LFS_FIND_PERM,
 			.name = "perm",		.has_arg = required_argument },
+	{ .val = LFS_FIND_THREADS_OPT,
+			.name = "threads",	.has_arg = required_argument },
+	{ .val = LFS_FIND_MDT_INFLIGHT_OPT,
+			.name = "mdt-inflight",	.has_arg = required_argument },
 	{ .val = 'T',	.name = "mdt-count",	.has_arg = required_argument },
 	{ .val = 'u',	.name = "uid",		.has_arg = required_argument },
 	{ .val = 'U',	.name = "user",		.has_arg = required_argument },
@@ -5726,6 +5740,42 @@ err_free:
 				goto err;
 			}
 			break;
+		case LFS_FIND_THREADS_OPT:
+			errno = 0;
+			param.fp_threads = strtoul(optarg, &endptr, 0);
+			if (errno != 0 || *endptr != '\0' ||
+			    param.fp_threads == 0 ||
+			    param.fp_threads > LLAPI_FIND_THREADS_MAX) {
+				fprintf(stderr,
+					"error: bad thread count '%s', must be 1-%u\n",
+					optarg, LLAPI_FIND_THREADS_MAX);
+				ret = -1;
+				goto err;
+			}
+			break;
+		case LFS_FIND_SORTED_OPT:
+			param.fp_sorted = 1;
+			break;
+		case LFS_FIND_MDT_INFLIGHT_OPT:
+			errno = 0;
+			param.fp_mdt_inflight = strtoul(optarg, &endptr, 0);
+			if (errno != 0 || *endptr != '\0' ||
+			    param.fp_mdt_inflight >=
+			    LLAPI_FIND_MDT_INFLIGHT_UNLIMITED) {
+				fprintf(stderr,
+					"error: bad MDT inflight count '%s'\n",
+					optarg);
+				ret = -1;
+				goto err;
+			}
+			/* 0 lifts the per-MDT limit */
+			if (param.fp_mdt_inflight == 0)
+				param.fp_mdt_inflight =
+					LLAPI_FIND_MDT_INFLIGHT_UNLIMITED;
+			break;
+		case LFS_FIND_MDT_SCAN_OPT:
+			param.fp_mdt_scan = 1;
+			break;
 		case LFS_FIND_PERM:
 			param.fp_exclude_perm = !!neg_opt;
 			param.fp_perm_sign = LFS_FIND_PERM_EXACT;
@@ -8953,17 +9003,139 @@ static int lfs_flushctx(int argc, char **argv)
 	return rc;
 }
 
+static void lfs_changelog_print(struct changelog_rec *rec)
+{
+	time_t secs;
+	struct tm ts;
+
+	secs = rec->cr_time >> 30;
+	gmtime_r(&secs, &ts);
+	printf("%ju %02d%-5s %02d:%02d:%02d.%09d %04d.%02d.%02d "
+	       "0x%x t="DFID, (uintmax_t)rec->cr_index, rec->cr_type,
+	       changelog_type2str(rec->cr_type),
+	       ts.tm_hour, ts.tm_min, ts.tm_sec,
+	       (int)(rec->cr_time & ((1 << 30) - 1)),
+	       ts.tm_year + 1900, ts.tm_mon + 1, ts.tm_mday,
+	       rec->cr_flags & CLF_FLAGMASK, PFID(&rec->cr_tfid));
+
+	if (rec->cr_flags & CLF_JOBID) {
+		struct changelog_ext_jobid *jid =
+			changelog_rec_jobid(rec);
+
+		if (jid->cr_jobid[0] != '\0')
+			printf(" j=%s", jid->cr_jobid);
+	}
+
+	if (rec->cr_flags & CLF_EXTRA_FLAGS) {
+		struct changelog_ext_extra_flags *ef =
+			changelog_rec_extra_flags(rec);
+
+		printf(" ef=0x%llx",
+		       (unsigned long long)ef->cr_extra_flags);
+
+		if (ef->cr_extra_flags & CLFE_UIDGID) {
+			struct changelog_ext_uidgid *uidgid =
+				changelog_rec_uidgid(rec);
+
+			printf(" u=%llu:%llu",
+			       (unsigned long long)uidgid->cr_uid,
+			       (unsigned long long)uidgid->cr_gid);
+		}
+		if (ef->cr_extra_flags & CLFE_NID) {
+			struct changelog_ext_nid *nid =
+				changelog_rec_nid(rec);
+
+			printf(" nid=%s",
+			       libcfs_nid2str(nid->cr_nid));
+		}
+
+		if (ef->cr_extra_flags & CLFE_OPEN) {
+			struct changelog_ext_openmode *omd =
+				changelog_rec_openmode(rec);
+			char mode[] = "---";
+
+			/* exec mode must be exclusive */
+			if (omd->cr_openflags & MDS_FMODE_EXEC) {
+				mode[2] = 'x';
+			} else {
+				if (omd->cr_openflags & MDS_FMODE_READ)
+					mode[0] = 'r';
+				if (omd->cr_openflags &
+				    (MDS_FMODE_WRITE |
+				     MDS_OPEN_TRUNC |
+				     MDS_OPEN_APPEND))
+					mode[1] = 'w';
+			}
+
+			if (strcmp(mode, "---") != 0)
+				printf(" m=%s", mode);
+		}
+
+		if (ef->cr_extra_flags & CLFE_XATTR) {
+			struct changelog_ext_xattr *xattr =
+				changelog_rec_xattr(rec);
+
+			if (xattr->cr_xattr[0] != '\0')
+				printf(" x=%s", xattr->cr_xattr);
+		}
+	}
+
+	if (!fid_is_zero(&rec->cr_pfid))
+		printf(" p="DFID, PFID(&rec->cr_pfid));
+	if (rec->cr_namelen)
+		printf(" %.*s", rec->cr_namelen,
+		       changelog_rec_name(rec));
+
+	if (rec->cr_flags & CLF_RENAME) {
+		struct changelog_ext_rename *rnm =
+			changelog_rec_rename(rec);
+
+		if (!fid_is_zero(&rnm->cr_sfid))
+			printf(" s="DFID" sp="DFID" %.*s",
+			       PFID(&rnm->cr_sfid),
+			       PFID(&rnm->cr_spfid),
+			       (int)changelog_rec_snamelen(rec),
+			       changelog_rec_sname(rec));
+	}
+	printf("\n");
+}
+
+/* parse a comma separated list of changelog record type names */
+static int lfs_changelog_str2types(char *str, __u32 *mask)
+{
+	char *name;
+	int type;
+
+	*mask = 0;
+	while ((name = strsep(&str, ",")) != NULL) {
+		for (type = 0; type < CL_LAST; type++)
+			if (strcasecmp(name, changelog_type2str(type)) == 0)
+				break;
+		if (type == CL_LAST)
+			return -EINVAL;
+		*mask |= 1U << type;
+	}
+
+	return 0;
+}
+
 static int lfs_changelog(int argc, char **argv)
 {
+	struct changelog_filter filter = { 0 };
+	struct changelog_rec *recs[256];
 	void *changelog_priv;
-	struct changelog_rec *rec;
 	long long startrec = 0, endrec = 0;
 	char *mdd;
+	char *end;
 	struct option long_opts[] = {
 		{ .val = 'f', .name = "follow", .has_arg = no_argument },
+		{ .val = 'j', .name = "jobid", .has_arg = required_argument },
+		{ .val = 's', .name = "seq", .has_arg = required_argument },
+		{ .val = 't', .name = "type", .has_arg = required_argument },
 		{ .name = NULL } };
-	char short_opts[] = "f";
+	char short_opts[] = "fj:s:t:";
 	int rc, follow = 0;
+	int i;
 
 	while ((rc = getopt_long(argc, argv, short_opts,
 		long_opts, NULL)) != -1) {
@@ -8971,6 +9143,40 @@ static int lfs_changelog(int argc, char **argv)
 		case 'f':
 			follow++;
 			break;
+		case 'j':
+			if (strlen(optarg) >= sizeof(filter.cf_jobid)) {
+				fprintf(stderr,
+					"%s changelog: jobid '%s' is too long\n",
+					progname, optarg);
+				return CMD_HELP;
+			}
+			strncpy(filter.cf_jobid, optarg,
+				sizeof(filter.cf_jobid) - 1);
+			break;
+		case 's':
+			errno = 0;
+			filter.cf_seq_start = strtoull(optarg, &end, 0);
+			if (errno == 0 && *end == ':')
+				filter.cf_seq_end = strtoull(end + 1, &end, 0);
+			else
+				filter.cf_seq_end = filter.cf_seq_start + 1;
+			if (errno != 0 || *end != '\0' ||
+			    filter.cf_seq_end <= filter.cf_seq_start) {
+				fprintf(stderr,
+					"%s changelog: bad FID sequence range '%s'\n",
+					progname, optarg);
+				return CMD_HELP;
+			}
+			break;
+		case 't':
+			if (lfs_changelog_str2types(optarg,
+						    &filter.cf_type_mask)) {
+				fprintf(stderr,
+					"%s changelog: bad record type list\n",
+					progname);
+				return CMD_HELP;
+			}
+			break;
 		default:
 			fprintf(stderr,
 				"%s changelog: unrecognized option '%s'\n",
@@ -9031,120 +9237,37 @@ static int lfs_changelog(int argc, char **argv)
 		return rc;
 	}
 
-	while ((rc = llapi_changelog_recv(changelog_priv, &rec)) == 0) {
-		time_t secs;
-		struct tm ts;
-
-		if (endrec && rec->cr_index > endrec) {
-			llapi_changelog_free(&rec);
-			break;
-		}
-		if (rec->cr_index < startrec) {
-			llapi_changelog_free(&rec);
-			continue;
-		}
-
-		secs = rec->cr_time >> 30;
-		gmtime_r(&secs, &ts);
-		printf("%ju %02d%-5s %02d:%02d:%02d.%09d %04d.%02d.%02d "
-		       "0x%x t="DFID, (uintmax_t)rec->cr_index, rec->cr_type,
-		       changelog_type2str(rec->cr_type),
-		       ts.tm_hour, ts.tm_min, ts.tm_sec,
-		       (int)(rec->cr_time & ((1 << 30) - 1)),
-		       ts.tm_year + 1900, ts.tm_mon + 1, ts.tm_mday,
-		       rec->cr_flags & CLF_FLAGMASK, PFID(&rec->cr_tfid));
-
-		if (rec->cr_flags & CLF_JOBID) {
-			struct changelog_ext_jobid *jid =
-				changelog_rec_jobid(rec);
-
-			if (jid->cr_jobid[0] != '\0')
-				printf(" j=%s", jid->cr_jobid);
-		}
-
-		if (rec->cr_flags & CLF_EXTRA_FLAGS) {
-			struct changelog_ext_extra_flags *ef =
-				changelog_rec_extra_flags(rec);
-
-			printf(" ef=0x%llx",
-			       (unsigned long long)ef->cr_extra_flags);
-
-			if (ef->cr_extra_flags & CLFE_UIDGID) {
-				struct changelog_ext_uidgid *uidgid =
-					changelog_rec_uidgid(rec);
-
-				printf(" u=%llu:%llu",
-				       (unsigned long long)uidgid->cr_uid,
-				       (unsigned long long)uidgid->cr_gid);
-			}
-			if (ef->cr_extra_flags & CLFE_NID) {
-				struct changelog_ext_nid *nid =
-					changelog_rec_nid(rec);
-
-				printf(" nid=%s",
-				       libcfs_nid2str(nid->cr_nid));
-			}
-
-			if (ef->cr_extra_flags & CLFE_OPEN) {
-				struct changelog_ext_openmode *omd =
-					changelog_rec_openmode(rec);
-				char mode[] = "---";
-
-				/* exec mode must be exclusive */
-				if (omd->cr_openflags & MDS_FMODE_EXEC) {
-					mode[2] = 'x';
-				} else {
-					if (omd->cr_openflags & MDS_FMODE_READ)
-						mode[0] = 'r';
-					if (omd->cr_openflags &
-					    (MDS_FMODE_WRITE |
-					     MDS_OPEN_TRUNC |
-					     MDS_OPEN_APPEND))
-						mode[1] = 'w';
-				}
-
-				if (strcmp(mode, "---") != 0)
-					printf(" m=%s", mode);
-			}
-
-			if (ef->cr_extra_flags & CLFE_XATTR) {
-				struct changelog_ext_xattr *xattr =
-					changelog_rec_xattr(rec);
-
-				if (xattr->cr_xattr[0] != '\0')
-					printf(" x=%s", xattr->cr_xattr);
-			}
+	if (filter.cf_type_mask || filter.cf_seq_end || filter.cf_jobid[0]) {
+		rc = llapi_changelog_set_filter(changelog_priv, &filter);
+		if (rc < 0) {
+			fprintf(stderr,
+				"%s changelog: cannot set changelog filter: %s\n",
+				progname, strerror(errno = -rc));
+			llapi_changelog_fini(&changelog_priv);
+			return rc;
 		}
+	}
 
-		if (!fid_is_zero(&rec->cr_pfid))
-			printf(" p="DFID, PFID(&rec->cr_pfid));
-		if (rec->cr_namelen)
-			printf(" %.*s", rec->cr_namelen,
-			       changelog_rec_name(rec));
-
-		if (rec->cr_flags & CLF_RENAME) {
-			struct changelog_ext_rename *rnm =
-				changelog_rec_rename(rec);
+	while ((rc = llapi_changelog_recv_batch(changelog_priv, recs,
+						ARRAY_SIZE(recs))) > 0) {
+		for (i = 0; i < rc; i++) {
+			if (endrec && recs[i]->cr_index > endrec)
+				goto out_fini;
+			if (recs[i]->cr_index < startrec)
+				continue;
 
-			if (!fid_is_zero(&rnm->cr_sfid))
-				printf(" s="DFID" sp="DFID" %.*s",
-				       PFID(&rnm->cr_sfid),
-				       PFID(&rnm->cr_spfid),
-				       (int)changelog_rec_snamelen(rec),
-				       changelog_rec_sname(rec));
+			lfs_changelog_print(recs[i]);
 		}
-		printf("\n");
-
-		llapi_changelog_free(&rec);
 	}
 
+out_fini:
 	llapi_changelog_fini(&changelog_priv);
 
 	if (rc < 0)
 		fprintf(stderr, "%s changelog: cannot access changelog: %s\n",
 			progname, strerror(errno = -rc));
 
-	return (rc == 1 ? 0 : rc);
+	return rc < 0 ? rc : 0;
 }
 
 static int lfs_changelog_clear(int argc, char **argv)
@@ -69,6 +69,7 @@
 #include <unistd.h>
 #endif
 #include <poll.h>
+#include <pthread.h>
 #include <time.h>
 #include <inttypes.h>
 
@@ -2206,14 +2207,273 @@ retry_getfileinfo:
 	return ret;
 }
 
+/*
+ * Parallel directory traversal for llapi_find().
+ *
+ * Every worker thread owns a deque of directories that still have to be
+ * scanned.  A worker takes work from the tail of its own deque, so that it
+ * walks its subtree depth-first like the serial code, and when that runs
+ * dry it steals from the head of another worker's deque, which holds the
+ * oldest and usually the largest subtrees.  Each worker uses a private copy
+ * of the find_param so that the cb_find_init() scratch state (fp_lmd,
+ * fp_lmv_md, target indexes, depth) is never shared.
+ *
+ * llapi_semantic_traverse() stays the only directory walker: when it runs
+ * on a worker it queues subdirectories instead of recursing into them.
+ */
+#define FIND_PAR_MDT_BUCKETS	256
+
+struct find_par_dir {
+	struct find_par_dir	*fpd_next;
+	struct find_par_dir	*fpd_prev;
+	unsigned int		 fpd_depth;
+	char			 fpd_name[NAME_MAX + 1];
+	char			 fpd_path[0];
+};
+
+struct find_par;
+
+struct find_par_worker {
+	struct find_par		*fpw_par;
+	pthread_t		 fpw_thread;
+	pthread_mutex_t		 fpw_lock;
+	struct find_par_dir	*fpw_head;
+	struct find_par_dir	*fpw_tail;
+	struct find_param	 fpw_param;
+	char			*fpw_buf;
+	/* results kept back for fp_sorted */
+	char			**fpw_out;
+	size_t			 fpw_out_count;
+	size_t			 fpw_out_alloc;
+	int			 fpw_rc;
+};
+
+struct find_par {
+	pthread_mutex_t		 fpr_lock;
+	pthread_cond_t		 fpr_work_cond;
+	pthread_cond_t		 fpr_mdt_cond;
+	/* directories queued on any worker deque */
+	int			 fpr_queued;
+	/* directories queued or being scanned */
+	int			 fpr_pending;
+	int			 fpr_idle;
+	bool			 fpr_stop;
+	unsigned int		 fpr_nworkers;
+	unsigned int		 fpr_mdt_max;
+	int			 fpr_mdt_waiters;
+	unsigned int		 fpr_mdt_busy[FIND_PAR_MDT_BUCKETS];
+	struct find_par_worker	*fpr_workers;
+	semantic_func_t		*fpr_sem_init;
+	semantic_func_t		*fpr_sem_fini;
+};
+
+static __thread struct find_par_worker *find_par_self;
+
+static int find_par_queue_dir(struct find_par_worker *w, const char *path,
+			      const char *name, unsigned int depth);
+static void find_par_mdt_get(struct find_par_worker *w, int mdt);
+static void find_par_mdt_put(struct find_par_worker *w, int mdt);
+
+/*
+ * With fp_mdt_scan the directory is read with LL_IOC_FIND_SCAN instead of
+ * readdir(), and the MDT leaves out the files which fail a predicate it can
+ * check from its own attributes.  Everything returned is still checked by
+ * cb_find_init() as usual, so this only saves the per-file stat RPCs.
+ */
+struct find_mdt_scan {
+	struct lu_find_scan	*fms_scan;
+	struct lu_find_scan_ent	*fms_ent;
+	unsigned int		 fms_left;
+	struct dirent64		 fms_dent;
+};
+
+static void find_mdt_scan_cmp(struct lu_find_scan_cmp *cmp,
+			      unsigned long long value,
+			      unsigned long long margin, int sign)
+{
+	cmp->lfsc_value = value;
+	cmp->lfsc_margin = margin;
+	cmp->lfsc_sign = sign;
+}
+
+static int find_mdt_scan_fill(struct find_mdt_scan *fms, int fd)
+{
+	fms->fms_scan->lfs_buflen = LU_FIND_SCAN_MAX_BUF;
+	fms->fms_scan->lfs_count = 0;
+	if (ioctl(fd, LL_IOC_FIND_SCAN, fms->fms_scan) < 0)
+		return -errno;
+
+	fms->fms_ent = (struct lu_find_scan_ent *)fms->fms_scan->lfs_ents;
+	fms->fms_left = fms->fms_scan->lfs_count;
+
+	return 0;
+}
+
+static void find_mdt_scan_fini(struct find_mdt_scan *fms)
+{
+	if (fms) {
+		free(fms->fms_scan);
+		free(fms);
+	}
+}
+
+/*
+ * Set up an MDT scan of directory \a fd, or return NULL if readdir() has to
+ * be used because there is nothing to check on the MDT, or because the
+ * directory is striped or the client or server do not support it.
+ */
+static struct find_mdt_scan *find_mdt_scan_init(struct find_param *param,
+						int fd)
+{
+	struct find_mdt_scan *fms;
+	struct lu_find_scan *lfs;
+
+	fms = calloc(1, sizeof(*fms));
+	if (!fms)
+		return NULL;
+
+	lfs = calloc(1, sizeof(*lfs) + LU_FIND_SCAN_MAX_BUF);
+	if (!lfs) {
+		free(fms);
+		return NULL;
+	}
+	fms->fms_scan = lfs;
+
+	if (param->fp_atime) {
+		lfs->lfs_valid |= LFSV_ATIME;
+		if (param->fp_exclude_atime)
+			lfs->lfs_exclude |= LFSV_ATIME;
+		find_mdt_scan_cmp(&lfs->lfs_atime, param->fp_atime,
+				  param->fp_time_margin, param->fp_asign);
+	}
+	if (param->fp_mtime) {
+		lfs->lfs_valid |= LFSV_MTIME;
+		if (param->fp_exclude_mtime)
+			lfs->lfs_exclude |= LFSV_MTIME;
+		find_mdt_scan_cmp(&lfs->lfs_mtime, param->fp_mtime,
+				  param->fp_time_margin, param->fp_msign);
+	}
+	if (param->fp_ctime) {
+		lfs->lfs_valid |= LFSV_CTIME;
+		if (param->fp_exclude_ctime)
+			lfs->lfs_exclude |= LFSV_CTIME;
+		find_mdt_scan_cmp(&lfs->lfs_ctime, param->fp_ctime,
+				  param->fp_time_margin, param->fp_csign);
+	}
+	if (param->fp_check_size) {
+		lfs->lfs_valid |= LFSV_SIZE;
+		if (param->fp_exclude_size)
+			lfs->lfs_exclude |= LFSV_SIZE;
+		find_mdt_scan_cmp(&lfs->lfs_size, param->fp_size,
+				  param->fp_size_units, param->fp_size_sign);
+	}
+	if (param->fp_check_uid) {
+		lfs->lfs_valid |= LFSV_UID;
+		if (param->fp_exclude_uid)
+			lfs->lfs_exclude |= LFSV_UID;
+		lfs->lfs_uid = param->fp_uid;
+	}
+	if (param->fp_check_gid) {
+		lfs->lfs_valid |= LFSV_GID;
+		if (param->fp_exclude_gid)
+			lfs->lfs_exclude |= LFSV_GID;
+		lfs->lfs_gid = param->fp_gid;
+	}
+	if (param->fp_check_projid) {
+		lfs->lfs_valid |= LFSV_PROJID;
+		if (param->fp_exclude_projid)
+			lfs->lfs_exclude |= LFSV_PROJID;
+		lfs->lfs_projid = param->fp_projid;
+	}
+	if (param->fp_check_pool) {
+		lfs->lfs_valid |= LFSV_POOL;
+		if (param->fp_exclude_pool)
+			lfs->lfs_exclude |= LFSV_POOL;
+		snprintf(lfs->lfs_pool, sizeof(lfs->lfs_pool), "%s",
+			 param->fp_poolname);
+	}
+	if (param->fp_check_layout) {
+		lfs->lfs_valid |= LFSV_LAYOUT;
+		if (param->fp_exclude_layout)
+			lfs->lfs_exclude |= LFSV_LAYOUT;
+		lfs->lfs_layout = param->fp_layout;
+	}
+	if (param->fp_check_stripe_count) {
+		lfs->lfs_valid |= LFSV_STRIPE_COUNT;
+		if (param->fp_exclude_stripe_count)
+			lfs->lfs_exclude |= LFSV_STRIPE_COUNT;
+		find_mdt_scan_cmp(&lfs->lfs_stripe_count,
+				  param->fp_stripe_count, 1,
+				  param->fp_stripe_count_sign);
+	}
+
+	if (!lfs->lfs_valid || find_mdt_scan_fill(fms, fd)) {
+		find_mdt_scan_fini(fms);
+		return NULL;
+	}
+
+	return fms;
+}
+
+static struct dirent64 *find_mdt_scan_next(struct find_mdt_scan *fms, int fd,
+					   char *path, int len, int *ret)
+{
+	struct lu_find_scan *lfs = fms->fms_scan;
+	struct lu_find_scan_ent *ent;
+	struct dirent64 *dent = &fms->fms_dent;
+	int rc;
+
+	while (fms->fms_left == 0) {
+		if (lfs->lfs_cookie == MDS_DIR_END_OFF)
+			return NULL;
+
+		rc = find_mdt_scan_fill(fms, fd);
+		if (rc) {
+			path[len] = 0;
+			llapi_error(LLAPI_MSG_ERROR, rc,
+				    "error: %s: cannot scan '%s' on MDT",
+				    __func__, path);
+			if (*ret == 0)
+				*ret = rc;
+			return NULL;
+		}
+	}
+
+	ent = fms->fms_ent;
+	if ((char *)ent + lu_find_scan_ent_size(ent->lfse_namelen) >
+	    lfs->lfs_ents + lfs->lfs_buflen || ent->lfse_namelen > NAME_MAX) {
+		path[len] = 0;
+		llapi_err_noerrno(LLAPI_MSG_ERROR,
+				  "error: %s: bad MDT scan reply for '%s'",
+				  __func__, path);
+		if (*ret == 0)
+			*ret = -EPROTO;
+		return NULL;
+	}
+	fms->fms_ent = lu_find_scan_ent_next(ent);
+	fms->fms_left--;
+
+	dent->d_ino = 0;
+	dent->d_off = 0;
+	dent->d_type = ent->lfse_type;
+	dent->d_reclen = offsetof(struct dirent64, d_name) +
+			 ent->lfse_namelen + 1;
+	memcpy(dent->d_name, ent->lfse_name, ent->lfse_namelen);
+	dent->d_name[ent->lfse_namelen] = '\0';
+
+	return dent;
+}
+
 static int llapi_semantic_traverse(char *path, int size, int parent,
 				   semantic_func_t sem_init,
 				   semantic_func_t sem_fini, void *data,
 				   struct dirent64 *de)
 {
 	struct find_param *param = (struct find_param *)data;
+	struct find_mdt_scan *scan = NULL;
 	struct dirent64 *dent;
 	int len, ret, d, p = -1;
+	int mdt = -1;
 	DIR *dir = NULL;
 
 	ret = 0;
@@ -2281,8 +2541,14 @@ static int llapi_semantic_traverse(char *path, int size, int parent,
 		}
 	}
 
+	/* bound the ioctls issued to the MDT holding this directory */
+	if (find_par_self && d != -1 && llapi_file_fget_mdtidx(d, &mdt))
+		mdt = -1;
+
 	if (sem_init) {
+		find_par_mdt_get(find_par_self, mdt);
 		ret = sem_init(path, (parent != -1) ? parent : p, &d, data, de);
+		find_par_mdt_put(find_par_self, mdt);
 		if (ret)
 			goto err;
 	}
@@ -2302,7 +2568,11 @@ static int llapi_semantic_traverse(char *path, int size, int parent,
 		goto out;
 	}
 
-	while ((dent = readdir64(dir)) != NULL) {
+	if (param->fp_mdt_scan)
+		scan = find_mdt_scan_init(param, d);
+
+	while ((dent = scan ? find_mdt_scan_next(scan, d, path, len, &ret) :
+			      readdir64(dir)) != NULL) {
 		int rc;
 
 		if (!strcmp(dent->d_name, ".") || !strcmp(dent->d_name, ".."))
@@ -2321,8 +2591,10 @@ static int llapi_semantic_traverse(char *path, int size, int parent,
 		if (dent->d_type == DT_UNKNOWN) {
 			struct lov_user_mds_data *lmd = param->fp_lmd;
 
+			find_par_mdt_get(find_par_self, mdt);
 			rc = get_lmd_info_fd(path, d, -1, param->fp_lmd,
 					     param->fp_lum_size, GET_LMD_INFO);
+			find_par_mdt_put(find_par_self, mdt);
 			if (rc == 0)
 				dent->d_type = IFTODT(lmd->lmd_stx.stx_mode);
 			else if (ret == 0)
@@ -2338,15 +2610,23 @@ static int llapi_semantic_traverse(char *path, int size, int parent,
 					  __func__, dent->d_name, dent->d_type);
 			break;
 		case DT_DIR:
-			rc = llapi_semantic_traverse(path, size, d, sem_init,
-						      sem_fini, data, dent);
+			if (find_par_self)
+				rc = find_par_queue_dir(find_par_self, path,
+							dent->d_name,
+							param->fp_depth);
+			else
+				rc = llapi_semantic_traverse(path, size, d,
+							     sem_init, sem_fini,
+							     data, dent);
 			if (rc != 0 && ret == 0)
 				ret = rc;
 			break;
 		default:
 			rc = 0;
 			if (sem_init) {
+				find_par_mdt_get(find_par_self, mdt);
 				rc = sem_init(path, d, NULL, data, dent);
+				find_par_mdt_put(find_par_self, mdt);
 				if (rc < 0 && ret == 0) {
 					ret = rc;
 					break;
@@ -2359,6 +2639,7 @@ static int llapi_semantic_traverse(char *path, int size, int parent,
 
 out:
 	path[len] = 0;
+	find_mdt_scan_fini(scan);
 
 	if (sem_fini)
 		sem_fini(path, parent, &d, data, de);
@@ -2406,6 +2687,363 @@ out:
 	return ret < 0 ? ret : 0;
 }
 
+static void find_par_mdt_get(struct find_par_worker *w, int mdt)
+{
+	struct find_par *fpr;
+	unsigned int *busy;
+
+	if (!w || mdt < 0 ||
+	    w->fpw_par->fpr_mdt_max == LLAPI_FIND_MDT_INFLIGHT_UNLIMITED)
+		return;
+
+	fpr = w->fpw_par;
+	busy = &fpr->fpr_mdt_busy[mdt % FIND_PAR_MDT_BUCKETS];
+	pthread_mutex_lock(&fpr->fpr_lock);
+	while (*busy >= fpr->fpr_mdt_max) {
+		fpr->fpr_mdt_waiters++;
+		pthread_cond_wait(&fpr->fpr_mdt_cond, &fpr->fpr_lock);
+		fpr->fpr_mdt_waiters--;
+	}
+	(*busy)++;
+	pthread_mutex_unlock(&fpr->fpr_lock);
+}
+
+static void find_par_mdt_put(struct find_par_worker *w, int mdt)
+{
+	struct find_par *fpr;
+
+	if (!w || mdt < 0 ||
+	    w->fpw_par->fpr_mdt_max == LLAPI_FIND_MDT_INFLIGHT_UNLIMITED)
+		return;
+
+	fpr = w->fpw_par;
+	pthread_mutex_lock(&fpr->fpr_lock);
+	fpr->fpr_mdt_busy[mdt % FIND_PAR_MDT_BUCKETS]--;
+	if (fpr->fpr_mdt_waiters)
+		pthread_cond_broadcast(&fpr->fpr_mdt_cond);
+	pthread_mutex_unlock(&fpr->fpr_lock);
+}
+
+static int find_par_queue_dir(struct find_par_worker *w, const char *path,
+			      const char *name, unsigned int depth)
+{
+	struct find_par *fpr = w->fpw_par;
+	struct find_par_dir *dir;
+
+	dir = malloc(sizeof(*dir) + strlen(path) + 1);
+	if (!dir)
+		return -ENOMEM;
+
+	dir->fpd_depth = depth;
+	snprintf(dir->fpd_name, sizeof(dir->fpd_name), "%s", name);
+	strcpy(dir->fpd_path, path);
+
+	/*
+	 * Account for the directory before it becomes visible, so that
+	 * fpr_pending cannot drop to zero while it is being scanned.
+	 */
+	pthread_mutex_lock(&fpr->fpr_lock);
+	fpr->fpr_queued++;
+	fpr->fpr_pending++;
+	if (fpr->fpr_idle)
+		pthread_cond_signal(&fpr->fpr_work_cond);
+	pthread_mutex_unlock(&fpr->fpr_lock);
+
+	pthread_mutex_lock(&w->fpw_lock);
+	dir->fpd_next = NULL;
+	dir->fpd_prev = w->fpw_tail;
+	if (w->fpw_tail)
+		w->fpw_tail->fpd_next = dir;
+	else
+		w->fpw_head = dir;
+	w->fpw_tail = dir;
+	pthread_mutex_unlock(&w->fpw_lock);
+
+	return 0;
+}
+
+/* pop from the tail of our own deque, or steal from the head of another */
+static struct find_par_dir *find_par_pop(struct find_par_worker *w, bool own)
+{
+	struct find_par_dir *dir;
+
+	pthread_mutex_lock(&w->fpw_lock);
+	dir = own ? w->fpw_tail : w->fpw_head;
+	if (dir) {
+		if (dir->fpd_prev)
+			dir->fpd_prev->fpd_next = dir->fpd_next;
+		else
+			w->fpw_head = dir->fpd_next;
+		if (dir->fpd_next)
+			dir->fpd_next->fpd_prev = dir->fpd_prev;
+		else
+			w->fpw_tail = dir->fpd_prev;
+	}
+	pthread_mutex_unlock(&w->fpw_lock);
+
+	return dir;
+}
+
+static struct find_par_dir *find_par_next(struct find_par_worker *w)
+{
+	struct find_par *fpr = w->fpw_par;
+	unsigned int self = w - fpr->fpr_workers;
+	struct find_par_dir *dir;
+	unsigned int i;
+
+	for (;;) {
+		dir = find_par_pop(w, true);
+		for (i = 1; !dir && i < fpr->fpr_nworkers; i++)
+			dir = find_par_pop(&fpr->fpr_workers[(self + i) %
+							     fpr->fpr_nworkers],
+					   false);
+
+		pthread_mutex_lock(&fpr->fpr_lock);
+		if (dir) {
+			fpr->fpr_queued--;
+			pthread_mutex_unlock(&fpr->fpr_lock);
+			return dir;
+		}
+		if (fpr->fpr_pending == 0 || fpr->fpr_stop) {
+			pthread_cond_broadcast(&fpr->fpr_work_cond);
+			pthread_mutex_unlock(&fpr->fpr_lock);
+			return NULL;
+		}
+		if (fpr->fpr_queued == 0) {
+			fpr->fpr_idle++;
+			pthread_cond_wait(&fpr->fpr_work_cond, &fpr->fpr_lock);
+			fpr->fpr_idle--;
+		}
+		pthread_mutex_unlock(&fpr->fpr_lock);
+	}
+}
+
+static void *find_par_worker_run(void *arg)
+{
+	struct find_par_worker *w = arg;
+	struct find_par *fpr = w->fpw_par;
+	struct find_par_dir *dir;
+	struct dirent64 de;
+	int rc;
+
+	find_par_self = w;
+	while ((dir = find_par_next(w)) != NULL) {
+		snprintf(w->fpw_buf, 2 * PATH_MAX, "%s", dir->fpd_path);
+		memset(&de, 0, sizeof(de));
+		de.d_type = DT_DIR;
+		snprintf(de.d_name, sizeof(de.d_name), "%s", dir->fpd_name);
+
+		w->fpw_param.fp_depth = dir->fpd_depth;
+		/* the starting path has no dirent, as in the serial walk */
+		rc = llapi_semantic_traverse(w->fpw_buf, 2 * PATH_MAX, -1,
+					     fpr->fpr_sem_init,
+					     fpr->fpr_sem_fini, &w->fpw_param,
+					     dir->fpd_name[0] ? &de : NULL);
+		if (rc < 0 && w->fpw_rc == 0)
+			w->fpw_rc = rc;
+		free(dir);
+
+		pthread_mutex_lock(&fpr->fpr_lock);
+		if (--fpr->fpr_pending == 0)
+			pthread_cond_broadcast(&fpr->fpr_work_cond);
+		pthread_mutex_unlock(&fpr->fpr_lock);
+	}
+	find_par_self = NULL;
+
+	return NULL;
+}
+
+static void find_print_path(struct find_param *param, char *path)
+{
+	struct find_par_worker *w = find_par_self;
+	char **out;
+	size_t alloc;
+
+	if (!w || !param->fp_sorted)
+		goto print;
+
+	if (w->fpw_out_count == w->fpw_out_alloc) {
+		alloc = w->fpw_out_alloc ? w->fpw_out_alloc * 2 : 1024;
+		out = realloc(w->fpw_out, alloc * sizeof(*out));
+		if (!out)
+			goto print;
+		w->fpw_out = out;
+		w->fpw_out_alloc = alloc;
+	}
+	w->fpw_out[w->fpw_out_count] = strdup(path);
+	if (w->fpw_out[w->fpw_out_count]) {
+		w->fpw_out_count++;
+		return;
+	}
+print:
+	llapi_printf(LLAPI_MSG_NORMAL, "%s%c", path,
+		     param->fp_zero_end ? '\0' : '\n');
+}
+
+static int find_path_cmp(const void *a, const void *b)
+{
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+static void find_par_print_sorted(struct find_par *fpr,
+				  struct find_param *param)
+{
+	struct find_par_worker *w;
+	size_t count = 0;
+	char **out;
+	unsigned int i;
+	size_t j;
+
+	for (i = 0; i < fpr->fpr_nworkers; i++)
+		count += fpr->fpr_workers[i].fpw_out_count;
+	if (count == 0)
+		return;
+
+	out = malloc(count * sizeof(*out));
+	if (!out) {
+		/* still print every match, just not in order */
+		for (i = 0; i < fpr->fpr_nworkers; i++) {
+			w = &fpr->fpr_workers[i];
+			for (j = 0; j < w->fpw_out_count; j++)
+				llapi_printf(LLAPI_MSG_NORMAL, "%s%c",
+					     w->fpw_out[j],
+					     param->fp_zero_end ? '\0' : '\n');
+		}
+		return;
+	}
+
+	count = 0;
+	for (i = 0; i < fpr->fpr_nworkers; i++) {
+		w = &fpr->fpr_workers[i];
+		memcpy(out + count, w->fpw_out,
+		       w->fpw_out_count * sizeof(*out));
+		count += w->fpw_out_count;
+	}
+	qsort(out, count, sizeof(*out), find_path_cmp);
+	for (j = 0; j < count; j++)
+		llapi_printf(LLAPI_MSG_NORMAL, "%s%c", out[j],
+			     param->fp_zero_end ? '\0' : '\n');
+	free(out);
+}
+
+static void find_par_fini(struct find_par *fpr)
+{
+	struct find_par_worker *w;
+	struct find_par_dir *dir;
+	unsigned int i;
+	size_t j;
+
+	for (i = 0; i < fpr->fpr_nworkers; i++) {
+		w = &fpr->fpr_workers[i];
+		while ((dir = find_par_pop(w, true)) != NULL)
+			free(dir);
+		for (j = 0; j < w->fpw_out_count; j++)
+			free(w->fpw_out[j]);
+		free(w->fpw_out);
+		find_param_fini(&w->fpw_param);
+		free(w->fpw_param.fp_mdt_indexes);
+		free(w->fpw_buf);
+		pthread_mutex_destroy(&w->fpw_lock);
+	}
+	pthread_cond_destroy(&fpr->fpr_mdt_cond);
+	pthread_cond_destroy(&fpr->fpr_work_cond);
+	pthread_mutex_destroy(&fpr->fpr_lock);
+	free(fpr->fpr_workers);
+	free(fpr);
+}
+
+static int param_callback_parallel(char *path, semantic_func_t sem_init,
+				   semantic_func_t sem_fini,
+				   struct find_param *param,
+				   unsigned int nthreads)
+{
+	struct find_par_worker *w;
+	struct find_par *fpr;
+	unsigned int started;
+	unsigned int i;
+	int ret;
+
+	if (strlen(path) > PATH_MAX) {
+		ret = -EINVAL;
+		llapi_error(LLAPI_MSG_ERROR, ret,
+			    "Path name '%s' is too long", path);
+		return ret;
+	}
+
+	if (nthreads == 0)
+		nthreads = 1;
+	if (nthreads > LLAPI_FIND_THREADS_MAX)
+		nthreads = LLAPI_FIND_THREADS_MAX;
+
+	fpr = calloc(1, sizeof(*fpr));
+	if (!fpr)
+		return -ENOMEM;
+	fpr->fpr_workers = calloc(nthreads, sizeof(*fpr->fpr_workers));
+	if (!fpr->fpr_workers) {
+		free(fpr);
+		return -ENOMEM;
+	}
+	pthread_mutex_init(&fpr->fpr_lock, NULL);
+	pthread_cond_init(&fpr->fpr_work_cond, NULL);
+	pthread_cond_init(&fpr->fpr_mdt_cond, NULL);
+	fpr->fpr_sem_init = sem_init;
+	fpr->fpr_sem_fini = sem_fini;
+	fpr->fpr_mdt_max = param->fp_mdt_inflight;
+	if (fpr->fpr_mdt_max == 0)
+		fpr->fpr_mdt_max = LLAPI_FIND_MDT_INFLIGHT_DEFAULT;
+
+	for (i = 0; i < nthreads; i++) {
+		w = &fpr->fpr_workers[i];
+		w->fpw_par = fpr;
+		pthread_mutex_init(&w->fpw_lock, NULL);
+		w->fpw_param = *param;
+		w->fpw_param.fp_mdt_indexes = NULL;
+		w->fpw_param.fp_lmd = NULL;
+		w->fpw_param.fp_lmv_md = NULL;
+		fpr->fpr_nworkers++;
+
+		w->fpw_buf = malloc(2 * PATH_MAX);
+		if (!w->fpw_buf) {
+			ret = -ENOMEM;
+			goto out;
+		}
+		snprintf(w->fpw_buf, PATH_MAX + 1, "%s", path);
+		ret = common_param_init(&w->fpw_param, w->fpw_buf);
+		if (ret)
+			goto out;
+	}
+
+	ret = find_par_queue_dir(&fpr->fpr_workers[0], path, "", 0);
+	if (ret)
+		goto out;
+
+	/* the caller runs worker 0, so the walk progresses without threads */
+	for (started = 1; started < nthreads; started++) {
+		w = &fpr->fpr_workers[started];
+		ret = pthread_create(&w->fpw_thread, NULL, find_par_worker_run,
+				     w);
+		if (ret) {
+			llapi_error(LLAPI_MSG_WARN, -ret,
+				    "%s: started only %u of %u threads",
+				    __func__, started, nthreads);
+			break;
+		}
+	}
+	find_par_worker_run(&fpr->fpr_workers[0]);
+	for (i = 1; i < started; i++)
+		pthread_join(fpr->fpr_workers[i].fpw_thread, NULL);
+
+	ret = 0;
+	for (i = 0; i < fpr->fpr_nworkers && !ret; i++)
+		ret = fpr->fpr_workers[i].fpw_rc;
+
+	if (param->fp_sorted)
+		find_par_print_sorted(fpr, param);
+out:
+	find_par_fini(fpr);
+	return ret < 0 ? ret : 0;
+}
+
 int llapi_file_fget_lov_uuid(int fd, struct obd_uuid *lov_name)
 {
 	int rc;
@@ -5415,8 +6053,7 @@ obd_matches:
 	}
 
 print:
-	llapi_printf(LLAPI_MSG_NORMAL, "%s%c", path,
-		     param->fp_zero_end ? '\0' : '\n');
+	find_print_path(param, path);
 
 decided:
 	ret = 0;
@@ -5593,9 +6230,37 @@ int llapi_mv(char *path, struct find_param *param)
 
 int llapi_find(char *path, struct find_param *param)
 {
+	if (param->fp_threads > 1 || param->fp_sorted)
+		return param_callback_parallel(path, cb_find_init,
+					       cb_common_fini, param,
+					       param->fp_threads);
+
 	return param_callback(path, cb_find_init, cb_common_fini, param);
 }
 
+/**
+ * Find files matching \a param below \a path using \a nthreads threads.
+ *
+ * Directories are scanned concurrently by a pool of threads which steal
+ * work from each other, each with a private copy of \a param, and with at
+ * most param->fp_mdt_inflight stat/layout ioctls in flight per MDT (no
+ * limit if it is LLAPI_FIND_MDT_INFLIGHT_UNLIMITED).  If
+ * param->fp_sorted is set, matches are printed in pathname order once the
+ * walk completes, otherwise as they are found.
+ *
+ * \param[in] path	starting file or directory
+ * \param[in] param	search predicates, as for llapi_find()
+ * \param[in] nthreads	number of traversal threads
+ *
+ * \retval 0 on success, negative errno of the first failure otherwise
+ */
+int llapi_find_parallel(char *path, struct find_param *param,
+			unsigned int nthreads)
+{
+	return param_callback_parallel(path, cb_find_init, cb_common_fini,
+				       param, nthreads);
+}
+
 /*
  * Get MDT number that the file/directory inode referenced
  * by the open fd resides on.
@@ -28,6 +28,8 @@
  */
 
 #include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -57,7 +59,9 @@ static int chlg_dev_path(char *path, size_t path_len, const char *device)
 }
 
 #define CHANGELOG_PRIV_MAGIC 0xCA8E1080
-#define CHANGELOG_BUFFER_SZ  4096
+#define CHANGELOG_BUFFER_SZ  (128 * 1024)
+/* remapped records returned by llapi_changelog_recv_batch() */
+#define CHANGELOG_BATCH_SZ   (2 * CHANGELOG_BUFFER_SZ)
 
 /**
  * Record state for efficient changelog consumption.
@@ -76,6 +80,8 @@ struct changelog_private {
 	size_t				 clp_buf_len;
 	/* Current position in buffer */
 	char				*clp_buf_pos;
+	/* Records remapped by llapi_changelog_recv_batch() */
+	char				*clp_batch;
 	/* Read buffer with records read from system */
 	char				 clp_buf[0];
 };
@@ -177,6 +183,7 @@ int llapi_changelog_fini(void **priv)
 		return -EINVAL;
 
 	close(cp->clp_fd);
+	free(cp->clp_batch);
 	free(cp);
 	*priv = NULL;
 	return 0;
@@ -215,6 +222,32 @@ int llapi_changelog_get_fd(void *priv)
 	return cp->clp_fd;
 }
 
+#define DEFAULT_RECORD_FMT	(CLF_VERSION | CLF_RENAME)
+
+/* Record format requested by the consumer */
+static void chlg_rec_fmt(struct changelog_private *cp,
+			 enum changelog_rec_flags *rec_fmt,
+			 enum changelog_rec_extra_flags *rec_extra_fmt)
+{
+	*rec_fmt = DEFAULT_RECORD_FMT;
+	*rec_extra_fmt = CLFE_INVALID;
+
+	if (cp->clp_send_flags & CHANGELOG_FLAG_JOBID)
+		*rec_fmt |= CLF_JOBID;
+
+	if (cp->clp_send_flags & CHANGELOG_FLAG_EXTRA_FLAGS) {
+		*rec_fmt |= CLF_EXTRA_FLAGS;
+		if (cp->clp_send_extra_flags & CHANGELOG_EXTRA_FLAG_UIDGID)
+			*rec_extra_fmt |= CLFE_UIDGID;
+		if (cp->clp_send_extra_flags & CHANGELOG_EXTRA_FLAG_NID)
+			*rec_extra_fmt |= CLFE_NID;
+		if (cp->clp_send_extra_flags & CHANGELOG_EXTRA_FLAG_OMODE)
+			*rec_extra_fmt |= CLFE_OPEN;
+		if (cp->clp_send_extra_flags & CHANGELOG_EXTRA_FLAG_XATTR)
+			*rec_extra_fmt |= CLFE_XATTR;
+	}
+}
+
 /** Read the next changelog entry
  * @param priv Opaque private control structure
  * @param rech Changelog record handle; record will be allocated here
@@ -222,12 +255,11 @@ int llapi_changelog_get_fd(void *priv)
  *	 <0 error code
  *	 1 EOF
  */
-#define DEFAULT_RECORD_FMT	(CLF_VERSION | CLF_RENAME)
 int llapi_changelog_recv(void *priv, struct changelog_rec **rech)
 {
 	struct changelog_private *cp = priv;
-	enum changelog_rec_flags rec_fmt = DEFAULT_RECORD_FMT;
-	enum changelog_rec_extra_flags rec_extra_fmt = CLFE_INVALID;
+	enum changelog_rec_flags rec_fmt;
+	enum changelog_rec_extra_flags rec_extra_fmt;
 	struct changelog_rec *tmp;
 	int rc = 0;
 
@@ -241,20 +273,7 @@ int llapi_changelog_recv(void *priv, struct changelog_rec **rech)
 	if (*rech == NULL)
 		return -ENOMEM;
 
-	if (cp->clp_send_flags & CHANGELOG_FLAG_JOBID)
-		rec_fmt |= CLF_JOBID;
-
-	if (cp->clp_send_flags & CHANGELOG_FLAG_EXTRA_FLAGS) {
-		rec_fmt |= CLF_EXTRA_FLAGS;
-		if (cp->clp_send_extra_flags & CHANGELOG_EXTRA_FLAG_UIDGID)
-			rec_extra_fmt |= CLFE_UIDGID;
-		if (cp->clp_send_extra_flags & CHANGELOG_EXTRA_FLAG_NID)
-			rec_extra_fmt |= CLFE_NID;
-		if (cp->clp_send_extra_flags & CHANGELOG_EXTRA_FLAG_OMODE)
-			rec_extra_fmt |= CLFE_OPEN;
-		if (cp->clp_send_extra_flags & CHANGELOG_EXTRA_FLAG_XATTR)
-			rec_extra_fmt |= CLFE_XATTR;
-	}
+	chlg_rec_fmt(cp, &rec_fmt, &rec_extra_fmt);
 
 	if (cp->clp_buf + cp->clp_buf_len <= cp->clp_buf_pos) {
 		ssize_t refresh;
@@ -287,6 +306,98 @@ out_free:
 	return rc;
 }
 
+/* Whether changelog_remap_rec() would change \a rec */
+static bool chlg_rec_need_remap(struct changelog_rec *rec,
+				enum changelog_rec_flags rec_fmt,
+				enum changelog_rec_extra_flags rec_extra_fmt)
+{
+	if ((rec->cr_flags & CLF_SUPPORTED) != (rec_fmt & CLF_SUPPORTED))
+		return true;
+
+	return rec->cr_flags & CLF_EXTRA_FLAGS &&
+	       (changelog_rec_extra_flags(rec)->cr_extra_flags &
+		CLFE_SUPPORTED) != (rec_extra_fmt & CLFE_SUPPORTED);
+}
+
+/**
+ * Receive a batch of changelog records.
+ *
+ * Up to \a count records are returned in \a recs.  They are not allocated
+ * one by one but point into buffers of the reader, so they must not be
+ * freed, and are only valid until the next call to llapi_changelog_recv(),
+ * llapi_changelog_recv_batch() or llapi_changelog_fini().  At most one read
+ * is done on the changelog device per call, so fewer than \a count records
+ * may be returned while more are pending.
+ *
+ * \param[in] priv	Opaque private control structure
+ * \param[out] recs	Array receiving the records
+ * \param[in] count	Size of \a recs
+ *
+ * \retval number of records stored in \a recs
+ * \retval 0 at the end of the changelog
+ * \retval negative errno on failure
+ */
+int llapi_changelog_recv_batch(void *priv, struct changelog_rec **recs,
+			       unsigned int count)
+{
+	struct changelog_private *cp = priv;
+	enum changelog_rec_flags rec_fmt;
+	enum changelog_rec_extra_flags rec_extra_fmt;
+	char *buf_end;
+	char *batch;
+	unsigned int nr = 0;
+
+	if (!cp || cp->clp_magic != CHANGELOG_PRIV_MAGIC)
+		return -EINVAL;
+
+	if (recs == NULL || count == 0)
+		return -EINVAL;
+
+	if (cp->clp_batch == NULL) {
+		cp->clp_batch = malloc(CHANGELOG_BATCH_SZ);
+		if (cp->clp_batch == NULL)
+			return -ENOMEM;
+	}
+
+	chlg_rec_fmt(cp, &rec_fmt, &rec_extra_fmt);
+
+	if (cp->clp_buf + cp->clp_buf_len <= cp->clp_buf_pos) {
+		ssize_t refresh;
+
+		refresh = chlg_read_bulk(cp);
+		if (refresh <= 0)
+			return refresh;
+	}
+
+	buf_end = cp->clp_buf + cp->clp_buf_len;
+	batch = cp->clp_batch;
+	while (nr < count && cp->clp_buf_pos < buf_end) {
+		struct changelog_rec *tmp = (void *)cp->clp_buf_pos;
+		size_t len = changelog_rec_size(tmp) + tmp->cr_namelen;
+
+		/* records are packed, so they may be misaligned */
+		if (!((uintptr_t)tmp & 7) &&
+		    !chlg_rec_need_remap(tmp, rec_fmt, rec_extra_fmt)) {
+			recs[nr] = tmp;
+		} else {
+			if (batch + CR_MAXSIZE > cp->clp_batch +
+						 CHANGELOG_BATCH_SZ)
+				break;
+
+			memcpy(batch, tmp, len);
+			recs[nr] = (struct changelog_rec *)batch;
+			changelog_remap_rec(recs[nr], rec_fmt, rec_extra_fmt);
+			batch += __ALIGN_KERNEL(changelog_rec_size(recs[nr]) +
+						recs[nr]->cr_namelen, 8);
+		}
+
+		cp->clp_buf_pos += len;
+		nr++;
+	}
+
+	return nr;
+}
+
 /** Release the changelog record when done with it. */
 int llapi_changelog_free(struct changelog_rec **rech)
 {
@@ -360,6 +471,33 @@ out:
 	return rc;
 }
 
+/**
+ * Only receive the changelog records matching \a filter.
+ *
+ * The records are filtered by the client kernel before they are copied to
+ * the reader, they are still all read from the MDT.  Call this right after
+ * llapi_changelog_start(), before the first record is received.
+ *
+ * \param[in] priv	Opaque private control structure
+ * \param[in] filter	Record types, FID sequence range and jobid to match
+ *
+ * \retval 0 on success
+ * \retval negative errno on failure, -EBUSY if records were already read
+ */
+int llapi_changelog_set_filter(void *priv,
+			       const struct changelog_filter *filter)
+{
+	struct changelog_private *cp = priv;
+
+	if (!cp || cp->clp_magic != CHANGELOG_PRIV_MAGIC || !filter)
+		return -EINVAL;
+
+	if (ioctl(cp->clp_fd, OBD_IOC_CHLG_SET_FILTER, filter) < 0)
+		return -errno;
+
+	return 0;
+}
+
 /**
  * Set extra flags for reading changelogs
  *
@@ -36,6 +36,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <pthread.h>
 #include <assert.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -58,6 +59,11 @@
 #define CHLG_POLL_INTV	60
 #define REC_MIN_AGE	600
 #define DEF_CACHE_SIZE	(256 * 1048576) /* 256MB */
+#define DEF_THREADS	4
+#define MAX_THREADS	64
+#define DEF_UPDATE_BATCH	256 /* FIDs synced per changelog clear */
+#define RECV_BATCH	64
+#define FID_HASH_SHIFT_MAX	20
 
 struct options {
 	const char	*o_chlg_user;
@@ -70,6 +76,8 @@ struct options {
 	int		 o_min_age;
 	unsigned long	 o_cached_fid_hiwm; /* high watermark */
 	unsigned long	 o_batch_sync_cnt;
+	int		 o_threads;
+	int		 o_update_batch;
 };
 
 struct options opt;
@@ -82,7 +90,8 @@ struct fid_rec {
 	__u64			fr_index;
 };
 
-static const int fid_hash_shift = 6;
+/* sized by lsom_setup() according to the FID cache size */
+static int fid_hash_shift = 6;
 
 #define FID_HASH_ENTRIES	(1 << fid_hash_shift)
 #define FID_ON_HASH(f)		(!hlist_unhashed(&(f)->fr_node))
@@ -101,6 +110,37 @@ struct lsom_head {
 	unsigned long		 lh_cached_count;
 } head;
 
+/*
+ * Worker threads syncing the LSOM of one batch of cached FIDs. The
+ * batch is taken from the head of lh_list, so the changelog can be
+ * cleared once up to the last record of the batch instead of once per
+ * FID.
+ */
+struct lsom_pool {
+	pthread_mutex_t		  lp_lock;
+	pthread_cond_t		  lp_work_cond;
+	pthread_cond_t		  lp_done_cond;
+	struct fid_rec		**lp_recs;	/* current batch */
+	int			 *lp_rcs;	/* update result of each FID */
+	int			  lp_count;
+	int			  lp_next;	/* next FID to update */
+	int			  lp_done;
+	bool			  lp_exit;
+	pthread_t		 *lp_threads;
+	int			  lp_nthreads;
+} pool;
+
+struct lsom_stats {
+	struct timespec		 ls_start;
+	unsigned long long	 ls_records;	/* SOM records received */
+	unsigned long long	 ls_coalesced;	/* merged into a cached FID */
+	unsigned long long	 ls_updated;	/* LSOM updates sent */
+	unsigned long long	 ls_vanished;	/* files gone before update */
+	unsigned long long	 ls_clears;	/* changelog clear calls */
+	unsigned long long	 ls_lag_total;	/* record age at update (s) */
+	unsigned long long	 ls_lag_max;
+} stats;
+
 static void usage(char *prog)
 {
 	printf("\nUsage: %s [options] -u <userid> -m <mdtdev> <mntpt>\n"
@@ -108,7 +148,10 @@ static void usage(char *prog)
 	       "\t-d, --daemonize\n"
 	       "\t-i, --interval, poll interval in second\n"
 	       "\t-a, --min-age, min age before a record is processed.\n"
+	       "\t\tUpdates of a file within this window are coalesced.\n"
+	       "\t-b, --batch, max FIDs synced per changelog clear\n"
 	       "\t-c, --max-cache, percentage of the memroy used for cache.\n"
+	       "\t-j, --threads, number of threads syncing LSOM xattrs\n"
 	       "\t-s, --sync, data sync when update LSOM xattr\n"
 	       "\t-v, --verbose, produce more verbose ouput\n",
 	       prog);
@@ -194,34 +237,10 @@ static struct fid_rec *fid_hash_find(const lustre_fid *fid)
 	return NULL;
 }
 
-static int lsom_setup(void)
-{
-	int i;
-
-	/* set llapi message level */
-	llapi_msg_set_level(opt.o_verbose);
-
-	memset(&head, 0, sizeof(head));
-	head.lh_hash = malloc(sizeof(struct hlist_head) * FID_HASH_ENTRIES);
-	if (head.lh_hash == NULL) {
-		llapi_err_noerrno(LLAPI_MSG_ERROR,
-				 "failed to alloc memory for hash (%zu).",
-				 sizeof(struct hlist_head) * FID_HASH_ENTRIES);
-		return -ENOMEM;
-	}
-
-	for (i = 0; i < FID_HASH_ENTRIES; i++)
-		INIT_HLIST_HEAD(&head.lh_hash[i]);
-
-	INIT_LIST_HEAD(&head.lh_list);
-	return 0;
-}
-
-static void lsom_cleanup(void)
-{
-	free(head.lh_hash);
-}
-
+/*
+ * Called from the sync threads, so it must only touch @f. The changelog
+ * is cleared by the caller once the whole batch is synced.
+ */
 static int lsom_update_one(struct fid_rec *f)
 {
 	struct stat st;
@@ -237,7 +256,7 @@ static int lsom_update_one(struct fid_rec *f)
 		 * changelog record and ignore this error.
 		 */
 		if (rc == -ENOENT)
-			goto clean_up;
+			return rc;
 
 		llapi_error(LLAPI_MSG_ERROR, rc,
 			    "llapi_open_by_fid for " DFID " failed",
@@ -259,8 +278,10 @@ static int lsom_update_one(struct fid_rec *f)
 
 	rc = fstat(fd, &st);
 	if (rc < 0) {
+		rc = -errno;
 		llapi_error(LLAPI_MSG_ERROR, rc, "failed to stat FID: " DFID,
 			    PFID(&f->fr_fid));
+		close(fd);
 		return rc;
 	}
 
@@ -277,76 +298,290 @@ static int lsom_update_one(struct fid_rec *f)
 		     (unsigned long long)f->fr_index,
 		     PFID(&f->fr_fid), st.st_size, st.st_blocks);
 
-clean_up:
-	rc = llapi_changelog_clear(opt.o_mdtname,
-				   opt.o_chlg_user, f->fr_index);
-	if (rc)
-		llapi_error(LLAPI_MSG_ERROR, rc,
-			    "failed to clear changelog record: %s:%llu",
-			    opt.o_chlg_user, (unsigned long long)f->fr_index);
-	return rc;
+	return 0;
+}
+
+static void *lsom_worker(void *arg)
+{
+	struct lsom_pool *lp = arg;
+	int i;
+
+	pthread_mutex_lock(&lp->lp_lock);
+	while (1) {
+		while (!lp->lp_exit && lp->lp_next >= lp->lp_count)
+			pthread_cond_wait(&lp->lp_work_cond, &lp->lp_lock);
+		if (lp->lp_exit)
+			break;
+
+		i = lp->lp_next++;
+		pthread_mutex_unlock(&lp->lp_lock);
+
+		lp->lp_rcs[i] = lsom_update_one(lp->lp_recs[i]);
+
+		pthread_mutex_lock(&lp->lp_lock);
+		if (++lp->lp_done == lp->lp_count)
+			pthread_cond_signal(&lp->lp_done_cond);
+	}
+	pthread_mutex_unlock(&lp->lp_lock);
+
+	return NULL;
+}
+
+/* Sync the LSOM of the first @count FIDs of pool.lp_recs */
+static void lsom_run_batch(int count)
+{
+	int i;
+
+	if (pool.lp_nthreads == 0) {
+		for (i = 0; i < count; i++)
+			pool.lp_rcs[i] = lsom_update_one(pool.lp_recs[i]);
+		return;
+	}
+
+	pthread_mutex_lock(&pool.lp_lock);
+	pool.lp_count = count;
+	pool.lp_next = 0;
+	pool.lp_done = 0;
+	pthread_cond_broadcast(&pool.lp_work_cond);
+	while (pool.lp_done < pool.lp_count)
+		pthread_cond_wait(&pool.lp_done_cond, &pool.lp_lock);
+	pool.lp_count = 0;
+	pthread_mutex_unlock(&pool.lp_lock);
+}
+
+static int lsom_pool_start(void)
+{
+	int rc;
+
+	memset(&pool, 0, sizeof(pool));
+	pool.lp_recs = calloc(opt.o_update_batch, sizeof(*pool.lp_recs));
+	pool.lp_rcs = calloc(opt.o_update_batch, sizeof(*pool.lp_rcs));
+	if (pool.lp_recs == NULL || pool.lp_rcs == NULL)
+		return -ENOMEM;
+
+	/* a single thread syncs from the main thread */
+	if (opt.o_threads <= 1)
+		return 0;
+
+	pool.lp_threads = calloc(opt.o_threads, sizeof(*pool.lp_threads));
+	if (pool.lp_threads == NULL)
+		return -ENOMEM;
+
+	pthread_mutex_init(&pool.lp_lock, NULL);
+	pthread_cond_init(&pool.lp_work_cond, NULL);
+	pthread_cond_init(&pool.lp_done_cond, NULL);
+
+	for (; pool.lp_nthreads < opt.o_threads; pool.lp_nthreads++) {
+		rc = pthread_create(&pool.lp_threads[pool.lp_nthreads], NULL,
+				    lsom_worker, &pool);
+		if (rc) {
+			llapi_error(LLAPI_MSG_ERROR, -rc,
+				    "failed to start sync thread %d",
+				    pool.lp_nthreads);
+			if (pool.lp_nthreads == 0)
+				return -rc;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static void lsom_pool_stop(void)
+{
+	int i;
+
+	if (pool.lp_nthreads > 0) {
+		pthread_mutex_lock(&pool.lp_lock);
+		pool.lp_exit = true;
+		pthread_cond_broadcast(&pool.lp_work_cond);
+		pthread_mutex_unlock(&pool.lp_lock);
+
+		for (i = 0; i < pool.lp_nthreads; i++)
+			pthread_join(pool.lp_threads[i], NULL);
+		pool.lp_nthreads = 0;
+	}
+
+	free(pool.lp_threads);
+	free(pool.lp_recs);
+	free(pool.lp_rcs);
+}
+
+static int lsom_setup(void)
+{
+	unsigned long buckets;
+	int i;
+
+	/* set llapi message level */
+	llapi_msg_set_level(opt.o_verbose);
+
+	/* aim for short hash chains when the FID cache is full */
+	for (buckets = opt.o_cached_fid_hiwm / 8;
+	     buckets >= (2UL << fid_hash_shift) &&
+	     fid_hash_shift < FID_HASH_SHIFT_MAX; fid_hash_shift++)
+		;
+
+	memset(&head, 0, sizeof(head));
+	head.lh_hash = malloc(sizeof(struct hlist_head) * FID_HASH_ENTRIES);
+	if (head.lh_hash == NULL) {
+		llapi_err_noerrno(LLAPI_MSG_ERROR,
+				 "failed to alloc memory for hash (%zu).",
+				 sizeof(struct hlist_head) * FID_HASH_ENTRIES);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < FID_HASH_ENTRIES; i++)
+		INIT_HLIST_HEAD(&head.lh_hash[i]);
+
+	INIT_LIST_HEAD(&head.lh_list);
+
+	memset(&stats, 0, sizeof(stats));
+	clock_gettime(CLOCK_MONOTONIC, &stats.ls_start);
+
+	return lsom_pool_start();
+}
+
+static void lsom_cleanup(void)
+{
+	lsom_pool_stop();
+	free(head.lh_hash);
+}
+
+static void lsom_print_stats(void)
+{
+	struct timespec now;
+	double elapsed;
+	unsigned long long synced = stats.ls_updated + stats.ls_vanished;
+	unsigned long long lag = 0;
+	time_t oldest = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	elapsed = (now.tv_sec - stats.ls_start.tv_sec) +
+		  (now.tv_nsec - stats.ls_start.tv_nsec) / 1e9;
+	if (elapsed <= 0)
+		elapsed = 1;
+	if (synced)
+		lag = stats.ls_lag_total / synced;
+	if (!list_empty(&head.lh_list)) {
+		struct fid_rec *f;
+
+		f = list_entry(head.lh_list.next, struct fid_rec, fr_link);
+		oldest = time(NULL) - (f->fr_time >> 30);
+	}
+
+	llapi_printf(LLAPI_MSG_INFO,
+		     "LSOM sync: %llu records, %llu coalesced, %llu updated (%.1f/s), %llu vanished, %llu clears, %lu pending (oldest %llds), lag avg %llus max %llus\n",
+		     stats.ls_records, stats.ls_coalesced, stats.ls_updated,
+		     stats.ls_updated / elapsed, stats.ls_vanished,
+		     stats.ls_clears, head.lh_cached_count,
+		     (long long)oldest, lag, stats.ls_lag_max);
 }
 
 static int lsom_start_update(int count)
 {
+	struct fid_rec *f;
+	time_t now;
 	int rc = 0;
+	int done;
+	int n;
 	int i = 0;
+	int j;
 
 	llapi_printf(LLAPI_MSG_INFO, "Start to sync %d records.\n", count);
 
 	while (i < count) {
-		struct fid_rec *f;
+		n = 0;
+		list_for_each_entry(f, &head.lh_list, fr_link) {
+			if (n == opt.o_update_batch || i + n == count)
+				break;
+			pool.lp_recs[n++] = f;
+		}
+		if (n == 0)
+			break;
 
-		f = list_entry(head.lh_list.next, struct fid_rec, fr_link);
-		rc = lsom_update_one(f);
-		if (rc == 0) {
+		lsom_run_batch(n);
+
+		/* only the in-order prefix of synced FIDs can be cleared */
+		now = time(NULL);
+		for (done = 0; done < n; done++) {
+			__u64 lag;
+
+			rc = pool.lp_rcs[done];
+			if (rc == -ENOENT)
+				stats.ls_vanished++;
+			else if (rc == 0)
+				stats.ls_updated++;
+			else
+				break;
+
+			f = pool.lp_recs[done];
+			lag = now > (f->fr_time >> 30) ?
+			      now - (f->fr_time >> 30) : 0;
+			stats.ls_lag_total += lag;
+			if (lag > stats.ls_lag_max)
+				stats.ls_lag_max = lag;
+		}
+		if (done == 0)
+			break;
+
+		f = pool.lp_recs[done - 1];
+		rc = llapi_changelog_clear(opt.o_mdtname,
+					   opt.o_chlg_user, f->fr_index);
+		if (rc) {
+			llapi_error(LLAPI_MSG_ERROR, rc,
+				    "failed to clear changelog record: %s:%llu",
+				    opt.o_chlg_user,
+				    (unsigned long long)f->fr_index);
+			break;
+		}
+		stats.ls_clears++;
+
+		for (j = 0; j < done; j++) {
+			f = pool.lp_recs[j];
 			list_del_init(&f->fr_link);
 			fid_hash_del(f);
 			free(f);
 			head.lh_cached_count--;
-			i++;
-		} else {
-			goto out;
 		}
+		i += done;
+
+		rc = done < n ? pool.lp_rcs[done] : 0;
+		if (rc)
+			break;
 	}
 
-out:
 	return rc;
 }
 
 static int lsom_check_sync(void)
 {
-	int rc = 0;
-	int count;
+	struct fid_rec *f;
+	time_t now;
+	int count = 0;
 
-repeated:
-	count = 0;
 	if (list_empty(&head.lh_list))
 		return 0;
 
-	if (head.lh_cached_count > opt.o_cached_fid_hiwm)
+	if (head.lh_cached_count > opt.o_cached_fid_hiwm) {
 		count = opt.o_batch_sync_cnt;
-	else {
-		struct fid_rec *f;
-		time_t now;
-
-		/* When the first record in the list was not being
-		 * processed for a long time (more than o_min_age),
-		 * pop the record, start to handle it immediately.
+	} else {
+		/* Sync all the records at the head of the list which
+		 * were not processed for a long time (more than
+		 * o_min_age), later updates to them are coalesced until
+		 * then.
 		 */
 		now = time(NULL);
-		f = list_entry(head.lh_list.next, struct fid_rec, fr_link);
-		if (now > ((f->fr_time >> 30) + opt.o_min_age))
-			count = 1;
+		list_for_each_entry(f, &head.lh_list, fr_link) {
+			if (now <= ((f->fr_time >> 30) + opt.o_min_age))
+				break;
+			count++;
+		}
 	}
 
 	if (count > 0)
-		rc = lsom_start_update(count);
-
-	if (rc == 0 && count == 1)
-		goto repeated;
+		return lsom_start_update(count);
 
-	return rc;
+	return 0;
 }
 
 static void lsom_sort_record_list(struct fid_rec *f)
@@ -378,6 +613,7 @@ static int process_record(struct changelog_rec *rec)
 	    rec->cr_type == CL_SETATTR) {
 		struct fid_rec *f;
 
+		stats.ls_records++;
 		f = fid_hash_find(&rec->cr_tfid);
 		if (f == NULL) {
 			f = malloc(sizeof(struct fid_rec));
@@ -401,6 +637,7 @@ static int process_record(struct changelog_rec *rec)
 			list_add_tail(&f->fr_link, &head.lh_list);
 			head.lh_cached_count++;
 		} else {
+			stats.ls_coalesced++;
 			f->fr_index = index;
 			lsom_sort_record_list(f);
 		}
@@ -443,7 +680,7 @@ int main(int argc, char **argv)
 	int			 c;
 	int			 rc;
 	void			*chglog_hdlr;
-	struct changelog_rec	*rec;
+	struct changelog_rec	*recs[RECV_BATCH];
 	bool			 stop = 0;
 	int			 ret = 0;
 	unsigned long		 cache_size = DEF_CACHE_SIZE;
@@ -454,7 +691,9 @@ int main(int argc, char **argv)
 		{ "daemonize", no_argument, NULL, 'd'},
 		{ "interval", required_argument, NULL, 'i'},
 		{ "min-age", required_argument, NULL, 'a'},
+		{ "batch", required_argument, NULL, 'b'},
 		{ "max-cache", required_argument, NULL, 'c'},
+		{ "threads", required_argument, NULL, 'j'},
 		{ "verbose", no_argument, NULL, 'v'},
 		{ "sync", no_argument, NULL, 's'},
 		{ "help", no_argument, NULL, 'h' },
@@ -466,8 +705,11 @@ int main(int argc, char **argv)
 	opt.o_verbose = LLAPI_MSG_INFO;
 	opt.o_intv = CHLG_POLL_INTV;
 	opt.o_min_age = REC_MIN_AGE;
+	opt.o_threads = DEF_THREADS;
+	opt.o_update_batch = DEF_UPDATE_BATCH;
 
-	while ((c = getopt_long(argc, argv, "u:hm:dsi:a:c:v", options, NULL))
+	while ((c = getopt_long(argc, argv, "u:hm:dsi:a:b:c:j:v", options,
+				NULL))
 	       != EOF) {
 		switch (c) {
 		default:
@@ -506,6 +748,24 @@ int main(int argc, char **argv)
 				return rc;
 			}
 			break;
+		case 'b':
+			opt.o_update_batch = atoi(optarg);
+			if (opt.o_update_batch <= 0) {
+				rc = -EINVAL;
+				llapi_error(LLAPI_MSG_ERROR, rc,
+					    "bad value for -b %s", optarg);
+				return rc;
+			}
+			break;
+		case 'j':
+			opt.o_threads = atoi(optarg);
+			if (opt.o_threads <= 0 || opt.o_threads > MAX_THREADS) {
+				rc = -EINVAL;
+				llapi_error(LLAPI_MSG_ERROR, rc,
+					    "bad value for -j %s", optarg);
+				return rc;
+			}
+			break;
 		case 'c':
 			rc = Parser_size(&cache_size, optarg);
 			if (rc < 0) {
@@ -588,26 +848,32 @@ int main(int argc, char **argv)
 		}
 
 		while (!eof && !stop) {
-			rc = llapi_changelog_recv(chglog_hdlr, &rec);
-			switch (rc) {
-			case 0:
-				rc = process_record(rec);
-				if (rc) {
-					llapi_error(LLAPI_MSG_ERROR, rc,
-						    "failed to process record");
-					ret = rc;
+			int i;
+
+			rc = llapi_changelog_recv_batch(chglog_hdlr, recs,
+							RECV_BATCH);
+			if (rc > 0) {
+				for (i = 0; i < rc; i++) {
+					int rc2 = process_record(recs[i]);
+
+					if (rc2) {
+						llapi_error(LLAPI_MSG_ERROR,
+							    rc2,
+							    "failed to process record");
+						ret = rc2;
+					}
 				}
 
-				llapi_changelog_free(&rec);
-
 				rc = lsom_check_sync();
 				if (rc) {
 					stop = true;
 					ret = rc;
 				}
+				continue;
+			}
 
-				break;
-			case 1: /* EOF */
+			switch (rc) {
+			case 0: /* EOF */
 				llapi_printf(LLAPI_MSG_DEBUG,
 					     "finished reading [%s]\n",
 					     opt.o_mdtname);
@@ -646,6 +912,7 @@ int main(int argc, char **argv)
 			lsom_start_update(head.lh_cached_count);
 			stop = true;
 		}
+		lsom_print_stats();
 	}
 
 	lsom_cleanup();
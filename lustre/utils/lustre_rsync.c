@@ -115,6 +115,8 @@
 #include <sys/types.h>
 #include <errno.h>
 #include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <utime.h>
 #include <time.h>
 #include <sys/xattr.h>
@@ -128,6 +130,9 @@
 #define REPLICATE_STATUS_VER 1
 #define CLEAR_INTERVAL 100
 #define DEFAULT_RSYNC_THRESHOLD 0xA00000 /* 10 MB */
+#define LR_BATCH 64		/* Records fetched per changelog read */
+#define LR_WINDOW 256		/* Records in flight with --threads */
+#define LR_MAX_THREADS 64
 
 #define TYPE_STR_LEN 16
 
@@ -149,6 +154,9 @@ struct lr_info {
 	long long recno;
 	int target_no;
 	unsigned int is_extended:1;
+	unsigned int is_barrier:1;	/* Must run alone with --threads */
+	int pipe_state;			/* enum lr_pipe_state */
+	int pipe_rc;
 	enum changelog_rec_type type;
 	char tfid[LR_FID_STR_LEN];
 	char pfid[LR_FID_STR_LEN];
@@ -177,6 +185,34 @@ struct lr_parent_child_list {
 	struct lr_parent_child_list *pc_next;
 };
 
+enum lr_pipe_state {
+	LR_QUEUED = 0,
+	LR_BUSY,
+	LR_DONE,
+};
+
+/*
+ * Records replicated by the worker threads. Records are kept in
+ * changelog order in a ring of LR_WINDOW slots. A worker takes the
+ * oldest queued record which shares no FID with an earlier record that
+ * is not yet done, so operations on the same file or directory are
+ * replayed in order while unrelated files are copied in parallel. The
+ * main thread retires done records from the head of the ring, which
+ * keeps error reporting and changelog clearing in record order.
+ */
+struct lr_pipe {
+	pthread_mutex_t lp_lock;
+	pthread_cond_t lp_work_cond;	/* Work queued or exiting */
+	pthread_cond_t lp_done_cond;	/* A record completed */
+	struct lr_info *lp_win[LR_WINDOW];
+	int lp_head;
+	int lp_count;
+	int lp_exit;
+	long long lp_last_recno;	/* Last retired record */
+	pthread_t lp_threads[LR_MAX_THREADS];
+	int lp_nthreads;
+};
+
 struct lustre_rsync_status *status;
 char *statuslog;  /* Name of the status log file */
 int logbackedup;
@@ -186,6 +222,7 @@ int debug;      /* Flag to turn debugging information on and off */
 int verbose;    /* Verbose output */
 long long rec_count; /* No of changelog records that were processed */
 int errors;
+int nthreads = 1; /* Number of replication threads */
 int dryrun;
 int use_rsync;  /* Flag to turn on use of rsync to copy data */
 long long rsync_threshold = DEFAULT_RSYNC_THRESHOLD;
@@ -197,6 +234,14 @@ int abort_on_err;
 char rsync[PATH_MAX + 128];
 char rsync_ver[PATH_MAX * 2];
 struct lr_parent_child_list *parents;
+/* Protect 'parents' and 'errors' against the replication threads */
+pthread_mutex_t lr_pc_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t lr_err_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Records returned by the last batched changelog read */
+struct changelog_rec *lr_batch[LR_BATCH];
+int lr_batch_count;
+int lr_batch_next;
 
 FILE *debug_log;
 
@@ -206,6 +251,7 @@ struct option long_opts[] = {
 	{ .val = 'm',	.name = "mdt",		.has_arg = required_argument },
 	{ .val = 's',	.name = "source",	.has_arg = required_argument },
 	{ .val = 't',	.name = "target",	.has_arg = required_argument },
+	{ .val = 'T',	.name = "threads",	.has_arg = required_argument },
 	{ .val = 'u',	.name = "user",		.has_arg = required_argument },
 	{ .val = 'v',	.name = "verbose",	.has_arg = no_argument },
 	{ .val = 'x',	.name = "xattr",	.has_arg = required_argument },
@@ -231,6 +277,7 @@ void lr_usage(void)
 		"\tlustre_rsync -l <log_file>\n"
 		"options:\n"
 		"\t--xattr <yes|no> replicate EAs\n"
+		"\t--threads <n>    replicate with n threads\n"
 		"\t--abort-on-err   abort at first err\n"
 		"\t--verbose\n"
 		"\t--dry-run        don't write anything\n");
@@ -255,6 +302,13 @@ void lr_debug(int level, const char *fmt, ...)
 	va_end(ap);
 }
 
+void lr_error(void)
+{
+	pthread_mutex_lock(&lr_err_lock);
+	errors++;
+	pthread_mutex_unlock(&lr_err_lock);
+}
+
 void *lr_grow_buf(void *buf, int size)
 {
 	void *ptr;
@@ -505,7 +559,7 @@ int lr_copy_xattr(struct lr_info *info)
 					fprintf(stderr, "cannot replicate xattrs from '%s' to '%s': %s\n",
 						info->src, info->dest,
 						strerror(errno));
-					errors++;
+					lr_error();
 				}
 				rc = 0;
 			}
@@ -661,8 +715,10 @@ int lr_add_pc(const char *pfid, const char *tfid, const char *name)
 	if (len >= sizeof(p->pc_log.pcl_name))
 		goto out_err;
 
+	pthread_mutex_lock(&lr_pc_lock);
 	p->pc_next = parents;
 	parents = p;
+	pthread_mutex_unlock(&lr_pc_lock);
 	return 0;
 
 out_err:
@@ -693,7 +749,7 @@ void lr_cascade_move(const char *fid, const char *dest, struct lr_info *info)
 			if (rc == -1) {
 				fprintf(stderr, "Error renaming file %s to %s: %d\n",
 					info->src, d, errno);
-				errors++;
+				lr_error();
 			}
 			if (curr == parents)
 				parents = curr->pc_next;
@@ -714,6 +770,7 @@ int lr_remove_pc(const char *pfid, const char *tfid)
 {
 	struct lr_parent_child_list *curr, *prev;
 
+	pthread_mutex_lock(&lr_pc_lock);
 	for (prev = curr = parents; curr; prev = curr, curr = curr->pc_next) {
 		if (strcmp(curr->pc_log.pcl_pfid, pfid) == 0 &&
 		    strcmp(curr->pc_log.pcl_tfid, tfid) == 0) {
@@ -725,6 +782,7 @@ int lr_remove_pc(const char *pfid, const char *tfid)
 			break;
 		}
 	}
+	pthread_mutex_unlock(&lr_pc_lock);
 	return 0;
 }
 
@@ -988,10 +1046,13 @@ int lr_move(struct lr_info *info)
 		if (special_src)
 			rc1 = lr_remove_pc(info->spfid, info->sfid);
 
-		if (!special_dest)
+		if (!special_dest) {
+			pthread_mutex_lock(&lr_pc_lock);
 			lr_cascade_move(info->sfid, info->dest, info);
-		else
+			pthread_mutex_unlock(&lr_pc_lock);
+		} else {
 			rc1 = lr_add_pc(info->pfid, info->sfid, info->name);
+		}
 
 		lr_debug(DINFO, "move: %s [to] %s rc1=%d, errno=%d\n",
 			 info->src, info->dest, rc1, errno);
@@ -1189,9 +1250,17 @@ int lr_parse_line(void *priv, struct lr_info *info)
 	struct changelog_ext_rename	*rnm;
 	size_t				 namelen;
 	size_t				 copylen = sizeof(info->name);
+	int				 rc;
 
-	if (llapi_changelog_recv(priv, &rec) != 0)
-		return -1;
+	if (lr_batch_next == lr_batch_count) {
+		rc = llapi_changelog_recv_batch(priv, lr_batch, LR_BATCH);
+		if (rc <= 0)
+			return -1;
+		lr_batch_count = rc;
+		lr_batch_next = 0;
+	}
+	/* Batched records belong to the reader and must not be freed */
+	rec = lr_batch[lr_batch_next++];
 
 	info->is_extended = !!(rec->cr_flags & CLF_RENAME);
 	info->recno = rec->cr_index;
@@ -1227,8 +1296,6 @@ int lr_parse_line(void *priv, struct lr_info *info)
 			       info->name);
 	}
 
-	llapi_changelog_free(&rec);
-
 	rec_count++;
 	return 0;
 }
@@ -1290,6 +1357,7 @@ int lr_write_log(void)
 		return -1;
 	}
 
+	pthread_mutex_lock(&lr_pc_lock);
 	for (curr = parents; curr; curr = curr->pc_next) {
 		size = write(fd, &curr->pc_log, sizeof(curr->pc_log));
 		if (size != sizeof(curr->pc_log)) {
@@ -1299,6 +1367,7 @@ int lr_write_log(void)
 			break;
 		}
 	}
+	pthread_mutex_unlock(&lr_pc_lock);
 	close(fd);
 	return rc;
 }
@@ -1530,12 +1599,260 @@ void lr_print_failure(struct lr_info *info, int rc)
 		info->tfid, info->pfid, info->name);
 }
 
+/* Replicate a single changelog record */
+int lr_process(struct lr_info *info)
+{
+	int rc = 0;
+
+	lr_debug(DTRACE, "***** Start %lld %s (%d) %s %s %s *****\n",
+		 info->recno, changelog_type2str(info->type),
+		 info->type, info->tfid, info->pfid, info->name);
+
+	switch (info->type) {
+	case CL_CREATE:
+	case CL_MKDIR:
+	case CL_MKNOD:
+	case CL_SOFTLINK:
+		rc = lr_create(info);
+		break;
+	case CL_RMDIR:
+	case CL_UNLINK:
+		rc = lr_remove(info);
+		break;
+	case CL_RENAME:
+		rc = lr_move(info);
+		break;
+	case CL_HARDLINK:
+		rc = lr_link(info);
+		break;
+	case CL_TRUNC:
+	case CL_SETATTR:
+		rc = lr_setattr(info);
+		break;
+	case CL_SETXATTR:
+		rc = lr_setxattr(info);
+		break;
+	case CL_CLOSE:
+	case CL_EXT:
+	case CL_OPEN:
+	case CL_GETXATTR:
+	case CL_DN_OPEN:
+	case CL_LAYOUT:
+	case CL_MARK:
+		/*
+		 * Nothing needs to be done for these entries
+		 * fallthrough
+		 */
+	default:
+		break;
+	}
+
+	lr_debug(DTRACE, "##### End %lld %s (%d) %s %s %s rc=%d #####\n",
+		 info->recno, changelog_type2str(info->type),
+		 info->type, info->tfid, info->pfid, info->name, rc);
+
+	return rc;
+}
+
+void lr_free_info(struct lr_info *info)
+{
+	free(info->buf);
+	free(info->xlist);
+	free(info->xvalue);
+	free(info);
+}
+
+static bool lr_fid_shared(const struct lr_info *a, const char *fid)
+{
+	if (fid[0] == '\0')
+		return false;
+
+	return strcmp(a->tfid, fid) == 0 || strcmp(a->pfid, fid) == 0 ||
+	       strcmp(a->sfid, fid) == 0 || strcmp(a->spfid, fid) == 0;
+}
+
+/* Must record 'b' wait for the earlier record 'a' to complete? */
+static bool lr_depends(const struct lr_info *a, const struct lr_info *b)
+{
+	if (a->is_barrier || b->is_barrier)
+		return true;
+
+	return lr_fid_shared(a, b->tfid) || lr_fid_shared(a, b->pfid) ||
+	       lr_fid_shared(a, b->sfid) || lr_fid_shared(a, b->spfid);
+}
+
+/* Find a queued record whose predecessors allow it to run. */
+static struct lr_info *lr_pipe_next(struct lr_pipe *lp)
+{
+	struct lr_info *info;
+	int i, j;
+
+	for (i = 0; i < lp->lp_count; i++) {
+		info = lp->lp_win[(lp->lp_head + i) % LR_WINDOW];
+		if (info->pipe_state != LR_QUEUED)
+			continue;
+
+		for (j = 0; j < i; j++) {
+			struct lr_info *prev;
+
+			prev = lp->lp_win[(lp->lp_head + j) % LR_WINDOW];
+			if (prev->pipe_state != LR_DONE &&
+			    lr_depends(prev, info))
+				break;
+		}
+		if (j == i)
+			return info;
+		/* Nothing after a blocked barrier can run either */
+		if (info->is_barrier)
+			return NULL;
+	}
+
+	return NULL;
+}
+
+static void *lr_pipe_worker(void *arg)
+{
+	struct lr_pipe *lp = arg;
+	struct lr_info *info;
+	int rc;
+
+	pthread_mutex_lock(&lp->lp_lock);
+	while (1) {
+		info = lr_pipe_next(lp);
+		if (!info) {
+			if (lp->lp_exit)
+				break;
+			pthread_cond_wait(&lp->lp_work_cond, &lp->lp_lock);
+			continue;
+		}
+
+		info->pipe_state = LR_BUSY;
+		pthread_mutex_unlock(&lp->lp_lock);
+
+		rc = lr_process(info);
+
+		pthread_mutex_lock(&lp->lp_lock);
+		info->pipe_rc = rc;
+		info->pipe_state = LR_DONE;
+		/* Records waiting on this one may be runnable now */
+		pthread_cond_broadcast(&lp->lp_work_cond);
+		pthread_cond_signal(&lp->lp_done_cond);
+	}
+	pthread_mutex_unlock(&lp->lp_lock);
+
+	return NULL;
+}
+
+/*
+ * Retire completed records from the head of the window in changelog
+ * order. With 'all' set, wait until every queued record is retired.
+ */
+static void lr_pipe_retire(struct lr_pipe *lp, bool all)
+{
+	struct lr_info *info;
+
+	pthread_mutex_lock(&lp->lp_lock);
+	while (lp->lp_count > 0) {
+		info = lp->lp_win[lp->lp_head];
+		if (info->pipe_state != LR_DONE) {
+			if (!all && lp->lp_count < LR_WINDOW)
+				break;
+			pthread_cond_wait(&lp->lp_done_cond, &lp->lp_lock);
+			continue;
+		}
+		lp->lp_head = (lp->lp_head + 1) % LR_WINDOW;
+		lp->lp_count--;
+		pthread_mutex_unlock(&lp->lp_lock);
+
+		if (info->pipe_rc && info->pipe_rc != -ENOENT) {
+			lr_print_failure(info, info->pipe_rc);
+			lr_error();
+			if (abort_on_err)
+				quit = 1;
+		}
+		/* Only clear records up to the oldest incomplete one */
+		lr_clear_cl(info, 0);
+		lp->lp_last_recno = info->recno;
+		lr_free_info(info);
+
+		pthread_mutex_lock(&lp->lp_lock);
+	}
+	pthread_mutex_unlock(&lp->lp_lock);
+}
+
+/* Queue a record for the workers. The pipe takes ownership of 'info'. */
+static void lr_pipe_queue(struct lr_pipe *lp, struct lr_info *info)
+{
+	/* Records in the rename and link replay read and move entries of
+	 * SPECIAL_DIR and depend on the paths of unrelated records.
+	 */
+	info->is_barrier = info->type == CL_RENAME ||
+			   info->type == CL_HARDLINK;
+	info->pipe_state = LR_QUEUED;
+
+	/* Make room in the window */
+	lr_pipe_retire(lp, false);
+
+	pthread_mutex_lock(&lp->lp_lock);
+	lp->lp_win[(lp->lp_head + lp->lp_count) % LR_WINDOW] = info;
+	lp->lp_count++;
+	pthread_cond_signal(&lp->lp_work_cond);
+	pthread_mutex_unlock(&lp->lp_lock);
+}
+
+static int lr_pipe_start(struct lr_pipe *lp, int threads)
+{
+	int rc;
+
+	memset(lp, 0, sizeof(*lp));
+	pthread_mutex_init(&lp->lp_lock, NULL);
+	pthread_cond_init(&lp->lp_work_cond, NULL);
+	pthread_cond_init(&lp->lp_done_cond, NULL);
+
+	for (lp->lp_nthreads = 0; lp->lp_nthreads < threads;
+	     lp->lp_nthreads++) {
+		rc = pthread_create(&lp->lp_threads[lp->lp_nthreads], NULL,
+				    lr_pipe_worker, lp);
+		if (rc) {
+			fprintf(stderr, "Error creating replication thread: %s\n",
+				strerror(rc));
+			if (lp->lp_nthreads == 0)
+				return -rc;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/* Wait for all queued records to be replicated and stop the workers */
+static void lr_pipe_stop(struct lr_pipe *lp)
+{
+	int i;
+
+	lr_pipe_retire(lp, true);
+
+	pthread_mutex_lock(&lp->lp_lock);
+	lp->lp_exit = 1;
+	pthread_cond_broadcast(&lp->lp_work_cond);
+	pthread_mutex_unlock(&lp->lp_lock);
+
+	for (i = 0; i < lp->lp_nthreads; i++)
+		pthread_join(lp->lp_threads[i], NULL);
+
+	pthread_cond_destroy(&lp->lp_done_cond);
+	pthread_cond_destroy(&lp->lp_work_cond);
+	pthread_mutex_destroy(&lp->lp_lock);
+}
+
 /* Replicate filesystem operations from src_path to target_path */
 int lr_replicate(void)
 {
 	void *changelog_priv;
 	struct lr_info *info;
 	struct lr_info *ext = NULL;
+	struct lr_info *next;
+	struct lr_pipe *lp = NULL;
 	time_t start;
 	int xattr_not_supp;
 	int i;
@@ -1594,6 +1911,20 @@ int lr_replicate(void)
 
 	lr_print_status(info);
 
+	if (nthreads > 1 && !dryrun) {
+		lp = malloc(sizeof(*lp));
+		if (!lp) {
+			rc = -ENOMEM;
+			goto out;
+		}
+		rc = lr_pipe_start(lp, nthreads);
+		if (rc) {
+			free(lp);
+			lp = NULL;
+			goto out;
+		}
+	}
+
 	/* Open changelogs for consumption*/
 	rc = llapi_changelog_start(&changelog_priv,
 				   CHANGELOG_FLAG_BLOCK |
@@ -1644,52 +1975,18 @@ int lr_replicate(void)
 		if (dryrun)
 			continue;
 
-		lr_debug(DTRACE, "***** Start %lld %s (%d) %s %s %s *****\n",
-			 info->recno, changelog_type2str(info->type),
-			 info->type, info->tfid, info->pfid, info->name);
-
-		switch (info->type) {
-		case CL_CREATE:
-		case CL_MKDIR:
-		case CL_MKNOD:
-		case CL_SOFTLINK:
-			rc = lr_create(info);
-			break;
-		case CL_RMDIR:
-		case CL_UNLINK:
-			rc = lr_remove(info);
-			break;
-		case CL_RENAME:
-			rc = lr_move(info);
-			break;
-		case CL_HARDLINK:
-			rc = lr_link(info);
-			break;
-		case CL_TRUNC:
-		case CL_SETATTR:
-			rc = lr_setattr(info);
-			break;
-		case CL_SETXATTR:
-			rc = lr_setxattr(info);
-			break;
-		case CL_CLOSE:
-		case CL_EXT:
-		case CL_OPEN:
-		case CL_GETXATTR:
-		case CL_DN_OPEN:
-		case CL_LAYOUT:
-		case CL_MARK:
-			/*
-			 * Nothing needs to be done for these entries
-			 * fallthrough
-			 */
-		default:
-			break;
+		if (lp) {
+			next = calloc(1, sizeof(struct lr_info));
+			if (!next) {
+				rc = -ENOMEM;
+				break;
+			}
+			lr_pipe_queue(lp, info);
+			info = next;
+			continue;
 		}
 
-		lr_debug(DTRACE, "##### End %lld %s (%d) %s %s %s rc=%d #####\n",
-			 info->recno, changelog_type2str(info->type),
-			 info->type, info->tfid, info->pfid, info->name, rc);
+		rc = lr_process(info);
 
 		if (rc && rc != -ENOENT) {
 			lr_print_failure(info, rc);
@@ -1700,6 +1997,13 @@ int lr_replicate(void)
 		lr_clear_cl(info, 0);
 	}
 
+	if (lp) {
+		lr_pipe_stop(lp);
+		info->recno = lp->lp_last_recno;
+		free(lp);
+		lp = NULL;
+	}
+
 	llapi_changelog_fini(&changelog_priv);
 
 	if (errors || verbose)
@@ -1716,6 +2020,10 @@ int lr_replicate(void)
 	rc = 0;
 
 out:
+	if (lp) {
+		lr_pipe_stop(lp);
+		free(lp);
+	}
 	if (info)
 		free(info);
 	if (ext)
@@ -1741,7 +2049,7 @@ int main(int argc, char *argv[])
 	if ((rc = lr_init_status()) != 0)
 		return rc;
 
-	while ((rc = getopt_long(argc, argv, "as:t:m:u:l:vx:zc:ry:n:d:D:",
+	while ((rc = getopt_long(argc, argv, "as:t:T:m:u:l:vx:zc:ry:n:d:D:",
 				 long_opts, NULL)) >= 0) {
 		switch (rc) {
 		case 'a':
@@ -1776,6 +2084,14 @@ int main(int argc, char *argv[])
 			snprintf(status->ls_targets[status->ls_num_targets - 1],
 				 sizeof(status->ls_targets[0]), "%s", optarg);
 			break;
+		case 'T':
+			nthreads = atoi(optarg);
+			if (nthreads < 1 || nthreads > LR_MAX_THREADS) {
+				printf("Invalid parameter %s. Specify --threads between 1 and %d\n",
+				       optarg, LR_MAX_THREADS);
+				return -1;
+			}
+			break;
 		case 'm':
 			snprintf(status->ls_mdt_device,
 				 sizeof(status->ls_mdt_device),
@@ -368,6 +368,7 @@ check_lu_ladvise(void)
 	CHECK_VALUE(LU_LADVISE_DONTNEED);
 	CHECK_VALUE(LU_LADVISE_LOCKNOEXPAND);
 	CHECK_VALUE(LU_LADVISE_LOCKAHEAD);
+	CHECK_VALUE(LU_LADVISE_WILLWRITE);
 }
 
 static void
@@ -642,6 +643,9 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT2_BATCH_RPC);
 	CHECK_DEFINE_64X(OBD_CONNECT2_PCCRO);
 	CHECK_DEFINE_64X(OBD_CONNECT2_ATOMIC_OPEN_LOCK);
+	CHECK_DEFINE_64X(OBD_CONNECT2_PIPE_PRECREATE);
+	CHECK_DEFINE_64X(OBD_CONNECT2_DESTROY_BATCH);
+	CHECK_DEFINE_64X(OBD_CONNECT2_QUOTA_BATCH);
 
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
 	CHECK_VALUE_X(OBD_CKSUM_ADLER);
@@ -928,7 +932,7 @@ check_obd_statfs(void)
 	CHECK_MEMBER(obd_statfs, os_state);
 	CHECK_MEMBER(obd_statfs, os_fprecreated);
 	CHECK_MEMBER(obd_statfs, os_granted);
-	CHECK_MEMBER(obd_statfs, os_spare3);
+	CHECK_MEMBER(obd_statfs, os_load);
 	CHECK_MEMBER(obd_statfs, os_spare4);
 	CHECK_MEMBER(obd_statfs, os_spare5);
 	CHECK_MEMBER(obd_statfs, os_spare6);
@@ -2166,6 +2170,65 @@ check_getinfo_fid2path(void)
 	printf("#endif /* HAVE_FID2PATH_ANON_UNIONS */\n");
 }
 
+static void
+check_lu_find_scan_cmp(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(lu_find_scan_cmp);
+	CHECK_MEMBER(lu_find_scan_cmp, lfsc_value);
+	CHECK_MEMBER(lu_find_scan_cmp, lfsc_margin);
+	CHECK_MEMBER(lu_find_scan_cmp, lfsc_sign);
+	CHECK_MEMBER(lu_find_scan_cmp, lfsc_padding);
+}
+
+static void
+check_lu_find_scan_ent(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(lu_find_scan_ent);
+	CHECK_MEMBER(lu_find_scan_ent, lfse_fid);
+	CHECK_MEMBER(lu_find_scan_ent, lfse_namelen);
+	CHECK_MEMBER(lu_find_scan_ent, lfse_type);
+	CHECK_MEMBER(lu_find_scan_ent, lfse_padding);
+	CHECK_MEMBER(lu_find_scan_ent, lfse_name[0]);
+}
+
+static void
+check_lu_find_scan(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(lu_find_scan);
+	CHECK_MEMBER(lu_find_scan, lfs_fid);
+	CHECK_MEMBER(lu_find_scan, lfs_cookie);
+	CHECK_MEMBER(lu_find_scan, lfs_valid);
+	CHECK_MEMBER(lu_find_scan, lfs_exclude);
+	CHECK_MEMBER(lu_find_scan, lfs_uid);
+	CHECK_MEMBER(lu_find_scan, lfs_gid);
+	CHECK_MEMBER(lu_find_scan, lfs_projid);
+	CHECK_MEMBER(lu_find_scan, lfs_layout);
+	CHECK_MEMBER(lu_find_scan, lfs_atime);
+	CHECK_MEMBER(lu_find_scan, lfs_mtime);
+	CHECK_MEMBER(lu_find_scan, lfs_ctime);
+	CHECK_MEMBER(lu_find_scan, lfs_size);
+	CHECK_MEMBER(lu_find_scan, lfs_stripe_count);
+	CHECK_MEMBER(lu_find_scan, lfs_pool);
+	CHECK_MEMBER(lu_find_scan, lfs_count);
+	CHECK_MEMBER(lu_find_scan, lfs_buflen);
+	CHECK_MEMBER(lu_find_scan, lfs_root_fid);
+	CHECK_MEMBER(lu_find_scan, lfs_ents[0]);
+
+	CHECK_VALUE_X(LFSV_ATIME);
+	CHECK_VALUE_X(LFSV_MTIME);
+	CHECK_VALUE_X(LFSV_CTIME);
+	CHECK_VALUE_X(LFSV_SIZE);
+	CHECK_VALUE_X(LFSV_UID);
+	CHECK_VALUE_X(LFSV_GID);
+	CHECK_VALUE_X(LFSV_PROJID);
+	CHECK_VALUE_X(LFSV_POOL);
+	CHECK_VALUE_X(LFSV_LAYOUT);
+	CHECK_VALUE_X(LFSV_STRIPE_COUNT);
+}
+
 /* We don't control the definitions of posix_acl_xattr_{entry,header}
  * and so we shouldn't have used them in our wire protocol. But it's
  * too late now and so we emit checks against the *fixed* definitions
@@ -3156,6 +3219,9 @@ printf("#endif /* HAVE_SERVER_SUPPORT */\n");
 	check_mgs_config_body();
 	check_mgs_config_res();
 	check_getinfo_fid2path();
+	check_lu_find_scan_cmp();
+	check_lu_find_scan_ent();
+	check_lu_find_scan();
 	check_ll_user_fiemap();
 	check_ll_fiemap_extent();
 	check_posix_acl_xattr_entry();